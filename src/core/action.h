@@ -46,9 +46,6 @@ struct Action
 	int       pluginParam = -1;
 	ID        prevId = 0;
 	ID        nextId = 0;
-	
-	const Action* prev = nullptr;
-	const Action* next = nullptr;
 
 	bool isValid() const 
 	{
@@ -0,0 +1,522 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include "core/const.h"
+#include "actionTimeline.h"
+
+
+namespace giada {
+namespace m
+{
+namespace
+{
+template <typename T>
+void permute_(std::vector<T>& v, const std::vector<std::size_t>& order)
+{
+	std::vector<T> out(order.size());
+	for (std::size_t i = 0; i < order.size(); i++)
+		out[i] = v[order[i]];
+	v = std::move(out);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* mix_
+Scrambles the bits of 'x' (splitmix64 finalizer), so that close keys land far
+apart in the hash tables. */
+
+std::size_t mix_(uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return static_cast<std::size_t>(x ^ (x >> 31));
+}
+
+
+std::size_t hashEvent_(ID channelId, Frame f, uint32_t raw)
+{
+	return mix_((static_cast<uint64_t>(channelId) << 32 | static_cast<uint32_t>(f)) ^ mix_(raw));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* probe_
+Linear probing: returns the first index in 'table' matching 'equal', starting
+from 'hash', or npos if an empty slot comes first. */
+
+template <typename F>
+std::size_t probe_(const std::vector<std::size_t>& table, std::size_t hash, F equal)
+{
+	if (table.empty())
+		return ActionTimeline::npos;
+
+	std::size_t mask = table.size() - 1;
+	for (std::size_t slot = hash & mask; table[slot] != ActionTimeline::npos; slot = (slot + 1) & mask)
+		if (equal(table[slot]))
+			return table[slot];
+	return ActionTimeline::npos;
+}
+
+
+void add_(std::vector<std::size_t>& table, std::size_t hash, std::size_t index)
+{
+	std::size_t mask = table.size() - 1;
+	std::size_t slot = hash & mask;
+	while (table[slot] != ActionTimeline::npos)
+		slot = (slot + 1) & mask;
+	table[slot] = index;
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t ActionTimeline::size() const { return m_ids.size(); }
+bool ActionTimeline::empty() const       { return m_ids.empty(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Action ActionTimeline::get(std::size_t i) const
+{
+	assert(i < size());
+
+	return Action {m_ids[i], m_channelIds[i], m_frames[i], m_events[i],
+		m_pluginIds[i], m_pluginParams[i], m_prevIds[i], m_nextIds[i]};
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t ActionTimeline::find(ID id) const
+{
+	return probe_(m_byId, mix_(id), [&](std::size_t i) { return m_ids[i] == id; });
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool ActionTimeline::contains(ID channelId, Frame f, const MidiEvent& e, 
+	ID pluginId, int pluginParam) const
+{
+	uint32_t raw = e.getRaw();
+
+	/* Plug-in data is left out of the hash: actions on the same frame for 
+	different parameters are rare, and just end up in the same probe chain. */
+
+	return probe_(m_byEvent, hashEvent_(channelId, f, raw), [&](std::size_t i)
+	{
+		return m_channelIds[i] == channelId && m_frames[i] == f && m_events[i].getRaw() == raw &&
+		       m_pluginIds[i] == pluginId && m_pluginParams[i] == pluginParam;
+	}) != npos;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t ActionTimeline::lowerBound(Frame f) const
+{
+	return std::lower_bound(m_frames.begin(), m_frames.end(), f) - m_frames.begin();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame ActionTimeline::getMaxSpan(ID channelId) const
+{
+	auto it = std::lower_bound(m_spans.begin(), m_spans.end(), channelId, 
+		[](const std::pair<ID, Frame>& s, ID id) { return s.first < id; });
+	return it != m_spans.end() && it->first == channelId ? it->second : 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t ActionTimeline::countOnChannel(ID channelId) const
+{
+	auto [first, last] = channelRange(channelId);
+	return last - first;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::insert(const Action& a)
+{
+	insert(std::vector<Action>{a});
+}
+
+
+void ActionTimeline::insert(const std::vector<Action>& as, bool skipDuplicates)
+{
+	if (as.empty())
+		return;
+
+	rehash(size() + as.size());
+
+	for (const Action& a : as)
+		if (!skipDuplicates || !contains(a.channelId, a.frame, a.event, a.pluginId, a.pluginParam))
+			push(a);
+
+	/* New actions are appended, so a stable sort keeps them after the existing
+	ones on the same frame. */
+
+	sort();
+	reindex();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::removeIf(std::function<bool(const Action&)> f)
+{
+	std::vector<std::size_t> order;
+	order.reserve(size());
+	for (std::size_t i = 0; i < size(); i++)
+		if (!f(get(i)))
+			order.push_back(i);
+
+	if (order.size() == size())
+		return;
+
+	permute(order);
+	reindex();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::clear()
+{
+	*this = ActionTimeline();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::setFrames(std::function<Frame(Frame old)> f)
+{
+	for (Frame& frame : m_frames)
+		frame = f(frame);
+	sort();
+	reindex();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::setEvent(std::size_t i, const MidiEvent& e)
+{
+	assert(i < size());
+
+	m_events[i] = e;
+	rehash(size());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::setSiblings(std::size_t i, ID prevId, ID nextId)
+{
+	assert(i < size());
+
+	std::size_t prev = find(prevId);
+	std::size_t next = find(nextId);
+
+	m_prevIds[i] = prev != npos ? prevId : 0;
+	m_nextIds[i] = next != npos ? nextId : 0;
+	m_prev[i]    = prev;
+	m_next[i]    = next;
+
+	if (prev != npos) {
+		m_nextIds[prev] = m_ids[i];
+		m_next[prev]    = i;
+	}
+	if (next != npos) {
+		m_prevIds[next] = m_ids[i];
+		m_prev[next]    = i;
+	}
+
+	/* Spans only grow here: old links may still be the widest ones, and a 
+	larger bound is still a valid one. */
+
+	growSpan(prev, i);
+	growSpan(i, next);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+float ActionTimeline::getLaneValue(const Lane& lane, Frame f) const
+{
+	assert(lane.first < lane.last && lane.last <= m_lanePoints.size());
+
+	auto value = [this](std::size_t i)
+	{ 
+		return m_events[i].getVelocity() / static_cast<float>(G_MAX_VELOCITY);
+	};
+
+	auto first = m_lanePoints.begin() + lane.first;
+	auto last  = m_lanePoints.begin() + lane.last;
+	auto next  = std::upper_bound(first, last, f, 
+		[this](Frame f, std::size_t i) { return f < m_frames[i]; });
+
+	if (next == first)
+		return value(*first);
+	if (next == last)
+		return value(*(next - 1));
+
+	std::size_t a = *(next - 1);
+	std::size_t b = *next;
+	float       t = (f - m_frames[a]) / static_cast<float>(m_frames[b] - m_frames[a]);
+
+	return value(a) + (value(b) - value(a)) * t;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::pair<ActionTimeline::Iterator, ActionTimeline::Iterator> 
+ActionTimeline::channelRange(ID channelId) const
+{
+	struct Compare
+	{
+		const std::vector<ID>& channelIds;
+		bool operator()(std::size_t i, ID id) const { return channelIds[i] < id; }
+		bool operator()(ID id, std::size_t i) const { return id < channelIds[i]; }
+	};
+
+	return std::equal_range(m_byChannel.begin(), m_byChannel.end(), channelId, 
+		Compare{m_channelIds});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::permute(const std::vector<std::size_t>& order)
+{
+	permute_(m_ids, order);
+	permute_(m_channelIds, order);
+	permute_(m_frames, order);
+	permute_(m_events, order);
+	permute_(m_pluginIds, order);
+	permute_(m_pluginParams, order);
+	permute_(m_prevIds, order);
+	permute_(m_nextIds, order);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::sort()
+{
+	if (std::is_sorted(m_frames.begin(), m_frames.end()))
+		return;
+
+	std::vector<std::size_t> order(size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), 
+		[this](std::size_t a, std::size_t b) { return m_frames[a] < m_frames[b]; });
+
+	permute(order);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::reindex()
+{
+	rehash(size());
+
+	/* Actions are sorted by frame, so a stable sort by channel keeps them 
+	sorted by frame within each channel. */
+
+	m_byChannel.resize(size());
+	std::iota(m_byChannel.begin(), m_byChannel.end(), 0);
+	std::stable_sort(m_byChannel.begin(), m_byChannel.end(), 
+		[this](std::size_t a, std::size_t b) { return m_channelIds[a] < m_channelIds[b]; });
+
+	reindexLanes();
+
+	m_prev.resize(size());
+	m_next.resize(size());
+	for (std::size_t i = 0; i < size(); i++) {
+		m_prev[i] = m_prevIds[i] != 0 ? find(m_prevIds[i]) : npos;
+		m_next[i] = m_nextIds[i] != 0 ? find(m_nextIds[i]) : npos;
+	}
+
+	reindexSpans();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::reindexSpans()
+{
+	m_spans.clear();
+	for (std::size_t i : m_byChannel) {
+		growSpan(m_prev[i], i);
+		growSpan(i, m_next[i]);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::growSpan(std::size_t a, std::size_t b)
+{
+	/* Links going back in time (e.g. the last point of an envelope wrapping 
+	around to the first one) don't count. Spans are computed in int64 as frames
+	can be anywhere in the Frame range, then saturated. */
+
+	if (a == npos || b == npos || m_frames[b] < m_frames[a])
+		return;
+
+	const std::int64_t d    = std::int64_t(m_frames[b]) - std::int64_t(m_frames[a]);
+	const Frame        span = static_cast<Frame>(std::min<std::int64_t>(d, std::numeric_limits<Frame>::max()));
+
+	const ID channelId = m_channelIds[a];
+	auto it = std::lower_bound(m_spans.begin(), m_spans.end(), channelId, 
+		[](const std::pair<ID, Frame>& s, ID id) { return s.first < id; });
+	if (it == m_spans.end() || it->first != channelId)
+		m_spans.insert(it, {channelId, span});
+	else
+		it->second = std::max(it->second, span);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::reindexLanes()
+{
+	m_lanes.clear();
+	m_lanePoints.clear();
+
+	/* The channel index is sorted by channel and frame: a stable sort by lane
+	keeps points sorted by frame within each lane. */
+
+	for (std::size_t i : m_byChannel)
+		if (m_events[i].getStatus() == MidiEvent::ENVELOPE)
+			m_lanePoints.push_back(i);
+
+	auto key = [this](std::size_t i)
+	{
+		return std::make_tuple(m_channelIds[i], m_pluginIds[i], m_pluginParams[i]);
+	};
+
+	std::stable_sort(m_lanePoints.begin(), m_lanePoints.end(), 
+		[&key](std::size_t a, std::size_t b) { return key(a) < key(b); });
+
+	for (std::size_t i = 0; i < m_lanePoints.size(); i++) {
+		std::size_t p = m_lanePoints[i];
+		if (m_lanes.empty() || key(p) != key(m_lanePoints[m_lanes.back().first]))
+			m_lanes.push_back({m_channelIds[p], m_pluginIds[p], m_pluginParams[p], i, i});
+		m_lanes.back().last = i + 1;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::push(const Action& a)
+{
+	std::size_t i = size();
+
+	m_ids.push_back(a.id);
+	m_channelIds.push_back(a.channelId);
+	m_frames.push_back(a.frame);
+	m_events.push_back(a.event);
+	m_pluginIds.push_back(a.pluginId);
+	m_pluginParams.push_back(a.pluginParam);
+	m_prevIds.push_back(a.prevId);
+	m_nextIds.push_back(a.nextId);
+
+	assert(m_byId.size() >= size() * 2);
+
+	add_(m_byId, mix_(a.id), i);
+	add_(m_byEvent, hashEvent(i), i);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ActionTimeline::rehash(std::size_t count)
+{
+	std::size_t tableSize = 16;
+	while (tableSize < count * 2)
+		tableSize *= 2;
+
+	m_byId.assign(tableSize, npos);
+	m_byEvent.assign(tableSize, npos);
+	for (std::size_t i = 0; i < size(); i++) {
+		add_(m_byId, mix_(m_ids[i]), i);
+		add_(m_byEvent, hashEvent(i), i);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t ActionTimeline::hashEvent(std::size_t i) const
+{
+	return hashEvent_(m_channelIds[i], m_frames[i], m_events[i].getRaw());
+}
+}} // giada::m::
@@ -0,0 +1,322 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_ACTION_TIMELINE_H
+#define G_ACTION_TIMELINE_H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "core/types.h"
+#include "core/action.h"
+#include "core/midiEvent.h"
+
+
+namespace giada {
+namespace m
+{
+/* ActionTimeline
+Flat container of recorded actions, laid out as a structure of arrays sorted by
+frame. Actions on the same frame keep their insertion order. Sibling actions 
+(prev/next) are linked by index, so the whole timeline is made of trivially 
+copyable arrays: cloning it for a model swap is a plain memory copy, with no 
+pointers to fix up. Lookups by ID and by channel+frame+event go through two 
+hash tables, lookups by channel through an index array sorted by channel: the 
+tables are flat arrays too, with open addressing. Envelope points are also 
+grouped into lanes, for automation playback. Any structural change (insert,
+remove, new frames) rebuilds the indexes: meant to be edited from the main 
+thread, read from the audio one. */
+
+class ActionTimeline
+{
+public:
+
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	/* Lane
+	Envelope points sharing the same channel, plug-in and parameter. Volume 
+	envelopes have no plug-in (pluginId == -1). Points are in [first, last) of
+	the lane points array, sorted by frame. */
+
+	struct Lane
+	{
+		ID          channelId;
+		ID          pluginId;
+		int         pluginParam;
+		std::size_t first;
+		std::size_t last;
+	};
+
+	std::size_t size() const;
+	bool empty() const;
+
+	/* get
+	Rebuilds the Action at index 'i'. */
+
+	Action get(std::size_t i) const;
+
+	ID        getId(std::size_t i) const          { return m_ids[i]; }
+	ID        getChannelId(std::size_t i) const   { return m_channelIds[i]; }
+	Frame     getFrame(std::size_t i) const       { return m_frames[i]; }
+	MidiEvent getEvent(std::size_t i) const       { return m_events[i]; }
+	ID        getPluginId(std::size_t i) const    { return m_pluginIds[i]; }
+	int       getPluginParam(std::size_t i) const { return m_pluginParams[i]; }
+
+	/* getPrev, getNext
+	Index of the previous/next sibling of action 'i', or npos if none. */
+
+	std::size_t getPrev(std::size_t i) const { return m_prev[i]; }
+	std::size_t getNext(std::size_t i) const { return m_next[i]; }
+
+	/* getMaxSpan
+	Upper bound of the distance in frames between two sibling actions of channel
+	'channelId', following links forward in time (e.g. the length of the longest
+	note, or the widest gap between two envelope points). 0 if none. Bounds 
+	lookups of actions linked across a frame range. */
+
+	Frame getMaxSpan(ID channelId) const;
+
+	/* find
+	Returns the index of the action with ID 'id', or npos if not found. */
+
+	std::size_t find(ID id) const;
+
+	/* contains
+	True if an action with the same channel, frame, event and plug-in parameter
+	already exists. */
+
+	bool contains(ID channelId, Frame f, const MidiEvent& e, ID pluginId=-1, 
+		int pluginParam=-1) const;
+
+	/* lowerBound
+	Index of the first action with frame >= 'f', or size() if none. */
+
+	std::size_t lowerBound(Frame f) const;
+
+	/* countOnChannel
+	How many actions belong to channel 'channelId'. */
+
+	std::size_t countOnChannel(ID channelId) const;
+
+	/* insert (1)
+	Adds a single action after any other action on the same frame. */
+
+	void insert(const Action& a);
+
+	/* insert (2)
+	Merges a batch of actions in the timeline. Cheaper than inserting them one
+	by one, as indexes are rebuilt only once. If 'skipDuplicates', actions equal
+	to an existing one (or to one earlier in the batch), as in contains(), are 
+	left out. */
+
+	void insert(const std::vector<Action>& as, bool skipDuplicates=false);
+
+	/* removeIf
+	Removes all actions for which 'f' returns true. */
+
+	void removeIf(std::function<bool(const Action&)> f);
+
+	void clear();
+
+	/* setFrames
+	Moves every action to the frame returned by 'f', given the old one. */
+
+	void setFrames(std::function<Frame(Frame old)> f);
+
+	void setEvent(std::size_t i, const MidiEvent& e);
+
+	/* setSiblings
+	Links action 'i' to actions with ID 'prevId' and 'nextId' (0 = none). 
+	Existing siblings are linked back to 'i'. */
+
+	void setSiblings(std::size_t i, ID prevId, ID nextId);
+
+	/* forEach
+	Calls 'f(index)' on each action, sorted by frame. */
+
+	template <typename F>
+	void forEach(F f) const
+	{
+		for (std::size_t i = 0; i < size(); i++)
+			f(i);
+	}
+
+	/* forEachInRange
+	Calls 'f(index)' on each action in frames [a, b), sorted by frame. */
+
+	template <typename F>
+	void forEachInRange(Frame a, Frame b, F f) const
+	{
+		for (std::size_t i = lowerBound(a); i < size() && m_frames[i] < b; i++)
+			f(i);
+	}
+
+	/* forEachOnChannel
+	Calls 'f(index)' on each action belonging to channel 'channelId', sorted by
+	frame. */
+
+	template <typename F>
+	void forEachOnChannel(ID channelId, F f) const
+	{
+		auto [first, last] = channelRange(channelId);
+		for (auto it = first; it != last; ++it)
+			f(*it);
+	}
+
+	/* forEachOnChannel (2)
+	Same as above, limited to frames [a, b). */
+
+	template <typename F>
+	void forEachOnChannel(ID channelId, Frame a, Frame b, F f) const
+	{
+		auto [first, last] = channelRange(channelId);
+		auto it = std::lower_bound(first, last, a, 
+			[this](std::size_t i, Frame f) { return m_frames[i] < f; });
+		for (; it != last && m_frames[*it] < b; ++it)
+			f(*it);
+	}
+
+	/* forEachLane
+	Calls 'f(const Lane&)' on each envelope lane of channel 'channelId'. */
+
+	template <typename F>
+	void forEachLane(ID channelId, F f) const
+	{
+		auto [first, last] = std::equal_range(m_lanes.begin(), m_lanes.end(), 
+			Lane{channelId, 0, 0, 0, 0}, 
+			[](const Lane& a, const Lane& b) { return a.channelId < b.channelId; });
+		for (auto it = first; it != last; ++it)
+			f(*it);
+	}
+
+	/* getLaneValue
+	Returns the value of lane 'lane' at frame 'f' in [0.0, 1.0], linearly
+	interpolated between the two points around 'f'. Frames before the first 
+	point or after the last one take the value of that point. */
+
+	float getLaneValue(const Lane& lane, Frame f) const;
+
+private:
+
+	using Iterator = std::vector<std::size_t>::const_iterator;
+
+	std::pair<Iterator, Iterator> channelRange(ID channelId) const;
+
+	/* permute
+	Rearranges all arrays so that the new i-th action is the old 'order[i]'-th. 
+	Indexes not in 'order' are dropped. */
+
+	void permute(const std::vector<std::size_t>& order);
+
+	/* sort
+	Stable-sorts the arrays by frame. */
+
+	void sort();
+
+	/* reindex
+	Rebuilds the hash tables, the channel index, the lanes and the sibling 
+	links. */
+
+	void reindex();
+
+	/* reindexLanes
+	Groups envelope points into lanes. Requires the channel index. */
+
+	void reindexLanes();
+
+	/* reindexSpans
+	Rebuilds the sibling spans of each channel. Requires the sibling links. */
+
+	void reindexSpans();
+
+	/* growSpan
+	Widens the span of the channel of action 'a' to fit the link from action 'a'
+	to the later action 'b', if any. */
+
+	void growSpan(std::size_t a, std::size_t b);
+
+	/* push
+	Appends an action to the arrays and to the hash tables, leaving the rest of
+	the indexes alone. The timeline must be sorted and reindexed afterwards. */
+
+	void push(const Action& a);
+
+	/* rehash
+	Rebuilds the hash tables, with room for at least 'count' actions. */
+
+	void rehash(std::size_t count);
+
+	std::size_t hashEvent(std::size_t i) const;
+
+	std::vector<ID>        m_ids;
+	std::vector<ID>        m_channelIds;
+	std::vector<Frame>     m_frames;
+	std::vector<MidiEvent> m_events;
+	std::vector<ID>        m_pluginIds;
+	std::vector<int>       m_pluginParams;
+	std::vector<ID>        m_prevIds;
+	std::vector<ID>        m_nextIds;
+
+	/* m_prev, m_next
+	Sibling links, as indexes into the arrays above. */
+
+	std::vector<std::size_t> m_prev;
+	std::vector<std::size_t> m_next;
+
+	/* m_byId, m_byEvent
+	Hash tables of action indexes, keyed by ID and by channel+frame+event. Their
+	size is a power of two, at least twice the number of actions. Empty slots 
+	hold npos. */
+
+	std::vector<std::size_t> m_byId;
+	std::vector<std::size_t> m_byEvent;
+
+	/* m_byChannel
+	Action indexes sorted by channel, then frame. */
+
+	std::vector<std::size_t> m_byChannel;
+
+	/* m_lanes, m_lanePoints
+	Envelope lanes sorted by channel, plug-in and parameter. Each one refers to
+	a range of m_lanePoints, i.e. the indexes of its points sorted by frame. */
+
+	std::vector<Lane>        m_lanes;
+	std::vector<std::size_t> m_lanePoints;
+
+	/* m_spans
+	Largest sibling span of each channel with links, as channel ID + frames, 
+	sorted by channel. */
+
+	std::vector<std::pair<ID, Frame>> m_spans;
+};
+}} // giada::m::
+
+
+#endif
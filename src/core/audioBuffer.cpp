@@ -27,6 +27,13 @@
 
 #include <cassert>
 #include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define G_AUDIO_BUFFER_SSE
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define G_AUDIO_BUFFER_NEON
+#endif
 #include "audioBuffer.h"
 
 
@@ -210,6 +217,43 @@ void AudioBuffer::addData(const AudioBuffer& b, float gain, Pan pan)
 }
 
 
+void AudioBuffer::addData(const AudioBuffer& b, float gain, Frame frames, 
+	Frame srcOffset, Frame destOffset)
+{
+	assert(m_data != nullptr);
+	assert(b.countChannels() == countChannels());
+	assert(srcOffset + frames <= b.countFrames());
+	assert(destOffset + frames <= countFrames());
+
+	/* Frames are interleaved and the channels match: the range is a flat array
+	of samples on both sides. */
+
+	addSamples(m_data + destOffset * m_channels, b.m_data + srcOffset * m_channels, 
+		frames * m_channels, gain);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void AudioBuffer::addSamples(float* dest, const float* src, int count, float gain)
+{
+	int i = 0;
+
+#if defined(G_AUDIO_BUFFER_SSE)
+	const __m128 g = _mm_set1_ps(gain);
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), 
+			_mm_mul_ps(_mm_loadu_ps(src + i), g)));
+#elif defined(G_AUDIO_BUFFER_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(dest + i, vmlaq_n_f32(vld1q_f32(dest + i), vld1q_f32(src + i), gain));
+#endif
+	for (; i < count; i++)
+		dest[i] += src[i] * gain;
+}
+
+
 /* -------------------------------------------------------------------------- */
 
 
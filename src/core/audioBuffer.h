@@ -49,6 +49,12 @@ public:
 
 	using Pan = std::array<float, NUM_CHANS>;
 
+	/* addSamples
+	Adds 'count' samples from 'src', multiplied by 'gain', to 'dest'. Vectorized
+	where possible. Realtime-safe. */
+
+	static void addSamples(float* dest, const float* src, int count, float gain);
+
 	/* AudioBuffer (1)
 	Creates an empty (and invalid) audio buffer. */
 
@@ -103,12 +109,20 @@ public:
 
 	void copyData(const AudioBuffer& b, float gain=1.0f);
 
-	/* addData
+	/* addData (1)
 	Merges audio data from buffer 'b' onto this one. Applies optional gain and
 	pan if needed. */
 
 	void addData(const AudioBuffer& b, float gain=1.0f, Pan pan={1.0f, 1.0f});
 
+	/* addData (2)
+	Merges 'frames' frames of buffer 'b', starting from frame 'srcOffset', onto
+	this one starting from frame 'destOffset', multiplied by 'gain'. Both 
+	buffers must have the same number of channels. Realtime-safe. */
+
+	void addData(const AudioBuffer& b, float gain, Frame frames, Frame srcOffset, 
+		Frame destOffset);
+
 	/* setData
 	Views 'data' as new m_data. Makes sure not to delete the data 'data' points
 	to while using it. Set it back to nullptr when done. */
@@ -0,0 +1,793 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "core/const.h"
+#if defined(G_OS_WINDOWS)
+	#include <windows.h>
+#elif defined(G_OS_MAC)
+	#include <pthread.h>
+	#include <sys/qos.h>
+#elif defined(G_OS_LINUX)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+#include "utils/fs.h"
+#include "utils/log.h"
+#include "core/model/model.h"
+#include "core/model/storage.h"
+#include "core/patchBinary.h"
+#include "core/wave.h"
+#include "core/waveLoader.h"
+#include "core/waveManager.h"
+#include "core/autosave.h"
+
+
+namespace giada::m::autosave
+{
+namespace
+{
+constexpr auto SNAPSHOT_FILE = "snapshot.gptc";
+constexpr auto JOURNAL_FILE  = "journal";
+constexpr auto WAVES_DIR     = "waves";
+
+constexpr char JOURNAL_MAGIC[8] = { 'G', 'I', 'A', 'D', 'A', 'J', 'N', 'L' };
+
+/* COMPACT_SIZE
+Journal size in bytes that triggers a compaction. */
+
+constexpr std::size_t COMPACT_SIZE = 4 * 1024 * 1024;
+
+
+/* JournalHeader
+Beginning of the journal file. 'snapshot' is the hash of the snapshot file the
+journal has been made against. */
+
+struct JournalHeader
+{
+	char          magic[8];
+	std::uint64_t snapshot;
+};
+
+
+/* EntryHeader
+Beginning of each Entry in the journal, followed by 'size' bytes of data: the
+number of removed IDs for channels, actions, waves and plug-ins, the IDs 
+themselves, then the changes as a binary patch. */
+
+struct EntryHeader
+{
+	std::uint64_t size;
+	std::uint64_t checksum;
+};
+
+
+/* WaveRef
+File that holds the audio data of a Wave. 'data' is set only for edited Waves
+written to the autosave directory: a Wave pointing to different data has been 
+edited again since then. */
+
+struct WaveRef
+{
+	Wave::SharedData data;
+	std::string      path;
+};
+
+
+/* Job
+Session snapshot taken on the main thread, to be written by the autosave thread:
+the model as a patch, copies of the Waves (cheap: audio data is shared) and the
+data given by the last reset(), if any. */
+
+struct Job
+{
+	patch::Patch                patch;
+	std::vector<Wave>           waves;
+	std::optional<patch::Patch> reset;
+};
+
+
+/* Main thread state. */
+
+std::chrono::seconds                  interval_;
+std::chrono::steady_clock::time_point nextRun_;
+
+/* Thread state. Data below the mutex is owned by the autosave thread. */
+
+std::thread                 worker_;
+std::mutex                  mutex_;
+std::condition_variable     cond_;
+bool                        quit_ = false;
+bool                        busy_ = false;
+std::optional<Job>          job_;
+std::optional<patch::Patch> pending_;
+
+patch::Patch                    current_;
+bool                            mustCompact_ = true;
+std::size_t                     journalSize_ = 0;
+std::unordered_map<ID, WaveRef> waveRefs_;
+std::string                     sessionTag_;
+int                             waveCount_ = 0;
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::string makePath_(const std::string& dir, const std::string& name)
+{
+	return dir + G_SLASH + name;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* hash_
+64 bit FNV-1a hash of 'size' bytes. */
+
+std::uint64_t hash_(const std::uint8_t* data, std::size_t size)
+{
+	std::uint64_t h = 0xcbf29ce484222325;
+	for (std::size_t i = 0; i < size; i++)
+		h = (h ^ data[i]) * 0x100000001b3;
+	return h;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool readFile_(const std::string& path, std::vector<std::uint8_t>& out)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs.good())
+		return false;
+	out.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	return true;
+}
+
+
+/* writeFile_
+Replaces file 'path' atomically: data is written to a temporary file first, then
+renamed. */
+
+bool writeFile_(const std::string& path, const std::vector<std::uint8_t>& data)
+{
+	std::string tmp = path + ".tmp";
+	{
+		std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+		if (!ofs.write(reinterpret_cast<const char*>(data.data()), data.size()))
+			return false;
+	}
+	std::error_code ec;
+	std::filesystem::rename(tmp, path, ec);
+	return !ec;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+template <typename T>
+void diffList_(const std::vector<T>& from, const std::vector<T>& to, 
+	std::vector<T>& changed, std::vector<ID>& removed)
+{
+	std::unordered_map<ID, const T*> old;
+	for (const T& t : from)
+		old[t.id] = &t;
+
+	for (const T& t : to) {
+		auto it = old.find(t.id);
+		if (it == old.end() || !(*it->second == t))
+			changed.push_back(t);
+		if (it != old.end())
+			old.erase(it);
+	}
+
+	for (const T& t : from)
+		if (old.count(t.id) > 0)
+			removed.push_back(t.id);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+template <typename T>
+void applyList_(std::vector<T>& list, const std::vector<T>& changed, 
+	const std::vector<ID>& removed)
+{
+	std::unordered_set<ID> gone(removed.begin(), removed.end());
+	list.erase(std::remove_if(list.begin(), list.end(), [&gone](const T& t) 
+	{ 
+		return gone.count(t.id) > 0; 
+	}), list.end());
+
+	std::unordered_map<ID, std::size_t> index;
+	for (std::size_t i = 0; i < list.size(); i++)
+		index[list[i].id] = i;
+
+	for (const T& t : changed) {
+		auto it = index.find(t.id);
+		if (it != index.end())
+			list[it->second] = t;
+		else {
+			index[t.id] = list.size();
+			list.push_back(t);
+		}
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool sameCommons_(const patch::Patch& a, const patch::Patch& b)
+{
+	return a.name       == b.name       &&
+	       a.bars       == b.bars       &&
+	       a.beats      == b.beats      &&
+	       a.bpm        == b.bpm        &&
+	       a.quantize   == b.quantize   &&
+	       a.lastTakeId == b.lastTakeId &&
+	       a.samplerate == b.samplerate &&
+	       a.metronome  == b.metronome;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::vector<std::uint8_t> serializeEntry_(const Entry& e)
+{
+	const std::vector<ID>* lists[] = { &e.removedChannels, &e.removedActions, 
+		&e.removedWaves, &e.removedPlugins };
+
+	std::vector<std::uint8_t> out(sizeof(EntryHeader));
+	auto put = [&out](const void* data, std::size_t size)
+	{
+		const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+		out.insert(out.end(), bytes, bytes + size);
+	};
+
+	for (const std::vector<ID>* l : lists) {
+		std::uint32_t count = static_cast<std::uint32_t>(l->size());
+		put(&count, sizeof(count));
+	}
+	for (const std::vector<ID>* l : lists)
+		put(l->data(), l->size() * sizeof(ID));
+
+	std::vector<std::uint8_t> changes = patch::binary::serialize(e.changes);
+	put(changes.data(), changes.size());
+
+	EntryHeader header;
+	header.size     = out.size() - sizeof(EntryHeader);
+	header.checksum = hash_(out.data() + sizeof(EntryHeader), header.size);
+	std::memcpy(out.data(), &header, sizeof(EntryHeader));
+
+	return out;
+}
+
+
+bool deserializeEntry_(const std::uint8_t* data, std::size_t size, Entry& e)
+{
+	std::vector<ID>* lists[] = { &e.removedChannels, &e.removedActions, 
+		&e.removedWaves, &e.removedPlugins };
+	std::uint32_t    counts[4];
+
+	if (size < sizeof(counts))
+		return false;
+	std::memcpy(counts, data, sizeof(counts));
+
+	std::size_t offset = sizeof(counts);
+	for (int i = 0; i < 4; i++) {
+		if (counts[i] > (size - offset) / sizeof(ID))
+			return false;
+		lists[i]->resize(counts[i]);
+		std::memcpy(lists[i]->data(), data + offset, counts[i] * sizeof(ID));
+		offset += counts[i] * sizeof(ID);
+	}
+
+	return patch::binary::deserialize(data + offset, size - offset, "", e.changes) == G_PATCH_OK;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* addMissingColumns_
+Columns live in the UI and are saved only on reset(): give a column to channels 
+that have been moved to a new one in the meantime. */
+
+void addMissingColumns_(patch::Patch& p)
+{
+	for (const patch::Channel& c : p.channels) {
+		if (c.type == ChannelType::MASTER || c.type == ChannelType::PREVIEW)
+			continue;
+		bool found = std::any_of(p.columns.begin(), p.columns.end(), 
+			[&c](const patch::Column& col) { return col.id == c.columnId; });
+		if (!found)
+			p.columns.push_back({ c.columnId, G_DEFAULT_COLUMN_WIDTH });
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* setLowPriority_
+Lowers the priority of the calling thread, so that autosave never competes with
+the UI. Such a thread can be starved for long: it must never hold model locks, 
+as writers wait for readers to leave. */
+
+void setLowPriority_()
+{
+#if defined(G_OS_WINDOWS)
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(G_OS_MAC)
+	pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#elif defined(G_OS_LINUX)
+	sched_param param{};
+	pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* saveWaves_
+Refreshes the file references of Waves 'waves', copied from the model. Unedited
+Waves point to their source file, edited ones are written to the autosave 
+directory, each one in its own subdirectory so that the file name doesn't 
+change. */
+
+void saveWaves_(const std::string& dir, const std::vector<Wave>& waves)
+{
+	std::unordered_set<ID> alive;
+	for (const Wave& w : waves)
+		alive.insert(w.id);
+
+	for (auto it = waveRefs_.begin(); it != waveRefs_.end(); )
+		it = alive.count(it->first) > 0 ? std::next(it) : waveRefs_.erase(it);
+
+	for (const Wave& w : waves) {
+		if (!w.isDirty()) {
+			waveRefs_[w.id] = { nullptr, w.getSourcePath() };
+			continue;
+		}
+		auto it = waveRefs_.find(w.id);
+		if (it != waveRefs_.end() && it->second.data == w.getSharedData())
+			continue;
+
+		std::string waveDir = makePath_(makePath_(dir, WAVES_DIR), sessionTag_ + "-" + std::to_string(waveCount_++));
+		std::string path    = makePath_(waveDir, w.getBasename(/*ext=*/false) + ".wav");
+		std::error_code ec;
+		std::filesystem::create_directories(waveDir, ec);
+		if (waveManager::save(w, path) == G_RES_OK)
+			waveRefs_[w.id] = { w.getSharedData(), path };
+		else
+			u::log::print("[autosave] unable to save wave %d to %s\n", w.id, path);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* removeUnusedWaves_
+Removes Wave subdirectories no longer referenced by patch 'p'. */
+
+void removeUnusedWaves_(const std::string& dir, const patch::Patch& p)
+{
+	std::unordered_set<std::string> used;
+	for (const patch::Wave& w : p.waves)
+		used.insert(std::filesystem::path(w.path).parent_path().filename().string());
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(makePath_(dir, WAVES_DIR), ec))
+		if (used.count(entry.path().filename().string()) == 0)
+			std::filesystem::remove_all(entry.path(), ec);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* makeJob_
+Takes a snapshot of the session. Main thread only: the model is read through RCU
+locks as the UI does, and plug-ins are asked for their state. */
+
+Job makeJob_()
+{
+	Job job;
+	model::store(job.patch);
+
+	model::WavesLock l(model::waves);
+	for (const Wave* w : model::waves)
+		job.waves.push_back(*w);
+	return job;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* makeSnapshot_
+Returns the session in 'job', completed with data held by the UI as given by
+the last reset() and with the current Wave file references. */
+
+patch::Patch makeSnapshot_(const std::string& dir, Job& job)
+{
+	patch::Patch p = std::move(job.patch);
+	p.name       = current_.name;
+	p.lastTakeId = current_.lastTakeId;
+	p.columns    = current_.columns;
+
+	saveWaves_(dir, job.waves);
+
+	for (patch::Wave& w : p.waves) {
+		auto it = waveRefs_.find(w.id);
+		if (it != waveRefs_.end())
+			w.path = it->second.path;
+	}
+	return p;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void save_(const std::string& dir, Job job)
+{
+	if (job.reset) {
+		current_.name       = job.reset->name;
+		current_.lastTakeId = job.reset->lastTakeId;
+		current_.columns    = job.reset->columns;
+		mustCompact_        = true;
+	}
+
+	patch::Patch next = makeSnapshot_(dir, job);
+
+	if (mustCompact_ || journalSize_ >= COMPACT_SIZE) {
+		if (!compact(dir, next)) {
+			u::log::print("[autosave] unable to write snapshot to %s\n", dir);
+			return;
+		}
+		removeUnusedWaves_(dir, next);
+		mustCompact_ = false;
+		journalSize_ = 0;
+		current_     = std::move(next);
+		return;
+	}
+
+	std::optional<Entry> e = diff(current_, next);
+	if (!e)
+		return;
+
+	std::size_t written = append(dir, *e);
+	if (written == 0) {
+		u::log::print("[autosave] unable to write journal to %s\n", dir);
+		return;
+	}
+	journalSize_ += written;
+	current_      = std::move(next);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void run_(std::string dir)
+{
+	setLowPriority_();
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		cond_.wait(lock, [] { return quit_ || job_.has_value(); });
+		if (quit_)
+			return;
+
+		Job job = std::move(*job_);
+		job_.reset();
+		busy_ = true;
+
+		lock.unlock();
+		save_(dir, std::move(job));
+		lock.lock();
+
+		busy_ = false;
+	}
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+std::optional<Entry> diff(const patch::Patch& from, const patch::Patch& to)
+{
+	Entry e;
+
+	diffList_(from.channels, to.channels, e.changes.channels, e.removedChannels);
+	diffList_(from.actions,  to.actions,  e.changes.actions,  e.removedActions);
+	diffList_(from.waves,    to.waves,    e.changes.waves,    e.removedWaves);
+#ifdef WITH_VST
+	diffList_(from.plugins,  to.plugins,  e.changes.plugins,  e.removedPlugins);
+#endif
+
+	bool same = sameCommons_(from, to) && 
+		e.changes.channels.empty() && e.removedChannels.empty() &&
+		e.changes.actions.empty()  && e.removedActions.empty()  &&
+		e.changes.waves.empty()    && e.removedWaves.empty()    &&
+#ifdef WITH_VST
+		e.changes.plugins.empty()  && e.removedPlugins.empty()  &&
+#endif
+		true;
+	if (same)
+		return {};
+
+	e.changes.name       = to.name;
+	e.changes.bars       = to.bars;
+	e.changes.beats      = to.beats;
+	e.changes.bpm        = to.bpm;
+	e.changes.quantize   = to.quantize;
+	e.changes.lastTakeId = to.lastTakeId;
+	e.changes.samplerate = to.samplerate;
+	e.changes.metronome  = to.metronome;
+
+	return e;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void apply(const Entry& e, patch::Patch& p)
+{
+	p.name       = e.changes.name;
+	p.bars       = e.changes.bars;
+	p.beats      = e.changes.beats;
+	p.bpm        = e.changes.bpm;
+	p.quantize   = e.changes.quantize;
+	p.lastTakeId = e.changes.lastTakeId;
+	p.samplerate = e.changes.samplerate;
+	p.metronome  = e.changes.metronome;
+
+	applyList_(p.channels, e.changes.channels, e.removedChannels);
+	applyList_(p.actions,  e.changes.actions,  e.removedActions);
+	applyList_(p.waves,    e.changes.waves,    e.removedWaves);
+#ifdef WITH_VST
+	applyList_(p.plugins,  e.changes.plugins,  e.removedPlugins);
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool compact(const std::string& dir, const patch::Patch& p)
+{
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+
+	std::vector<std::uint8_t> snapshot = patch::binary::serialize(p);
+
+	JournalHeader header;
+	std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+	header.snapshot = hash_(snapshot.data(), snapshot.size());
+
+	std::vector<std::uint8_t> journal(sizeof(JournalHeader));
+	std::memcpy(journal.data(), &header, sizeof(JournalHeader));
+
+	/* Snapshot first: a crash in between leaves the old journal, which doesn't
+	match the new snapshot and is ignored by recover(). */
+
+	return writeFile_(makePath_(dir, SNAPSHOT_FILE), snapshot) && 
+	       writeFile_(makePath_(dir, JOURNAL_FILE), journal);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t append(const std::string& dir, const Entry& e)
+{
+	std::vector<std::uint8_t> data = serializeEntry_(e);
+
+	std::ofstream ofs(makePath_(dir, JOURNAL_FILE), std::ios::binary | std::ios::app);
+	if (!ofs.good() || !ofs.write(reinterpret_cast<const char*>(data.data()), data.size()) || !ofs.flush())
+		return 0;
+	return data.size();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool canRecover(const std::string& dir)
+{
+	return u::fs::fileExists(makePath_(dir, SNAPSHOT_FILE));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int recover(const std::string& dir, patch::Patch& p)
+{
+	std::vector<std::uint8_t> snapshot;
+	if (!readFile_(makePath_(dir, SNAPSHOT_FILE), snapshot))
+		return G_PATCH_UNREADABLE;
+
+	int res = patch::binary::deserialize(snapshot.data(), snapshot.size(), "", p);
+	if (res != G_PATCH_OK)
+		return res;
+
+	std::vector<std::uint8_t> journal;
+	JournalHeader             header;
+
+	if (!readFile_(makePath_(dir, JOURNAL_FILE), journal) || journal.size() < sizeof(JournalHeader))
+		journal.clear();
+	else
+		std::memcpy(&header, journal.data(), sizeof(JournalHeader));
+
+	if (!journal.empty() && 
+	    std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0 &&
+	    header.snapshot == hash_(snapshot.data(), snapshot.size())) {
+		std::size_t offset = sizeof(JournalHeader);
+		int         count  = 0;
+		while (journal.size() - offset >= sizeof(EntryHeader)) {
+			EntryHeader eh;
+			std::memcpy(&eh, journal.data() + offset, sizeof(EntryHeader));
+			offset += sizeof(EntryHeader);
+
+			const std::uint8_t* data = journal.data() + offset;
+			Entry               e;
+			if (eh.size > journal.size() - offset || eh.checksum != hash_(data, eh.size) ||
+			    !deserializeEntry_(data, eh.size, e)) {
+				u::log::print("[autosave::recover] broken journal entry, %d entries replayed\n", count);
+				break;
+			}
+			apply(e, p);
+			offset += eh.size;
+			count++;
+		}
+	}
+
+	addMissingColumns_(p);
+	return G_PATCH_OK;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void clear(const std::string& dir)
+{
+	std::error_code ec;
+	std::filesystem::remove_all(dir, ec);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void start(const std::string& dir, int interval)
+{
+	stop();
+
+	current_     = patch::Patch();
+	mustCompact_ = true;
+	journalSize_ = 0;
+	waveCount_   = 0;
+	sessionTag_  = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count());
+	waveRefs_.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = false;
+		busy_ = false;
+		job_.reset();
+		pending_.reset();
+	}
+
+	interval_ = std::chrono::seconds(std::max(1, interval));
+	nextRun_  = std::chrono::steady_clock::now() + interval_;
+
+	u::log::print("[autosave::start] saving to %s every %d seconds\n", dir, interval);
+
+	worker_ = std::thread(run_, dir);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void update()
+{
+	if (!worker_.joinable() || std::chrono::steady_clock::now() < nextRun_)
+		return;
+
+	/* The model is incomplete while Waves are still being loaded. */
+
+	if (waveLoader::isLoading())
+		return;
+
+	/* Previous snapshot still being written: skip this round. */
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (busy_ || job_.has_value())
+			return;
+	}
+
+	nextRun_ = std::chrono::steady_clock::now() + interval_;
+
+	Job job = makeJob_();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		job.reset = std::move(pending_);
+		pending_.reset();
+		job_ = std::move(job);
+	}
+	cond_.notify_one();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void stop()
+{
+	if (!worker_.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		quit_ = true;
+	}
+	cond_.notify_one();
+	worker_.join();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void reset(const patch::Patch& p)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	pending_ = p;
+}
+} // giada::m::autosave::
@@ -0,0 +1,138 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_AUTOSAVE_H
+#define G_AUTOSAVE_H
+
+
+#include <optional>
+#include <string>
+#include <vector>
+#include "core/patch.h"
+#include "core/types.h"
+
+
+namespace giada::m::autosave
+{
+/* Autosave
+Keeps a copy of the session on disk, to be recovered after a crash. Every few 
+seconds the main thread takes a snapshot of the model (see update()) and hands
+it over to a low priority thread, which compares it with the last saved state 
+and appends the differences to a journal file. From time to time the journal 
+is compacted into a full binary patch, the snapshot. Edited samples are written
+to the autosave directory and journaled by path, like unedited ones. Only the 
+main thread reads the model: the low priority thread never holds model locks.
+
+	[dir]/snapshot.gptc  binary patch, see patch::binary
+	[dir]/journal        header + list of Entries, made against the snapshot
+	[dir]/waves/         edited samples */
+
+/* Entry
+A change to the session, as stored in the journal: items added or modified 
+since the previous state, plus IDs of the removed ones. Commons (name, bpm, 
+bars, ...) are always there. */
+
+struct Entry
+{
+	patch::Patch    changes;
+	std::vector<ID> removedChannels;
+	std::vector<ID> removedActions;
+	std::vector<ID> removedWaves;
+	std::vector<ID> removedPlugins;
+};
+
+/* diff
+Returns the Entry that turns patch 'from' into patch 'to', or nothing if they 
+are equal. Columns are not included: see reset(). */
+
+std::optional<Entry> diff(const patch::Patch& from, const patch::Patch& to);
+
+/* apply
+Applies Entry 'e' to patch 'p'. */
+
+void apply(const Entry& e, patch::Patch& p);
+
+/* compact
+Writes patch 'p' as the new snapshot in 'dir' and starts an empty journal. */
+
+bool compact(const std::string& dir, const patch::Patch& p);
+
+/* append
+Appends Entry 'e' to the journal in 'dir'. Returns the number of bytes 
+written, 0 on failure. */
+
+std::size_t append(const std::string& dir, const Entry& e);
+
+/* canRecover
+True if 'dir' holds a session to recover, i.e. Giada didn't stop normally. */
+
+bool canRecover(const std::string& dir);
+
+/* recover
+Rebuilds the session found in 'dir' into patch 'p': the snapshot, then the 
+journal replayed on top of it. A broken entry at the end of the journal (a 
+crash while writing) is discarded, together with anything after it. Returns
+one of the G_PATCH_* values. */
+
+int recover(const std::string& dir, patch::Patch& p);
+
+/* clear
+Removes all autosave files from 'dir'. */
+
+void clear(const std::string& dir);
+
+/* start
+Starts the autosave thread: the model is checked every 'interval' seconds and
+changes are saved to 'dir'. */
+
+void start(const std::string& dir, int interval);
+
+/* update
+Takes a snapshot of the model for the autosave thread, if 'interval' seconds 
+have passed and the previous one has been written. Call it periodically from 
+the main thread. */
+
+void update();
+
+/* stop
+Stops the autosave thread. Autosave files are left there: call clear() after a 
+normal shutdown, as there is nothing to recover. */
+
+void stop();
+
+/* reset
+Starts a new session, e.g. after a project has been loaded, saved or closed: 
+the journal is compacted on the next run. Only data not held by the model is
+taken from patch 'p': name, last take ID and columns (they belong to the UI, 
+see v::model). */
+
+void reset(const patch::Patch& p);
+} // giada::m::autosave::
+
+
+#endif
@@ -26,6 +26,8 @@
 
 
 #include "core/channels/state.h"
+#include "core/const.h"
+#include "core/mixer.h"
 #include "audioReceiver.h"
 
 
@@ -67,12 +69,19 @@ void AudioReceiver::render(const AudioBuffer& in) const
 	/* If armed and input monitor is on, copy input buffer to channel buffer: 
 	this enables the input monitoring. The channel buffer will be overwritten 
 	later on by pluginHost::processStack, so that you would record "clean" audio 
-	(i.e. not plugin-processed). */
+	(i.e. not plugin-processed). Channels with their own pair of inputs monitor
+	that one instead of the master input. */
 
 	bool armed        = m_channelState->armed.load();
 	bool inputMonitor = state->inputMonitor.load();
+	int  pair         = state->inputPair.load();
 
-	if (armed && inputMonitor)
-		m_channelState->buffer.addData(in);  // add, don't overwrite
+	if (!armed || !inputMonitor)
+		return;
+
+	if (pair >= 0 && pair < G_MAX_INPUT_PAIRS)
+		m_channelState->buffer.addData(mixer::getInputPair(pair));  // add, don't overwrite
+	else
+		m_channelState->buffer.addData(in);
 }
 }} // giada::m::
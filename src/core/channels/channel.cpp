@@ -25,8 +25,11 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include <cassert>
 #include "core/channels/state.h"
+#include "core/model/model.h"
+#include "core/clock.h"
 #include "core/mixerHandler.h"
 #include "core/plugins/pluginHost.h"
 #include "channel.h"
@@ -151,13 +154,26 @@ Channel::Channel(const patch::Channel& p, Frame bufferSize)
 /* -------------------------------------------------------------------------- */
 
 
-void Channel::parse(const mixer::EventBuffer& events, bool audible) const
+void Channel::parse(const mixer::EventBuffer& events, bool audible, 
+	Range<Frame> seqFrames) const
 {
+	/* Recorded actions are interleaved with events by frame: actions before an
+	event go first, actions on the same frame (e.g. of a SEQUENCER_FIRST_BEAT)
+	right after it. 'done' is how many frames of the block have had their 
+	actions read so far. */
+
+	Frame done = 0;
+
 	for (const mixer::Event& e : events) {
 
 		if (e.action.channelId > 0 && e.action.channelId != id)
 			continue;
 
+		if (e.delta > done) {
+			parseActions(seqFrames, done, e.delta);
+			done = e.delta;
+		}
+
 		parse(e);
 		midiLighter.parse(e, audible);
 
@@ -171,6 +187,8 @@ void Channel::parse(const mixer::EventBuffer& events, bool audible) const
   		if (sampleActionRecorder && samplePlayer && samplePlayer->hasWave()) 
 			sampleActionRecorder->parse(e);
 	}
+
+	parseActions(seqFrames, done, seqFrames.getLength());
 }
 
 
@@ -179,9 +197,6 @@ void Channel::parse(const mixer::EventBuffer& events, bool audible) const
 
 void Channel::advance(Frame bufferSize) const
 {
-	/* TODO - this is used only to advance samplePlayer for its quantizer. Use
-	this to render actions in the future. */
-
 	if (samplePlayer) samplePlayer->advance(bufferSize);
 }
 
@@ -233,6 +248,52 @@ void Channel::parse(const mixer::Event& e) const
 /* -------------------------------------------------------------------------- */
 
 
+void Channel::parseActions(Range<Frame> seqFrames, Frame from, Frame to) const
+{
+	to = std::min(to, seqFrames.getLength());
+	if (from >= to)
+		return;
+
+	model::ActionsLock lock(model::actions);
+
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+	const Frame           total    = clock::getFramesInLoop();
+	const Frame           end      = seqFrames.getBegin() + to;
+
+	/* The range is split where it wraps around the loop. For each piece, a 
+	binary search finds the first action of this channel, then a cursor walks 
+	the channel actions along with the frames. Envelope points are not events:
+	they are read by the plug-in automation instead. */
+
+	for (Frame a = seqFrames.getBegin() + from; a < end;) {
+		Frame global = a % total;
+		Frame length = std::min(end - a, total - global);
+		Frame local  = a - seqFrames.getBegin();
+
+		timeline.forEachOnChannel(id, global, global + length, [&](std::size_t i)
+		{
+			if (timeline.getEvent(i).getStatus() == MidiEvent::ENVELOPE)
+				return;
+			parseAction({ mixer::EventType::ACTION, local + timeline.getFrame(i) - global, timeline.get(i) });
+		});
+		a += length;
+	}
+}
+
+
+void Channel::parseAction(const mixer::Event& e) const
+{
+#ifdef WITH_VST
+	if (midiReceiver) midiReceiver->parse(e);
+#endif
+	if (midiSender)   midiSender->parse(e);
+	if (samplePlayer) samplePlayer->parse(e);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void Channel::renderMasterOut(AudioBuffer& out) const
 {
 	state->buffer.copyData(out);
@@ -266,11 +327,17 @@ void Channel::renderChannel(AudioBuffer& out, AudioBuffer& in, bool audible) con
 	if (samplePlayer)  samplePlayer->render(out);
 	if (audioReceiver) audioReceiver->render(in);
 
+#ifdef WITH_VST
+	/* Plug-in parameter envelopes are applied once per block, before the 
+	plug-in stack runs. */
+
+	if (pluginIds.size() > 0 && clock::isRunning() && state->readActions.load())
+		pluginHost::automate(id, clock::getCurrentFrame());
+
 	/* If MidiReceiver exists, let it process the plug-in stack, as it can 
 	contain plug-ins that take MIDI events (i.e. synths). Otherwise process the
 	plug-in stack internally with no MIDI events. */
 
-#ifdef WITH_VST
 	if (midiReceiver)  
 		midiReceiver->render(pluginIds); 
 	else 
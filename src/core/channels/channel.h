@@ -31,6 +31,7 @@
 
 #include <optional>
 #include "core/const.h"
+#include "core/range.h"
 #include "core/mixer.h"
 #include "core/channels/state.h"
 #include "core/channels/samplePlayer.h"
@@ -66,12 +67,16 @@ public:
     ~Channel()                         = default;
 
     /* parse
-    Parses live events. */
+    Parses live events, along with the recorded actions read straight from the
+    timeline in 'seqFrames', i.e. the sequencer block in global frames (empty if
+    the sequencer is not running). Actions and events are parsed in frame order;
+    an action on the same frame of an event comes after it. */
 
-    void parse(const mixer::EventBuffer& e, bool audible) const;
+    void parse(const mixer::EventBuffer& e, bool audible, 
+        Range<Frame> seqFrames={}) const;
 
     /* advance
-    Processes static events (e.g. actions) in the current block. */
+    Processes static events in the current block. */
 
     void advance(Frame bufferSize) const;
 
@@ -116,6 +121,14 @@ private:
 
     void parse(const mixer::Event& e) const;
 
+    /* parseActions
+    Reads the actions of this channel in frames [from, to) of 'seqFrames', 
+    relative to its beginning and wrapped around the loop, and hands them over
+    to the components. */
+
+    void parseActions(Range<Frame> seqFrames, Frame from, Frame to) const;
+    void parseAction(const mixer::Event& e) const;
+
     void renderMasterOut(AudioBuffer& out) const;
     void renderMasterIn(AudioBuffer& in) const;
     void renderChannel(AudioBuffer& out, AudioBuffer& in, bool audible) const;
@@ -147,10 +147,17 @@ const patch::Channel serializeChannel(const Channel& c)
 		pc.begin             = c.samplePlayer->state->begin.load();
 		pc.end               = c.samplePlayer->state->end.load();
 		pc.pitch             = c.samplePlayer->state->pitch.load();
+		pc.resamplerQuality  = c.samplePlayer->getResamplerQuality();
+		pc.stretchToTempo    = c.samplePlayer->state->stretchToTempo.load();
+		pc.stretchBeats      = c.samplePlayer->state->stretchBeats.load();
+		pc.polyphony         = c.samplePlayer->getPolyphony();
+		pc.voiceStealing     = c.samplePlayer->getVoiceStealing();
+		pc.rootNote          = c.samplePlayer->getRootNote();
 		pc.shift             = c.samplePlayer->state->shift.load();
 		pc.midiInVeloAsVol   = c.samplePlayer->state->velocityAsVol.load();
 		pc.inputMonitor      = c.audioReceiver->state->inputMonitor.load();
 		pc.overdubProtection = c.audioReceiver->state->overdubProtection.load();
+		pc.inputPair         = c.audioReceiver->state->inputPair.load();
 
 	}
 	else
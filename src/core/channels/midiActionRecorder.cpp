@@ -73,7 +73,8 @@ void MidiActionRecorder::record(const MidiEvent& e) const
 {
 	MidiEvent flat(e);
 	flat.setChannel(0);
-	recorderHandler::liveRec(m_channelState->id, flat, clock::quantize(clock::getCurrentFrame()));
+	recorderHandler::liveRec(m_channelState->id, flat, clock::quantize(clock::getCurrentFrame()), 
+		Thread::AUDIO);
 	m_channelState->hasActions = true;
 }
 
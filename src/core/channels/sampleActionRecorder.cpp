@@ -101,7 +101,7 @@ void SampleActionRecorder::parse(const mixer::Event& e) const
 void SampleActionRecorder::record(int note) const
 {
 	recorderHandler::liveRec(m_channelState->id, MidiEvent(note, 0, 0), 
-		clock::quantize(clock::getCurrentFrame()));
+		clock::quantize(clock::getCurrentFrame()), Thread::AUDIO);
 
 	m_channelState->hasActions = true;
 }
@@ -27,10 +27,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include "core/channels/channel.h"
 #include "core/channels/state.h"
 #include "core/wave.h"
 #include "core/clock.h"
+#include "utils/math.h"
 #include "samplePlayer.h"
 
 
@@ -40,6 +42,7 @@ namespace m
 SamplePlayer::SamplePlayer(ChannelState* c)
 : state             (std::make_unique<SamplePlayerState>())
 , m_waveId          (0)
+, m_voicePool       (c->buffer.countFrames())
 , m_sampleController(c, state.get())
 , m_channelState    (c)
 {
@@ -53,6 +56,7 @@ SamplePlayer::SamplePlayer(const SamplePlayer& o, ChannelState* c)
 : state             (std::make_unique<SamplePlayerState>(*o.state))
 , m_waveId          (o.m_waveId)
 , m_waveReader      (o.m_waveReader)
+, m_voicePool       (o.m_voicePool)
 , m_sampleController(o.m_sampleController, c, state.get())
 , m_channelState    (c)
 {
@@ -65,9 +69,15 @@ SamplePlayer::SamplePlayer(const SamplePlayer& o, ChannelState* c)
 SamplePlayer::SamplePlayer(const patch::Channel& p, ChannelState* c)
 : state             (std::make_unique<SamplePlayerState>(p))
 , m_waveId          (p.waveId)
+, m_voicePool       (c->buffer.countFrames())
 , m_sampleController(c, state.get())
 , m_channelState    (c)
 {
+    m_waveReader.setQuality(p.resamplerQuality);
+    m_voicePool.setQuality(p.resamplerQuality);
+    m_voicePool.setPolyphony(p.polyphony);
+    m_voicePool.setStealing(p.voiceStealing);
+    m_voicePool.setRootNote(p.rootNote);
 }
 
 
@@ -79,8 +89,37 @@ void SamplePlayer::parse(const mixer::Event& e) const
     if (e.type == mixer::EventType::CHANNEL_PITCH)
         state->pitch.store(e.action.event.getVelocityFloat());
 
-    if (hasWave())
-        m_sampleController.parse(e);
+    if (!hasWave())
+        return;
+
+    m_sampleController.parse(e);
+
+    if (e.type == mixer::EventType::MIDI && m_voicePool.isKeyed())
+        parseNote(e.action.event, e.delta);
+    else
+    if (e.type == mixer::EventType::KEY_KILL)
+        m_voicePool.kill(e.delta);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void SamplePlayer::parseNote(const MidiEvent& e, Frame localFrame) const
+{
+    int note = e.getNote();
+
+    if (e.getStatus() == MidiEvent::NOTE_ON && e.getVelocity() > 0) {
+        float pitch = std::exp2((note - m_voicePool.getRootNote()) / 12.0f);
+        float gain  = state->velocityAsVol.load() ? u::math::map(e.getVelocity(), G_MAX_VELOCITY, 1.0f) : 1.0f;
+        m_voicePool.start(state->begin.load(), localFrame, pitch, gain, note);
+    }
+    else
+    if (e.getStatus() == MidiEvent::NOTE_OFF || e.getStatus() == MidiEvent::NOTE_ON) {
+        /* Note off is meaningful only for SINGLE_PRESS mode, as with keys. */
+        if (state->mode.load() == SamplePlayerMode::SINGLE_PRESS)
+            m_voicePool.release(note, localFrame);
+    }
 }
 
 
@@ -100,19 +139,35 @@ void SamplePlayer::render(AudioBuffer& /*out*/) const
 {
     assert(m_channelState != nullptr);
 
-    if (m_waveReader.wave == nullptr || !m_channelState->isPlaying())
+    if (m_waveReader.wave == nullptr)
         return;
 
     Frame begin   = state->begin.load();
     Frame end     = state->end.load();
-    Frame tracker = state->tracker.load();
     float pitch   = state->pitch.load();
-    Frame used    = 0;
+    float stretch = getStretch(begin, end);
 
-    /* Audio data is temporarily stored to the working audio buffer. */
+    /* Audio data is temporarily stored to the working audio buffer. Extra 
+    voices are mixed in last, as the main voice overwrites the buffer. They 
+    keep on playing even if the channel has been stopped. */
 
     AudioBuffer& buffer = m_channelState->buffer;
 
+    if (m_channelState->isPlaying())
+        renderPlayer(buffer, begin, end, pitch, stretch);
+    m_voicePool.render(buffer, pitch, stretch, begin, end);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void SamplePlayer::renderPlayer(AudioBuffer& buffer, Frame begin, Frame end, 
+    float pitch, float stretch) const
+{
+    Frame tracker = state->tracker.load();
+    bool  loop    = shouldLoop();
+
     /* Adjust tracker in case someone has changed the begin/end points in the
     meantime. */
     
@@ -120,30 +175,39 @@ void SamplePlayer::render(AudioBuffer& /*out*/) const
         tracker = begin;
 
     /* If rewinding, fill the tail first, then reset the tracker to the begin
-    point. The rest is performed as usual. */
+    point. The rest is performed as usual. A retriggered sample with a free 
+    voice hands the tail over to it instead: it plays to the end, overlapped
+    to the new start. */
 
     if (state->rewinding) {
-		if (tracker < end)
-            m_waveReader.fill(buffer, tracker, 0, pitch);
+        bool forked = state->mode.load() == SamplePlayerMode::SINGLE_RETRIG && 
+                      tracker < end && m_voicePool.fork(m_waveReader, tracker);
+		if (!forked && tracker < end)
+            m_waveReader.fill(buffer, tracker, 0, pitch, stretch, begin, end, /*loop=*/false);
         state->rewinding = false;
 		tracker = begin;
     }
 
-    used     = m_waveReader.fill(buffer, tracker, state->offset, pitch);
-    tracker += used;
+    WaveReader::Result res = m_waveReader.fill(buffer, tracker, state->offset, pitch, stretch, begin, end, loop);
+    tracker += res.used;
 
-G_DEBUG ("block=[" << tracker - used << ", " << tracker << ")" << 
-         ", used=" << used << ", range=[" << begin << ", " << end << ")" <<
+G_DEBUG ("block=[" << tracker - res.used << ", " << tracker << ")" << 
+         ", used=" << res.used << ", range=[" << begin << ", " << end << ")" <<
          ", tracker=" << tracker << 
          ", offset=" << state->offset << ", globalFrame=" << clock::getCurrentFrame());
 
     if (tracker >= end) {
 G_DEBUG ("last frame tracker=" << tracker);
+        /* The resampler might read slightly past the end point: carry the 
+        excess over to the next loop, to keep the loop seamless. */
+        Frame overshoot = end > begin ? (tracker - end) % (end - begin) : 0;
         tracker = begin;
         m_sampleController.onLastFrame();
         if (shouldLoop()) {
-            Frame offset = std::min(static_cast<Frame>(used / pitch), buffer.countFrames() - 1);
-            tracker += m_waveReader.fill(buffer, tracker, offset, pitch);
+            Frame offset = state->offset + res.generated;
+            tracker += overshoot;
+            if (offset < buffer.countFrames())
+                tracker += m_waveReader.fill(buffer, tracker, offset, pitch, stretch, begin, end, loop).used;
         }
     }
 
@@ -158,6 +222,7 @@ G_DEBUG ("last frame tracker=" << tracker);
 void SamplePlayer::loadWave(const Wave* w)
 {
     m_waveReader.wave = w;
+    m_voicePool.setWave(w);
 
     state->tracker.store(0);
     state->shift.store(0);
@@ -184,23 +249,51 @@ void SamplePlayer::loadWave(const Wave* w)
 void SamplePlayer::setWave(const Wave& w, float samplerateRatio)
 {
     m_waveReader.wave = &w;
+    m_voicePool.setWave(&w);
     m_waveId = w.id;
 
-    if (samplerateRatio != 1.0f) {
-        Frame begin = state->begin.load();
-        Frame end   = state->end.load();
-        Frame shift = state->shift.load();
-        state->begin.store(begin * samplerateRatio);
-        state->end.store(end * samplerateRatio);
-        state->shift.store(shift * samplerateRatio);
-    }
+    if (m_channelState->playStatus.load() == ChannelStatus::LOADING)
+        m_channelState->playStatus.store(ChannelStatus::OFF);
+
+    applySamplerateRatio(samplerateRatio);
+}
+
+
+void SamplePlayer::setLoadingWave(float samplerateRatio)
+{
+    m_waveReader.wave = nullptr;
+    m_voicePool.setWave(nullptr);
+    m_channelState->playStatus.store(ChannelStatus::LOADING);
+
+    applySamplerateRatio(samplerateRatio);
 }
 
 
 void SamplePlayer::setInvalidWave()
 {
     m_waveReader.wave = nullptr;
+    m_voicePool.setWave(nullptr);
     m_waveId = 0;
+
+    if (m_channelState->playStatus.load() == ChannelStatus::LOADING)
+        m_channelState->playStatus.store(ChannelStatus::MISSING);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void SamplePlayer::applySamplerateRatio(float samplerateRatio)
+{
+    if (samplerateRatio == 1.0f)
+        return;
+
+    Frame begin = state->begin.load();
+    Frame end   = state->end.load();
+    Frame shift = state->shift.load();
+    state->begin.store(begin * samplerateRatio);
+    state->end.store(end * samplerateRatio);
+    state->shift.store(shift * samplerateRatio);
 }
 
 
@@ -233,9 +326,53 @@ bool SamplePlayer::shouldLoop() const
 /* -------------------------------------------------------------------------- */
 
 
+float SamplePlayer::getStretch(Frame begin, Frame end) const
+{
+    float beats = state->stretchBeats.load();
+
+    if (!state->stretchToTempo.load() || beats <= 0.0f || end <= begin)
+        return 1.0f;
+    return (beats * clock::getFramesInBeat()) / static_cast<float>(end - begin);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 bool SamplePlayer::hasWave() const        { return m_waveReader.wave != nullptr; }
 bool SamplePlayer::hasLogicalWave() const { return hasWave() && m_waveReader.wave->isLogical(); }
 bool SamplePlayer::hasEditedWave() const  { return hasWave() && m_waveReader.wave->isEdited(); }
+bool SamplePlayer::isLoadingWave() const  { return m_channelState->playStatus.load() == ChannelStatus::LOADING; }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+ResamplerQuality SamplePlayer::getResamplerQuality() const
+{
+    return m_waveReader.getQuality();
+}
+
+
+void SamplePlayer::setResamplerQuality(ResamplerQuality q)
+{
+    m_waveReader.setQuality(q);
+    m_voicePool.setQuality(q);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int           SamplePlayer::getPolyphony() const     { return m_voicePool.getPolyphony(); }
+VoiceStealing SamplePlayer::getVoiceStealing() const { return m_voicePool.getStealing(); }
+int           SamplePlayer::getRootNote() const      { return m_voicePool.getRootNote(); }
+bool          SamplePlayer::isKeyed() const          { return m_voicePool.isKeyed(); }
+
+
+void SamplePlayer::setPolyphony(int p)               { m_voicePool.setPolyphony(p); }
+void SamplePlayer::setVoiceStealing(VoiceStealing s) { m_voicePool.setStealing(s); }
+void SamplePlayer::setRootNote(int note)             { m_voicePool.setRootNote(note); }
 
 
 /* -------------------------------------------------------------------------- */
@@ -34,6 +34,7 @@
 #include "core/mixer.h" // TODO - forward declare
 #include "core/audioBuffer.h" // TODO - forward declare
 #include "core/channels/waveReader.h"
+#include "core/channels/voicePool.h"
 #include "core/channels/sampleController.h"
 
 
@@ -57,8 +58,19 @@ public:
     bool hasWave() const;
     bool hasLogicalWave() const;
     bool hasEditedWave() const;
+    bool isLoadingWave() const;
     ID getWaveId() const;
     Frame getWaveSize() const;
+    ResamplerQuality getResamplerQuality() const;
+    int getPolyphony() const;
+    VoiceStealing getVoiceStealing() const;
+    int getRootNote() const;
+
+    /* isKeyed
+    True if incoming MIDI notes play the sample chromatically, one voice per
+    note (see VoicePool). */
+
+    bool isKeyed() const;
 
     /* loadWave
     Loads Wave 'w' into this channel and sets it up (name, markers, ...). */
@@ -72,8 +84,15 @@ public:
 
     void setWave(const Wave& w, float samplerateRatio);
 
+    /* setLoadingWave
+    Keeps the Wave ID but no Wave yet: the channel waits for its Wave to be
+    decoded in background. Ratio is applied as in setWave(). */
+
+    void setLoadingWave(float samplerateRatio);
+
     /* setInvalidWave
-    Same as setWave(nullptr) plus the invalid ID (i.e. 0). */
+    Same as setWave(nullptr) plus the invalid ID (i.e. 0). A channel still in
+    loading state is marked as MISSING. */
     
     void setInvalidWave(); 
 
@@ -83,6 +102,18 @@ public:
     
     void kickIn(Frame f);
 
+    /* setResamplerQuality
+    Selects the interpolation used when playing the Wave at a pitch other than
+    1.0. */
+
+    void setResamplerQuality(ResamplerQuality q);
+
+    /* setPolyphony, setVoiceStealing, setRootNote
+    Voice settings, see VoicePool. Playing voices are stopped. */
+
+    void setPolyphony(int p);
+    void setVoiceStealing(VoiceStealing s);
+    void setRootNote(int note);
 
     /* state
     Pointer to mutable SamplePlayerState state. */
@@ -93,6 +124,24 @@ private:
 
     bool shouldLoop() const;
 
+    /* renderPlayer
+    Renders the main voice, i.e. the one driven by the SampleController. */
+
+    void renderPlayer(AudioBuffer& buffer, Frame begin, Frame end, float pitch,
+        float stretch) const;
+
+    /* parseNote
+    Starts or releases a voice on a MIDI note, when in keyed mode. */
+
+    void parseNote(const MidiEvent& e, Frame localFrame) const;
+
+    /* getStretch
+    Returns how much the range [begin, end) must be stretched to last 
+    'stretchBeats' beats at the current tempo, or 1.0 if stretching is off. */
+
+    float getStretch(Frame begin, Frame end) const;
+    void applySamplerateRatio(float samplerateRatio);
+
     ID m_waveId;
 
     /* m_waveReader
@@ -100,6 +149,11 @@ private:
 
     WaveReader m_waveReader;
 
+    /* m_voicePool
+    Extra voices: retriggered tails and MIDI notes in keyed mode. */
+
+    VoicePool m_voicePool;
+
     /* m_sampleController
     Managers events for this Sample Player. */
 
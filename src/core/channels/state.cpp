@@ -164,6 +164,8 @@ SamplePlayerState::SamplePlayerState()
 : tracker      (0)
 , pitch        (G_DEFAULT_PITCH)
 , mode         (SamplePlayerMode::SINGLE_BASIC)
+, stretchToTempo(false)
+, stretchBeats (0.0f)
 , velocityAsVol(false)
 , rewinding    (false)
 , quantizing   (false)
@@ -179,6 +181,8 @@ SamplePlayerState::SamplePlayerState(const SamplePlayerState& o)
 , shift        (o.shift.load())
 , begin        (o.begin.load())
 , end          (o.end.load())
+, stretchToTempo(o.stretchToTempo.load())
+, stretchBeats (o.stretchBeats.load())
 , velocityAsVol(o.velocityAsVol.load())
 , rewinding    (o.rewinding)
 , quantizing   (o.quantizing)
@@ -195,6 +199,8 @@ SamplePlayerState::SamplePlayerState(const patch::Channel& p)
 , shift        (p.shift)
 , begin        (p.begin)
 , end          (p.end)
+, stretchToTempo(p.stretchToTempo)
+, stretchBeats (p.stretchBeats)
 , velocityAsVol(p.midiInVeloAsVol)
 , rewinding    (false)
 , quantizing   (false)
@@ -225,6 +231,7 @@ bool SamplePlayerState::isAnyLoopMode() const
 AudioReceiverState::AudioReceiverState(const conf::Conf& c)
 : inputMonitor     (c.inputMonitorDefaultOn)
 , overdubProtection(c.overdubProtectionDefaultOn)
+, inputPair        (-1)
 {
 }
 
@@ -232,6 +239,7 @@ AudioReceiverState::AudioReceiverState(const conf::Conf& c)
 AudioReceiverState::AudioReceiverState(const patch::Channel& p)
 : inputMonitor     (p.inputMonitor)
 , overdubProtection(p.overdubProtection)
+, inputPair        (p.inputPair)
 {
 }
 
@@ -239,6 +247,7 @@ AudioReceiverState::AudioReceiverState(const patch::Channel& p)
 AudioReceiverState::AudioReceiverState(const AudioReceiverState& o)
 : inputMonitor     (o.inputMonitor.load())
 , overdubProtection(o.overdubProtection.load())
+, inputPair        (o.inputPair.load())
 {
 }
 
@@ -167,6 +167,13 @@ struct SamplePlayerState
     std::atomic<Frame>            begin;
     std::atomic<Frame>            end;
 
+    /* stretchToTempo, stretchBeats
+    If enabled, the sample follows the tempo without changing pitch, lasting 
+    'stretchBeats' beats. */
+
+    std::atomic<bool>             stretchToTempo;
+    std::atomic<float>            stretchBeats;
+
     /* velocityAsVol
     Velocity drives volume. */
 
@@ -190,6 +197,14 @@ struct AudioReceiverState
 
     std::atomic<bool> inputMonitor;
     std::atomic<bool> overdubProtection;
+
+    /* inputPair
+    Stereo pair of device inputs to record from and to monitor, i.e. channels
+    2 * inputPair and 2 * inputPair + 1 counted from the first input channel
+    selected in the configuration. -1 for the master input, plug-ins 
+    included. */
+
+    std::atomic<int>  inputPair;
 };
 
 
@@ -0,0 +1,266 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <cassert>
+#include <algorithm>
+#include "core/const.h"
+#include "voicePool.h"
+
+
+namespace giada {
+namespace m 
+{
+VoicePool::VoicePool(Frame bufferSize)
+: m_serial    (0)
+, m_bufferSize(bufferSize)
+, m_wave      (nullptr)
+, m_quality   (ResamplerQuality::LINEAR)
+, m_polyphony (1)
+, m_stealing  (VoiceStealing::OLDEST)
+, m_rootNote  (-1)
+{
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool VoicePool::start(Frame start, Frame offset, float pitch, float gain, int note) const
+{
+	Voice* v = grab();
+	if (v == nullptr)
+		return false;
+
+	v->reader.reset();
+	v->tracker = start;
+	v->offset  = offset;
+	v->stopAt  = -1;
+	v->pitch   = pitch;
+	v->gain    = gain;
+	v->note    = note;
+	v->serial  = ++m_serial;
+	v->active  = true;
+	return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool VoicePool::fork(const WaveReader& reader, Frame tracker) const
+{
+	Voice* v = grab();
+	if (v == nullptr)
+		return false;
+
+	v->reader  = reader; // Same buffer sizes: no allocation here
+	v->tracker = tracker;
+	v->offset  = 0;
+	v->stopAt  = -1;
+	v->pitch   = 1.0f;
+	v->gain    = 1.0f;
+	v->note    = -1;
+	v->serial  = ++m_serial;
+	v->active  = true;
+	return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void VoicePool::release(int note, Frame offset) const
+{
+	for (Voice& v : m_voices)
+		if (v.active && v.note == note && v.stopAt == -1)
+			v.stopAt = offset;
+}
+
+
+void VoicePool::kill(Frame offset) const
+{
+	for (Voice& v : m_voices)
+		if (v.active)
+			v.stopAt = offset;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void VoicePool::render(AudioBuffer& out, float pitch, float stretch, Frame begin, 
+	Frame end) const
+{
+	const Frame frames   = out.countFrames();
+	const int   channels = out.countChannels();
+
+	if (m_wave == nullptr || m_scratch.countFrames() < frames)
+		return;
+
+	for (Voice& v : m_voices) {
+		if (!v.active)
+			continue;
+
+		/* A voice can't start past the end point, which might have been moved
+		in the meantime. */
+
+		Frame stop = v.stopAt >= 0 ? std::max(v.stopAt, v.offset) : frames;
+		WaveReader::Result res = {0, 0};
+
+		if (v.tracker < end && v.offset < stop)
+			res = v.reader.fill(m_scratch, v.tracker, v.offset, pitch * v.pitch, 
+				stretch, begin, end, /*loop=*/false);
+
+		Frame last = std::min(v.offset + res.generated, stop);
+		for (Frame i = v.offset; i < last; i++)
+			for (int j = 0; j < channels; j++)
+				out[i][j] += m_scratch[i][j] * v.gain;
+		
+		v.tracker += res.used;
+		v.active   = v.stopAt == -1 && v.tracker < end && res.generated == frames - v.offset;
+		v.offset   = 0;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int VoicePool::countActive() const
+{
+	return std::count_if(m_voices.begin(), m_voices.end(), [](const Voice& v)
+	{ 
+		return v.active; 
+	});
+}
+
+
+int           VoicePool::getPolyphony() const { return m_polyphony; }
+VoiceStealing VoicePool::getStealing() const  { return m_stealing; }
+int           VoicePool::getRootNote() const  { return m_rootNote; }
+bool          VoicePool::isKeyed() const      { return m_rootNote >= 0; }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void VoicePool::setWave(const Wave* w)
+{
+	m_wave = w;
+	for (Voice& v : m_voices) {
+		v.reader.wave = w;
+		v.active      = false;
+	}
+}
+
+
+void VoicePool::setQuality(ResamplerQuality q)
+{
+	m_quality = q;
+	for (Voice& v : m_voices)
+		v.reader.setQuality(q);
+}
+
+
+void VoicePool::setPolyphony(int p)
+{
+	m_polyphony = std::clamp(p, 1, G_MAX_POLYPHONY);
+	resize();
+}
+
+
+void VoicePool::setStealing(VoiceStealing s)
+{
+	m_stealing = s;
+}
+
+
+void VoicePool::setRootNote(int note)
+{
+	m_rootNote = std::min(note, G_MAX_VELOCITY); // Notes share the velocity range
+	resize();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+VoicePool::Voice* VoicePool::grab() const
+{
+	if (m_voices.empty())
+		return nullptr;
+
+	auto free = std::find_if(m_voices.begin(), m_voices.end(), [](const Voice& v)
+	{ 
+		return !v.active; 
+	});
+	if (free != m_voices.end())
+		return &*free;
+
+	switch (m_stealing) {
+		case VoiceStealing::OLDEST:
+			return &*std::min_element(m_voices.begin(), m_voices.end(), 
+				[](const Voice& a, const Voice& b)
+			{
+				return a.serial < b.serial;
+			});
+		
+		case VoiceStealing::QUIETEST:
+			return &*std::min_element(m_voices.begin(), m_voices.end(), 
+				[](const Voice& a, const Voice& b)
+			{
+				return a.gain < b.gain || (a.gain == b.gain && a.serial < b.serial);
+			});
+
+		default:
+			return nullptr;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void VoicePool::resize()
+{
+	std::size_t size = isKeyed() ? m_polyphony : m_polyphony - 1;
+
+	m_voices.clear();
+	m_voices.resize(size);
+	for (Voice& v : m_voices) {
+		v.reader.wave = m_wave;
+		v.reader.setQuality(m_quality);
+	}
+
+	if (size > 0 && m_scratch.countFrames() != m_bufferSize)
+		m_scratch.alloc(m_bufferSize, G_MAX_IO_CHANS);
+	else
+	if (size == 0)
+		m_scratch.free();
+}
+}} // giada::m::
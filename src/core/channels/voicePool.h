@@ -0,0 +1,171 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_CHANNEL_VOICE_POOL_H
+#define G_CHANNEL_VOICE_POOL_H
+
+
+#include <cstdint>
+#include <vector>
+#include "core/types.h"
+#include "core/audioBuffer.h"
+#include "core/channels/waveReader.h"
+
+
+namespace giada {
+namespace m
+{
+class Wave;
+
+/* VoicePool
+Extra voices of a sample channel, i.e. copies of the sample playing at the 
+same time, each one with its own read position, pitch and gain. Voices are 
+allocated when the polyphony changes (main thread, on a model clone) and then
+recycled: starting, releasing and rendering a voice never allocates, so the
+pool is safe to use in the audio thread. When all voices are busy a new one
+is taken from a playing voice, according to the stealing policy. */
+
+class VoicePool final
+{
+public:
+
+	VoicePool(Frame bufferSize=0);
+
+	/* start
+	Starts a voice reading from frame 'start', 'pitch' times faster than the 
+	channel pitch and scaled by 'gain'. Playback begins at frame 'offset' of the
+	next rendered block. Voices started this way are tagged with 'note', so 
+	that they can be released later on. Returns false if no voice is 
+	available. */
+
+	bool start(Frame start, Frame offset, float pitch, float gain, int note) const;
+
+	/* fork
+	Moves the audio being played by 'reader' from frame 'tracker' into a voice,
+	so that it keeps playing to the end while 'reader' starts over. Resampler 
+	and stretcher state come along, for a click-free transition. */
+
+	bool fork(const WaveReader& reader, Frame tracker) const;
+
+	/* release
+	Stops voices tagged with 'note' at frame 'offset' of the next rendered
+	block. */
+
+	void release(int note, Frame offset) const;
+
+	/* kill
+	Stops all voices at frame 'offset' of the next rendered block. */
+
+	void kill(Frame offset) const;
+
+	/* render
+	Adds active voices to 'out', reading the range [begin, end) of the Wave 
+	at the channel 'pitch' and 'stretch' (see WaveReader::fill()). */
+
+	void render(AudioBuffer& out, float pitch, float stretch, Frame begin, 
+		Frame end) const;
+
+	int countActive() const;
+	int getPolyphony() const;
+	VoiceStealing getStealing() const;
+	int getRootNote() const;
+
+	/* isKeyed
+	True if the channel plays incoming MIDI notes chromatically, with 'root 
+	note' at the original pitch. */
+
+	bool isKeyed() const;
+
+	/* setWave
+	Sets the Wave to read from. All voices are stopped. */
+
+	void setWave(const Wave* w);
+	void setQuality(ResamplerQuality q);
+
+	/* setPolyphony
+	Sets how many copies of the sample can play at the same time, in range 
+	[1, G_MAX_POLYPHONY]. All voices are stopped. */
+
+	void setPolyphony(int p);
+	void setStealing(VoiceStealing s);
+
+	/* setRootNote
+	Sets the MIDI note that plays the sample at its original pitch. Any value
+	below zero disables the keyed mode. */
+
+	void setRootNote(int note);
+
+private:
+
+	struct Voice
+	{
+		WaveReader reader;
+		Frame      tracker = 0;
+		Frame      offset  = 0;
+		Frame      stopAt  = -1;
+		float      pitch   = 1.0f;
+		float      gain    = 1.0f;
+		int        note    = -1;
+		uint64_t   serial  = 0;
+		bool       active  = false;
+	};
+
+	/* grab
+	Returns a voice ready to be started, or nullptr if none is available. */
+
+	Voice* grab() const;
+
+	/* resize
+	Allocates voices according to the current polyphony and keyed mode: the
+	channel's own player counts as the first voice, unless keyed. */
+
+	void resize();
+
+	/* m_voices, m_serial
+	Voices and a counter of voices started so far, to tell the oldest one. */
+
+	mutable std::vector<Voice> m_voices;
+	mutable uint64_t           m_serial;
+
+	/* m_scratch
+	Working buffer each voice is rendered to before being mixed. Allocated 
+	only if there are voices. */
+
+	mutable AudioBuffer m_scratch;
+
+	Frame            m_bufferSize;
+	const Wave*      m_wave;
+	ResamplerQuality m_quality;
+	int              m_polyphony;
+	VoiceStealing    m_stealing;
+	int              m_rootNote;
+};
+}} // giada::m::
+
+
+#endif
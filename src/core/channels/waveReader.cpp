@@ -25,14 +25,12 @@
  * -------------------------------------------------------------------------- */
 
 
-#include <memory>
 #include <cassert>
 #include <algorithm>
 #include "core/const.h"
 #include "core/model/model.h"
 #include "core/audioBuffer.h"
 #include "core/wave.h"
-#include "utils/log.h"
 #include "waveReader.h"
 
 
@@ -40,137 +38,161 @@ namespace giada {
 namespace m 
 {
 WaveReader::WaveReader()
-: wave      (nullptr),
-  m_srcState(nullptr)
+: wave         (nullptr)
+, m_window     (WINDOW_FRAMES * G_MAX_IO_CHANS)
+, m_stretchNext(0)
 {
-	allocateSrc();
 }
 
+
 /* -------------------------------------------------------------------------- */
 
 
-WaveReader::WaveReader(const WaveReader& o)
-: wave      (o.wave),
-  m_srcState(nullptr)
+WaveReader::Result WaveReader::fill(AudioBuffer& out, Frame start, Frame offset, 
+	float pitch, float stretch, Frame begin, Frame end, bool loop) const
 {
-	allocateSrc();
-}
-
-
-/* -------------------------------------------------------------------------- */
+	assert(wave != nullptr);
+	assert(start >= 0);
+	assert(offset < out.countFrames());
 
+	model::WavesLock l(model::waves); // TODO dependency
 
-WaveReader::WaveReader(WaveReader&& o)
-: wave      (o.wave),
-  m_srcState(nullptr)
-{
-	moveSrc(&o.m_srcState);
+	end = std::min(end, wave->getSize());
+	if (start >= end)
+		return {0, 0};
+	
+	if (stretch != 1.0) return fillStretched(out, start, offset, stretch, begin, end, loop);
+	if (pitch == 1.0)   return fillCopy(out, start, offset, end);
+	else                return fillResampled(out, start, offset, pitch, begin, end, loop);
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-WaveReader& WaveReader::operator=(const WaveReader& o)
+ResamplerQuality WaveReader::getQuality() const
 {
-	if (this == &o) return *this;
-	wave = o.wave;
-	allocateSrc();
-	return *this;
+	return m_resampler.getQuality();
 }
 
 
-WaveReader& WaveReader::operator=(WaveReader&& o)
+void WaveReader::setQuality(ResamplerQuality q)
 {
-	if (this == &o) return *this;
-	wave = o.wave;
-	moveSrc(&o.m_srcState);
-	return *this;
+	m_resampler.setQuality(q);
 }
 
 
-/* -------------------------------------------------------------------------- */
-
-
-WaveReader::~WaveReader()
+void WaveReader::reset() const
 {
-	if (m_srcState != nullptr)
-		src_delete(m_srcState);    
+	m_resampler.reset();
+	m_stretcher.reset();
+	m_stretchNext = 0;
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-Frame WaveReader::fill(AudioBuffer& out, Frame start, Frame offset, float pitch) const
+WaveReader::Result WaveReader::fillResampled(AudioBuffer& dest, Frame start, 
+	Frame offset, float pitch, Frame begin, Frame end, bool loop) const
 {
-	assert(wave != nullptr);
-	assert(start >= 0);
-	assert(offset < out.countFrames());
+	/* Wave data is contiguous only within a block (see WaveData) and the kernel
+	reads frames around the read position, possibly across the loop point: copy
+	the input to the scratch window first, then resample from there. */
+
+	const Frame history = m_resampler.getHistory();
+	const Frame padding = m_resampler.getTaps() - 1;
+
+	Frame used      = 0;
+	Frame generated = 0;
+	Frame frames    = dest.countFrames() - offset;  // How many frames to process
+
+	while (generated < frames && start + used < end) {
+		Frame out = std::min({ 
+			frames - generated,
+			m_resampler.countOutputFrames(end - start - used, pitch),
+			m_resampler.countOutputFrames(WINDOW_FRAMES - padding, pitch) });
+		if (out == 0)
+			break;
+
+		fillWindow(m_window.data(), start + used - history, m_resampler.countInputFrames(out, pitch) + padding, 
+			begin, end, loop);
+
+		used      += m_resampler.process(m_window.data(), dest[offset + generated], out, pitch);
+		generated += out;
+	}
 
-	model::WavesLock l(model::waves); // TODO dependency
-	
-	if (pitch == 1.0) return fillCopy(out, start, offset);
-	else              return fillResampled(out, start, offset, pitch);
+	return {used, generated};
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-Frame WaveReader::fillResampled(AudioBuffer& dest, Frame start, Frame offset, float pitch) const
+WaveReader::Result WaveReader::fillStretched(AudioBuffer& dest, Frame start, 
+	Frame offset, float stretch, Frame begin, Frame end, bool loop) const
 {
-    SRC_DATA srcData;
-	
-	srcData.data_in       = wave->getFrame(start);        // Source data
-	srcData.input_frames  = wave->getSize() - start;      // How many readable frames
-	srcData.data_out      = dest[offset];                 // Destination (processed data)
-	srcData.output_frames = dest.countFrames() - offset;  // How many frames to process
-	srcData.end_of_input  = false;
-	srcData.src_ratio     = 1 / pitch;
+	if (start != m_stretchNext)
+		m_stretcher.reset();
+
+	Frame used = m_stretcher.process(dest[offset], dest.countFrames() - offset, stretch, 
+		[&](Frame first, Frame count, float* window)
+	{
+		fillWindow(window, start + first, count, begin, end, loop);
+	});
 
-	src_process(m_srcState, &srcData);
+	/* Keep track of the next frame as the SamplePlayer will compute it, loop 
+	point included. */
 
-	return srcData.input_frames_used;
+	m_stretchNext = start + used;
+	if (loop && end > begin && m_stretchNext >= end)
+		m_stretchNext = begin + (m_stretchNext - end) % (end - begin);
+
+	return {used, dest.countFrames() - offset};
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-Frame WaveReader::fillCopy(AudioBuffer& dest, Frame start, Frame offset) const
+WaveReader::Result WaveReader::fillCopy(AudioBuffer& dest, Frame start, Frame offset,
+	Frame end) const
 {
-	Frame used = dest.countFrames() - offset;
-	if (used > wave->getSize() - start)
-		used = wave->getSize() - start;
+	Frame used = std::min(dest.countFrames() - offset, end - start);
 
-	dest.copyData(wave->getFrame(start), used, G_MAX_IO_CHANS, offset);
+	/* Wave data might be stored in a compact format: read() decodes it straight
+	into the destination buffer. */
 
-	return used;
-}
+	wave->getData().read(start, used, dest[offset]);
 
-
-/* -------------------------------------------------------------------------- */
-
-
-void WaveReader::allocateSrc()
-{
-	m_srcState = src_new(SRC_LINEAR, G_MAX_IO_CHANS, nullptr);
-	if (m_srcState == nullptr) {
-		u::log::print("[WaveReader] unable to allocate memory for SRC_STATE!\n");
-		throw std::bad_alloc();
-	}
+	return {used, used};
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-void WaveReader::moveSrc(SRC_STATE** other)
+void WaveReader::fillWindow(float* dest, Frame first, Frame count, Frame begin, 
+	Frame end, bool loop) const
 {
-	if (m_srcState != nullptr)
-		src_delete(m_srcState);
-	m_srcState = *other;
-	*other = nullptr;
+	const Frame length = end - begin;
+
+	for (Frame i = 0; i < count;) {
+		Frame f = first + i;
+		Frame run;
+
+		if (loop && length > 0 && (f < begin || f >= end))
+			f = begin + (((f - begin) % length) + length) % length;
+
+		if (f >= begin && f < end) {
+			run = std::min(end - f, count - i);
+			wave->getData().read(f, run, dest + i * G_MAX_IO_CHANS);
+		}
+		else {
+			run = f < begin ? std::min(begin - f, count - i) : count - i;
+			std::fill_n(dest + i * G_MAX_IO_CHANS, run * G_MAX_IO_CHANS, 0.0f);
+		}
+		i += run;
+	}
 }
 }} // giada::m::
@@ -29,7 +29,9 @@
 #define G_CHANNEL_WAVE_READER_H
 
 
-#include <samplerate.h>
+#include <vector>
+#include "core/resampler.h"
+#include "core/timeStretcher.h"
 #include "core/types.h"
 
 
@@ -37,18 +39,40 @@ namespace giada {
 namespace m
 {
 class Wave;
+class AudioBuffer;
 class WaveReader final
 {
 public:
 
+	/* Result
+	Outcome of a fill() call: Wave frames read and audio frames written. They
+	differ when the Wave is resampled. */
+
+	struct Result
+	{
+		Frame used;
+		Frame generated;
+	};
+
     WaveReader();
-    WaveReader(const WaveReader&);
-    WaveReader(WaveReader&&);
-    WaveReader& operator=(const WaveReader&);
-    WaveReader& operator=(WaveReader&&);
-    ~WaveReader();
 
-    Frame fill(AudioBuffer& out, Frame start, Frame offset, float pitch) const;
+	/* fill
+	Fills 'out' from frame 'offset' on with Wave data read from 'start', never
+	going past 'end' (excluded). If 'loop' is true, the resampler sees the 
+	frames past 'end' as the ones starting from 'begin', so that the loop point
+	is seamless. A 'stretch' other than 1.0 changes the duration without 
+	changing the pitch: 'pitch' is ignored in that case. */
+
+    Result fill(AudioBuffer& out, Frame start, Frame offset, float pitch, 
+		float stretch, Frame begin, Frame end, bool loop) const;
+
+	ResamplerQuality getQuality() const;
+	void setQuality(ResamplerQuality q);
+
+	/* reset
+	Drops the resampler and stretcher state, as if reading started over. */
+
+	void reset() const;
 
 	/* wave
 	Wave object. Might be null if the channel has no sample. */
@@ -57,16 +81,37 @@ public:
 
 private:
 
-	Frame fillResampled(AudioBuffer& out, Frame start, Frame offset, float pitch) const;
-	Frame fillCopy     (AudioBuffer& out, Frame start, Frame offset) const;
+	/* WINDOW_FRAMES
+	Size of the scratch window the resampler reads from, in frames. */
+
+	static constexpr Frame WINDOW_FRAMES = 1024;
+
+	Result fillResampled(AudioBuffer& out, Frame start, Frame offset, float pitch,
+		Frame begin, Frame end, bool loop) const;
+	Result fillStretched(AudioBuffer& out, Frame start, Frame offset, float stretch,
+		Frame begin, Frame end, bool loop) const;
+	Result fillCopy     (AudioBuffer& out, Frame start, Frame offset, Frame end) const;
+
+	/* fillWindow
+	Copies 'count' Wave frames starting from 'first' into 'dest'. Frames outside
+	[begin, end) are wrapped around if 'loop' is true, silent otherwise. */
+
+	void fillWindow(float* dest, Frame first, Frame count, Frame begin, Frame end, 
+		bool loop) const;
+
+	/* m_resampler, m_window
+	Resampler state (the fractional read position) and its scratch input: both 
+	change while rendering. */
 
-	void allocateSrc();
-	void moveSrc(SRC_STATE** o);
+	mutable Resampler          m_resampler;
+	mutable std::vector<float> m_window;
 
-	/* srcState
-	Struct from libsamplerate. */
+	/* m_stretcher, m_stretchNext
+	Time-stretcher state and the frame it expects to be read from next: any 
+	other start frame means a jump (e.g. a restart) and resets the stretcher. */
 
-	SRC_STATE* m_srcState;
+	mutable TimeStretcher m_stretcher;
+	mutable Frame         m_stretchNext;
 };
 }} // giada::m::
 
@@ -25,6 +25,7 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include <fstream>
 #include <cassert>
 #include <string>
@@ -57,6 +58,12 @@ void sanitize_()
 {
 	conf.soundDeviceOut = std::max(0, conf.soundDeviceOut);
 	conf.channelsOut    = std::max(0, conf.channelsOut);
+	conf.sampleEditorUndoMemory = std::max(0, conf.sampleEditorUndoMemory);
+	conf.sampleStorage  = std::clamp(conf.sampleStorage, 0, static_cast<int>(SampleStorage::HALF));
+	conf.projectSampleFormat = std::clamp(conf.projectSampleFormat, 0, static_cast<int>(SampleFileFormat::FLAC));
+	conf.projectPatchFormat  = std::clamp(conf.projectPatchFormat, 0, static_cast<int>(PatchFormat::BINARY));
+	conf.autosaveInterval    = std::max(1, conf.autosaveInterval);
+	conf.liveRecActions      = std::max(1, conf.liveRecActions);
 }
 
 
@@ -140,6 +147,11 @@ bool read()
 	nl::json j = nl::json::parse(ifs);
 
 	conf.logMode                    =  j.value(CONF_KEY_LOG_MODE, conf.logMode);
+	conf.projectSampleFormat        =  j.value(CONF_KEY_PROJECT_SAMPLE_FORMAT, conf.projectSampleFormat);
+	conf.projectPatchFormat         =  j.value(CONF_KEY_PROJECT_PATCH_FORMAT, conf.projectPatchFormat);
+	conf.autosave                   =  j.value(CONF_KEY_AUTOSAVE, conf.autosave);
+	conf.autosaveInterval           =  j.value(CONF_KEY_AUTOSAVE_INTERVAL, conf.autosaveInterval);
+	conf.liveRecActions             =  j.value(CONF_KEY_LIVE_REC_ACTIONS, conf.liveRecActions);
 	conf.soundSystem                =  j.value(CONF_KEY_SOUND_SYSTEM, conf.soundSystem);
 	conf.soundDeviceOut             =  j.value(CONF_KEY_SOUND_DEVICE_OUT, conf.soundDeviceOut);
 	conf.soundDeviceIn              =  j.value(CONF_KEY_SOUND_DEVICE_IN, conf.soundDeviceIn);
@@ -150,6 +162,7 @@ bool read()
 	conf.buffersize                 =  j.value(CONF_KEY_BUFFER_SIZE, conf.buffersize);
 	conf.limitOutput                =  j.value(CONF_KEY_LIMIT_OUTPUT, conf.limitOutput);
 	conf.rsmpQuality                =  j.value(CONF_KEY_RESAMPLE_QUALITY, conf.rsmpQuality);
+	conf.sampleStorage              =  j.value(CONF_KEY_SAMPLE_STORAGE, conf.sampleStorage);
 	conf.midiSystem                 =  j.value(CONF_KEY_MIDI_SYSTEM, conf.midiSystem);
 	conf.midiPortOut                =  j.value(CONF_KEY_MIDI_PORT_OUT, conf.midiPortOut);
 	conf.midiPortIn                 =  j.value(CONF_KEY_MIDI_PORT_IN, conf.midiPortIn);
@@ -161,6 +174,7 @@ bool read()
 	conf.treatRecsAsLoops           =  j.value(CONF_KEY_TREAT_RECS_AS_LOOPS, conf.treatRecsAsLoops);
 	conf.inputMonitorDefaultOn      =  j.value(CONF_KEY_INPUT_MONITOR_DEFAULT_ON, conf.inputMonitorDefaultOn);
 	conf.overdubProtectionDefaultOn =  j.value(CONF_KEY_OVERDUB_PROTECTION_DEFAULT_ON, conf.overdubProtectionDefaultOn);
+	conf.freeInputRec               =  j.value(CONF_KEY_FREE_INPUT_REC, conf.freeInputRec);
 	conf.pluginPath                 =  j.value(CONF_KEY_PLUGINS_PATH, conf.pluginPath);
 	conf.patchPath                  =  j.value(CONF_KEY_PATCHES_PATH, conf.patchPath);
 	conf.samplePath                 =  j.value(CONF_KEY_SAMPLES_PATH, conf.samplePath);
@@ -188,6 +202,7 @@ bool read()
 	conf.sampleEditorH              =  j.value(CONF_KEY_SAMPLE_EDITOR_H, conf.sampleEditorH);
 	conf.sampleEditorGridVal        =  j.value(CONF_KEY_SAMPLE_EDITOR_GRID_VAL, conf.sampleEditorGridVal);
 	conf.sampleEditorGridOn         =  j.value(CONF_KEY_SAMPLE_EDITOR_GRID_ON, conf.sampleEditorGridOn);
+	conf.sampleEditorUndoMemory     =  j.value(CONF_KEY_SAMPLE_EDITOR_UNDO_MEMORY, conf.sampleEditorUndoMemory);
 	conf.pianoRollY                 =  j.value(CONF_KEY_PIANO_ROLL_Y, conf.pianoRollY);
 	conf.pianoRollH                 =  j.value(CONF_KEY_PIANO_ROLL_H, conf.pianoRollH);
 	conf.sampleActionEditorH        =  j.value(CONF_KEY_SAMPLE_ACTION_EDITOR_H, conf.sampleActionEditorH);
@@ -238,6 +253,11 @@ bool write()
 
 	j[CONF_KEY_HEADER]                        = "GIADACFG";
 	j[CONF_KEY_LOG_MODE]                      = conf.logMode;
+	j[CONF_KEY_PROJECT_SAMPLE_FORMAT]         = conf.projectSampleFormat;
+	j[CONF_KEY_PROJECT_PATCH_FORMAT]          = conf.projectPatchFormat;
+	j[CONF_KEY_AUTOSAVE]                      = conf.autosave;
+	j[CONF_KEY_AUTOSAVE_INTERVAL]             = conf.autosaveInterval;
+	j[CONF_KEY_LIVE_REC_ACTIONS]              = conf.liveRecActions;
 	j[CONF_KEY_SOUND_SYSTEM]                  = conf.soundSystem;
 	j[CONF_KEY_SOUND_DEVICE_OUT]              = conf.soundDeviceOut;
 	j[CONF_KEY_SOUND_DEVICE_IN]               = conf.soundDeviceIn;
@@ -248,6 +268,7 @@ bool write()
 	j[CONF_KEY_BUFFER_SIZE]                   = conf.buffersize;
 	j[CONF_KEY_LIMIT_OUTPUT]                  = conf.limitOutput;
 	j[CONF_KEY_RESAMPLE_QUALITY]              = conf.rsmpQuality;
+	j[CONF_KEY_SAMPLE_STORAGE]                = conf.sampleStorage;
 	j[CONF_KEY_MIDI_SYSTEM]                   = conf.midiSystem;
 	j[CONF_KEY_MIDI_PORT_OUT]                 = conf.midiPortOut;
 	j[CONF_KEY_MIDI_PORT_IN]                  = conf.midiPortIn;
@@ -270,6 +291,7 @@ bool write()
 	j[CONF_KEY_TREAT_RECS_AS_LOOPS]           = conf.treatRecsAsLoops;
 	j[CONF_KEY_INPUT_MONITOR_DEFAULT_ON]      = conf.inputMonitorDefaultOn;
 	j[CONF_KEY_OVERDUB_PROTECTION_DEFAULT_ON] = conf.overdubProtectionDefaultOn;
+	j[CONF_KEY_FREE_INPUT_REC]                = conf.freeInputRec;
 	j[CONF_KEY_PLUGINS_PATH]                  = conf.pluginPath;
 	j[CONF_KEY_PATCHES_PATH]                  = conf.patchPath;
 	j[CONF_KEY_SAMPLES_PATH]                  = conf.samplePath;
@@ -297,6 +319,7 @@ bool write()
 	j[CONF_KEY_SAMPLE_EDITOR_H]               = conf.sampleEditorH;
 	j[CONF_KEY_SAMPLE_EDITOR_GRID_VAL]        = conf.sampleEditorGridVal;
 	j[CONF_KEY_SAMPLE_EDITOR_GRID_ON]         = conf.sampleEditorGridOn;
+	j[CONF_KEY_SAMPLE_EDITOR_UNDO_MEMORY]     = conf.sampleEditorUndoMemory;
 	j[CONF_KEY_PIANO_ROLL_Y]                  = conf.pianoRollY;
 	j[CONF_KEY_PIANO_ROLL_H]                  = conf.pianoRollH;
 	j[CONF_KEY_SAMPLE_ACTION_EDITOR_H]        = conf.sampleActionEditorH;
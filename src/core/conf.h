@@ -42,6 +42,11 @@ namespace conf
 struct Conf
 {
 	int  logMode         = LOG_MODE_MUTE;
+	int  projectSampleFormat = 0; // SampleFileFormat
+	int  projectPatchFormat  = 0; // PatchFormat
+	bool autosave            = true;
+	int  autosaveInterval    = G_DEFAULT_AUTOSAVE_INTERVAL; // seconds
+	int  liveRecActions      = G_DEFAULT_LIVE_REC_ACTIONS;  // per thread
 	int  soundSystem     = G_DEFAULT_SOUNDSYS;
 	int  soundDeviceOut  = G_DEFAULT_SOUNDDEV_OUT;
 	int  soundDeviceIn   = G_DEFAULT_SOUNDDEV_IN;
@@ -52,6 +57,7 @@ struct Conf
 	int  buffersize      = G_DEFAULT_BUFSIZE;
 	bool limitOutput     = false;
 	int  rsmpQuality     = 0;
+	int  sampleStorage   = 0; // SampleStorage
 
 	int         midiSystem  = 0;
 	int         midiPortOut = G_DEFAULT_MIDI_PORT_OUT;
@@ -65,6 +71,7 @@ struct Conf
 	bool treatRecsAsLoops           = false;
 	bool inputMonitorDefaultOn      = false;
 	bool overdubProtectionDefaultOn = false;
+	bool freeInputRec               = false;
 
 	std::string pluginPath;
 	std::string patchPath;
@@ -97,6 +104,7 @@ struct Conf
 	int sampleEditorH = G_DEFAULT_SUBWINDOW_H;
 	int sampleEditorGridVal = 0;
 	int sampleEditorGridOn  = false;
+	int sampleEditorUndoMemory = G_DEFAULT_UNDO_MEMORY; // MB
 
 	int midiInputX; 
 	int midiInputY; 
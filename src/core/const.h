@@ -120,11 +120,14 @@ constexpr int    G_MAX_BUF_SIZE       = 4096;
 constexpr int    G_MIN_GUI_WIDTH      = 816;
 constexpr int    G_MIN_GUI_HEIGHT     = 510;
 constexpr int    G_MAX_IO_CHANS       = 2;
+constexpr int    G_MAX_INPUT_PAIRS    = 4;     // stereo pairs of device inputs channels can record from
 constexpr int    G_MAX_VELOCITY       = 0x7F;
 constexpr int    G_MAX_MIDI_CHANS     = 16;
 constexpr int    G_MAX_POLYPHONY      = 32;
 constexpr int    G_MAX_QUEUE_EVENTS   = 32;
+constexpr int    G_MAX_SEQ_EVENTS     = 8;     // sequencer events per block (bars, rewinds)
 constexpr int    G_MAX_QUANTIZER_SIZE = 8;
+constexpr int    G_MAX_IO_THREADS     = 8;     // disk-bound workers (e.g. decoding)
 
 
 
@@ -182,6 +185,11 @@ constexpr float G_DEFAULT_REC_TRIGGER_LEVEL   = -10.0f;
 constexpr int   G_DEFAULT_SUBWINDOW_W         = 640;
 constexpr int   G_DEFAULT_SUBWINDOW_H         = 480;
 constexpr int   G_DEFAULT_VST_MIDIBUFFER_SIZE = 1024;  // TODO - not 100% sure about this size
+constexpr int   G_DEFAULT_UNDO_MEMORY         = 256;   // MB, sample editor undo history
+constexpr int   G_DEFAULT_AUTOSAVE_INTERVAL   = 30;    // seconds
+constexpr auto  G_AUTOSAVE_DIR                = "autosave";
+constexpr auto  G_TAKES_DIR                   = "takes";
+constexpr int   G_DEFAULT_LIVE_REC_ACTIONS    = 16384;
 
 
 
@@ -351,8 +359,15 @@ constexpr auto PATCH_KEY_CHANNEL_SHIFT                = "shift";
 constexpr auto PATCH_KEY_CHANNEL_HAS_ACTIONS          = "has_actions";
 constexpr auto PATCH_KEY_CHANNEL_READ_ACTIONS         = "read_actions";
 constexpr auto PATCH_KEY_CHANNEL_PITCH                = "pitch";
+constexpr auto PATCH_KEY_CHANNEL_RESAMPLER_QUALITY    = "resampler_quality";
+constexpr auto PATCH_KEY_CHANNEL_STRETCH_TO_TEMPO     = "stretch_to_tempo";
+constexpr auto PATCH_KEY_CHANNEL_STRETCH_BEATS        = "stretch_beats";
+constexpr auto PATCH_KEY_CHANNEL_POLYPHONY            = "polyphony";
+constexpr auto PATCH_KEY_CHANNEL_VOICE_STEALING       = "voice_stealing";
+constexpr auto PATCH_KEY_CHANNEL_ROOT_NOTE            = "root_note";
 constexpr auto PATCH_KEY_CHANNEL_INPUT_MONITOR        = "input_monitor";
 constexpr auto PATCH_KEY_CHANNEL_OVERDUB_PROTECTION   = "overdub_protection";
+constexpr auto PATCH_KEY_CHANNEL_INPUT_PAIR           = "input_pair";
 constexpr auto PATCH_KEY_CHANNEL_MIDI_IN_READ_ACTIONS = "midi_in_read_actions";
 constexpr auto PATCH_KEY_CHANNEL_MIDI_IN_PITCH        = "midi_in_pitch";
 constexpr auto PATCH_KEY_CHANNEL_MIDI_OUT             = "midi_out";
@@ -383,11 +398,18 @@ constexpr auto G_PATCH_KEY_ACTION_FRAME               = "frame";
 constexpr auto G_PATCH_KEY_ACTION_EVENT               = "event";   
 constexpr auto G_PATCH_KEY_ACTION_PREV                = "prev";  
 constexpr auto G_PATCH_KEY_ACTION_NEXT                = "next";
+constexpr auto G_PATCH_KEY_ACTION_PLUGIN              = "plugin";
+constexpr auto G_PATCH_KEY_ACTION_PLUGIN_PARAM        = "plugin_param";
 
 /* JSON config keys */
 
 constexpr auto CONF_KEY_HEADER                        = "header";
 constexpr auto CONF_KEY_LOG_MODE                      = "log_mode";
+constexpr auto CONF_KEY_PROJECT_SAMPLE_FORMAT         = "project_sample_format";
+constexpr auto CONF_KEY_PROJECT_PATCH_FORMAT          = "project_patch_format";
+constexpr auto CONF_KEY_AUTOSAVE                      = "autosave";
+constexpr auto CONF_KEY_AUTOSAVE_INTERVAL             = "autosave_interval";
+constexpr auto CONF_KEY_LIVE_REC_ACTIONS              = "live_rec_actions";
 constexpr auto CONF_KEY_SOUND_SYSTEM                  = "sound_system";
 constexpr auto CONF_KEY_SOUND_DEVICE_IN               = "sound_device_in";
 constexpr auto CONF_KEY_SOUND_DEVICE_OUT              = "sound_device_out";
@@ -399,6 +421,7 @@ constexpr auto CONF_KEY_BUFFER_SIZE                   = "buffer_size";
 constexpr auto CONF_KEY_DELAY_COMPENSATION            = "delay_compensation";
 constexpr auto CONF_KEY_LIMIT_OUTPUT                  = "limit_output";
 constexpr auto CONF_KEY_RESAMPLE_QUALITY              = "resample_quality";
+constexpr auto CONF_KEY_SAMPLE_STORAGE                = "sample_storage";
 constexpr auto CONF_KEY_MIDI_SYSTEM                   = "midi_system";
 constexpr auto CONF_KEY_MIDI_PORT_OUT                 = "midi_port_out";
 constexpr auto CONF_KEY_MIDI_PORT_IN                  = "midi_port_in";
@@ -421,6 +444,7 @@ constexpr auto CONF_KEY_CHANS_STOP_ON_SEQ_HALT        = "chans_stop_on_seq_halt"
 constexpr auto CONF_KEY_TREAT_RECS_AS_LOOPS           = "treat_recs_as_loops";
 constexpr auto CONF_KEY_INPUT_MONITOR_DEFAULT_ON      = "input_monitor_default_on";
 constexpr auto CONF_KEY_OVERDUB_PROTECTION_DEFAULT_ON = "overdub_protection_default_on";
+constexpr auto CONF_KEY_FREE_INPUT_REC                = "free_input_rec";
 constexpr auto CONF_KEY_PLUGINS_PATH                  = "plugins_path";
 constexpr auto CONF_KEY_PATCHES_PATH                  = "patches_path";
 constexpr auto CONF_KEY_SAMPLES_PATH                  = "samples_path";
@@ -448,6 +472,7 @@ constexpr auto CONF_KEY_SAMPLE_EDITOR_W               = "sample_editor_w";
 constexpr auto CONF_KEY_SAMPLE_EDITOR_H               = "sample_editor_h";
 constexpr auto CONF_KEY_SAMPLE_EDITOR_GRID_VAL        = "sample_editor_grid_val";
 constexpr auto CONF_KEY_SAMPLE_EDITOR_GRID_ON         = "sample_editor_grid_on";
+constexpr auto CONF_KEY_SAMPLE_EDITOR_UNDO_MEMORY     = "sample_editor_undo_memory";
 constexpr auto CONF_KEY_PIANO_ROLL_Y                  = "piano_roll_y";
 constexpr auto CONF_KEY_PIANO_ROLL_H                  = "piano_roll_h";
 constexpr auto CONF_KEY_SAMPLE_ACTION_EDITOR_H        = "sample_action_editor_h";
@@ -33,6 +33,19 @@ namespace giada::m
 IdManager::IdManager() : m_id(0)
 {
 }
+
+
+IdManager::IdManager(const IdManager& o) : m_id(o.m_id.load())
+{
+}
+
+
+IdManager& IdManager::operator=(const IdManager& o)
+{
+	if (this == &o) return *this;
+	m_id.store(o.m_id.load());
+	return *this;
+}
 	
 
 /* -------------------------------------------------------------------------- */
@@ -40,8 +53,10 @@ IdManager::IdManager() : m_id(0)
 
 void IdManager::set(ID id)
 {
-	if (id != 0 && id > m_id)
-		m_id = id;
+	if (id == 0)
+		return;
+	ID curr = m_id.load();
+	while (id > curr && !m_id.compare_exchange_weak(curr, id));
 }
 
 
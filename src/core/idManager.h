@@ -29,16 +29,23 @@
 #define G_ID_MANAGER_H
 
 
+#include <atomic>
 #include "core/types.h"
 
 
 namespace giada::m 
 {
+/* IdManager
+Generates unique IDs. Thread safe: IDs can be requested from multiple threads 
+at the same time (e.g. when decoding Waves in parallel). */
+
 class IdManager
 {
 public:
 
 	IdManager();
+	IdManager(const IdManager& o);
+	IdManager& operator=(const IdManager& o);
 
 	/* set
 	Stores a new id, only if != 0 (valid) and greater than current id (unique). */
@@ -54,7 +61,7 @@ public:
 
 private:
 
-	ID m_id;
+	std::atomic<ID> m_id;
 };
 } // giada::m::
 
@@ -45,6 +45,7 @@
 #include "gui/dialogs/mainWindow.h"
 #include "gui/dialogs/warnings.h"
 #include "glue/main.h"
+#include "glue/storage.h"
 #include "core/model/storage.h"
 #include "core/channels/channelManager.h"
 #include "core/mixer.h"
@@ -54,6 +55,8 @@
 #include "core/mixerHandler.h"
 #include "core/sequencer.h"
 #include "core/patch.h"
+#include "core/autosave.h"
+#include "core/takeWriter.h"
 #include "core/conf.h"
 #include "core/waveManager.h"
 #include "core/plugins/pluginManager.h"
@@ -162,6 +165,30 @@ void initGUI_(int argc, char** argv)
 }
 
 
+/* -------------------------------------------------------------------------- */
+
+/* initAutosave_
+Offers to recover the session left by a crash, if any, then starts saving the
+current one in background. */
+
+void initAutosave_()
+{
+	std::string dir = u::fs::getHomePath() + G_SLASH + G_AUTOSAVE_DIR;
+
+	if (autosave::canRecover(dir)) {
+		if (v::gdConfirmWin("Warning", "Giada was not closed properly.\nRecover the last session?"))
+			c::storage::recoverSession(dir);
+		else
+			autosave::clear(dir);
+	}
+
+	if (conf::conf.autosave) {
+		autosave::start(dir, conf::conf.autosaveInterval);
+		autosave::reset(patch::patch);
+	}
+}
+
+
 /* -------------------------------------------------------------------------- */
 
 
@@ -237,6 +264,7 @@ void startup(int argc, char** argv)
 	initAudio_();
 	initMIDI_();
 	initGUI_(argc, argv);
+	initAutosave_();
 }
 
 
@@ -287,6 +315,12 @@ void reset()
 
 void shutdown()
 {
+	/* A normal shutdown leaves nothing to recover. */
+
+	autosave::stop();
+	autosave::clear(u::fs::getHomePath() + G_SLASH + G_AUTOSAVE_DIR);
+	takeWriter::close();
+
 	shutdownGUI_();
 
 	model::store(conf::conf);
@@ -27,6 +27,7 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include "deps/rtaudio/RtAudio.h"
 #include "utils/log.h"
 #include "glue/main.h"
@@ -45,6 +46,8 @@ namespace
 RtAudio* rtSystem     = nullptr;
 unsigned numDevs      = 0;
 bool     inputEnabled = false;
+int      inputChans   = 0;     // Channels in the input stream
+int      inputFirst   = 0;     // First device channel of the input stream
 unsigned realBufsize  = 0;     // Real buffer size from the soundcard
 int      api          = 0;
 
@@ -159,18 +162,26 @@ int openDevice()
 	outParams.nChannels    = G_MAX_IO_CHANS;
 	outParams.firstChannel = conf::conf.channelsOut * G_MAX_IO_CHANS; // chan 0=0, 1=2, 2=4, ...
 
-	/* Input device can be disabled. Unlike the output, here we are using all
-	channels and let the user choose which one to record from in the configuration
-	panel. */
+	/* Input device can be disabled. Unlike the output, here we are using up to
+	G_MAX_INPUT_PAIRS pairs of channels, starting from the one selected in the
+	configuration panel, and let the user choose which one to record from: the
+	master input in the configuration panel, each Sample Channel in its own 
+	menu. */
 
 	if (conf::conf.soundDeviceIn != -1) {
+		int available = static_cast<int>(getMaxInChans(conf::conf.soundDeviceIn)) - conf::conf.channelsInStart;
+		inputChans = std::max(conf::conf.channelsInCount, std::min(available, G_MAX_INPUT_PAIRS * 2));
 		inParams.deviceId     = conf::conf.soundDeviceIn;
-		inParams.nChannels    = conf::conf.channelsInCount;
+		inParams.nChannels    = inputChans;
 		inParams.firstChannel = conf::conf.channelsInStart;
+		inputFirst   = conf::conf.channelsInStart;
 		inputEnabled = true;
 	}
-	else
+	else {
+		inputChans   = 0;
+		inputFirst   = 0;
 		inputEnabled = false;
+	}
 
 	RtAudio::StreamOptions options;
 	options.streamName = G_APP_NAME;
@@ -395,6 +406,8 @@ int	getFreq(unsigned dev, int i)
 
 unsigned getRealBufSize() { return realBufsize; }
 bool isInputEnabled() { return inputEnabled; }
+int countInputChannels() { return inputChans; }
+int getFirstInputChannel() { return inputFirst; }
 unsigned countDevices() { return numDevs; }
 
 
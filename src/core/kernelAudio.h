@@ -67,6 +67,8 @@ unsigned getMaxInChans(int dev);
 unsigned getMaxOutChans(unsigned dev);
 unsigned getDuplexChans(unsigned dev);
 unsigned getRealBufSize();
+int countInputChannels();
+int getFirstInputChannel();
 unsigned countDevices();
 int getTotalFreqs(unsigned dev);
 int getFreq(unsigned dev, int i);
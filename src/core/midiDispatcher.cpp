@@ -173,9 +173,10 @@ void processChannels_(const MidiEvent& midiEvent)
 #endif
 
 		/* Redirect raw MIDI message (pure + velocity) to plug-ins in armed
-		channels. */
+		channels, or to sample channels that play MIDI notes (keyed mode). */
 
-		if (c->state->armed.load() == true)
+		bool keyed = c->samplePlayer && c->samplePlayer->isKeyed();
+		if (c->state->armed.load() == true || keyed)
 			c::events::sendMidiToChannel(c->id, midiEvent, Thread::MIDI);
 	}
 }
@@ -25,6 +25,8 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
 #include "deps/rtaudio/RtAudio.h"
@@ -42,7 +44,9 @@
 #include "core/const.h"
 #include "core/audioBuffer.h"
 #include "core/action.h"
+#include "core/range.h"
 #include "core/sequencer.h"
+#include "core/takeWriter.h"
 #include "core/mixer.h"
 
 
@@ -52,16 +56,17 @@ namespace mixer
 {
 namespace
 {
-/* recBuffer_
-Working buffer for audio recording. */
-
-AudioBuffer recBuffer_;
-
 /* inBuffer_
 Working buffer for input channel. Used for the in->out bridge. */
 
 AudioBuffer inBuffer_;
 
+/* inputPairs_
+Working buffers for the device input, one for each stereo pair. Input volume 
+is applied as in inBuffer_. */
+
+std::array<AudioBuffer, G_MAX_INPUT_PAIRS> inputPairs_;
+
 /* inputTracker_
 Frame position while recording. */
 
@@ -97,37 +102,144 @@ bool isChannelAudible_(const Channel& c)
 }
 
 
+/* -------------------------------------------------------------------------- */
+
+/* readInput_
+Copies 'count' channels (1 or 2) starting from channel 'first' out of the
+interleaved device input 'in', 'channels' channels wide, to 'out'. A single 
+channel is spread over the stereo buffer. */
+
+void readInput_(const float* in, Frame frames, int channels, int first, int count,
+	AudioBuffer& out)
+{
+	frames = std::min(frames, out.countFrames());
+
+	if (first + count > channels || count <= 0) {
+		out.clear();
+		return;
+	}
+
+	for (Frame i = 0; i < frames; i++)
+		for (int j = 0; j < out.countChannels(); j++)
+			out[i][j] = in[i * channels + first + std::min(j, count - 1)];
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* overdub_
+Adds input block 'inBuf' to take 'take', at the current position in the loop.
+The block wraps around the end of the loop at most once, unless the loop is 
+shorter than the block itself. */
+
+void overdub_(Take& take, const AudioBuffer& inBuf, Frame framesInLoop)
+{
+	framesInLoop = std::min(framesInLoop, take.data.countFrames());
+	if (framesInLoop <= 0)
+		return;
+
+	for (Frame done = 0; done < inBuf.countFrames();) {
+		Frame pos    = (inputTracker_ + done) % framesInLoop;
+		Frame frames = std::min(inBuf.countFrames() - done, framesInLoop - pos);
+		take.data.addData(inBuf[done], frames, 1.0f, pos);
+		done += frames;
+	}
+}
+
+
 /* -------------------------------------------------------------------------- */
 
 /* lineInRec
-Records from line in. */
+Records from line in. Each take gets either the master input or its own pair 
+of device inputs. The master input is also streamed to disk, if a free take is
+open (see takeWriter). Input volume has already been applied to all inputs by
+processLineIn_(). */
 
 void lineInRec_(const AudioBuffer& inBuf)
 {
 	if (!recManager::isRecordingInput() || !kernelAudio::isInputEnabled())
 		return;
 	
-	float inVol        = mh::getInVol();
-	int   framesInLoop = clock::getFramesInLoop();
+	Frame framesInLoop = clock::getFramesInLoop();
+
+	if (takeWriter::isOpen() && clock::isRunning())
+		takeWriter::push(inBuf, 1.0f);
+
+	/* Adding: overdub! Takes are read from the model: the UI thread replaces 
+	them as a whole, never while they are being written here. */
+
+	model::InputRecLock l(model::inputRec);
+
+	std::vector<Take>* takes = model::inputRec.get()->takes.get();
+	if (takes == nullptr)
+		return;
+
+	for (Take& take : *takes) {
+		bool master = take.inputPair < 0 || take.inputPair >= G_MAX_INPUT_PAIRS;
+		overdub_(take, master ? inBuf : inputPairs_[take.inputPair], framesInLoop);
+	}
 
-	for (int i = 0; i < inBuf.countFrames(); i++, inputTracker_++)
-		for (int j = 0; j < inBuf.countChannels(); j++)
-			recBuffer_[inputTracker_ % framesInLoop][j] += inBuf[i][j] * inVol;  // adding: overdub!
+	inputTracker_ += inBuf.countFrames();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getUsedInputPairs_
+Input pairs armed channels monitor or record from, plus the ones of the takes
+being recorded. Nobody reads the other pairs. */
+
+std::array<bool, G_MAX_INPUT_PAIRS> getUsedInputPairs_()
+{
+	std::array<bool, G_MAX_INPUT_PAIRS> out{};
+
+	auto use = [&out](int pair)
+	{
+		if (pair >= 0 && pair < G_MAX_INPUT_PAIRS)
+			out[pair] = true;
+	};
+
+	{
+		model::ChannelsLock lock(model::channels);
+		for (const Channel* c : model::channels)
+			if (c->audioReceiver && c->state->armed.load())
+				use(c->audioReceiver->state->inputPair.load());
+	}
+
+	model::InputRecLock lock(model::inputRec);
+	if (const std::vector<Take>* takes = model::inputRec.get()->takes.get(); takes != nullptr)
+		for (const Take& take : *takes)
+			use(take.inputPair);
+
+	return out;
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 /* processLineIn
-Computes line in peaks and prepares the internal working buffer for input
-recording. */
+Splits the raw device input 'inBuf' into the master input, as selected in the
+configuration, and the stereo pairs in use. Computes line in peaks and prepares
+the internal working buffer for input recording. */
 
-void processLineIn_(const AudioBuffer& inBuf)
+void processLineIn_(const float* inBuf, Frame bufferSize)
 {
-	if (!kernelAudio::isInputEnabled())
+	if (!kernelAudio::isInputEnabled() || inBuf == nullptr)
 		return;
 
-	peakIn.store(inBuf.getPeak());
+	/* The input stream starts from the first channel of the master input, see
+	kernelAudio::openDevice(). */
+
+	int channels = kernelAudio::countInputChannels();
+
+	std::array<bool, G_MAX_INPUT_PAIRS> used = getUsedInputPairs_();
+	for (int i = 0; i < G_MAX_INPUT_PAIRS; i++)
+		if (used[i])
+			readInput_(inBuf, bufferSize, channels, i * 2, std::min(2, channels - i * 2), inputPairs_[i]);
+
+	readInput_(inBuf, bufferSize, channels, 0, conf::conf.channelsInCount, inBuffer_);
+
+	peakIn.store(inBuffer_.getPeak());
 
 	if (signalCb_ != nullptr && u::math::linearToDB(peakIn) > conf::conf.recTriggerLevel) {
 G_DEBUG("Signal > threshold!");
@@ -136,12 +248,15 @@ G_DEBUG("Signal > threshold!");
 	}
 
 	/* Prepare the working buffer for input stream, which will be processed 
-	later on by the Master Input Channel with plug-ins. */
-	
-	assert(inBuf.countChannels() <= inBuffer_.countChannels());
+	later on by the Master Input Channel with plug-ins. Input volume applies to
+	the stereo pairs too, for both monitoring and recording. */
 
 	model::MixerLock lock(model::mixer);
-	inBuffer_.copyData(inBuf, mh::getInVol());
+	const float inVol = mh::getInVol();
+	inBuffer_.applyGain(inVol);
+	for (int i = 0; i < G_MAX_INPUT_PAIRS; i++)
+		if (used[i])
+			inputPairs_[i].applyGain(inVol);
 }
 
 
@@ -167,13 +282,18 @@ void fillEventBuffer_()
 /* -------------------------------------------------------------------------- */
 
 
-void processChannels_(AudioBuffer& out, AudioBuffer& in)
+/* processChannels_
+Parses live events along with the recorded actions in 'seqFrames' (i.e. the 
+sequencer block, empty if the sequencer is not running) and renders each 
+channel. */
+
+void processChannels_(AudioBuffer& out, AudioBuffer& in, Range<Frame> seqFrames)
 {
 	model::ChannelsLock lock(model::channels);
 
 	for (const Channel* c : model::channels) {
 		bool audible = isChannelAudible_(*c);	
-		c->parse(eventBuffer_, audible); 
+		c->parse(eventBuffer_, audible, seqFrames); 
 		if (c->getType() != ChannelType::MASTER) {
 			c->advance(out.countFrames());
 			c->render(&out, &in, audible);
@@ -185,14 +305,17 @@ void processChannels_(AudioBuffer& out, AudioBuffer& in)
 /* -------------------------------------------------------------------------- */
 
 
-void processSequencer_(AudioBuffer& in)
+Range<Frame> processSequencer_(AudioBuffer& in)
 {
+	Range<Frame> seqFrames;
+
 	sequencer::parse(eventBuffer_);
 	if (clock::isActive()) {
 		if (clock::isRunning())
-			sequencer::run(in.countFrames());
+			seqFrames = sequencer::run(in.countFrames());
 		lineInRec_(in);
 	}
+	return seqFrames;
 }
 
 
@@ -276,16 +399,16 @@ Queue<Event, G_MAX_QUEUE_EVENTS> MidiEvents;
 /* -------------------------------------------------------------------------- */
 
 
-void init(Frame framesInSeq, Frame framesInBuffer)
+void init(Frame framesInBuffer)
 {
-	/* Allocate virtual inputs. recBuffer_ has variable size: it depends
-	on how many frames there are in sequencer. */
+	/* Allocate virtual inputs. Takes are allocated only when needed, as they
+	depend on how many frames there are in sequencer: see prepareInputRec(). */
 	
-	recBuffer_.alloc(framesInSeq, G_MAX_IO_CHANS);
 	inBuffer_.alloc(framesInBuffer, G_MAX_IO_CHANS);
+	for (AudioBuffer& b : inputPairs_)
+		b.alloc(framesInBuffer, G_MAX_IO_CHANS);
 
-	u::log::print("[mixer::init] buffers ready - framesInSeq=%d, framesInBuffer=%d\n", 
-		framesInSeq, framesInBuffer);
+	u::log::print("[mixer::init] buffers ready - framesInBuffer=%d\n", framesInBuffer);
 }
 
 
@@ -311,21 +434,45 @@ void disable()
 /* -------------------------------------------------------------------------- */
 
 
-void allocRecBuffer(Frame frames)
+void prepareInputRec(Frame frames)
 {
-	recBuffer_.alloc(frames, G_MAX_IO_CHANS);
+	auto takes = std::make_shared<std::vector<Take>>();
+
+	{
+		model::ChannelsLock lock(model::channels);
+		for (const Channel* c : model::channels)
+			if (c->canInputRec())
+				takes->push_back({ c->id, c->audioReceiver->state->inputPair.load(), 
+					WaveData(frames, G_MAX_IO_CHANS) });
+	}
+
+	/* Takes left over from a previous session, if any, are freed here once the
+	audio thread is done with the old model node. */
+
+	model::onSwap(model::inputRec, [&](model::InputRec& r) { r.takes = std::move(takes); });
 }
 
 
-void clearRecBuffer()
+std::vector<Take> collectInputRec()
 {
-	recBuffer_.clear();
+	std::shared_ptr<std::vector<Take>> takes;
+
+	/* The swap returns when no reader is left on the old node: from now on the
+	audio thread can't touch these takes any more. */
+
+	model::onSwap(model::inputRec, [&](model::InputRec& r) { takes = std::move(r.takes); });
+
+	return takes != nullptr ? std::move(*takes) : std::vector<Take>();
 }
 
 
-const AudioBuffer& getRecBuffer()
+/* -------------------------------------------------------------------------- */
+
+
+const AudioBuffer& getInputPair(int pair)
 {
-	return recBuffer_;
+	assert(pair >= 0 && pair < G_MAX_INPUT_PAIRS);
+	return inputPairs_[pair];
 }
 
 
@@ -345,10 +492,8 @@ int masterPlay(void* outBuf, void* inBuf, unsigned bufferSize,
 		clock::recvJackSync();
 #endif
 
-	AudioBuffer out, in;
+	AudioBuffer out;
 	out.setData(static_cast<float*>(outBuf), bufferSize, G_MAX_IO_CHANS);
-	if (kernelAudio::isInputEnabled())
-		in.setData(static_cast<float*>(inBuf), bufferSize, conf::conf.channelsInCount);
 
 	/* Reset peak computation. */
 
@@ -356,15 +501,15 @@ int masterPlay(void* outBuf, void* inBuf, unsigned bufferSize,
 	peakIn  = 0.0;
 
 	prepareBuffers_(out);
-	processLineIn_(in);
+	processLineIn_(static_cast<const float*>(inBuf), bufferSize);
 
 //out[0][0] = 3.0f;
 
 	renderMasterIn_(inBuffer_);
 
 	fillEventBuffer_();
-	processSequencer_(inBuffer_);
-	processChannels_(out, inBuffer_);
+	Range<Frame> seqFrames = processSequencer_(inBuffer_);
+	processChannels_(out, inBuffer_, seqFrames);
 
 	renderMasterOut_(out);
 
@@ -381,7 +526,6 @@ int masterPlay(void* outBuf, void* inBuf, unsigned bufferSize,
 	destroy memory allocated by RtAudio ---> havoc. */
 
 	out.setData(nullptr, 0, 0);
-	in.setData (nullptr, 0, 0);
 
 	processing_.store(false);
 
@@ -38,6 +38,7 @@
 #include "core/types.h"
 #include "core/queue.h"
 #include "core/midiEvent.h"
+#include "core/waveData.h"
 
 
 namespace giada {
@@ -72,6 +73,16 @@ enum class EventType
 	CHANNEL_PAN
 };
 
+/* Take
+Audio recorded by a Sample Channel in an input recording session. */
+
+struct Take
+{
+	ID       channelId;
+	int      inputPair;
+	WaveData data;
+};
+
 struct Event
 {
 	EventType type;
@@ -80,11 +91,13 @@ struct Event
 };
 
 /* EventBuffer
-Alias for a RingBuffer containing events to be sent to engine. The double size
-is due to the presence of two distinct Queues for collecting events coming from
-other threads. See below. */
+Alias for a RingBuffer containing live events to be sent to engine. The double 
+size is due to the presence of two distinct Queues for collecting events coming
+from other threads (see below), plus some room for the sequencer events of the 
+current block. Recorded actions don't go through here: each channel reads its 
+own from the action timeline (see Channel::advance()). */
 
-using EventBuffer = RingBuffer<Event, G_MAX_QUEUE_EVENTS * 2>;
+using EventBuffer = RingBuffer<Event, G_MAX_QUEUE_EVENTS * 2 + G_MAX_SEQ_EVENTS>;
 
 constexpr int MASTER_OUT_CHANNEL_ID = 1;
 constexpr int MASTER_IN_CHANNEL_ID  = 2;
@@ -101,7 +114,7 @@ for two writers. TODO - let's add a multi-producer queue sooner or later! */
 extern Queue<Event, G_MAX_QUEUE_EVENTS> UIevents;
 extern Queue<Event, G_MAX_QUEUE_EVENTS> MidiEvents;
 
-void init(Frame framesInSeq, Frame framesInBuffer);
+void init(Frame framesInBuffer);
 
 /* enable, disable
 Toggles master callback processing. Useful when loading a new patch. Mixer
@@ -111,22 +124,25 @@ called. */
 void enable();
 void disable();
 
-/* allocRecBuffer
-Allocates new memory for the virtual input channel. Call this whenever you 
-shrink or resize the sequencer. */
+/* prepareInputRec
+Allocates a silent take of 'frames' frames for each Sample Channel that can 
+record input and hands them to the audio thread through the model. Call it 
+before starting an input recording session. */
 
-void allocRecBuffer(Frame frames);
+void prepareInputRec(Frame frames);
 
-/* clearRecBuffer
-Clears internal virtual channel. */
+/* collectInputRec
+Takes the takes recorded in the last input recording session back from the 
+model. Call it once the session has stopped. */
 
-void clearRecBuffer();
+std::vector<Take> collectInputRec();
 
-/* getRecBuffer
-Returns a read-only reference to the internal virtual channel. Use this to
-merge data into channel after an input recording session. */
+/* getInputPair
+Returns the audio coming from the stereo pair of device inputs 'pair' in the 
+current block, with input volume applied and no other processing. Audio 
+thread only. */
 
-const AudioBuffer& getRecBuffer(); 
+const AudioBuffer& getInputPair(int pair);
 
 void close();
 
@@ -27,6 +27,7 @@
 
 #include <cassert>
 #include <vector>
+#include <unordered_map>
 #include <algorithm>
 #include "utils/fs.h"
 #include "utils/string.h"
@@ -54,6 +55,7 @@
 #include "core/midiMapConf.h"
 #include "core/wave.h"
 #include "core/waveManager.h"
+#include "core/waveLoader.h"
 #include "core/mixerHandler.h"
 
 
@@ -82,7 +84,7 @@ std::unique_ptr<Channel> createChannel_(ChannelType type, ID columnId, ID channe
 waveManager::Result createWave_(const std::string& fname)
 {
 	return waveManager::createFromFile(fname, /*ID=*/0, conf::conf.samplerate, 
-		conf::conf.rsmpQuality); 
+		conf::conf.rsmpQuality, static_cast<SampleStorage>(conf::conf.sampleStorage)); 
 }
 
 
@@ -116,7 +118,17 @@ std::vector<ID> getChannelsWithWave_()
 {
 	return getChannelsIf_([] (const Channel* c)
 	{
-		return c->samplePlayer && c->samplePlayer->hasWave();
+		return c->samplePlayer && (c->samplePlayer->hasWave() || c->samplePlayer->isLoadingWave());
+	});
+}
+
+
+std::vector<ID> getChannelsWaitingFor_(ID waveId)
+{
+	return getChannelsIf_([waveId] (const Channel* c)
+	{
+		return c->samplePlayer && c->samplePlayer->isLoadingWave() && 
+		       c->samplePlayer->getWaveId() == waveId;
 	});
 }
 
@@ -150,6 +162,19 @@ void pushWave_(Channel& ch, std::unique_ptr<Wave>&& w)
 }
 
 
+/* -------------------------------------------------------------------------- */
+
+/* popWave_
+Removes Wave 'waveId' from the Wave list, if any. The Wave might not be there 
+yet if it's still being loaded in background. */
+
+void popWave_(ID waveId)
+{
+	if (waveId != 0 && model::exists(model::waves, waveId))
+		model::waves.pop(model::getIndex(model::waves, waveId)); 
+}
+
+
 /* -------------------------------------------------------------------------- */
 
 
@@ -168,18 +193,36 @@ void setupChannelPostRecording_(Channel& c)
 
 
 /* recordChannel_
-Records the current Mixer audio input data into an empty channel. */
+Moves the take recorded by an empty channel into a new Wave. A free take longer
+than the loop, if any, is loaded whole from 'takePath' instead. Returns whether
+the new Wave comes from 'takePath'. */
 
-void recordChannel_(ID channelId)
+bool recordChannel_(ID channelId, WaveData&& take, const std::string& takePath)
 {
-	/* Create a new Wave with audio coming from Mixer's virtual input. */
+	std::unique_ptr<Wave> wave;
 
-	std::string filename = "TAKE-" + std::to_string(patch::patch.lastTakeId++) + ".wav";
+	if (!takePath.empty()) {
+		waveManager::Result res = createWave_(takePath);
+		if (res.status == G_RES_OK)
+			wave = std::move(res.wave);
+		else
+			u::log::print("[mh::recordChannel_] unable to read take %s\n", takePath);
+	}
+
+	/* Create a new Wave with audio coming from the take: no data is copied. 
+	The take might be longer than the loop, if the loop has shrunk in the 
+	meantime. */
 
-	std::unique_ptr<Wave> wave = waveManager::createEmpty(clock::getFramesInLoop(), 
-		G_MAX_IO_CHANS, conf::conf.samplerate, filename);
+	const bool fromFile = wave != nullptr;
 
-	wave->copyData(mixer::getRecBuffer());
+	std::string filename = "TAKE-" + std::to_string(patch::patch.lastTakeId++) + ".wav";
+
+	if (!fromFile) {
+		if (take.countFrames() > clock::getFramesInLoop())
+			take.remove(clock::getFramesInLoop(), take.countFrames());
+		wave = waveManager::createEmpty(0, G_MAX_IO_CHANS, conf::conf.samplerate, filename);
+		wave->setData(std::move(take));
+	}
 
 	/* Update Channel with the new Wave. The function pushWave_ will take
 	care of pushing it into the Wave stack first. */
@@ -189,6 +232,8 @@ void recordChannel_(ID channelId)
 		pushWave_(c, std::move(wave));
 		setupChannelPostRecording_(c);
 	});
+
+	return fromFile;
 }
 
 
@@ -196,10 +241,11 @@ void recordChannel_(ID channelId)
 
 
 /* overdubChannel_
-Records the current Mixer audio input data into a channel with an existing
-Wave, overdub mode. */
+Adds the take recorded by a channel with an existing Wave to that Wave, 
+overdub mode. The Wave is being played: audio is merged into a copy of its data
+(cheap, see WaveData), then swapped in. */
 
-void overdubChannel_(ID channelId)
+void overdubChannel_(ID channelId, const WaveData& take)
 {
 	ID waveId;
 	model::onGet(model::channels, channelId, [&](Channel& c)
@@ -207,14 +253,25 @@ void overdubChannel_(ID channelId)
 		waveId = c.samplePlayer->getWaveId();
 	});
 
-	model::onGet(m::model::waves, waveId, [&](Wave& w)
+	WaveData data;
+	model::onGet(model::waves, waveId, [&](Wave& w)
+	{
+		data = w.getData();
+	});
+	data.addData(take);
+
+	model::onSwap(model::waves, waveId, [&](Wave& w)
 	{
-		w.addData(mixer::getRecBuffer());
+		w.setData(std::move(data));
 		w.setLogical(true);
 	});
 
-	model::onGet(model::channels, channelId, [&](Channel& c)
+	/* Point the channel to the new Wave, without stopping it. */
+
+	model::onSwap(model::channels, channelId, [&](Channel& c)
 	{
+		model::WavesLock wl(model::waves);
+		c.samplePlayer->setWave(model::get(model::waves, waveId), /*samplerateRatio=*/1.0f);
 		setupChannelPostRecording_(c);
 	});
 }
@@ -228,7 +285,7 @@ void overdubChannel_(ID channelId)
 
 void init()
 {
-	mixer::init(clock::getFramesInLoop(), kernelAudio::getRealBufSize());
+	mixer::init(kernelAudio::getRealBufSize());
 	
 	model::channels.push(createChannel_(ChannelType::MASTER, /*column=*/0, 
 		mixer::MASTER_OUT_CHANNEL_ID));
@@ -244,6 +301,7 @@ void init()
 
 void close()
 {
+	waveLoader::stop();
 	mixer::disable();
 	model::channels.clear();
 	model::waves.clear();
@@ -281,8 +339,7 @@ int loadChannel(ID channelId, const std::string& fname)
 	/* Remove old wave, if any. It is safe to do it now: the channel already
 	points to the new one. */
 
-	if (oldWaveId != 0)
-		model::waves.pop(model::getIndex(model::waves, oldWaveId));
+	popWave_(oldWaveId);
 
 	return res.status;
 }
@@ -325,10 +382,13 @@ void cloneChannel(ID channelId)
 
 	/* Clone plugins, actions and wave first in their own lists. */
 	
+	std::unordered_map<ID, ID> newPluginIds;
 #ifdef WITH_VST
 	newChannel->pluginIds = pluginHost::clonePlugins(oldChannel.pluginIds);
+	for (std::size_t i = 0; i < oldChannel.pluginIds.size(); i++)
+		newPluginIds[oldChannel.pluginIds[i]] = newChannel->pluginIds[i];
 #endif
-	recorderHandler::cloneActions(channelId, newChannel->id);
+	recorderHandler::cloneActions(channelId, newChannel->id, newPluginIds);
 	
 	if (newChannel->samplePlayer && newChannel->samplePlayer->hasWave()) 
 	{
@@ -359,8 +419,7 @@ void freeChannel(ID channelId)
 
 	/* Then remove the actual Wave, if any. */
 	
-	if (waveId != 0)
-		model::waves.pop(model::getIndex(model::waves, waveId)); 
+	popWave_(waveId);
 }
 
 
@@ -369,6 +428,8 @@ void freeChannel(ID channelId)
 
 void freeAllChannels()
 {
+	waveLoader::stop();
+
 	for (ID id : getChannelsWithWave_()) {
 		model::onSwap(model::channels, id, [](Channel& c) 
 		{ 
@@ -383,6 +444,51 @@ void freeAllChannels()
 /* -------------------------------------------------------------------------- */
 
 
+void bindLoadedWaves()
+{
+	for (waveLoader::Loaded& l : waveLoader::collect()) {
+
+		std::vector<ID> channelIds = getChannelsWaitingFor_(l.id);
+
+		/* Nobody is interested in this Wave anymore (e.g. the channel has been
+		freed or deleted in the meantime): just drop it. */
+
+		if (channelIds.empty())
+			continue;
+
+		for (std::size_t i = 0; i < channelIds.size(); i++) {
+			if (l.wave == nullptr) {
+				model::onSwap(model::channels, channelIds[i], [](Channel& c)
+				{
+					c.samplePlayer->setInvalidWave();
+				});
+				continue;
+			}
+
+			/* The first channel takes the Wave, other ones (i.e. clones made
+			while loading) get their own Wave, sharing the same data. */
+
+			if (i == 0)
+				model::waves.push(std::move(l.wave));
+			else {
+				model::WavesLock wl(model::waves);
+				const Wave& w = model::get(model::waves, l.id);
+				model::waves.push(waveManager::createFromWave(w, 0, w.getSize()));
+			}
+
+			model::onSwap(model::channels, channelIds[i], [](Channel& c)
+			{
+				model::WavesLock wl(model::waves);
+				c.samplePlayer->setWave(*model::waves.back(), /*samplerateRatio=*/1.0f);
+			});
+		}
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void deleteChannel(ID channelId)
 {
 	ID              waveId;
@@ -400,8 +506,7 @@ void deleteChannel(ID channelId)
 	
 	model::channels.pop(model::getIndex(model::channels, channelId));
 
-	if (waveId != 0)
-		model::waves.pop(model::getIndex(model::waves, waveId)); 
+	popWave_(waveId);
 
 #ifdef WITH_VST
 	pluginHost::freePlugins(pluginIds);
@@ -476,14 +581,33 @@ bool getInToOut()
 require some changes when we will allow overdubbing (the previous existing Wave
 has to be overwritten somehow). */
 
-void finalizeInputRec()
+void finalizeInputRec(const std::string& takePath)
 {
+	/* Channels armed after the session has started have no take. Free takes 
+	come from the master input: only channels that record from there get 
+	them. */
+
+	std::vector<mixer::Take> takes = mixer::collectInputRec();
+
+	auto findTake = [&takes](ID id) -> mixer::Take*
+	{
+		auto it = std::find_if(takes.begin(), takes.end(), [id](const mixer::Take& t) { return t.channelId == id; });
+		return it != takes.end() ? &*it : nullptr;
+	};
+
+	bool takeLoaded = false;
+
 	for (ID id : getRecordableChannels_())
-		recordChannel_(id);
+		if (mixer::Take* t = findTake(id); t != nullptr)
+			takeLoaded |= recordChannel_(id, std::move(t->data), t->inputPair < 0 ? takePath : "");
 	for (ID id : getOverdubbableChannels_())
-		overdubChannel_(id);
+		if (mixer::Take* t = findTake(id); t != nullptr)
+			overdubChannel_(id, t->data);
+
+	/* Waves loaded from the free take keep it on disk. Nobody else needs it. */
 
-	mixer::clearRecBuffer();
+	if (!takePath.empty() && !takeLoaded)
+		u::fs::remove(takePath);
 }
 
 
@@ -84,6 +84,12 @@ Completely removes a channel from the stack. */
 
 void deleteChannel(ID channelId);
 
+/* bindLoadedWaves
+Pushes Waves decoded in background into the model and assigns them to the 
+channels waiting for them. Call it from the main thread only. */
+
+void bindLoadedWaves();
+
 void cloneChannel(ID channelId);
 void renameChannel(ID channelId, const std::string& name);
 void freeAllChannels();
@@ -96,10 +102,12 @@ Updates the number of solo-ed channels in mixer. */
 void updateSoloCount();
 
 /* finalizeInputRec
-Fills armed Sample Channels with audio data coming from an input recording
-session. */
+Fills armed Sample Channels with their takes from an input recording session.
+Empty channels recording from the master input get the whole free take 
+'takePath' instead, if given (see conf::freeInputRec). Overdubbed channels 
+always get one loop. The free take file is deleted if no channel loads it. */
 
-void finalizeInputRec();
+void finalizeInputRec(const std::string& takePath="");
 
 /* hasLogicalSamples
 True if 1 or more samples are logical (memory only, such as takes) */
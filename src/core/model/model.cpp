@@ -42,6 +42,7 @@ RCUList<Kernel>   kernel(std::make_unique<Kernel>());
 RCUList<Recorder> recorder(std::make_unique<Recorder>());
 RCUList<MidiIn>   midiIn(std::make_unique<MidiIn>());
 RCUList<Actions>  actions(std::make_unique<Actions>());
+RCUList<InputRec> inputRec(std::make_unique<InputRec>());
 RCUList<Channel> channels;
 RCUList<Wave>     waves;
 #ifdef WITH_VST
@@ -49,15 +50,6 @@ RCUList<Plugin>   plugins;
 #endif
 
 
-Actions::Actions(const Actions& o) : map(o.map)
-{
-	/* Needs to update all pointers of prev and next actions with addresses 
-	coming from the new 'actions' map.  */
-
-	recorder::updateMapPointers(map);
-}
-
-
 #ifdef G_DEBUG_MODE
 
 void debug()
@@ -119,12 +111,14 @@ void debug()
 
 	puts("model::actions");
 
-	for (auto& kv : actions.get()->map) {
-		printf("\tframe: %d\n", kv.first);
-		for (const Action& a : kv.second)
-			printf("\t\t(%p) - ID=%d, frame=%d, channel=%d, value=0x%X, prevId=%d, prev=%p, nextId=%d, next=%p\n", 
-				(void*) &a, a.id, a.frame, a.channelId, a.event.getRaw(), a.prevId, (void*) a.prev, a.nextId, (void*) a.next);	
-	}
+	const ActionTimeline& timeline = actions.get()->timeline;
+	timeline.forEach([&](std::size_t i)
+	{
+		const Action a = timeline.get(i);
+		printf("\t%zu) ID=%d, frame=%d, channel=%d, value=0x%X, prevId=%d, prev=%d, nextId=%d, next=%d\n", 
+			i, a.id, a.frame, a.channelId, a.event.getRaw(), a.prevId, 
+			static_cast<int>(timeline.getPrev(i)), a.nextId, static_cast<int>(timeline.getNext(i)));
+	});
 	
 	puts("===============================");
 }
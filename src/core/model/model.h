@@ -30,13 +30,17 @@
 
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 #include "core/model/traits.h"
 #include "core/channels/channel.h"
 #include "core/channels/state.h"
 #include "core/const.h"
 #include "core/wave.h"
+#include "core/mixer.h"
 #include "core/plugins/plugin.h"
 #include "core/rcuList.h"
+#include "core/actionTimeline.h"
 #include "core/recorder.h"
 
 
@@ -134,10 +138,18 @@ struct MidiIn
 
 struct Actions
 {
-	Actions() = default;
-	Actions(const Actions& o);
+	ActionTimeline timeline;
+};
+
 
-	recorder::ActionMap map;
+/* InputRec
+Takes being recorded by the audio thread. Held by a shared pointer, so that a 
+swap moves the very same takes to the new node instead of copying audio data. 
+Set up and collected by mixer::prepareInputRec() and mixer::collectInputRec(). */
+
+struct InputRec
+{
+	std::shared_ptr<std::vector<mixer::Take>> takes;
 };
 
 
@@ -147,6 +159,7 @@ using KernelLock   = RCUList<Kernel>::Lock;
 using RecorderLock = RCUList<Recorder>::Lock;
 using MidiInLock   = RCUList<MidiIn>::Lock;
 using ActionsLock  = RCUList<Actions>::Lock;
+using InputRecLock = RCUList<InputRec>::Lock;
 using ChannelsLock = RCUList<Channel>::Lock;
 using WavesLock    = RCUList<Wave>::Lock;
 #ifdef WITH_VST
@@ -159,6 +172,7 @@ extern RCUList<Kernel>   kernel;
 extern RCUList<Recorder> recorder;
 extern RCUList<MidiIn>   midiIn;
 extern RCUList<Actions>  actions;
+extern RCUList<InputRec> inputRec;
 extern RCUList<Channel>  channels;
 extern RCUList<Wave>     waves;
 #ifdef WITH_VST
@@ -25,6 +25,7 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include <cassert>
 #include "core/model/model.h"
 #include "core/channels/channelManager.h"
@@ -34,6 +35,7 @@
 #include "core/plugins/pluginManager.h"
 #include "core/recorderHandler.h"
 #include "core/waveManager.h"
+#include "core/waveLoader.h"
 #include "core/sequencer.h"
 #include "core/model/storage.h"
 
@@ -64,7 +66,7 @@ void store(patch::Patch& patch)
 		patch.plugins.push_back(pluginManager::serializePlugin(*p));
 #endif
 
-	patch.actions = recorderHandler::serializeActions(actions.get()->map); 
+	patch.actions = recorderHandler::serializeActions(actions.get()->timeline); 
 
 	for (const Wave* w : waves)
 		patch.waves.push_back(waveManager::serializeWave(*w));
@@ -111,40 +113,44 @@ void load(const patch::Patch& patch)
 
 	onSwap(actions, [&](Actions& a)
 	{
-		a.map = recorderHandler::deserializeActions(patch.actions);
+		a.timeline = recorderHandler::deserializeActions(patch.actions);
 	});
 
 #ifdef WITH_VST
     for (const patch::Plugin& pplugin : patch.plugins)
         plugins.push(pluginManager::deserializePlugin(pplugin, patch.version));
 #endif
-    
-	for (const patch::Wave& pwave : patch.waves) {
-		std::unique_ptr<Wave> w = waveManager::deserializeWave(pwave, conf::conf.samplerate,
-			conf::conf.rsmpQuality);
-		if (w != nullptr)
-			waves.push(std::move(w));	
-	}
 
 	channels.clear();
     for (const patch::Channel& pchannel : patch.channels)
 		channels.push(channelManager::deserializeChannel(pchannel, kernelAudio::getRealBufSize()));
 	
-	/* Load Waves into Channels. */
+	/* Waves are decoded in background: Channels referring to a known Wave are 
+	put in loading state and get their Wave later on, when ready. See 
+	mixerHandler::bindLoadedWaves(). */
 
 	ChannelsLock cl(channels);
-	WavesLock    wl(waves);
 
 	float samplerateRatio = conf::conf.samplerate / static_cast<float>(patch::patch.samplerate);
 	
 	for (Channel* c : channels) {
 		if (!c->samplePlayer)
 			continue;
-		if (exists(waves, c->samplePlayer->getWaveId()))
-			c->samplePlayer->setWave(get(waves, c->samplePlayer->getWaveId()), samplerateRatio);
+		ID waveId = c->samplePlayer->getWaveId();
+		bool known = std::any_of(patch.waves.begin(), patch.waves.end(), 
+			[waveId](const patch::Wave& w) { return w.id == waveId; });
+		if (waveId != 0 && known)
+			c->samplePlayer->setLoadingWave(samplerateRatio);
 		else
 			c->samplePlayer->setInvalidWave();
 	}
+
+	/* IDs must be taken right now: new Waves might be created from the main
+	thread before the background decoding is over. */
+
+	waveManager::reserveIds(patch.waves);
+	waveLoader::start(patch.waves, conf::conf.samplerate, conf::conf.rsmpQuality, 
+		static_cast<SampleStorage>(conf::conf.sampleStorage));
 }
 
 
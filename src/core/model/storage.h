@@ -43,8 +43,13 @@ namespace model
 {
 void store(conf::Conf& c);
 void store(patch::Patch& p);
-void load(const patch::Patch& p);
 void load(const conf::Conf& c);
+
+/* load
+Fills the model with data from patch 'p'. Waves are decoded in background by
+waveLoader: sample channels stay in loading state until their Wave is ready. */
+
+void load(const patch::Patch& p);
 }}} // giada::m::model::
 
 
@@ -31,6 +31,7 @@
 #include "utils/log.h"
 #include "core/mixer.h"
 #include "patch.h"
+#include "patchBinary.h"
 
 
 namespace nl = nlohmann;
@@ -133,12 +134,14 @@ void readActions_(const nl::json& j)
 	ID id = 0;
 	for (const auto& jaction : j[PATCH_KEY_ACTIONS]) {
 		Action a;
-		a.id        = jaction.value(G_PATCH_KEY_ACTION_ID, ++id);
-		a.channelId = jaction.value(G_PATCH_KEY_ACTION_CHANNEL, 0);
-		a.frame     = jaction.value(G_PATCH_KEY_ACTION_FRAME, 0);
-		a.event     = jaction.value(G_PATCH_KEY_ACTION_EVENT, 0);
-		a.prevId    = jaction.value(G_PATCH_KEY_ACTION_PREV, 0);
-		a.nextId    = jaction.value(G_PATCH_KEY_ACTION_NEXT, 0);
+		a.id          = jaction.value(G_PATCH_KEY_ACTION_ID, ++id);
+		a.channelId   = jaction.value(G_PATCH_KEY_ACTION_CHANNEL, 0);
+		a.frame       = jaction.value(G_PATCH_KEY_ACTION_FRAME, 0);
+		a.event       = jaction.value(G_PATCH_KEY_ACTION_EVENT, 0);
+		a.prevId      = jaction.value(G_PATCH_KEY_ACTION_PREV, 0);
+		a.nextId      = jaction.value(G_PATCH_KEY_ACTION_NEXT, 0);
+		a.pluginId    = jaction.value(G_PATCH_KEY_ACTION_PLUGIN, -1);
+		a.pluginParam = jaction.value(G_PATCH_KEY_ACTION_PLUGIN_PARAM, -1);
 		patch.actions.push_back(a);
 	}
 }
@@ -188,8 +191,15 @@ void readChannels_(const nl::json& j)
 		c.shift             = jchannel.value(PATCH_KEY_CHANNEL_SHIFT, 0);
 		c.readActions       = jchannel.value(PATCH_KEY_CHANNEL_READ_ACTIONS, false);
 		c.pitch             = jchannel.value(PATCH_KEY_CHANNEL_PITCH, G_DEFAULT_PITCH);
+		c.resamplerQuality  = static_cast<ResamplerQuality>(jchannel.value(PATCH_KEY_CHANNEL_RESAMPLER_QUALITY, 0));
+		c.stretchToTempo    = jchannel.value(PATCH_KEY_CHANNEL_STRETCH_TO_TEMPO, false);
+		c.stretchBeats      = jchannel.value(PATCH_KEY_CHANNEL_STRETCH_BEATS, 0.0f);
+		c.polyphony         = jchannel.value(PATCH_KEY_CHANNEL_POLYPHONY, 1);
+		c.voiceStealing     = static_cast<VoiceStealing>(jchannel.value(PATCH_KEY_CHANNEL_VOICE_STEALING, 0));
+		c.rootNote          = jchannel.value(PATCH_KEY_CHANNEL_ROOT_NOTE, -1);
 		c.inputMonitor      = jchannel.value(PATCH_KEY_CHANNEL_INPUT_MONITOR, false);
 		c.overdubProtection = jchannel.value(PATCH_KEY_CHANNEL_OVERDUB_PROTECTION, false);
+		c.inputPair         = jchannel.value(PATCH_KEY_CHANNEL_INPUT_PAIR, -1);
 		c.midiInVeloAsVol   = jchannel.value(PATCH_KEY_CHANNEL_MIDI_IN_VELO_AS_VOL, 0);
 		c.midiInReadActions = jchannel.value(PATCH_KEY_CHANNEL_MIDI_IN_READ_ACTIONS, 0);
 		c.midiInPitch       = jchannel.value(PATCH_KEY_CHANNEL_MIDI_IN_PITCH, 0);
@@ -267,6 +277,10 @@ void writeActions_(nl::json& j)
 		jaction[G_PATCH_KEY_ACTION_EVENT]   = a.event;
 		jaction[G_PATCH_KEY_ACTION_PREV]    = a.prevId;
 		jaction[G_PATCH_KEY_ACTION_NEXT]    = a.nextId;
+		if (a.pluginId != -1) {
+			jaction[G_PATCH_KEY_ACTION_PLUGIN]       = a.pluginId;
+			jaction[G_PATCH_KEY_ACTION_PLUGIN_PARAM] = a.pluginParam;
+		}
 		j[PATCH_KEY_ACTIONS].push_back(jaction);
 	}
 }
@@ -351,8 +365,15 @@ void writeChannels_(nl::json& j)
 		jchannel[PATCH_KEY_CHANNEL_SHIFT]                = c.shift;
 		jchannel[PATCH_KEY_CHANNEL_READ_ACTIONS]         = c.readActions;
 		jchannel[PATCH_KEY_CHANNEL_PITCH]                = c.pitch;
+		jchannel[PATCH_KEY_CHANNEL_RESAMPLER_QUALITY]    = static_cast<int>(c.resamplerQuality);
+		jchannel[PATCH_KEY_CHANNEL_STRETCH_TO_TEMPO]     = c.stretchToTempo;
+		jchannel[PATCH_KEY_CHANNEL_STRETCH_BEATS]        = c.stretchBeats;
+		jchannel[PATCH_KEY_CHANNEL_POLYPHONY]            = c.polyphony;
+		jchannel[PATCH_KEY_CHANNEL_VOICE_STEALING]       = static_cast<int>(c.voiceStealing);
+		jchannel[PATCH_KEY_CHANNEL_ROOT_NOTE]            = c.rootNote;
 		jchannel[PATCH_KEY_CHANNEL_INPUT_MONITOR]        = c.inputMonitor;
 		jchannel[PATCH_KEY_CHANNEL_OVERDUB_PROTECTION]   = c.overdubProtection;
+		jchannel[PATCH_KEY_CHANNEL_INPUT_PAIR]           = c.inputPair;
 		jchannel[PATCH_KEY_CHANNEL_MIDI_IN_VELO_AS_VOL]  = c.midiInVeloAsVol;
 		jchannel[PATCH_KEY_CHANNEL_MIDI_IN_READ_ACTIONS] = c.midiInReadActions;
 		jchannel[PATCH_KEY_CHANNEL_MIDI_IN_PITCH]        = c.midiInPitch;
@@ -430,6 +451,92 @@ bool Version::operator <(const Version& o) const
 /* -------------------------------------------------------------------------- */
 
 
+bool Column::operator ==(const Column& o) const
+{
+	return id == o.id && width == o.width;
+}
+
+
+bool Channel::operator ==(const Channel& o) const
+{
+	return id                == o.id                &&
+	       type              == o.type              &&
+	       height            == o.height            &&
+	       name              == o.name              &&
+	       columnId          == o.columnId          &&
+	       key               == o.key               &&
+	       mute              == o.mute              &&
+	       solo              == o.solo              &&
+	       volume            == o.volume            &&
+	       pan               == o.pan               &&
+	       hasActions        == o.hasActions        &&
+	       armed             == o.armed             &&
+	       midiIn            == o.midiIn            &&
+	       midiInKeyPress    == o.midiInKeyPress    &&
+	       midiInKeyRel      == o.midiInKeyRel      &&
+	       midiInKill        == o.midiInKill        &&
+	       midiInArm         == o.midiInArm         &&
+	       midiInVolume      == o.midiInVolume      &&
+	       midiInMute        == o.midiInMute        &&
+	       midiInSolo        == o.midiInSolo        &&
+	       midiInFilter      == o.midiInFilter      &&
+	       midiOutL          == o.midiOutL          &&
+	       midiOutLplaying   == o.midiOutLplaying   &&
+	       midiOutLmute      == o.midiOutLmute      &&
+	       midiOutLsolo      == o.midiOutLsolo      &&
+	       waveId            == o.waveId            &&
+	       mode              == o.mode              &&
+	       begin             == o.begin             &&
+	       end               == o.end               &&
+	       shift             == o.shift             &&
+	       readActions       == o.readActions       &&
+	       pitch             == o.pitch             &&
+	       resamplerQuality  == o.resamplerQuality  &&
+	       stretchToTempo    == o.stretchToTempo    &&
+	       stretchBeats      == o.stretchBeats      &&
+	       polyphony         == o.polyphony         &&
+	       voiceStealing     == o.voiceStealing     &&
+	       rootNote          == o.rootNote          &&
+	       inputMonitor      == o.inputMonitor      &&
+	       overdubProtection == o.overdubProtection &&
+	       inputPair         == o.inputPair         &&
+	       midiInVeloAsVol   == o.midiInVeloAsVol   &&
+	       midiInReadActions == o.midiInReadActions &&
+	       midiInPitch       == o.midiInPitch       &&
+	       midiOut           == o.midiOut           &&
+#ifdef WITH_VST
+	       pluginIds         == o.pluginIds         &&
+#endif
+	       midiOutChan       == o.midiOutChan;
+}
+
+
+bool Action::operator ==(const Action& o) const
+{
+	return id == o.id && channelId == o.channelId && frame == o.frame && 
+	       event == o.event && prevId == o.prevId && nextId == o.nextId &&
+	       pluginId == o.pluginId && pluginParam == o.pluginParam;
+}
+
+
+bool Wave::operator ==(const Wave& o) const
+{
+	return id == o.id && path == o.path;
+}
+
+
+#ifdef WITH_VST
+bool Plugin::operator ==(const Plugin& o) const
+{
+	return id == o.id && path == o.path && bypass == o.bypass && 
+	       params == o.params && state == o.state && midiInParams == o.midiInParams;
+}
+#endif
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void init()
 {
 	patch = Patch();
@@ -439,8 +546,11 @@ void init()
 /* -------------------------------------------------------------------------- */
 
 
-bool write(const std::string& file)
+bool write(const std::string& file, PatchFormat f)
 {
+	if (f == PatchFormat::BINARY)
+		return binary::write(file, patch);
+
 	nl::json j;
 
 	writeCommons_(j);
@@ -466,6 +576,13 @@ bool write(const std::string& file)
 
 int read(const std::string& file, const std::string& basePath)
 {
+	if (binary::isBinary(file)) {
+		int res = binary::read(file, basePath, patch);
+		if (res == G_PATCH_OK)
+			modernize_();
+		return res;
+	}
+
 	std::ifstream ifs(file);
 	if (!ifs.good())
 		return G_PATCH_UNREADABLE;
@@ -501,4 +618,21 @@ int read(const std::string& file, const std::string& basePath)
 
 	return G_PATCH_OK;
 }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int convert(const std::string& from, const std::string& to, PatchFormat f)
+{
+	Patch backup = patch;
+
+	init();
+	int res = read(from, "");
+	if (res == G_PATCH_OK && !write(to, f))
+		res = G_PATCH_UNREADABLE;
+
+	patch = backup;
+	return res;
+}
 }}} // giada::m::patch::
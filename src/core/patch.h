@@ -55,6 +55,8 @@ struct Column
 {
 	ID  id;
 	int width;
+
+	bool operator ==(const Column& o) const;
 };
 
 
@@ -93,8 +95,15 @@ struct Channel
 	Frame            shift;
 	bool             readActions;
 	float            pitch = G_DEFAULT_PITCH;
+	ResamplerQuality resamplerQuality = ResamplerQuality::LINEAR;
+	bool             stretchToTempo = false;
+	float            stretchBeats = 0.0f;
+	int              polyphony = 1;
+	VoiceStealing    voiceStealing = VoiceStealing::OLDEST;
+	int              rootNote = -1;
 	bool             inputMonitor;
 	bool             overdubProtection;
+	int              inputPair = -1;
 	bool             midiInVeloAsVol;
 	uint32_t         midiInReadActions;
 	uint32_t         midiInPitch;
@@ -104,6 +113,8 @@ struct Channel
 #ifdef WITH_VST
 	std::vector<ID> pluginIds;
 #endif
+
+	bool operator ==(const Channel& o) const;
 };
 
 
@@ -115,6 +126,10 @@ struct Action
 	uint32_t event;
 	ID       prevId;
 	ID       nextId;
+	ID       pluginId    = -1;
+	int      pluginParam = -1;
+
+	bool operator ==(const Action& o) const;
 };
 
 
@@ -122,6 +137,8 @@ struct Wave
 {
 	ID          id;
 	std::string path;
+
+	bool operator ==(const Wave& o) const;
 };
 
 
@@ -134,6 +151,8 @@ struct Plugin
 	std::vector<float>    params; // TODO - to be removed in 0.18.0
 	std::string           state;
 	std::vector<uint32_t> midiInParams;
+
+	bool operator ==(const Plugin& o) const;
 };
 #endif
 
@@ -174,14 +193,22 @@ Initializes the patch with default values. */
 void init();
 
 /* read
-Reads patch from file. It takes 'basePath' as parameter for Wave reading. */
+Reads patch from file. It takes 'basePath' as parameter for Wave reading. Both
+JSON and binary patches are accepted: the format is detected from the file 
+content. */
 
 int read(const std::string& file, const std::string& basePath);
 
 /* write
-Writes patch to file. */
+Writes patch to file, in JSON or binary format. */
+
+bool write(const std::string& file, PatchFormat f=PatchFormat::JSON);
+
+/* convert
+Converts patch file 'from' to patch file 'to' in format 'f', losslessly. The 
+current patch is left untouched. Returns one of the G_PATCH_* values. */
 
-bool write(const std::string& file);
+int convert(const std::string& from, const std::string& to, PatchFormat f);
 }}}  // giada::m::patch::
 
 
@@ -0,0 +1,778 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+#include "utils/log.h"
+#include "core/const.h"
+#include "patch.h"
+#include "patchBinary.h"
+
+
+namespace giada {
+namespace m {
+namespace patch {
+namespace binary
+{
+namespace
+{
+constexpr char          MAGIC[8]       = { 'G', 'I', 'A', 'D', 'A', 'B', 'P', 'T' };
+constexpr std::uint32_t ENDIAN_CHECK     = 0x01020304;
+constexpr std::uint32_t FORMAT_VERSION = 1;
+constexpr std::size_t   ALIGNMENT      = 8;
+
+/* MAX_RECORD_GROWTH
+Records from older files may be smaller than the current ones, but not by more
+than this factor. Bounds the memory taken by records to a small multiple of the
+file size, whatever a corrupted section table says. */
+
+constexpr std::size_t MAX_RECORD_GROWTH = 4;
+
+
+enum class SectionType : std::uint32_t
+{
+	COMMONS = 1, STRINGS, IDS, COLUMNS, CHANNELS, ACTIONS, WAVES, PLUGINS, 
+	PLUGIN_MIDI_IN_PARAMS
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* Header, Section
+File header and section table entry. */
+
+struct Header
+{
+	char          magic[8];
+	std::uint32_t byteOrder;
+	std::uint32_t formatVersion;
+	std::int32_t  versionMajor;
+	std::int32_t  versionMinor;
+	std::int32_t  versionPatch;
+	std::uint32_t sections;
+};
+
+
+struct Section
+{
+	SectionType   type;
+	std::uint32_t recordSize;
+	std::uint64_t offset;
+	std::uint64_t count;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* StringRef, Range
+References to data in pools: a string in the STRINGS section, a list of values
+in the IDS or PLUGIN_MIDI_IN_PARAMS sections. */
+
+struct StringRef
+{
+	std::uint32_t offset = 0;
+	std::uint32_t size   = 0;
+};
+
+
+struct Range
+{
+	std::uint32_t first = 0;
+	std::uint32_t count = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* Records
+On-disk layout of each element. Fields are all 4 bytes wide, so there is no 
+padding in between. Defaults are the same of the JSON reader, for fields
+missing from older files. Actions are stored as patch::Action. */
+
+struct Commons
+{
+	StringRef     name;
+	std::int32_t  bars       = G_DEFAULT_BARS;
+	std::int32_t  beats      = G_DEFAULT_BEATS;
+	float         bpm        = G_DEFAULT_BPM;
+	std::uint32_t quantize   = G_DEFAULT_QUANTIZE;
+	std::int32_t  lastTakeId = 0;
+	std::int32_t  samplerate = G_DEFAULT_SAMPLERATE;
+	std::uint32_t metronome  = 0;
+};
+
+
+struct ColumnRecord
+{
+	std::int32_t id    = 0;
+	std::int32_t width = G_DEFAULT_COLUMN_WIDTH;
+};
+
+
+struct ChannelRecord
+{
+	std::int32_t  id                = 0;
+	std::int32_t  type              = static_cast<std::int32_t>(ChannelType::SAMPLE);
+	std::int32_t  height            = G_GUI_UNIT;
+	StringRef     name;
+	std::int32_t  columnId          = 1;
+	std::int32_t  key               = 0;
+	std::uint32_t mute              = 0;
+	std::uint32_t solo              = 0;
+	float         volume            = G_DEFAULT_VOL;
+	float         pan               = G_DEFAULT_PAN;
+	std::uint32_t hasActions        = 0;
+	std::uint32_t armed             = 0;
+	std::uint32_t midiIn            = 0;
+	std::uint32_t midiInKeyPress    = 0;
+	std::uint32_t midiInKeyRel      = 0;
+	std::uint32_t midiInKill        = 0;
+	std::uint32_t midiInArm         = 0;
+	std::uint32_t midiInVolume      = 0;
+	std::uint32_t midiInMute        = 0;
+	std::uint32_t midiInSolo        = 0;
+	std::int32_t  midiInFilter      = 0;
+	std::uint32_t midiOutL          = 0;
+	std::uint32_t midiOutLplaying   = 0;
+	std::uint32_t midiOutLmute      = 0;
+	std::uint32_t midiOutLsolo      = 0;
+	std::int32_t  waveId            = 0;
+	std::int32_t  mode              = static_cast<std::int32_t>(SamplePlayerMode::SINGLE_BASIC);
+	std::int32_t  begin             = 0;
+	std::int32_t  end               = 0;
+	std::int32_t  shift             = 0;
+	std::uint32_t readActions       = 0;
+	float         pitch             = G_DEFAULT_PITCH;
+	std::int32_t  resamplerQuality  = 0;
+	std::uint32_t stretchToTempo    = 0;
+	float         stretchBeats      = 0.0f;
+	std::int32_t  polyphony         = 1;
+	std::int32_t  voiceStealing     = 0;
+	std::int32_t  rootNote          = -1;
+	std::uint32_t inputMonitor      = 0;
+	std::uint32_t overdubProtection = 0;
+	std::uint32_t midiInVeloAsVol   = 0;
+	std::uint32_t midiInReadActions = 0;
+	std::uint32_t midiInPitch       = 0;
+	std::uint32_t midiOut           = 0;
+	std::int32_t  midiOutChan       = 0;
+	Range         pluginIds;
+	std::int32_t  inputPair         = -1;
+};
+
+
+struct WaveRecord
+{
+	std::int32_t id = 0;
+	StringRef    path;
+};
+
+
+struct PluginRecord
+{
+	std::int32_t  id     = 0;
+	StringRef     path;
+	std::uint32_t bypass = 0;
+	StringRef     state;
+	Range         midiInParams;
+};
+
+
+static_assert(std::is_trivially_copyable_v<Action> && sizeof(Action) == 32, 
+	"patch::Action layout doesn't match the ACTIONS section");
+
+
+/* -------------------------------------------------------------------------- */
+
+/* MappedFile_
+A read-only memory mapping of a whole file. Data is nullptr if the file can't
+be opened or is empty. */
+
+class MappedFile_
+{
+public:
+
+	MappedFile_(const std::string& path)
+	{
+#if defined(_WIN32)
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, 
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+			return;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+			return;
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr)
+			return;
+		m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		m_size = m_data != nullptr ? static_cast<std::size_t>(size.QuadPart) : 0;
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd == -1)
+			return;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				m_data = static_cast<const std::uint8_t*>(data);
+				m_size = st.st_size;
+			}
+		}
+		close(fd);
+#endif
+	}
+
+
+	~MappedFile_()
+	{
+#if defined(_WIN32)
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+#else
+		if (m_data != nullptr)
+			munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+	}
+
+
+	MappedFile_(const MappedFile_&) = delete;
+	MappedFile_& operator =(const MappedFile_&) = delete;
+
+
+	const std::uint8_t* getData() const { return m_data; }
+	std::size_t         getSize() const { return m_size; }
+
+private:
+
+	const std::uint8_t* m_data = nullptr;
+	std::size_t         m_size = 0;
+#if defined(_WIN32)
+	HANDLE m_file    = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#endif
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* Reader_
+Gives access to sections and pools of a binary patch in memory. All offsets
+are checked against the data size: any inconsistency makes the Reader invalid,
+see isValid(). */
+
+class Reader_
+{
+public:
+
+	Reader_(const std::uint8_t* data, std::size_t size)
+	: m_data (data)
+	, m_size (size)
+	, m_valid(false)
+	{
+		if (size < sizeof(Header))
+			return;
+		std::memcpy(&m_header, data, sizeof(Header));
+		if (std::memcmp(m_header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		    m_header.byteOrder != ENDIAN_CHECK ||
+		    m_header.sections > (size - sizeof(Header)) / sizeof(Section))
+			return;
+
+		m_sections.resize(m_header.sections);
+		std::memcpy(m_sections.data(), data + sizeof(Header), m_header.sections * sizeof(Section));
+
+		/* Every section holds records or pool items of some size, strings being
+		one byte each. Unknown sections from newer files are never read: only
+		their offset is checked. */
+
+		for (const Section& s : m_sections) {
+			if (s.offset > size)
+				return;
+			if (s.recordSize == 0 ? isKnown(s.type) : s.count > (size - s.offset) / s.recordSize)
+				return;
+		}
+
+		m_valid = true;
+	}
+
+
+	bool isValid() const { return m_valid; }
+	const Header& getHeader() const { return m_header; }
+
+
+	/* getRecords
+	Returns all records in section 't'. Records might be smaller (older files)
+	or bigger (newer files) than T: only the common part is read. Records too
+	small to be a T, see MAX_RECORD_GROWTH, make the Reader invalid. */
+
+	template <typename T>
+	std::vector<T> getRecords(SectionType t)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		const Section* s = findSection(t);
+		if (s == nullptr)
+			return {};
+		if (s->recordSize * MAX_RECORD_GROWTH < sizeof(T)) {
+			m_valid = false;
+			return {};
+		}
+
+		std::vector<T>      out(s->count, T{});
+		const std::uint8_t* in = m_data + s->offset;
+
+		if (s->recordSize == sizeof(T))
+			std::memcpy(out.data(), in, s->count * sizeof(T));
+		else
+			for (std::size_t i = 0; i < s->count; i++)
+				std::memcpy(&out[i], in + i * s->recordSize, std::min<std::size_t>(sizeof(T), s->recordSize));
+		return out;
+	}
+
+
+	/* getString, getValues
+	Returns data from a pool, given a reference to it. */
+
+	std::string getString(StringRef r)
+	{
+		const Section* s = findSection(SectionType::STRINGS);
+		if (r.size == 0)
+			return "";
+		if (s == nullptr || s->recordSize != 1 || std::uint64_t(r.offset) + r.size > s->count) {
+			m_valid = false;
+			return "";
+		}
+		return std::string(reinterpret_cast<const char*>(m_data + s->offset + r.offset), r.size);
+	}
+
+
+	template <typename T>
+	std::vector<T> getValues(SectionType t, Range r)
+	{
+		const Section* s = findSection(t);
+		if (r.count == 0)
+			return {};
+		if (s == nullptr || s->recordSize != sizeof(T) || std::uint64_t(r.first) + r.count > s->count) {
+			m_valid = false;
+			return {};
+		}
+		std::vector<T> out(r.count);
+		std::memcpy(out.data(), m_data + s->offset + r.first * sizeof(T), r.count * sizeof(T));
+		return out;
+	}
+
+private:
+
+	static bool isKnown(SectionType t)
+	{
+		return t >= SectionType::COMMONS && t <= SectionType::PLUGIN_MIDI_IN_PARAMS;
+	}
+
+
+	const Section* findSection(SectionType t) const
+	{
+		for (const Section& s : m_sections)
+			if (s.type == t)
+				return &s;
+		return nullptr;
+	}
+
+	const std::uint8_t*  m_data;
+	std::size_t          m_size;
+	bool                 m_valid;
+	Header               m_header;
+	std::vector<Section> m_sections;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* Writer_
+Collects sections and pools, then writes them to file in one go. */
+
+class Writer_
+{
+public:
+
+	StringRef addString(const std::string& s)
+	{
+		StringRef r{ static_cast<std::uint32_t>(m_strings.size()), static_cast<std::uint32_t>(s.size()) };
+		m_strings.insert(m_strings.end(), s.begin(), s.end());
+		return r;
+	}
+
+
+	template <typename T>
+	Range addValues(std::vector<T>& pool, const std::vector<T>& values)
+	{
+		Range r{ static_cast<std::uint32_t>(pool.size()), static_cast<std::uint32_t>(values.size()) };
+		pool.insert(pool.end(), values.begin(), values.end());
+		return r;
+	}
+
+
+	template <typename T>
+	void addSection(SectionType t, const std::vector<T>& records)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		const std::uint8_t* data = reinterpret_cast<const std::uint8_t*>(records.data());
+		m_sections.push_back({ t, sizeof(T), std::vector<std::uint8_t>(data, data + records.size() * sizeof(T)), records.size() });
+	}
+
+
+	std::vector<std::uint8_t> serialize(const Version& v)
+	{
+		addSection(SectionType::STRINGS, m_strings);
+
+		Header header;
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.byteOrder     = ENDIAN_CHECK;
+		header.formatVersion = FORMAT_VERSION;
+		header.versionMajor  = v.major;
+		header.versionMinor  = v.minor;
+		header.versionPatch  = v.patch;
+		header.sections      = static_cast<std::uint32_t>(m_sections.size());
+
+		/* Sections start right after the table, each one aligned to 
+		ALIGNMENT bytes. */
+
+		std::vector<Section> table;
+		std::uint64_t        offset = align(sizeof(Header) + m_sections.size() * sizeof(Section));
+		for (const Data& d : m_sections) {
+			table.push_back({ d.type, d.recordSize, offset, d.count });
+			offset = align(offset + d.bytes.size());
+		}
+
+		std::vector<std::uint8_t> out(offset, 0);
+		std::memcpy(out.data(), &header, sizeof(Header));
+		std::memcpy(out.data() + sizeof(Header), table.data(), table.size() * sizeof(Section));
+		for (std::size_t i = 0; i < m_sections.size(); i++)
+			std::copy(m_sections[i].bytes.begin(), m_sections[i].bytes.end(), out.begin() + table[i].offset);
+		return out;
+	}
+
+
+	std::vector<ID>            ids;
+	std::vector<std::uint32_t> midiInParams;
+
+private:
+
+	struct Data
+	{
+		SectionType               type;
+		std::uint32_t             recordSize;
+		std::vector<std::uint8_t> bytes;
+		std::uint64_t             count;
+	};
+
+
+	static std::uint64_t align(std::uint64_t offset)
+	{
+		return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	}
+
+
+	std::vector<std::uint8_t> m_strings;
+	std::vector<Data>         m_sections;
+};
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+bool isBinary(const std::string& file)
+{
+	char magic[sizeof(MAGIC)];
+
+	std::ifstream ifs(file, std::ios::binary);
+	return ifs.read(magic, sizeof(MAGIC)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int read(const std::string& file, const std::string& basePath, Patch& p)
+{
+	MappedFile_ mapped(file);
+	if (mapped.getData() == nullptr)
+		return G_PATCH_UNREADABLE;
+
+	int res = deserialize(mapped.getData(), mapped.getSize(), basePath, p);
+	if (res == G_PATCH_INVALID)
+		u::log::print("[patch::binary::read] corrupted data in %s\n", file);
+	return res;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int deserialize(const std::uint8_t* data, std::size_t size, const std::string& basePath, Patch& p)
+{
+	Reader_ r(data, size);
+	if (!r.isValid())
+		return G_PATCH_INVALID;
+
+	p.version = { r.getHeader().versionMajor, r.getHeader().versionMinor, r.getHeader().versionPatch };
+	if (p.version < Version{0, 16, 0})
+		return G_PATCH_UNSUPPORTED;
+
+	std::vector<Commons> commons = r.getRecords<Commons>(SectionType::COMMONS);
+	if (commons.size() != 1)
+		return G_PATCH_INVALID;
+
+	p.name       = r.getString(commons[0].name);
+	p.bars       = commons[0].bars;
+	p.beats      = commons[0].beats;
+	p.bpm        = commons[0].bpm;
+	p.quantize   = commons[0].quantize;
+	p.lastTakeId = commons[0].lastTakeId;
+	p.samplerate = commons[0].samplerate;
+	p.metronome  = commons[0].metronome;
+
+	for (const ColumnRecord& c : r.getRecords<ColumnRecord>(SectionType::COLUMNS))
+		p.columns.push_back({ c.id, c.width });
+
+#ifdef WITH_VST
+	for (const PluginRecord& rp : r.getRecords<PluginRecord>(SectionType::PLUGINS)) {
+		Plugin pl;
+		pl.id           = rp.id;
+		pl.path         = r.getString(rp.path);
+		pl.bypass       = rp.bypass;
+		pl.state        = r.getString(rp.state);
+		pl.midiInParams = r.getValues<std::uint32_t>(SectionType::PLUGIN_MIDI_IN_PARAMS, rp.midiInParams);
+		p.plugins.push_back(pl);
+	}
+#endif
+
+	for (const WaveRecord& rw : r.getRecords<WaveRecord>(SectionType::WAVES))
+		p.waves.push_back({ rw.id, basePath + r.getString(rw.path) });
+
+	/* Actions are laid out as patch::Action: a single copy. */
+
+	p.actions = r.getRecords<Action>(SectionType::ACTIONS);
+
+	for (const ChannelRecord& rc : r.getRecords<ChannelRecord>(SectionType::CHANNELS)) {
+		Channel c;
+		c.id                = rc.id;
+		c.type              = static_cast<ChannelType>(rc.type);
+		c.height            = rc.height;
+		c.name              = r.getString(rc.name);
+		c.columnId          = rc.columnId;
+		c.key               = rc.key;
+		c.mute              = rc.mute;
+		c.solo              = rc.solo;
+		c.volume            = rc.volume;
+		c.pan               = rc.pan;
+		c.hasActions        = rc.hasActions;
+		c.armed             = rc.armed;
+		c.midiIn            = rc.midiIn;
+		c.midiInKeyPress    = rc.midiInKeyPress;
+		c.midiInKeyRel      = rc.midiInKeyRel;
+		c.midiInKill        = rc.midiInKill;
+		c.midiInArm         = rc.midiInArm;
+		c.midiInVolume      = rc.midiInVolume;
+		c.midiInMute        = rc.midiInMute;
+		c.midiInSolo        = rc.midiInSolo;
+		c.midiInFilter      = rc.midiInFilter;
+		c.midiOutL          = rc.midiOutL;
+		c.midiOutLplaying   = rc.midiOutLplaying;
+		c.midiOutLmute      = rc.midiOutLmute;
+		c.midiOutLsolo      = rc.midiOutLsolo;
+		c.waveId            = rc.waveId;
+		c.mode              = static_cast<SamplePlayerMode>(rc.mode);
+		c.begin             = rc.begin;
+		c.end               = rc.end;
+		c.shift             = rc.shift;
+		c.readActions       = rc.readActions;
+		c.pitch             = rc.pitch;
+		c.resamplerQuality  = static_cast<ResamplerQuality>(rc.resamplerQuality);
+		c.stretchToTempo    = rc.stretchToTempo;
+		c.stretchBeats      = rc.stretchBeats;
+		c.polyphony         = rc.polyphony;
+		c.voiceStealing     = static_cast<VoiceStealing>(rc.voiceStealing);
+		c.rootNote          = rc.rootNote;
+		c.inputMonitor      = rc.inputMonitor;
+		c.overdubProtection = rc.overdubProtection;
+		c.inputPair         = rc.inputPair;
+		c.midiInVeloAsVol   = rc.midiInVeloAsVol;
+		c.midiInReadActions = rc.midiInReadActions;
+		c.midiInPitch       = rc.midiInPitch;
+		c.midiOut           = rc.midiOut;
+		c.midiOutChan       = rc.midiOutChan;
+#ifdef WITH_VST
+		c.pluginIds         = r.getValues<ID>(SectionType::IDS, rc.pluginIds);
+#endif
+		p.channels.push_back(c);
+	}
+
+	return r.isValid() ? G_PATCH_OK : G_PATCH_INVALID;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool write(const std::string& file, const Patch& p)
+{
+	std::vector<std::uint8_t> data = serialize(p);
+
+	std::ofstream ofs(file, std::ios::binary | std::ios::trunc);
+	if (!ofs.good())
+		return false;
+	ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return ofs.good();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::vector<std::uint8_t> serialize(const Patch& p)
+{
+	Writer_ w;
+
+	Commons commons;
+	commons.name       = w.addString(p.name);
+	commons.bars       = p.bars;
+	commons.beats      = p.beats;
+	commons.bpm        = p.bpm;
+	commons.quantize   = p.quantize;
+	commons.lastTakeId = p.lastTakeId;
+	commons.samplerate = p.samplerate;
+	commons.metronome  = p.metronome;
+	w.addSection(SectionType::COMMONS, std::vector<Commons>{ commons });
+
+	std::vector<ColumnRecord> columns;
+	for (const Column& c : p.columns)
+		columns.push_back({ c.id, c.width });
+	w.addSection(SectionType::COLUMNS, columns);
+
+	std::vector<ChannelRecord> channels;
+	for (const Channel& c : p.channels) {
+		ChannelRecord rc;
+		rc.id                = c.id;
+		rc.type              = static_cast<std::int32_t>(c.type);
+		rc.height            = c.height;
+		rc.name              = w.addString(c.name);
+		rc.columnId          = c.columnId;
+		rc.key               = c.key;
+		rc.mute              = c.mute;
+		rc.solo              = c.solo;
+		rc.volume            = c.volume;
+		rc.pan               = c.pan;
+		rc.hasActions        = c.hasActions;
+		rc.armed             = c.armed;
+		rc.midiIn            = c.midiIn;
+		rc.midiInKeyPress    = c.midiInKeyPress;
+		rc.midiInKeyRel      = c.midiInKeyRel;
+		rc.midiInKill        = c.midiInKill;
+		rc.midiInArm         = c.midiInArm;
+		rc.midiInVolume      = c.midiInVolume;
+		rc.midiInMute        = c.midiInMute;
+		rc.midiInSolo        = c.midiInSolo;
+		rc.midiInFilter      = c.midiInFilter;
+		rc.midiOutL          = c.midiOutL;
+		rc.midiOutLplaying   = c.midiOutLplaying;
+		rc.midiOutLmute      = c.midiOutLmute;
+		rc.midiOutLsolo      = c.midiOutLsolo;
+		rc.waveId            = c.waveId;
+		rc.mode              = static_cast<std::int32_t>(c.mode);
+		rc.begin             = c.begin;
+		rc.end               = c.end;
+		rc.shift             = c.shift;
+		rc.readActions       = c.readActions;
+		rc.pitch             = c.pitch;
+		rc.resamplerQuality  = static_cast<std::int32_t>(c.resamplerQuality);
+		rc.stretchToTempo    = c.stretchToTempo;
+		rc.stretchBeats      = c.stretchBeats;
+		rc.polyphony         = c.polyphony;
+		rc.voiceStealing     = static_cast<std::int32_t>(c.voiceStealing);
+		rc.rootNote          = c.rootNote;
+		rc.inputMonitor      = c.inputMonitor;
+		rc.overdubProtection = c.overdubProtection;
+		rc.inputPair         = c.inputPair;
+		rc.midiInVeloAsVol   = c.midiInVeloAsVol;
+		rc.midiInReadActions = c.midiInReadActions;
+		rc.midiInPitch       = c.midiInPitch;
+		rc.midiOut           = c.midiOut;
+		rc.midiOutChan       = c.midiOutChan;
+#ifdef WITH_VST
+		rc.pluginIds         = w.addValues(w.ids, c.pluginIds);
+#endif
+		channels.push_back(rc);
+	}
+	w.addSection(SectionType::CHANNELS, channels);
+	w.addSection(SectionType::ACTIONS, p.actions);
+
+	std::vector<WaveRecord> waves;
+	for (const Wave& wave : p.waves)
+		waves.push_back({ wave.id, w.addString(wave.path) });
+	w.addSection(SectionType::WAVES, waves);
+
+#ifdef WITH_VST
+	std::vector<PluginRecord> plugins;
+	for (const Plugin& pl : p.plugins) {
+		PluginRecord rp;
+		rp.id           = pl.id;
+		rp.path         = w.addString(pl.path);
+		rp.bypass       = pl.bypass;
+		rp.state        = w.addString(pl.state);
+		rp.midiInParams = w.addValues(w.midiInParams, pl.midiInParams);
+		plugins.push_back(rp);
+	}
+	w.addSection(SectionType::PLUGINS, plugins);
+	w.addSection(SectionType::PLUGIN_MIDI_IN_PARAMS, w.midiInParams);
+#endif
+
+	w.addSection(SectionType::IDS, w.ids);
+
+	return w.serialize(Version{});
+}
+}}}} // giada::m::patch::binary::
@@ -0,0 +1,87 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_PATCH_BINARY_H
+#define G_PATCH_BINARY_H
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace giada {
+namespace m {
+namespace patch
+{
+struct Patch;
+namespace binary
+{
+/* Binary patch format
+An alternative to JSON patches, meant for large projects: no parsing is needed,
+as data is laid out in fixed-size records. The file is memory-mapped and read 
+straight into the Patch, without intermediate objects.
+
+	[header][section table][section 0][section 1]...
+
+The header holds a magic string, a byte order mark, the format version and the
+Giada version that wrote the file. Each entry in the section table tells the 
+type, the offset, the number of records and the size of each record of a 
+section. Sections hold columns, channels, actions, waves and plug-ins, plus 
+some pools for variable-size data referenced by them: strings (names, paths, 
+plug-in state blobs) and ID lists. 
+Records only grow by appending new fields at the end: older files come with 
+smaller records, and missing fields take their default value. Unknown sections
+are skipped. Data is stored in native byte order: files with a different one
+are rejected. */
+
+/* isBinary
+True if 'file' is a binary patch. */
+
+bool isBinary(const std::string& file);
+
+/* read
+Reads binary patch 'file' into 'p'. Takes 'basePath' as parameter for Wave 
+reading, as patch::read() does. Returns one of the G_PATCH_* values. */
+
+int read(const std::string& file, const std::string& basePath, Patch& p);
+
+/* write
+Writes Patch 'p' to binary patch 'file'. */
+
+bool write(const std::string& file, const Patch& p);
+
+/* (de)serialize
+Same as read() and write() above, working on a block of memory. */
+
+int deserialize(const std::uint8_t* data, std::size_t size, const std::string& basePath, Patch& p);
+std::vector<std::uint8_t> serialize(const Patch& p);
+}}}} // giada::m::patch::binary::
+
+
+#endif
@@ -89,6 +89,21 @@ void processPlugins_(const std::vector<ID>& pluginIds, juce::MidiBuffer& events)
 }
 
 
+/* findPlugin_
+Returns the plug-in with ID 'id', or nullptr if it no longer exists. */
+
+Plugin* findPlugin_(ID id)
+{
+	for (Plugin* p : model::plugins)
+		if (p->id == id)
+			return p;
+	return nullptr;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 ID clonePlugin_(ID pluginId)
 {
 	model::PluginsLock l(model::plugins);
@@ -156,6 +171,35 @@ void processStack(AudioBuffer& outBuf, const std::vector<ID>& pluginIds,
 /* -------------------------------------------------------------------------- */
 
 
+void automate(ID channelId, Frame f)
+{
+	model::ActionsLock al(model::actions);
+	model::PluginsLock pl(model::plugins);
+
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+
+	timeline.forEachLane(channelId, [&](const ActionTimeline::Lane& lane)
+	{
+		if (lane.pluginId == -1) // Volume envelope, not a plug-in one
+			return;
+
+		Plugin* p = findPlugin_(lane.pluginId);
+		if (p == nullptr || !p->valid || lane.pluginParam >= p->getNumParameters())
+			return;
+
+		/* Skip unchanged values: setting a parameter might be expensive on
+		the plug-in side. */
+
+		float value = timeline.getLaneValue(lane, f);
+		if (p->getParameter(lane.pluginParam) != value)
+			p->setParameter(lane.pluginParam, value);
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void addPlugin(std::unique_ptr<Plugin> p, ID channelId)
 {
 	ID pluginId = p->id;
@@ -60,6 +60,13 @@ Applies the fx list to the buffer. */
 void processStack(AudioBuffer& outBuf, const std::vector<ID>& pluginIds, 
 	juce::MidiBuffer* events=nullptr);
 
+/* automate
+Sets the plug-in parameters of channel 'channelId' to the values of their 
+envelopes at frame 'f'. Called by the audio thread once per block, right before
+processing the plug-in stack. */
+
+void automate(ID channelId, Frame f);
+
 /* swapPlugin 
 Swaps plug-in with ID 1 with plug-in with ID 2 in Channel 'channelId'. */
 
@@ -25,18 +25,23 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <ctime>
+#include <string>
+#include "utils/fs.h"
 #include "gui/dispatcher.h"
 #include "core/model/model.h"
 #include "core/types.h"
 #include "core/clock.h"
 #include "core/kernelAudio.h"
 #include "core/conf.h"
+#include "core/const.h"
 #include "core/mixer.h"
 #include "core/sequencer.h"
 #include "core/mixerHandler.h"
 #include "core/midiDispatcher.h"
 #include "core/recorder.h"
 #include "core/recorderHandler.h"
+#include "core/takeWriter.h"
 #include "core/recManager.h"
 
 
@@ -46,6 +51,15 @@ namespace recManager
 {
 namespace
 {
+/* takePath_
+File the current free take is written to, if any. */
+
+std::string takePath_;
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void setRecordingAction_(bool v)
 {
 	model::onSwap(model::recorder, [&](model::Recorder& r)
@@ -81,6 +95,66 @@ bool startActionRec_()
 /* -------------------------------------------------------------------------- */
 
 
+/* makeTakePath_
+Returns a new file path in directory 'dir', named after the current date and
+time. Takes are kept across sessions by the Waves loaded from them, so a name is
+never reused. */
+
+std::string makeTakePath_(const std::string& dir)
+{
+	std::time_t now = std::time(nullptr);
+	char stamp[32];
+	std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+
+	std::string base = dir + G_SLASH + "TAKE-" + stamp;
+	std::string path = base + ".wav";
+	for (int i = 1; u::fs::fileExists(path); i++)
+		path = base + "-" + std::to_string(i) + ".wav";
+	return path;
+}
+
+
+/* openTake_
+Starts streaming input to disk, if free input recording is enabled: the take 
+can then grow longer than the loop. */
+
+void openTake_()
+{
+	if (!conf::conf.freeInputRec)
+		return;
+
+	std::string dir = u::fs::getHomePath() + G_SLASH + G_TAKES_DIR;
+	if (!u::fs::dirExists(dir) && !u::fs::mkdir(dir))
+		return;
+
+	std::string path = makeTakePath_(dir);
+	if (takeWriter::open(path, G_MAX_IO_CHANS, conf::conf.samplerate))
+		takePath_ = path;
+}
+
+
+/* closeTake_
+Stops streaming input to disk. Returns the path of the take if it's longer than
+the loop, i.e. worth keeping. Shorter takes are deleted. */
+
+std::string closeTake_()
+{
+	if (takePath_.empty())
+		return "";
+
+	std::string path = takePath_;
+	takePath_.clear();
+
+	if (takeWriter::close() > clock::getFramesInLoop())
+		return path;
+	u::fs::remove(path);
+	return "";
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 bool startInputRec_()
 {
 	if (!kernelAudio::isReady() || !mh::hasInputRecordableChannels())
@@ -187,8 +261,12 @@ bool startInputRec(RecTriggerMode mode)
 {
 	if (mode == RecTriggerMode::NORMAL) {
 G_DEBUG("Start input rec, NORMAL mode");
-		if (!startInputRec_())
+		mixer::prepareInputRec(clock::getFramesInLoop());
+		openTake_();
+		if (!startInputRec_()) {
+			closeTake_();
 			return false;
+		}
 		setRecordingInput_(true);
 		return true;
 	}
@@ -196,6 +274,8 @@ G_DEBUG("Start input rec, NORMAL mode");
 G_DEBUG("Start input rec, SIGNAL mode");
 		if (!mh::hasInputRecordableChannels())
 			return false;
+		mixer::prepareInputRec(clock::getFramesInLoop());
+		openTake_();
 		clock::setStatus(ClockStatus::WAITING);
 		clock::rewind();
 		mixer::setSignalCallback(startInputRec_);
@@ -213,6 +293,8 @@ void stopInputRec()
 	setRecordingInput_(false);
 
 	mixer::stopInputRec();
+
+	std::string takePath = closeTake_();
 	
 	/* If you stop the Input Recorder in SIGNAL mode before any actual 
 	recording: just clean up everything and return. */
@@ -220,9 +302,10 @@ void stopInputRec()
 	if (clock::getStatus() == ClockStatus::WAITING) {
 		clock::setStatus(ClockStatus::STOPPED);
 		mixer::setSignalCallback(nullptr);
+		mixer::collectInputRec();
 	}
 	else
-		mh::finalizeInputRec();
+		mh::finalizeInputRec(takePath);
 }
 
 
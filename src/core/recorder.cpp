@@ -26,11 +26,15 @@
 
 
 #include <memory>
+#include <map>
+#include <iterator>
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include "utils/log.h"
 #include "core/model/model.h"
 #include "core/action.h"
+#include "core/const.h"
 #include "core/idManager.h"
 #include "core/recorder.h"
 
@@ -47,26 +51,11 @@ IdManager actionId_;
 /* -------------------------------------------------------------------------- */
 
 
-Action* findAction_(ActionMap& src, ID id)
+std::size_t findAction_(const ActionTimeline& src, ID id)
 {
-	for (auto& [frame, actions] : src)
-		for (Action& a : actions)
-			if (a.id == id)
-				return &a;
-	assert(false);
-	return nullptr;	
-}
-
-
-/* -------------------------------------------------------------------------- */
-
-/* optimize
-Removes frames without actions. */
-
-void optimize_(ActionMap& map)
-{
-	for (auto it = map.cbegin(); it != map.cend();)
-		it->second.size() == 0 ? it = map.erase(it) : ++it;
+	std::size_t i = src.find(id);
+	assert(i != ActionTimeline::npos);
+	return i;
 }
 
 
@@ -77,30 +66,29 @@ void removeIf_(std::function<bool(const Action&)> f)
 {
 	model::onSwap(model::actions, [&](model::Actions& a)
 	{
-		for (auto& [frame, actions] : a.map)
-			actions.erase(std::remove_if(actions.begin(), actions.end(), f), actions.end());
-		optimize_(a.map);
-		updateMapPointers(a.map);
+		a.timeline.removeIf(f);
 	});
 }
 
+
 /* -------------------------------------------------------------------------- */
 
 
-bool exists_(ID channelId, Frame frame, const MidiEvent& event, const ActionMap& target)
+bool exists_(ID channelId, Frame frame, const MidiEvent& event, ID pluginId, 
+	int pluginParam)
 {
-	for (const auto& [_, actions] : target)
-		for (const Action& a : actions) 
-			if (a.channelId == channelId && a.frame == frame && a.event.getRaw() == event.getRaw())
-				return true;
-	return false;	
+	model::ActionsLock lock(model::actions);
+	return model::actions.get()->timeline.contains(channelId, frame, event, pluginId, pluginParam);
 }
 
 
-bool exists_(ID channelId, Frame frame, const MidiEvent& event)
+/* -------------------------------------------------------------------------- */
+
+
+bool isEnvelope_(const Action& a, ID channelId, ID pluginId, int pluginParam)
 {
-	model::ActionsLock lock(model::actions);
-	return exists_(channelId, frame, event, model::actions.get()->map);
+	return a.channelId == channelId && a.event.getStatus() == MidiEvent::ENVELOPE &&
+	       a.pluginId == pluginId && a.pluginParam == pluginParam;
 }
 } // {anonymous}
 
@@ -124,7 +112,7 @@ void clearAll()
 {
 	model::onSwap(model::actions, [&](model::Actions& a)
 	{
-		a.map.clear();
+		a.timeline.clear();
 	});
 }
 
@@ -150,6 +138,21 @@ void clearActions(ID channelId, int type)
 }
 
 
+void clearEnvelope(ID channelId, ID pluginId, int pluginParam)
+{
+	removeIf_([=](const Action& a)
+	{ 
+		return isEnvelope_(a, channelId, pluginId, pluginParam);
+	});
+}
+
+
+void clearPluginActions(ID pluginId)
+{
+	removeIf_([=](const Action& a) { return a.pluginId == pluginId; });
+}
+
+
 /* -------------------------------------------------------------------------- */
 
 
@@ -170,33 +173,10 @@ void deleteAction(ID currId, ID nextId)
 
 void updateKeyFrames(std::function<Frame(Frame old)> f)
 {
-	std::unique_ptr<model::Actions> ma = model::actions.clone();
-	
-	/* Remove all existing actions: let's start from scratch. 
-	TODO - so why cloning it?! */
-
-	ma->map.clear();
-
-	/* Copy all existing actions in local data by cloning them, with just a
-	difference: they have a new frame value. */
-
+	model::onSwap(model::actions, [&](model::Actions& a)
 	{
-		model::ActionsLock lock(model::actions);
-
-		for (const auto& [oldFrame, actions] : model::actions.get()->map) {
-			Frame newFrame = f(oldFrame);
-			for (const Action& a : actions) {
-				Action copy = a;
-				copy.frame = newFrame;
-				ma->map[newFrame].push_back(copy);
-			}
-G_DEBUG(oldFrame << " -> " << newFrame);
-		}
-	}
-
-	updateMapPointers(ma->map);
-
-	model::actions.swap(std::move(ma));
+		a.timeline.setFrames(f);
+	});
 }
 
 
@@ -207,7 +187,7 @@ void updateEvent(ID id, MidiEvent e)
 {
 	model::onSwap(model::actions, [&](model::Actions& a)
 	{
-		findAction_(a.map, id)->event = e;
+		a.timeline.setEvent(findAction_(a.timeline, id), e);
 	});
 }
 
@@ -219,23 +199,7 @@ void updateSiblings(ID id, ID prevId, ID nextId)
 {
 	model::onSwap(model::actions, [&](model::Actions& a)
 	{
-		Action* pcurr = findAction_(a.map, id);
-		Action* pprev = findAction_(a.map, prevId);
-		Action* pnext = findAction_(a.map, nextId);
-
-		pcurr->prev   = pprev;
-		pcurr->prevId = pprev->id;
-		pcurr->next   = pnext;
-		pcurr->nextId = pnext->id;
-
-		if (pprev != nullptr) {
-			pprev->next   = pcurr;
-			pprev->nextId = pcurr->id;
-		}
-		if (pnext != nullptr) {
-			pnext->prev   = pcurr;
-			pnext->prevId = pcurr->id;
-		}
+		a.timeline.setSiblings(findAction_(a.timeline, id), prevId, nextId);
 	});
 }
 
@@ -247,20 +211,40 @@ bool hasActions(ID channelId, int type)
 {
 	model::ActionsLock lock(model::actions);
 	
-	for (const auto& [frame, actions] : model::actions.get()->map)
-		for (const Action& a : actions)
-			if (a.channelId == channelId && (type == 0 || type == a.event.getStatus()))
-				return true;
-	return false;
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+
+	if (type == 0)
+		return timeline.countOnChannel(channelId) > 0;
+
+	bool found = false;
+	timeline.forEachOnChannel(channelId, [&](std::size_t i)
+	{
+		found = found || timeline.getEvent(i).getStatus() == type;
+	});
+	return found;
+}
+
+
+bool hasEnvelope(ID channelId, ID pluginId, int pluginParam)
+{
+	model::ActionsLock lock(model::actions);
+	
+	bool found = false;
+	model::actions.get()->timeline.forEachLane(channelId, [&](const ActionTimeline::Lane& lane)
+	{
+		found = found || (lane.pluginId == pluginId && lane.pluginParam == pluginParam);
+	});
+	return found;
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-Action makeAction(ID id, ID channelId, Frame frame, MidiEvent e)
+Action makeAction(ID id, ID channelId, Frame frame, MidiEvent e, ID pluginId,
+	int pluginParam)
 {
-	Action out {actionId_.get(id), channelId, frame, e, -1, -1};
+	Action out {actionId_.get(id), channelId, frame, e, pluginId, pluginParam};
 	actionId_.set(id);
 	return out;
 }
@@ -269,30 +253,27 @@ Action makeAction(ID id, ID channelId, Frame frame, MidiEvent e)
 Action makeAction(const patch::Action& a)
 {
 	actionId_.set(a.id);
-	return Action {a.id, a.channelId, a.frame, a.event, -1, -1, a.prevId,
-		a.nextId};
+	return Action {a.id, a.channelId, a.frame, a.event, a.pluginId, 
+		a.pluginParam, a.prevId, a.nextId};
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-Action rec(ID channelId, Frame frame, MidiEvent event)
+Action rec(ID channelId, Frame frame, MidiEvent event, ID pluginId, 
+	int pluginParam)
 {
 	/* Skip duplicates. */
 
-	if (exists_(channelId, frame, event))
+	if (exists_(channelId, frame, event, pluginId, pluginParam))
 		return {};
 
-	Action a = makeAction(0, channelId, frame, event);
-	
-	/* If key frame doesn't exist yet, the [] operator in std::map is smart 
-	enough to insert a new item first. No plug-in data for now. */
+	Action a = makeAction(0, channelId, frame, event, pluginId, pluginParam);
 
 	model::onSwap(model::actions, [&](model::Actions& mas)
 	{
-		mas.map[frame].push_back(a);
-		updateMapPointers(mas.map);
+		mas.timeline.insert(a);
 	});
 
 	return a;
@@ -309,10 +290,7 @@ void rec(std::vector<Action>& actions)
 
 	model::onSwap(model::actions, [&](model::Actions& mas)
 	{
-		for (const Action& a : actions)
-			if (!exists_(a.channelId, a.frame, a.event, mas.map))
-				mas.map[a.frame].push_back(a);
-		updateMapPointers(mas.map);
+		mas.timeline.insert(actions, /*skipDuplicates=*/true);
 	});
 }
 
@@ -322,17 +300,78 @@ void rec(std::vector<Action>& actions)
 
 void rec(ID channelId, Frame f1, Frame f2, MidiEvent e1, MidiEvent e2)
 {
+	Action a1 = makeAction(0, channelId, f1, e1);
+	Action a2 = makeAction(0, channelId, f2, e2);
+	a1.nextId = a2.id;
+	a2.prevId = a1.id;
+
+	model::onSwap(model::actions, [&](model::Actions& mas)
+	{
+		mas.timeline.insert({a1, a2});
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void recEnvelope(ID channelId, ID pluginId, int pluginParam, 
+	const std::vector<std::pair<Frame, int>>& points, Frame framesInLoop)
+{
+	if (points.empty() || framesInLoop <= 0)
+		return;
+
+	/* Incoming points by frame: the latest one on a frame wins. */
+
+	std::map<Frame, int> values;
+	for (const auto& [frame, value] : points)
+		if (frame >= 0 && frame < framesInLoop)
+			values[frame] = value;
+	if (values.empty())
+		return;
+
 	model::onSwap(model::actions, [&](model::Actions& mas)
 	{
-		mas.map[f1].push_back(makeAction(0, channelId, f1, e1));
-		mas.map[f2].push_back(makeAction(0, channelId, f2, e2));
+		ActionTimeline& timeline = mas.timeline;
+
+		/* Existing points of the envelope, sorted by frame. */
+
+		std::map<Frame, ID> lane;
+		timeline.forEach([&](std::size_t i)
+		{
+			if (isEnvelope_(timeline.get(i), channelId, pluginId, pluginParam))
+				lane[timeline.getFrame(i)] = timeline.getId(i);
+		});
+
+		/* First points ever? Add actions at boundaries. Volume starts at full
+		scale, a plug-in parameter at the value of the first point. */
+
+		if (lane.empty()) {
+			int boundary = pluginId == -1 ? G_MAX_VELOCITY : points.front().second;
+			values.emplace(0, boundary);
+			values.emplace(framesInLoop - 1, boundary);
+		}
 
-		Action* a1 = findAction_(mas.map, mas.map[f1].back().id);
-		Action* a2 = findAction_(mas.map, mas.map[f2].back().id);
-		a1->nextId = a2->id;
-		a2->prevId = a1->id;
+		std::vector<Action> added;
+		for (const auto& [frame, value] : values) {
+			MidiEvent e = MidiEvent(MidiEvent::ENVELOPE, 0, value);
+			if (auto it = lane.find(frame); it != lane.end())
+				timeline.setEvent(findAction_(timeline, it->second), e);
+			else {
+				added.push_back(makeAction(0, channelId, frame, e, pluginId, pluginParam));
+				lane[frame] = added.back().id;
+			}
+		}
+		timeline.insert(added);
 
-		updateMapPointers(mas.map);
+		/* Link the whole envelope again in a circular loop, as new points might
+		sit anywhere in between the existing ones. */
+
+		for (auto it = lane.begin(); it != lane.end(); ++it) {
+			auto prev = it == lane.begin() ? std::prev(lane.end()) : std::prev(it);
+			auto next = std::next(it) == lane.end() ? lane.begin() : std::next(it);
+			timeline.setSiblings(findAction_(timeline, it->second), prev->second, next->second);
+		}
 	});
 }
 
@@ -340,13 +379,14 @@ void rec(ID channelId, Frame f1, Frame f2, MidiEvent e1, MidiEvent e2)
 /* -------------------------------------------------------------------------- */
 
 
-const std::vector<Action>* getActionsOnFrame(Frame frame)
+Action getAction(ID id)
 {
 	model::ActionsLock lock(model::actions);
-	
-	if (model::actions.get()->map.count(frame) == 0)
-		return nullptr;
-	return &model::actions.get()->map.at(frame);
+
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+	std::size_t           i        = timeline.find(id);
+
+	return i != ActionTimeline::npos ? timeline.get(i) : Action{};
 }
 
 
@@ -355,13 +395,35 @@ const std::vector<Action>* getActionsOnFrame(Frame frame)
 
 Action getClosestAction(ID channelId, Frame f, int type)
 {
+	model::ActionsLock lock(model::actions);
+
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+
+	Action out = {};
+	timeline.forEachOnChannel(channelId, [&](std::size_t i)
+	{
+		if (timeline.getEvent(i).getStatus() != type)
+			return;
+		if (!out.isValid() || (timeline.getFrame(i) <= f && timeline.getFrame(i) > out.frame))
+			out = timeline.get(i);
+	});
+	return out;
+}
+
+
+Action getClosestEnvelopeAction(ID channelId, Frame f, ID pluginId, int pluginParam)
+{
+	model::ActionsLock lock(model::actions);
+
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+
 	Action out = {};
-	forEachAction([&](const Action& a)
+	timeline.forEachOnChannel(channelId, [&](std::size_t i)
 	{
-		if (a.event.getStatus() != type || a.channelId != channelId)
+		if (!isEnvelope_(timeline.get(i), channelId, pluginId, pluginParam))
 			return;
-		if (!out.isValid() || (a.frame <= f && a.frame > out.frame))
-			out = a;
+		if (!out.isValid() || (timeline.getFrame(i) <= f && timeline.getFrame(i) > out.frame))
+			out = timeline.get(i);
 	});
 	return out;
 }
@@ -372,29 +434,55 @@ Action getClosestAction(ID channelId, Frame f, int type)
 
 std::vector<Action> getActionsOnChannel(ID channelId)
 {
+	model::ActionsLock lock(model::actions);
+
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+
 	std::vector<Action> out;
-	forEachAction([&](const Action& a)
+	out.reserve(timeline.countOnChannel(channelId));
+	timeline.forEachOnChannel(channelId, [&](std::size_t i)
 	{
-		if (a.channelId == channelId)
-			out.push_back(a);
+		out.push_back(timeline.get(i));
 	});
 	return out;
 }
 
 
-/* -------------------------------------------------------------------------- */
+std::vector<Action> getActionsOnChannel(ID channelId, Frame a, Frame b)
+{
+	model::ActionsLock lock(model::actions);
 
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+	const Frame           span     = timeline.getMaxSpan(channelId);
+	const Frame           min      = std::numeric_limits<Frame>::min();
+	const Frame           max      = std::numeric_limits<Frame>::max();
 
-void updateMapPointers(ActionMap& src)
-{
-	for (auto& kv : src) {
-		for (Action& action : kv.second) {
-			if (action.nextId != 0)
-				action.next = findAction_(src, action.nextId);
-			if (action.prevId != 0)
-				action.prev = findAction_(src, action.prevId);
-		}
-	}
+	/* Actions outside [a, b) linked to the other side of it are at most 'span'
+	frames away from the range edges: look for them there only. */
+
+	const Frame before = a > min + span ? a - span : min;
+	const Frame after  = b < max - span ? b + span : max;
+
+	std::vector<Action> out;
+
+	timeline.forEachOnChannel(channelId, before, a, [&](std::size_t i)
+	{
+		std::size_t next = timeline.getNext(i);
+		if (next != ActionTimeline::npos && timeline.getFrame(next) >= a)
+			out.push_back(timeline.get(i));
+	});
+	timeline.forEachOnChannel(channelId, a, b, [&](std::size_t i)
+	{
+		out.push_back(timeline.get(i));
+	});
+	timeline.forEachOnChannel(channelId, b, after, [&](std::size_t i)
+	{
+		std::size_t prev = timeline.getPrev(i);
+		if (prev != ActionTimeline::npos && timeline.getFrame(prev) < b)
+			out.push_back(timeline.get(i));
+	});
+
+	return out;
 }
 
 
@@ -405,9 +493,8 @@ void forEachAction(std::function<void(const Action&)> f)
 {
 	model::ActionsLock lock(model::actions);
 	
-	for (auto& [_, actions] : model::actions.get()->map)
-		for (const Action& action : actions)
-			f(action);
+	const ActionTimeline& timeline = model::actions.get()->timeline;
+	timeline.forEach([&](std::size_t i) { f(timeline.get(i)); });
 }
 
 
@@ -29,12 +29,13 @@
 #define G_RECORDER_H
 
 
-#include <map>
 #include <vector>
+#include <utility>
 #include <functional>
 #include <memory>
 #include "core/types.h"
 #include "core/action.h"
+#include "core/actionTimeline.h"
 #include "core/patch.h"
 #include "core/midiEvent.h"
 
@@ -44,8 +45,6 @@ namespace m
 {
 namespace recorder
 {
-using ActionMap = std::map<Frame, std::vector<Action>>;
-
 /* init
 Initializes the recorder: everything starts from here. */
 
@@ -66,6 +65,17 @@ Clears the actions by type from a channel. */
 
 void clearActions(ID channelId, int type);
 
+/* clearEnvelope
+Clears the envelope of a plug-in parameter from a channel. Volume envelope if
+pluginId == -1. */
+
+void clearEnvelope(ID channelId, ID pluginId=-1, int pluginParam=-1);
+
+/* clearPluginActions
+Clears all the actions bound to a plug-in, e.g. when the plug-in is removed. */
+
+void clearPluginActions(ID pluginId);
+
 /* deleteAction (1)
 Deletes a specific action. */
 
@@ -98,20 +108,30 @@ Checks if the channel has at least one action recorded. */
 
 bool hasActions(ID channelId, int type=0);
 
+/* hasEnvelope
+Checks if the channel has an envelope for a plug-in parameter (or for volume,
+if pluginId == -1). */
+
+bool hasEnvelope(ID channelId, ID pluginId=-1, int pluginParam=-1);
+
 /* makeAction
 Makes a new action given some data. */
 
-Action makeAction(ID id, ID channelId, Frame frame, MidiEvent e);
+Action makeAction(ID id, ID channelId, Frame frame, MidiEvent e, ID pluginId=-1,
+	int pluginParam=-1);
 Action makeAction(const patch::Action& a);
 
 /* rec (1)
-Records an action and returns it. Used by the Action Editor. */
+Records an action and returns it. Used by the Action Editor. Plug-in parameter
+automation goes through 'pluginId' and 'pluginParam'. */
 
-Action rec(ID channelId, Frame frame, MidiEvent e);
+Action rec(ID channelId, Frame frame, MidiEvent e, ID pluginId=-1, 
+	int pluginParam=-1);
 
 /* rec (2)
-Transfer a vector of actions into the current ActionMap. This is called by 
-recordHandler when a live session is over and consolidation is required. */
+Transfer a vector of actions into the current ActionTimeline. This is called by 
+recordHandler when a live session is over and consolidation is required. 
+Duplicates are skipped. */
 
 void rec(std::vector<Action>& actions);
 
@@ -121,35 +141,51 @@ actions in the Action Editor. */
 
 void rec(ID channelId, Frame f1, Frame f2, MidiEvent e1, MidiEvent e2);
 
+/* recEnvelope
+Merges a batch of (frame, value) points into the envelope of a plug-in 
+parameter (or volume, if pluginId == -1) in one go. A new envelope gets its
+boundary points at frame 0 and 'framesInLoop' - 1, as in the Action Editor. A
+point on a frame already taken replaces its value. Points past the loop are 
+discarded. Used by recorderHandler to consolidate live automation. */
+
+void recEnvelope(ID channelId, ID pluginId, int pluginParam, 
+	const std::vector<std::pair<Frame, int>>& points, Frame framesInLoop);
+
 /* forEachAction
 Applies a read-only callback on each action recorded. NEVER do anything inside 
-the callback that might alter the ActionMap. */
+the callback that might alter the ActionTimeline. */
 
 void forEachAction(std::function<void(const Action&)> f);
 
-/* getActionsOnFrame
-Returns a pointer to a vector of actions recorded on frame 'f', or nullptr if
-the frame has no actions. */
+/* getAction
+Returns a copy of the action with ID 'id', or an invalid action if not found. 
+Used to follow the prevId/nextId links of an action. */
 
-const std::vector<Action>* getActionsOnFrame(Frame f);
+Action getAction(ID id);
 
 /* getActionsOnChannel
 Returns a vector of actions belonging to channel 'ch'. */
 
 std::vector<Action> getActionsOnChannel(ID channelId);
 
+/* getActionsOnChannel (2)
+Returns actions belonging to channel 'ch' in frames [a, b), plus the ones 
+outside the range linked to the other side of it (e.g. a long note crossing 
+the range edges, or the envelope points next to the range). */
+
+std::vector<Action> getActionsOnChannel(ID channelId, Frame a, Frame b);
+
 /* getClosestAction
 Given a frame 'f' returns the closest action. */
 
 Action getClosestAction(ID channelId, Frame f, int type);
 
-/* updateMapPointers
-Updates all prev/next actions pointers into the action map. This is required
-after an action has been recorded, since pushing back new actions in a Action 
-vector makes it reallocating the existing ones. Also needed in model::Data copy
-constructor. */
+/* getClosestEnvelopeAction
+Same as above, for the envelope of a plug-in parameter (or volume, if 
+pluginId == -1). */
 
-void updateMapPointers(ActionMap& src); 
+Action getClosestEnvelopeAction(ID channelId, Frame f, ID pluginId=-1, 
+	int pluginParam=-1);
 
 /* getNewActionId
 Returns a new action ID, internally generated. */
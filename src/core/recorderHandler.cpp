@@ -26,6 +26,9 @@
 
 
 #include <unordered_map>
+#include <map>
+#include <tuple>
+#include <array>
 #include <algorithm>
 #include <cmath>
 #include <cassert>
@@ -36,7 +39,9 @@
 #include "action.h"
 #include "clock.h"
 #include "const.h"
+#include "conf.h"
 #include "patch.h"
+#include "stagingQueue.h"
 #include "recorderHandler.h"
 
 
@@ -46,23 +51,38 @@ namespace recorderHandler
 {
 namespace
 {
-constexpr int MAX_LIVE_RECS_CHUNK = 128;
+/* PRODUCERS_
+Threads allowed to call liveRec(). Channels record actions while rendering on
+the audio thread, plug-in parameter changes come from the UI or from MIDI 
+learn. */
 
-std::vector<Action> recs_; 
+constexpr std::array<Thread, 3> PRODUCERS_ = { Thread::MAIN, Thread::MIDI, Thread::AUDIO };
+
+/* liveRecs_
+Live actions waiting for consolidation, one queue per thread indexed by Thread. */
+
+constexpr std::size_t THREADS_ = static_cast<std::size_t>(Thread::AUDIO) + 1;
+
+std::array<StagingQueue<Action>, THREADS_> liveRecs_;
+
+static_assert(static_cast<std::size_t>(Thread::MAIN) < THREADS_ && 
+              static_cast<std::size_t>(Thread::MIDI) < THREADS_);
 
 
 /* -------------------------------------------------------------------------- */
 
 
-const Action* getActionPtrById_(int id, const recorder::ActionMap& source)
+StagingQueue<Action>& getLiveRecs_(Thread t)
 {
-	for (const auto& [_, actions] : source)
-		for (const Action& action : actions)
-			if (action.id == id)
-				return &action;
-	return nullptr;
+	assert(static_cast<std::size_t>(t) < THREADS_);
+	return liveRecs_[static_cast<std::size_t>(t)];
 }
 
+/* recs_
+Live actions drained from liveRecs_, being consolidated. Main thread only. */
+
+std::vector<Action> recs_; 
+
 
 /* -------------------------------------------------------------------------- */
 
@@ -124,7 +144,8 @@ void consolidate_()
 
 void init()
 {
-	recs_.reserve(MAX_LIVE_RECS_CHUNK);
+	for (Thread t : PRODUCERS_)
+		getLiveRecs_(t).alloc(conf::conf.liveRecActions);
 }
 
 
@@ -133,9 +154,11 @@ void init()
 
 bool isBoundaryEnvelopeAction(const Action& a)
 {
-	assert(a.prev != nullptr);
-	assert(a.next != nullptr);
-	return a.prev->frame > a.frame || a.next->frame < a.frame;
+	const Action prev = recorder::getAction(a.prevId);
+	const Action next = recorder::getAction(a.nextId);
+	assert(prev.isValid());
+	assert(next.isValid());
+	return prev.frame > a.frame || next.frame < a.frame;
 }
 
 
@@ -178,7 +201,8 @@ void updateSamplerate(int systemRate, int patchRate)
 /* -------------------------------------------------------------------------- */
 
 
-bool cloneActions(ID channelId, ID newChannelId)
+bool cloneActions(ID channelId, ID newChannelId, 
+	const std::unordered_map<ID, ID>& newPluginIds)
 {
 	bool cloned = false;
 	std::vector<Action> actions;
@@ -196,6 +220,8 @@ bool cloneActions(ID channelId, ID newChannelId)
 		Action clone(a);
 		clone.id        = newActionId;
 		clone.channelId = newChannelId;
+		if (auto it = newPluginIds.find(a.pluginId); it != newPluginIds.end())
+			clone.pluginId = it->second;
 
 		actions.push_back(clone);
 		cloned = true;
@@ -217,15 +243,15 @@ bool cloneActions(ID channelId, ID newChannelId)
 /* -------------------------------------------------------------------------- */
 
 
-void liveRec(ID channelId, MidiEvent e, Frame globalFrame)
+void liveRec(ID channelId, MidiEvent e, Frame globalFrame, Thread t, 
+	ID pluginId, int pluginParam)
 {
-	assert(e.isNoteOnOff()); // Can't record any other kind of events for now
+	assert(e.isNoteOnOff() || e.getStatus() == MidiEvent::ENVELOPE);
 
-	/* TODO - this might allocate on the MIDI thread */
-	if (recs_.size() >= recs_.capacity())
-		recs_.reserve(recs_.size() + MAX_LIVE_RECS_CHUNK);
-	
-	recs_.push_back(recorder::makeAction(recorder::getNewActionId(), channelId, globalFrame, e));
+	assert(getLiveRecs_(t).capacity() > 0); // Not a producer thread, see PRODUCERS_
+
+	getLiveRecs_(t).push(recorder::makeAction(recorder::getNewActionId(), 
+		channelId, globalFrame, e, pluginId, pluginParam));
 }
 
 
@@ -234,13 +260,42 @@ void liveRec(ID channelId, MidiEvent e, Frame globalFrame)
 
 std::unordered_set<ID> consolidate()
 {
-	consolidate_();
-	recorder::rec(recs_);
+	/* Drain each producer's queue in turn: notes always come from the audio 
+	thread, so NOTE_ON/NOTE_OFF pairs are kept in recording order. */
+
+	for (Thread t : PRODUCERS_) {
+		StagingQueue<Action>& q = getLiveRecs_(t);
+		Action a;
+		while (q.pop(a))
+			recs_.push_back(a);
+		if (std::size_t dropped = q.takeDropped(); dropped > 0)
+			u::log::print("[recorderHandler::consolidate] live recording buffer full, %d actions lost\n", 
+				static_cast<int>(dropped));
+	}
 
 	std::unordered_set<ID> out;
 	for (const Action& action : recs_)
 		out.insert(action.channelId);
 
+	/* Envelope points are merged lane by lane, as they must be linked to the
+	existing points of the same envelope. */
+
+	std::map<std::tuple<ID, ID, int>, std::vector<std::pair<Frame, int>>> lanes;
+	for (const Action& a : recs_)
+		if (a.event.getStatus() == MidiEvent::ENVELOPE)
+			lanes[{a.channelId, a.pluginId, a.pluginParam}].push_back({a.frame, a.event.getVelocity()});
+	for (const auto& [lane, points] : lanes)
+		recorder::recEnvelope(std::get<0>(lane), std::get<1>(lane), std::get<2>(lane),
+			points, clock::getFramesInLoop());
+
+	recs_.erase(std::remove_if(recs_.begin(), recs_.end(), [](const Action& a)
+	{
+		return a.event.getStatus() == MidiEvent::ENVELOPE;
+	}), recs_.end());
+
+	consolidate_();
+	recorder::rec(recs_);
+
 	recs_.clear();
 	return out;
 }
@@ -265,34 +320,18 @@ void clearAllActions()
 /* -------------------------------------------------------------------------- */
 
 
-recorder::ActionMap deserializeActions(const std::vector<patch::Action>& pactions)
+ActionTimeline deserializeActions(const std::vector<patch::Action>& pactions)
 {
-	recorder::ActionMap out;
-
-	/* First pass: add actions with no relationship, that is with no prev/next
-	pointers filled in. */
+	/* Actions are inserted in one go: the timeline sorts them and links 
+	siblings by their prev/next IDs. */
 
+	std::vector<Action> actions;
+	actions.reserve(pactions.size());
 	for (const patch::Action& paction : pactions)
-		out[paction.frame].push_back(recorder::makeAction(paction));
-
-	/* Second pass: fill in previous and next actions, if any. Is this the
-	fastest/smartest way to do it? Maybe not. Optimizations are welcome. */
-
-	for (const patch::Action& paction : pactions) {
-		if (paction.nextId == 0 && paction.prevId == 0) 
-			continue;
-		Action* curr = const_cast<Action*>(getActionPtrById_(paction.id, out));
-		assert(curr != nullptr);
-		if (paction.nextId != 0) {
-			curr->next = getActionPtrById_(paction.nextId, out);
-			assert(curr->next != nullptr);
-		}
-		if (paction.prevId != 0) {
-			curr->prev = getActionPtrById_(paction.prevId, out);
-			assert(curr->prev != nullptr);
-		}
-	}
+		actions.push_back(recorder::makeAction(paction));
 
+	ActionTimeline out;
+	out.insert(actions);
 	return out;
 }
 
@@ -300,21 +339,24 @@ recorder::ActionMap deserializeActions(const std::vector<patch::Action>& paction
 /* -------------------------------------------------------------------------- */
 
 
-std::vector<patch::Action> serializeActions(const recorder::ActionMap& actions)
+std::vector<patch::Action> serializeActions(const ActionTimeline& actions)
 {
 	std::vector<patch::Action> out;
-	for (const auto& kv : actions) {
-		for (const Action& a : kv.second) {
-			out.push_back({
-				a.id,
-				a.channelId,
-				a.frame,
-				a.event.getRaw(),
-				a.prevId,
-				a.nextId,
-			});
-		}
-	}
+	out.reserve(actions.size());
+	actions.forEach([&](std::size_t i)
+	{
+		const Action a = actions.get(i);
+		out.push_back({
+			a.id,
+			a.channelId,
+			a.frame,
+			a.event.getRaw(),
+			a.prevId,
+			a.nextId,
+			a.pluginId,
+			a.pluginParam,
+		});
+	});
 	return out;	
 }
 
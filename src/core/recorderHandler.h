@@ -29,7 +29,9 @@
 #define G_RECORDER_HANDLER_H
 
 
+#include <unordered_map>
 #include <unordered_set>
+#include "types.h"
 #include "midiEvent.h"
 
 
@@ -41,6 +43,7 @@ namespace patch
 struct Action;
 }
 struct Action;
+class ActionTimeline;
 namespace recorderHandler
 {
 void init();
@@ -60,19 +63,25 @@ mandatory. */
 void updateSamplerate(int systemRate, int patchRate);
 
 /* cloneActions
-Clones actions in channel 'channelId', giving them a new channel ID. Returns
-whether any action has been cloned. */
+Clones actions in channel 'channelId', giving them a new channel ID. Plug-in
+automation follows the cloned plug-ins: 'newPluginIds' maps the old plug-in 
+IDs to the new ones. Returns whether any action has been cloned. */
 
-bool cloneActions(ID channelId, ID newChannelId);
+bool cloneActions(ID channelId, ID newChannelId, 
+	const std::unordered_map<ID, ID>& newPluginIds={});
 
 /* liveRec
-Records a user-generated action. NOTE_ON or NOTE_OFF only for now. */
+Records a user-generated action: NOTE_ON or NOTE_OFF, or ENVELOPE for plug-in
+parameter automation through 'pluginId' and 'pluginParam'. Lock-free and 
+allocation-free: the action waits in a fixed-size queue of thread 't' until the
+next consolidate() call. Actions beyond conf::liveRecActions are lost. */
 
-void liveRec(ID channelId, MidiEvent e, Frame global);
+void liveRec(ID channelId, MidiEvent e, Frame global, Thread t, ID pluginId=-1,
+	int pluginParam=-1);
 
 /* consolidate
 Records all live actions. Returns a set of channels IDs that have been 
-recorded. */
+recorded. Main thread only. */
 
 std::unordered_set<ID> consolidate();
 
@@ -84,8 +93,8 @@ void clearAllActions();
 /* (de)serializeActions
 Creates new Actions given the patch raw data and vice versa. */
 
-recorder::ActionMap deserializeActions(const std::vector<patch::Action>& as);
-std::vector<patch::Action> serializeActions(const recorder::ActionMap& as);
+ActionTimeline deserializeActions(const std::vector<patch::Action>& as);
+std::vector<patch::Action> serializeActions(const ActionTimeline& as);
 }}} // giada::m::recorderHandler::
 
 
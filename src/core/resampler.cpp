@@ -0,0 +1,304 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define G_RESAMPLER_SSE
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define G_RESAMPLER_NEON
+#endif
+#include "core/const.h"
+#include "resampler.h"
+
+
+namespace giada {
+namespace m
+{
+static_assert(G_MAX_IO_CHANS == 2, "Resampler works on stereo frames only");
+
+
+/* Kernel
+Polyphase table: 'phases' + 1 rows of 'taps' coefficients. Row 'p' holds the 
+kernel for a read position p / phases frames past the current input frame. 
+The extra row closes the last interpolation interval. */
+
+struct Resampler::Kernel
+{
+	int                taps;
+	int                phases;
+	std::vector<float> coefs;
+};
+
+
+namespace
+{
+constexpr double PI_ = 3.14159265358979323846;
+
+
+/* -------------------------------------------------------------------------- */
+
+/* besselI0_
+Modified Bessel function of the first kind, order zero. Needed by the Kaiser
+window. */
+
+double besselI0_(double x)
+{
+	double sum  = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum  += term;
+	}
+	return sum;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+double cubic_(double x)
+{
+	x = std::abs(x);
+	if (x <= 1.0) return  1.5 * x*x*x - 2.5 * x*x + 1.0;
+	if (x <  2.0) return -0.5 * x*x*x + 2.5 * x*x - 4.0 * x + 2.0;
+	return 0.0;
+}
+
+
+/* windowedSinc_
+Low-pass kernel with 'cutoff' relative to the Nyquist frequency, windowed by a
+Kaiser window of half length 'half'. */
+
+double windowedSinc_(double x, double cutoff, double half, double beta)
+{
+	double r = x / half;
+	if (r <= -1.0 || r >= 1.0)
+		return 0.0;
+	double sinc   = x == 0.0 ? 1.0 : std::sin(PI_ * cutoff * x) / (PI_ * cutoff * x);
+	double window = besselI0_(beta * std::sqrt(1.0 - r * r)) / besselI0_(beta);
+	return cutoff * sinc * window;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* makeKernel_
+Samples 'f' into a polyphase table. Each row is normalized to unity gain, so 
+that DC passes through untouched. */
+
+Resampler::Kernel makeKernel_(int taps, int phases, std::function<double(double)> f)
+{
+	Resampler::Kernel k{taps, phases, std::vector<float>((phases + 1) * taps)};
+
+	int history = taps / 2 - 1;
+	for (int p = 0; p <= phases; p++) {
+		double phase = p / static_cast<double>(phases);
+		double sum   = 0.0;
+		std::vector<double> row(taps);
+		for (int t = 0; t < taps; t++) {
+			row[t] = f(t - history - phase);
+			sum   += row[t];
+		}
+		for (int t = 0; t < taps; t++)
+			k.coefs[p * taps + t] = static_cast<float>(row[t] / sum);
+	}
+	return k;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getKernel_
+Returns the kernel for quality 'q'. Tables are built on first use: make sure 
+that happens outside the audio thread (e.g. when a Resampler is created). */
+
+const Resampler::Kernel& getKernel_(ResamplerQuality q)
+{
+	static const std::array<Resampler::Kernel, 4> kernels = {
+		makeKernel_(2,  1,   [](double x) { return std::max(0.0, 1.0 - std::abs(x)); }),
+		makeKernel_(4,  256, [](double x) { return cubic_(x); }),
+		makeKernel_(16, 256, [](double x) { return windowedSinc_(x, 0.90, 8.0, 7.0); }),
+		makeKernel_(64, 256, [](double x) { return windowedSinc_(x, 0.96, 32.0, 9.0); })
+	};
+	return kernels.at(static_cast<int>(q));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* dot_
+Computes one output frame: the dot product between 'taps' input frames 'in' 
+and kernel row 'c0', interpolated towards the next row 'c1' by 't'. */
+
+void dot_(const float* in, const float* c0, const float* c1, float t, int taps, 
+	float* out)
+{
+#if defined(G_RESAMPLER_SSE)
+
+	if (taps % 4 == 0) {
+		__m128 vt   = _mm_set1_ps(t);
+		__m128 acc0 = _mm_setzero_ps();
+		__m128 acc1 = _mm_setzero_ps();
+		for (int k = 0; k < taps; k += 4) {
+			__m128 a = _mm_loadu_ps(c0 + k);
+			__m128 c = _mm_add_ps(a, _mm_mul_ps(vt, _mm_sub_ps(_mm_loadu_ps(c1 + k), a)));
+			/* Coefficients are per frame, input is interleaved L/R: spread each 
+			coefficient over both channels. */
+			acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_unpacklo_ps(c, c), _mm_loadu_ps(in + k * 2)));
+			acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_unpackhi_ps(c, c), _mm_loadu_ps(in + k * 2 + 4)));
+		}
+		__m128 acc = _mm_add_ps(acc0, acc1);         // L0 R0 L1 R1
+		acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc)); // L  R  .  .
+		_mm_storel_pi(reinterpret_cast<__m64*>(out), acc);
+		return;
+	}
+
+#elif defined(G_RESAMPLER_NEON)
+
+	if (taps % 4 == 0) {
+		float32x4_t acc0 = vdupq_n_f32(0.0f);
+		float32x4_t acc1 = vdupq_n_f32(0.0f);
+		for (int k = 0; k < taps; k += 4) {
+			float32x4_t   a = vld1q_f32(c0 + k);
+			float32x4_t   c = vmlaq_n_f32(a, vsubq_f32(vld1q_f32(c1 + k), a), t);
+			float32x4x2_t z = vzipq_f32(c, c);
+			acc0 = vmlaq_f32(acc0, z.val[0], vld1q_f32(in + k * 2));
+			acc1 = vmlaq_f32(acc1, z.val[1], vld1q_f32(in + k * 2 + 4));
+		}
+		float32x4_t acc = vaddq_f32(acc0, acc1);
+		vst1_f32(out, vadd_f32(vget_low_f32(acc), vget_high_f32(acc)));
+		return;
+	}
+
+#endif
+
+	float l = 0.0f;
+	float r = 0.0f;
+	for (int k = 0; k < taps; k++) {
+		float c = c0[k] + t * (c1[k] - c0[k]);
+		l += c * in[k * 2];
+		r += c * in[k * 2 + 1];
+	}
+	out[0] = l;
+	out[1] = r;
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+Resampler::Resampler(ResamplerQuality q)
+: m_kernel  (&getKernel_(q))
+, m_quality (q)
+, m_fraction(0.0)
+{
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+ResamplerQuality Resampler::getQuality() const { return m_quality; }
+int Resampler::getTaps() const                 { return m_kernel->taps; }
+int Resampler::getHistory() const              { return m_kernel->taps / 2 - 1; }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame Resampler::countOutputFrames(Frame frames, float step) const
+{
+	assert(step > 0.0f);
+
+	if (m_fraction >= frames)
+		return 0;
+	Frame out = static_cast<Frame>(std::ceil((frames - m_fraction) / step));
+	while (out > 0 && m_fraction + (out - 1) * static_cast<double>(step) >= frames)
+		out--;
+	return out;
+}
+
+
+Frame Resampler::countInputFrames(Frame frames, float step) const
+{
+	if (frames <= 0)
+		return 0;
+	return static_cast<Frame>(m_fraction + (frames - 1) * static_cast<double>(step)) + 1;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame Resampler::process(const float* in, float* out, Frame frames, float step)
+{
+	const int    taps   = m_kernel->taps;
+	const int    phases = m_kernel->phases;
+	const float* coefs  = m_kernel->coefs.data();
+
+	double pos = m_fraction;
+	for (Frame i = 0; i < frames; i++, pos += step) {
+		Frame  frame = static_cast<Frame>(pos);
+		double phase = (pos - frame) * phases;
+		int    row   = static_cast<int>(phase);
+
+		const float* c0 = coefs + row * taps;
+		dot_(in + frame * G_MAX_IO_CHANS, c0, c0 + taps, 
+			static_cast<float>(phase - row), taps, out + i * G_MAX_IO_CHANS);
+	}
+
+	Frame used = static_cast<Frame>(pos);
+	m_fraction = pos - used;
+	return used;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void Resampler::setQuality(ResamplerQuality q)
+{
+	m_kernel  = &getKernel_(q);
+	m_quality = q;
+}
+
+
+void Resampler::reset()
+{
+	m_fraction = 0.0;
+}
+}} // giada::m::
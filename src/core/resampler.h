@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_RESAMPLER_H
+#define G_RESAMPLER_H
+
+
+#include "core/types.h"
+
+
+namespace giada {
+namespace m
+{
+/* Resampler
+Real-time polyphase resampler for interleaved stereo audio. Each output frame
+is computed as a dot product between the input frames around the read position
+and a precomputed kernel phase, interpolated between the two nearest phases.
+Quality tiers differ in the kernel length:
+
+	LINEAR  - 2 taps, linear interpolation;
+	CUBIC   - 4 taps, Catmull-Rom spline;
+	SINC_16 - 16 taps, Kaiser-windowed sinc;
+	SINC_64 - 64 taps, Kaiser-windowed sinc.
+
+Kernels are designed for the input rate: when reading faster than 1:1 (pitch
+up) content above the new Nyquist frequency still folds back, although far 
+less than with plain interpolation. */
+
+class Resampler
+{
+public:
+
+	/* MAX_TAPS
+	Kernel length of the highest quality tier. */
+
+	static constexpr int MAX_TAPS = 64;
+
+	Resampler(ResamplerQuality q=ResamplerQuality::LINEAR);
+
+	ResamplerQuality getQuality() const;
+
+	/* getTaps
+	Returns how many input frames are read to compute one output frame. */
+
+	int getTaps() const;
+
+	/* getHistory
+	Returns how many input frames before the read position are read by the 
+	kernel. The input passed to process() must start that many frames before 
+	the first frame to read. */
+
+	int getHistory() const;
+
+	/* countOutputFrames
+	Returns how many output frames can be generated at 'step' before the read
+	position goes past 'frames' input frames. */
+
+	Frame countOutputFrames(Frame frames, float step) const;
+
+	/* countInputFrames
+	Returns the input frames spanned by 'frames' output frames at 'step'. The
+	actual input passed to process() must be getTaps() - 1 frames longer. */
+
+	Frame countInputFrames(Frame frames, float step) const;
+
+	/* process
+	Generates 'frames' output frames into 'out', reading 'in' by 'step' input
+	frames per output frame. Returns the number of whole input frames consumed:
+	the fractional part is kept for the next call. */
+
+	Frame process(const float* in, float* out, Frame frames, float step);
+
+	void setQuality(ResamplerQuality q);
+
+	/* reset
+	Drops the fractional read position. */
+
+	void reset();
+
+	struct Kernel;
+
+private:
+
+	const Kernel*    m_kernel;
+	ResamplerQuality m_quality;
+	double           m_fraction;
+};
+}} // giada::m::
+
+
+#endif
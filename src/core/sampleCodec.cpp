@@ -0,0 +1,271 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define G_SAMPLE_CODEC_SSE
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define G_SAMPLE_CODEC_NEON
+#endif
+#include "sampleCodec.h"
+
+
+namespace giada {
+namespace m {
+namespace sampleCodec
+{
+namespace
+{
+constexpr float INT16_SCALE = 32767.0f;
+
+/* HALF_MAGIC
+2^112: rescales a half-float exponent, shifted into a float, to the float 
+exponent range. Denormal halves end up as normal floats for free. */
+
+constexpr std::uint32_t HALF_MAGIC = (254 - 15) << 23;
+
+
+/* -------------------------------------------------------------------------- */
+
+
+float fromBits_(std::uint32_t u)
+{
+	float f;
+	std::memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+
+std::uint32_t toBits_(float f)
+{
+	std::uint32_t u;
+	std::memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* floatToHalf_
+Float to half-float conversion, rounding to nearest even. */
+
+std::uint16_t floatToHalf_(float f)
+{
+	std::uint32_t x    = toBits_(f);
+	std::uint32_t sign = x & 0x80000000u;
+	std::uint16_t o;
+
+	x ^= sign;
+
+	if (x >= 0x47800000u)      // Too large for half: infinity, or NaN
+		o = x > 0x7f800000u ? 0x7e00 : 0x7c00;
+	else 
+	if (x < 0x38800000u) {     // Denormal half or zero: let the FPU round it
+		std::uint32_t magic = ((127 - 15) + (23 - 10) + 1) << 23;
+		o = static_cast<std::uint16_t>(toBits_(fromBits_(x) + fromBits_(magic)) - magic);
+	}
+	else {                     // Normal half: rebias exponent, round mantissa
+		std::uint32_t odd = (x >> 13) & 1;
+		x += 0xc8000fffu;      // ((15 - 127) << 23) + 0xfff
+		x += odd;
+		o = static_cast<std::uint16_t>(x >> 13);
+	}
+	return o | static_cast<std::uint16_t>(sign >> 16);
+}
+
+
+/* halfToFloat_
+Scalar version of the half-float decoder. */
+
+float halfToFloat_(std::uint16_t h)
+{
+	std::uint32_t expmant = h & 0x7fffu;
+	std::uint32_t u = toBits_(fromBits_(expmant << 13) * fromBits_(HALF_MAGIC));
+	if (expmant >= 0x7c00u)    // Infinity or NaN
+		u |= 255u << 23;
+	return fromBits_(u | (static_cast<std::uint32_t>(h & 0x8000u) << 16));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void encodeInt16_(const float* in, std::uint16_t* out, std::size_t count)
+{
+	std::size_t i = 0;
+
+#if defined(G_SAMPLE_CODEC_SSE)
+
+	const __m128 lo    = _mm_set1_ps(-1.0f);
+	const __m128 hi    = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(INT16_SCALE);
+	for (; i + 8 <= count; i += 8) {
+		__m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi), scale);
+		__m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi), scale);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), 
+			_mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+	}
+
+#endif
+
+	for (; i < count; i++) {
+		float v = std::max(-1.0f, std::min(in[i], 1.0f));
+		out[i] = static_cast<std::uint16_t>(static_cast<std::int16_t>(std::lrint(v * INT16_SCALE)));
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void decodeInt16_(const std::uint16_t* in, float* out, std::size_t count)
+{
+	const float scale = 1.0f / INT16_SCALE;
+	std::size_t i = 0;
+
+#if defined(G_SAMPLE_CODEC_SSE)
+
+	const __m128 vscale = _mm_set1_ps(scale);
+	for (; i + 8 <= count; i += 8) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		/* Sign-extend to 32 bit: place each sample in the upper half, then 
+		shift it back down arithmetically. */
+		__m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+		__m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+		_mm_storeu_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(a), vscale));
+		_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(b), vscale));
+	}
+
+#elif defined(G_SAMPLE_CODEC_NEON)
+
+	for (; i + 8 <= count; i += 8) {
+		int16x8_t x = vreinterpretq_s16_u16(vld1q_u16(in + i));
+		vst1q_f32(out + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+		vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+	}
+
+#endif
+
+	for (; i < count; i++)
+		out[i] = static_cast<std::int16_t>(in[i]) * scale;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void decodeHalf_(const std::uint16_t* in, float* out, std::size_t count)
+{
+	std::size_t i = 0;
+
+#if defined(G_SAMPLE_CODEC_SSE)
+
+	/* Same steps as halfToFloat_(), four samples at a time. F16C would do this
+	in a single instruction, but it is not part of the x86-64 baseline. */
+
+	const __m128i maskNoSign = _mm_set1_epi32(0x7fff);
+	const __m128i wasInfNan  = _mm_set1_epi32(0x7bff);
+	const __m128i expInfNan  = _mm_set1_epi32(255 << 23);
+	const __m128  magic      = _mm_castsi128_ps(_mm_set1_epi32(HALF_MAGIC));
+	const __m128i zero       = _mm_setzero_si128();
+
+	auto convert = [&](__m128i h)
+	{
+		__m128i expmant = _mm_and_si128(maskNoSign, h);
+		__m128i sign    = _mm_slli_epi32(_mm_xor_si128(h, expmant), 16);
+		__m128  scaled  = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)), magic);
+		__m128i infNan  = _mm_and_si128(_mm_cmpgt_epi32(expmant, wasInfNan), expInfNan);
+		return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNan)));
+	};
+
+	for (; i + 8 <= count; i += 8) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		_mm_storeu_ps(out + i,     convert(_mm_unpacklo_epi16(x, zero)));
+		_mm_storeu_ps(out + i + 4, convert(_mm_unpackhi_epi16(x, zero)));
+	}
+
+#elif defined(G_SAMPLE_CODEC_NEON) && defined(__aarch64__)
+
+	for (; i + 8 <= count; i += 8) {
+		float16x8_t x = vreinterpretq_f16_u16(vld1q_u16(in + i));
+		vst1q_f32(out + i,     vcvt_f32_f16(vget_low_f16(x)));
+		vst1q_f32(out + i + 4, vcvt_high_f32_f16(x));
+	}
+
+#endif
+
+	for (; i < count; i++)
+		out[i] = halfToFloat_(in[i]);
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t getBytes(SampleStorage s)
+{
+	return s == SampleStorage::FLOAT ? sizeof(float) : sizeof(std::uint16_t);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void encode(const float* in, std::uint16_t* out, std::size_t count, SampleStorage s)
+{
+	assert(s != SampleStorage::FLOAT);
+
+	if (s == SampleStorage::INT16)
+		encodeInt16_(in, out, count);
+	else
+		for (std::size_t i = 0; i < count; i++)
+			out[i] = floatToHalf_(in[i]);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void decode(const std::uint16_t* in, float* out, std::size_t count, SampleStorage s)
+{
+	assert(s != SampleStorage::FLOAT);
+
+	if (s == SampleStorage::INT16)
+		decodeInt16_(in, out, count);
+	else
+		decodeHalf_(in, out, count);
+}
+}}} // giada::m::sampleCodec::
@@ -0,0 +1,61 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_SAMPLE_CODEC_H
+#define G_SAMPLE_CODEC_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include "core/types.h"
+
+
+namespace giada {
+namespace m {
+namespace sampleCodec
+{
+/* getBytes
+Returns the size, in bytes, of a single sample stored in format 's'. */
+
+std::size_t getBytes(SampleStorage s);
+
+/* encode
+Converts 'count' float samples from 'in' to the 16-bit format 's' (INT16 or 
+HALF). Values outside [-1.0, 1.0] are clipped when converting to INT16. */
+
+void encode(const float* in, std::uint16_t* out, std::size_t count, SampleStorage s);
+
+/* decode
+Converts 'count' 16-bit samples in format 's' from 'in' back to float. Safe to
+call from the audio thread: vectorized where the CPU allows it. */
+
+void decode(const std::uint16_t* in, float* out, std::size_t count, SampleStorage s);
+}}} // giada::m::sampleCodec::
+
+
+#endif
@@ -180,7 +180,7 @@ void init()
 /* -------------------------------------------------------------------------- */
 
 
-void run(Frame bufferSize)
+Range<Frame> run(Frame bufferSize)
 {
 	Frame start = clock::getCurrentFrame();
 	Frame end   = start + bufferSize;
@@ -196,14 +196,14 @@ void run(Frame bufferSize)
 		else
 		if (global % bar == 0)
 			mixer::pumpEvent({ mixer::EventType::SEQUENCER_BAR, local, { 0, 0, global, {} } });
-
-		const std::vector<Action>* as = recorder::getActionsOnFrame(global);
-		if (as != nullptr)
-			for (const Action& a : *as)
-				mixer::pumpEvent({ mixer::EventType::ACTION, local, a });
 	}
 
+	/* The quantizer might rewind the clock: return the block as it was when
+	started. */
+
 	quantizer_.advance(Range<Frame>(start, end), clock::getQuantizerStep());
+
+	return Range<Frame>(start, end);
 }
 
 
@@ -30,6 +30,7 @@
 
 
 #include "core/mixer.h"
+#include "core/range.h"
 
 
 namespace giada {
@@ -40,11 +41,13 @@ namespace sequencer
 {
 void init();
 
-/* parse
-Parses sequencer events that might occur in a block and advances the internal 
-quantizer. */
+/* run
+Pumps the sequencer events (first beat, bars) that occur in the next 
+'bufferSize' frames and advances the internal quantizer. Returns the frames of
+the block, not wrapped around the loop: channels read their own actions in 
+there. */
 
-void run(Frame bufferSize);
+Range<Frame> run(Frame bufferSize);
 void parse(const mixer::EventBuffer& events); 
 void advance(AudioBuffer& outBuf);
 
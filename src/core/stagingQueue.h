@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_STAGING_QUEUE_H
+#define G_STAGING_QUEUE_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+
+namespace giada {
+namespace m
+{
+/* StagingQueue
+Single producer, single consumer lock-free queue like Queue, with a capacity
+chosen at runtime. Memory is allocated in alloc() only: a producer on a
+realtime thread never allocates. Items pushed while the queue is full are
+dropped and counted, so that the consumer can report the loss. */
+
+template<typename T>
+class StagingQueue
+{
+public:
+
+	StagingQueue() : m_head(0), m_tail(0), m_dropped(0)
+	{
+	}
+
+
+	StagingQueue(const StagingQueue&) = delete;
+
+
+	/* alloc
+	Makes room for 'capacity' items and empties the queue. Not thread safe: 
+	call it while no one is pushing or popping. */
+
+	void alloc(std::size_t capacity)
+	{
+		m_data.assign(capacity + 1, T{});  // One slot always stays free
+		m_head.store(0);
+		m_tail.store(0);
+		m_dropped.store(0);
+	}
+
+
+	bool push(const T& item)
+	{
+		std::size_t curr = m_tail.load(std::memory_order_relaxed);
+		std::size_t next = increment(curr);
+
+		if (m_data.empty() || next == m_head.load(std::memory_order_acquire)) {
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		m_data[curr] = item;
+		m_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+
+	bool pop(T& item)
+	{
+		std::size_t curr = m_head.load(std::memory_order_relaxed);
+		if (curr == m_tail.load(std::memory_order_acquire))
+			return false;
+
+		item = m_data[curr];
+		m_head.store(increment(curr), std::memory_order_release);
+		return true;
+	}
+
+
+	/* takeDropped
+	Returns how many items have been dropped since the last call. */
+
+	std::size_t takeDropped()
+	{
+		return m_dropped.exchange(0);
+	}
+
+
+	std::size_t capacity() const
+	{
+		return m_data.empty() ? 0 : m_data.size() - 1;
+	}
+
+private:
+
+	std::size_t increment(std::size_t i) const
+	{
+		return m_data.empty() ? 0 : (i + 1) % m_data.size();
+	}
+
+
+	std::vector<T>           m_data;
+	std::atomic<std::size_t> m_head;
+	std::atomic<std::size_t> m_tail;
+	std::atomic<std::size_t> m_dropped;
+};
+}} // giada::m::
+
+
+#endif
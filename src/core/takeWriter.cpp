@@ -0,0 +1,227 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sndfile.h>
+#include "utils/log.h"
+#include "utils/fs.h"
+#include "core/audioBuffer.h"
+#include "core/takeWriter.h"
+
+
+namespace giada::m::takeWriter
+{
+namespace
+{
+/* BUFFER_SECONDS
+Seconds of audio the ring buffer below can hold while the background thread is
+busy writing. */
+
+constexpr int BUFFER_SECONDS = 4;
+
+/* POLL_INTERVAL
+How often the background thread looks for new audio. The audio thread never
+wakes it up: it would have to take a lock. */
+
+constexpr std::chrono::milliseconds POLL_INTERVAL(10);
+
+std::thread       worker_;
+std::atomic<bool> quit_(false);
+std::atomic<bool> open_(false);
+std::atomic<bool> pushing_(false);
+
+SNDFILE* file_     = nullptr;
+int      channels_ = 0;
+Frame    written_  = 0;
+
+/* ring_
+Single producer, single consumer ring buffer of interleaved samples. 'head_' 
+and 'tail_' count samples read and written since the take has been opened. */
+
+std::vector<float>       ring_;
+std::atomic<std::size_t> head_(0);
+std::atomic<std::size_t> tail_(0);
+std::atomic<std::size_t> dropped_(0);
+
+
+/* -------------------------------------------------------------------------- */
+
+/* drain_
+Writes to file all the audio pushed so far. Runs on the background thread. */
+
+void drain_()
+{
+	std::size_t head = head_.load(std::memory_order_relaxed);
+	std::size_t tail = tail_.load(std::memory_order_acquire);
+
+	while (head < tail) {
+		std::size_t pos   = head % ring_.size();
+		std::size_t count = std::min(tail - head, ring_.size() - pos);
+		Frame       frames = count / channels_;
+		if (sf_writef_float(file_, ring_.data() + pos, frames) != frames)
+			u::log::print("[takeWriter::drain_] warning: incomplete write!\n");
+		written_ += frames;
+		head     += count;
+		head_.store(head, std::memory_order_release);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void run_()
+{
+	while (!quit_.load()) {
+		drain_();
+		std::this_thread::sleep_for(POLL_INTERVAL);
+	}
+	drain_();
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+bool open(const std::string& path, int channels, int samplerate)
+{
+	close();
+
+	SF_INFO header;
+	header.samplerate = samplerate;
+	header.channels   = channels;
+	header.format     = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+	/* Replace any existing file instead of overwriting it: it might be a hard
+	link to a file in some project (see waveManager::persist()). */
+
+	u::fs::remove(path);
+
+	file_ = sf_open(path.c_str(), SFM_WRITE, &header);
+	if (file_ == nullptr) {
+		u::log::print("[takeWriter::open] unable to open %s for writing: %s\n",
+			path, sf_strerror(file_));
+		return false;
+	}
+
+	/* Buffer length is rounded to whole frames, so that a frame never wraps
+	around the end of the ring. */
+
+	ring_.assign(static_cast<std::size_t>(samplerate) * BUFFER_SECONDS * channels, 0.0f);
+	channels_ = channels;
+	written_  = 0;
+	head_.store(0);
+	tail_.store(0);
+	dropped_.store(0);
+	quit_.store(false);
+
+	worker_ = std::thread(run_);
+	open_.store(true);
+
+	u::log::print("[takeWriter::open] writing take to %s\n", path);
+	return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void push(const AudioBuffer& b, float gain)
+{
+	pushing_.store(true);
+
+	if (open_.load() && b.countChannels() == channels_) {
+		std::size_t count = b.countSamples();
+		std::size_t tail  = tail_.load(std::memory_order_relaxed);
+		std::size_t head  = head_.load(std::memory_order_acquire);
+
+		if (tail + count - head > ring_.size())
+			dropped_.fetch_add(b.countFrames(), std::memory_order_relaxed);
+		else {
+			const float* src = b[0];
+			for (std::size_t i = 0; i < count;) {
+				std::size_t pos   = (tail + i) % ring_.size();
+				std::size_t chunk = std::min(count - i, ring_.size() - pos);
+				std::transform(src + i, src + i + chunk, ring_.data() + pos, 
+					[gain](float s) { return s * gain; });
+				i += chunk;
+			}
+			tail_.store(tail + count, std::memory_order_release);
+		}
+	}
+
+	pushing_.store(false);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame close()
+{
+	if (!worker_.joinable())
+		return 0;
+
+	/* Wait for the audio thread to leave push(), if it is in there. */
+
+	open_.store(false);
+	while (pushing_.load())
+		std::this_thread::yield();
+
+	quit_.store(true);
+	worker_.join();
+
+	sf_close(file_);
+	file_ = nullptr;
+	ring_.clear();
+	ring_.shrink_to_fit();
+
+	if (std::size_t dropped = dropped_.load(); dropped > 0)
+		u::log::print("[takeWriter::close] warning: %d frames dropped!\n", 
+			static_cast<int>(dropped));
+	u::log::print("[takeWriter::close] take closed, %d frames written\n", written_);
+
+	return written_;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool isOpen()
+{
+	return open_.load();
+}
+} // giada::m::takeWriter::
@@ -0,0 +1,65 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+#ifndef G_TAKE_WRITER_H
+#define G_TAKE_WRITER_H
+
+
+#include <string>
+#include "core/types.h"
+
+
+namespace giada::m 
+{
+class AudioBuffer;
+namespace takeWriter
+{
+/* open
+Creates the audio file 'path' and starts a background thread that writes into
+it the audio pushed with push(). Any previous take is closed first. Returns 
+false if the file can't be created. */
+
+bool open(const std::string& path, int channels, int samplerate);
+
+/* push
+Queues buffer 'b' multiplied by 'gain' for writing. Meant to be called by the
+audio thread: it never blocks nor allocates. Audio is dropped if the background 
+thread can't keep up. Does nothing if no take is open. */
+
+void push(const AudioBuffer& b, float gain);
+
+/* close
+Writes any pending audio, stops the background thread and closes the file. 
+Returns the number of frames in the file. */
+
+Frame close();
+
+bool isOpen();
+}} // giada::m::takeWriter::
+
+
+#endif
@@ -0,0 +1,129 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "threadPool.h"
+
+
+namespace giada::m 
+{
+namespace
+{
+/* isWorker_
+True on threads spawned by a pool. Pools run from there (e.g. resampling a 
+Wave while loading many in parallel) stay on the calling thread: threads would
+multiply otherwise. */
+
+thread_local bool isWorker_ = false;
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+ThreadPool::ThreadPool(std::size_t maxThreads)
+: m_threads(std::max<std::size_t>(1, std::min<std::size_t>(maxThreads, 
+	std::thread::hardware_concurrency())))
+{
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void ThreadPool::run(std::size_t count, std::function<void(std::size_t)> job,
+	std::function<void(float)> progress) const
+{
+	if (count == 0)
+		return;
+
+	/* No need to spawn anything with a single worker, or from a worker of 
+	another pool: just run jobs in the calling thread. */
+
+	if (m_threads == 1 || count == 1 || isWorker_) {
+		for (std::size_t i = 0; i < count; i++) {
+			job(i);
+			if (progress != nullptr)
+				progress((i + 1) / static_cast<float>(count));
+		}
+		return;
+	}
+
+	std::atomic<std::size_t> next(0);
+	std::size_t              done = 0;
+	std::mutex               mutex;
+	std::condition_variable  cond;
+
+	auto worker = [&]()
+	{
+		isWorker_ = true;
+		for (std::size_t i = next++; i < count; i = next++) {
+			job(i);
+			std::lock_guard<std::mutex> lock(mutex);
+			done++;
+			cond.notify_one();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < std::min(m_threads, count); i++)
+		threads.emplace_back(worker);
+
+	/* Wait for jobs to complete. Progress is reported from here, outside the
+	lock, so that the callback can take its time without stalling workers. */
+
+	std::size_t reported = 0;
+	while (reported < count) {
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [&] { return done > reported; });
+		reported = done;
+		lock.unlock();
+		if (progress != nullptr)
+			progress(reported / static_cast<float>(count));
+	}
+
+	for (std::thread& t : threads)
+		t.join();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t ThreadPool::countThreads() const
+{
+	return m_threads;
+}
+} // giada::m::
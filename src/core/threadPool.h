@@ -0,0 +1,74 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_THREAD_POOL_H
+#define G_THREAD_POOL_H
+
+
+#include <cstddef>
+#include <functional>
+
+
+namespace giada::m 
+{
+/* ThreadPool
+Fork-join pool for heavy non-realtime work, such as decoding or processing
+audio files. Threads are spawned on each run() call and joined before it 
+returns. Pools nested in the job of another pool run their jobs serially, so 
+that the total number of threads stays bounded by the cores count. Never use it
+from the audio thread. */
+
+class ThreadPool
+{
+public:
+
+	/* ThreadPool
+	Creates a pool that will use at most 'maxThreads' threads, clamped to the 
+	number of available cores. */
+
+	ThreadPool(std::size_t maxThreads);
+
+	/* run
+	Calls 'job(i)' for each i in [0, count), spreading jobs across the workers.
+	Blocks until all jobs are done. The optional 'progress' callback is invoked
+	on the calling thread with a value in (0.0, 1.0] each time some job is 
+	completed, so it is safe to update the UI from there. Jobs must not throw.*/
+
+	void run(std::size_t count, std::function<void(std::size_t)> job,
+		std::function<void(float)> progress=nullptr) const;
+
+	std::size_t countThreads() const;
+
+private:
+
+	std::size_t m_threads;
+};
+} // giada::m::
+
+
+#endif
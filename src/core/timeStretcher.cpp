@@ -0,0 +1,171 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <cmath>
+#include "core/const.h"
+#include "timeStretcher.h"
+
+
+namespace giada {
+namespace m
+{
+namespace
+{
+constexpr Frame  OVERLAP_ = TimeStretcher::GRAIN - TimeStretcher::HOP;
+constexpr double PI_      = 3.14159265358979323846;
+
+
+/* -------------------------------------------------------------------------- */
+
+/* similarity_
+Normalized cross-correlation between 'target' and 'candidate', looking at one
+frame every 'stride'. */
+
+float similarity_(const float* target, const float* candidate, Frame stride)
+{
+	float corr   = 0.0f;
+	float energy = 0.0f;
+	for (Frame i = 0; i < OVERLAP_; i += stride) {
+		corr   += target[i] * candidate[i];
+		energy += candidate[i] * candidate[i];
+	}
+	return corr / std::sqrt(energy + 1e-9f);
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+TimeStretcher::TimeStretcher()
+: m_window       (GRAIN)
+, m_candidates   ((GRAIN + TOLERANCE * 2) * G_MAX_IO_CHANS)
+, m_target       (OVERLAP_ * G_MAX_IO_CHANS)
+, m_mixTarget    (OVERLAP_)
+, m_mixCandidates(OVERLAP_ + TOLERANCE * 2)
+, m_accumulator  (GRAIN * G_MAX_IO_CHANS)
+, m_output       (HOP * G_MAX_IO_CHANS)
+{
+	static_assert(G_MAX_IO_CHANS == 2, "TimeStretcher works on stereo frames only");
+
+	for (Frame i = 0; i < GRAIN; i++)
+		m_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI_ * i / GRAIN));
+
+	reset();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void TimeStretcher::reset()
+{
+	std::fill(m_accumulator.begin(), m_accumulator.end(), 0.0f);
+	m_ready    = HOP;
+	m_position = 0.0;
+	m_previous = 0;
+	m_started  = false;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void TimeStretcher::step(float stretch)
+{
+	Frame offset = m_started ? findBestOffset() : 0;
+
+	/* Overlap-add the windowed grain. The first grain after a reset has no 
+	previous one to overlap with: its first half goes through as is, instead of
+	fading in and softening the attack of the sound. */
+
+	const float* grain = m_candidates.data() + (TOLERANCE + offset) * G_MAX_IO_CHANS;
+	const Frame  flat  = m_started ? 0 : HOP;
+	for (Frame i = 0; i < GRAIN; i++) {
+		float w = i < flat ? 1.0f : m_window[i];
+		m_accumulator[i * 2]     += grain[i * 2]     * w;
+		m_accumulator[i * 2 + 1] += grain[i * 2 + 1] * w;
+	}
+
+	/* The first HOP frames are complete: move them to the output and make room
+	for the next grain. */
+
+	std::copy_n(m_accumulator.begin(), HOP * 2, m_output.begin());
+	std::copy(m_accumulator.begin() + HOP * 2, m_accumulator.end(), m_accumulator.begin());
+	std::fill(m_accumulator.end() - HOP * 2, m_accumulator.end(), 0.0f);
+	m_ready = 0;
+
+	m_previous  = static_cast<Frame>(m_position) + offset;
+	m_position += HOP / stretch;
+	m_started   = true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame TimeStretcher::findBestOffset()
+{
+	for (Frame i = 0; i < OVERLAP_; i++)
+		m_mixTarget[i] = m_target[i * 2] + m_target[i * 2 + 1];
+	for (Frame i = 0; i < OVERLAP_ + TOLERANCE * 2; i++)
+		m_mixCandidates[i] = m_candidates[i * 2] + m_candidates[i * 2 + 1];
+
+	const float* target     = m_mixTarget.data();
+	const float* candidates = m_mixCandidates.data() + TOLERANCE;
+
+	/* Coarse search on a subsampled signal first, then refine around the best
+	match. Keeps the cost per hop constant and low. */
+
+	constexpr Frame STRIDE = 4;
+
+	Frame best      = 0;
+	float bestScore = similarity_(target, candidates, STRIDE);
+	for (Frame k = -TOLERANCE; k <= TOLERANCE; k += STRIDE) {
+		float score = similarity_(target, candidates + k, STRIDE);
+		if (score > bestScore) {
+			bestScore = score;
+			best      = k;
+		}
+	}
+
+	Frame coarse = best;
+	bestScore    = similarity_(target, candidates + coarse, 1);
+	for (Frame k = std::max(-TOLERANCE, coarse - STRIDE + 1); k <= std::min(TOLERANCE, coarse + STRIDE - 1); k++) {
+		float score = similarity_(target, candidates + k, 1);
+		if (score > bestScore) {
+			bestScore = score;
+			best      = k;
+		}
+	}
+
+	return best;
+}
+}} // giada::m::
@@ -0,0 +1,161 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_TIME_STRETCHER_H
+#define G_TIME_STRETCHER_H
+
+
+#include <algorithm>
+#include <vector>
+#include "core/types.h"
+
+
+namespace giada {
+namespace m
+{
+/* TimeStretcher
+Streaming WSOLA (Waveform Similarity Overlap-Add) time-stretcher for 
+interleaved stereo audio. Changes the duration of the input without changing 
+its pitch. Grains of GRAIN frames are taken from the input every GRAIN/2 / 
+stretch frames, slightly moved (up to TOLERANCE frames) to best match the 
+natural continuation of the previous grain, and overlap-added every GRAIN/2 
+frames of output. All buffers are allocated on construction and the work per
+output frame is constant: safe to use in the audio thread. */
+
+class TimeStretcher
+{
+public:
+
+	static constexpr Frame GRAIN     = 1024;
+	static constexpr Frame HOP       = GRAIN / 2;
+	static constexpr Frame TOLERANCE = 256;
+
+	static constexpr float MIN_STRETCH = 0.25f;
+	static constexpr float MAX_STRETCH = 4.0f;
+
+	TimeStretcher();
+
+	/* process
+	Generates 'frames' output frames into 'out', stretching the input by 
+	'stretch' (> 1.0 slows down, < 1.0 speeds up). Input is fetched through 
+	'read', a callable void(Frame offset, Frame count, float* dest) that copies
+	'count' input frames starting 'offset' frames from the current read 
+	position (offset might be negative). Returns the number of whole input 
+	frames consumed: the next call starts from there. */
+
+	template <typename F>
+	Frame process(float* out, Frame frames, float stretch, F&& read)
+	{
+		stretch = std::clamp(stretch, MIN_STRETCH, MAX_STRETCH);
+
+		for (Frame i = 0; i < frames;) {
+			if (m_ready == HOP) {
+				Frame start = static_cast<Frame>(m_position) - TOLERANCE;
+				read(start, GRAIN + TOLERANCE * 2, m_candidates.data());
+				if (m_started)
+					read(m_previous + HOP, GRAIN - HOP, m_target.data());
+				step(stretch);
+			}
+			Frame count = std::min(frames - i, HOP - m_ready);
+			std::copy_n(m_output.data() + m_ready * 2, count * 2, out + i * 2);
+			m_ready += count;
+			i       += count;
+		}
+
+		Frame used = static_cast<Frame>(m_position);
+		m_position -= used;
+		m_previous -= used;
+		return used;
+	}
+
+	/* reset
+	Drops any pending audio and starts over from the current read position, with
+	no fade in. */
+
+	void reset();
+
+private:
+
+	/* step
+	Builds the next HOP frames of output from the candidate region and the 
+	target in m_candidates and m_target. */
+
+	void step(float stretch);
+
+	/* findBestOffset
+	Returns the offset in [-TOLERANCE, TOLERANCE] of the candidate grain most
+	similar to the target. */
+
+	Frame findBestOffset();
+
+	/* m_window
+	Hann window, GRAIN frames long. Overlapping by half, windows add up to 1. */
+
+	std::vector<float> m_window;
+
+	/* m_candidates
+	Input around the nominal position of the next grain: GRAIN + 2 * TOLERANCE
+	frames, starting TOLERANCE frames before it. */
+
+	std::vector<float> m_candidates;
+
+	/* m_target
+	Natural continuation of the previous grain, i.e. what the next grain should
+	look like where it overlaps the previous one. */
+
+	std::vector<float> m_target;
+
+	/* m_mixTarget, m_mixCandidates
+	Mono mix of m_target and m_candidates, used by the similarity search. */
+
+	std::vector<float> m_mixTarget;
+	std::vector<float> m_mixCandidates;
+
+	/* m_accumulator
+	Overlap-add buffer, GRAIN frames. */
+
+	std::vector<float> m_accumulator;
+
+	/* m_output, m_ready
+	Last HOP frames of output and how many of them have been consumed. */
+
+	std::vector<float> m_output;
+	Frame              m_ready;
+
+	/* m_position, m_previous
+	Nominal input position of the next grain and actual position of the last 
+	one, relative to the current read position. */
+
+	double m_position;
+	Frame  m_previous;
+	bool   m_started;
+};
+}} // giada::m::
+
+
+#endif
@@ -35,6 +35,9 @@ using ID    = int;
 using Pixel = int;
 using Frame = int;
 
+/* Thread
+Keep AUDIO last: per-thread tables are sized as AUDIO + 1. */
+
 enum class Thread { MAIN, MIDI, AUDIO };
 
 /* Windows fix */
@@ -47,7 +50,7 @@ enum class ChannelType : int { SAMPLE = 1, MIDI, MASTER, PREVIEW };
 
 enum class ChannelStatus : int
 {
-	ENDING = 1, WAIT, PLAY, OFF, EMPTY, MISSING, WRONG  
+	ENDING = 1, WAIT, PLAY, OFF, EMPTY, MISSING, WRONG, LOADING  
 };
 
 enum class SamplePlayerMode : int
@@ -56,6 +59,16 @@ enum class SamplePlayerMode : int
 	SINGLE_BASIC, SINGLE_PRESS, SINGLE_RETRIG, SINGLE_ENDLESS
 };
 
+enum class ResamplerQuality : int { LINEAR = 0, CUBIC, SINC_16, SINC_64 };
+
+enum class SampleStorage : int { FLOAT = 0, INT16, HALF };
+
+enum class SampleFileFormat : int { WAV_FLOAT = 0, WAV_ORIGINAL, FLAC };
+
+enum class PatchFormat : int { JSON = 0, BINARY };
+
+enum class VoiceStealing : int { OLDEST = 0, QUIETEST, NONE };
+
 enum class RecTriggerMode : int { NORMAL = 0, SIGNAL };
 
 enum class EventType : int { AUTO = 0, MANUAL };
@@ -39,6 +39,7 @@ namespace m
 {
 Wave::Wave(ID id)
 : id       (id),
+  m_data   (std::make_shared<WaveData>()),
   m_rate   (0),
   m_bits   (0),
   m_logical(false),
@@ -50,9 +51,15 @@ Wave::Wave(ID id)
 /* -------------------------------------------------------------------------- */
 
 
-float* Wave::operator [](int offset) const
+const float* Wave::operator [](int offset) const
 {
-	return buffer[offset];
+	return getFrame(offset);
+}
+
+
+float* Wave::operator [](int offset)
+{
+	return getFrame(offset);
 }
 
 
@@ -61,14 +68,14 @@ float* Wave::operator [](int offset) const
 
 Wave::Wave(const Wave& other)
 : id        (other.id), 
+  m_data    (other.m_data),
   m_rate    (other.m_rate),
   m_bits    (other.m_bits),	
   m_logical (false),
   m_edited  (false),
-  m_path    (other.m_path)
+  m_path    (other.m_path),
+  m_sourcePath(other.m_sourcePath)
 {
-	buffer.alloc(other.getSize(), other.getChannels());
-	buffer.copyData(other.getFrame(0), other.getSize());
 }
 
 
@@ -77,10 +84,11 @@ Wave::Wave(const Wave& other)
 
 void Wave::alloc(int size, int channels, int rate, int bits, const std::string& path)
 {
-	buffer.alloc(size, channels);
+	m_data = std::make_shared<WaveData>(size, channels);
 	m_rate = rate;
 	m_bits = bits;
 	m_path = path;
+	m_sourcePath.clear();
 }
 
 
@@ -97,12 +105,14 @@ std::string Wave::getBasename(bool ext) const
 
 
 int Wave::getRate() const { return m_rate; }
-int Wave::getChannels() const { return buffer.countChannels(); }
+int Wave::getChannels() const { return m_data->countChannels(); }
 std::string Wave::getPath() const { return m_path; }
-int Wave::getSize() const { return buffer.countFrames(); }
+int Wave::getSize() const { return m_data->countFrames(); }
 int Wave::getBits() const { return m_bits; }
 bool Wave::isLogical() const { return m_logical; }
 bool Wave::isEdited() const { return m_edited; }
+bool Wave::isDirty() const { return m_sourcePath.empty(); }
+std::string Wave::getSourcePath() const { return m_sourcePath; }
 
 
 /* -------------------------------------------------------------------------- */
@@ -110,7 +120,7 @@ bool Wave::isEdited() const { return m_edited; }
 
 int Wave::getDuration() const
 {
-	return buffer.countFrames() / m_rate;
+	return m_data->countFrames() / m_rate;
 }
 
 
@@ -126,18 +136,121 @@ std::string Wave::getExtension() const
 /* -------------------------------------------------------------------------- */
 
 
-float* Wave::getFrame(int f) const
+const float* Wave::getFrame(int f) const
+{
+	return (*m_data)[f];
+}
+
+
+float* Wave::getFrame(int f)
+{
+	return getWritableBlock(f).data;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveData::Block Wave::getBlock(int f) const
+{
+	return m_data->getBlock(f);
+}
+
+
+WaveData::WritableBlock Wave::getWritableBlock(int f)
+{
+	detach();
+	touch();
+	return m_data->getWritableBlock(f);
+}
+
+
+void Wave::touchData()
+{
+	detach();
+	m_data->touch();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+const WaveData& Wave::getData() const
+{
+	return *m_data;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool Wave::isSharingData(const Wave& other) const
+{
+	return m_data == other.m_data;
+}
+
+
+Wave::SharedData Wave::getSharedData() const
+{
+	return m_data;
+}
+
+
+void Wave::setSharedData(SharedData d)
+{
+	assert(d != nullptr);
+	m_data = d;
+	touch();
+}
+
+
+void Wave::setData(WaveData d)
+{
+	m_data = std::make_shared<WaveData>(std::move(d));
+	touch();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void Wave::setStorage(SampleStorage s)
 {
-	return buffer[f];
+	detach();
+	m_data->compact(s);
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-void Wave::setRate(int v)     { m_rate = v; }
+void Wave::detach()
+{
+	/* Only the piece table is copied here. Chunks are shared until written to, 
+	see WaveData::getWritableBlock(). */
+
+	if (m_data.use_count() > 1)
+		m_data = std::make_shared<WaveData>(*m_data);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void Wave::touch()
+{
+	m_sourcePath.clear();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void Wave::setRate(int v)     { m_rate = v; touch(); }
+void Wave::setBits(int v)     { m_bits = v; }
 void Wave::setLogical(bool l) { m_logical = l; }
 void Wave::setEdited(bool e)  { m_edited = e; }
+void Wave::setSourcePath(const std::string& p) { m_sourcePath = p; }
 
 
 /* -------------------------------------------------------------------------- */
@@ -157,19 +270,30 @@ void Wave::setPath(const std::string& p, int wid)
 
 void Wave::copyData(const float* data, int frames, int channels, int offset)
 {
-	buffer.copyData(data, frames, channels, offset);
+	detach();
+	touch();
+	m_data->copyData(data, frames, channels, offset);
 }
 
 
-void Wave::copyData(const AudioBuffer& b) { buffer.copyData(b); }
-void Wave::addData(const AudioBuffer& b)  { buffer.addData(b); }
+void Wave::copyData(const AudioBuffer& b) 
+{ 
+	copyData(b[0], b.countFrames(), b.countChannels()); 
+}
 
 
-/* -------------------------------------------------------------------------- */
+void Wave::addData(const AudioBuffer& b)  
+{ 
+	detach(); 
+	touch();
+	m_data->addData(b); 
+}
 
 
-void Wave::moveData(AudioBuffer& b)
-{
-	buffer.moveData(b);
+void Wave::addData(const WaveData& d)  
+{ 
+	detach(); 
+	touch();
+	m_data->addData(d); 
 }
 }} // giada::m::
@@ -30,26 +30,61 @@
 
 
 #include <string>
+#include <memory>
 #include "core/audioBuffer.h"
+#include "core/waveData.h"
 #include "core/types.h"
 
 
 namespace giada {
 namespace m 
 {
+/* Wave
+Audio data is shared among copies of the same Wave (and among Waves loaded from
+the same content, see waveManager) and duplicated only when written to, i.e. 
+copy-on-write. Non-const accessors give write access, so they make a private 
+copy of the data first if shared: read through a const Wave whenever possible.
+Data is stored in chunks (see WaveData), so only the touched ones get copied. */
+
 class Wave
 {
 public:
 
+	/* SharedData
+	Audio data, possibly shared among multiple Waves. */
+
+	using SharedData = std::shared_ptr<WaveData>;
+
 	Wave(ID id);
 	Wave(const Wave& other);
 
-	float* operator [](int offset) const;
+	const float* operator [](int offset) const;
+	float* operator [](int offset);
 
 	/* getFrame
-	Works like operator []. See AudioBuffer for reference. */
+	Works like operator []. Returns a pointer to frame 'f': only the frame itself
+	is guaranteed to be contiguous. Use getBlock() for bulk access. Float data
+	only: see WaveData::read(). */
 	
-	float* getFrame(int f) const;
+	const float* getFrame(int f) const;
+	float* getFrame(int f);
+
+	/* get[Writable]Block
+	Returns the contiguous block of data starting at frame 'f'. See WaveData. */
+
+	WaveData::Block getBlock(int f) const;
+	WaveData::WritableBlock getWritableBlock(int f);
+
+	/* touchData
+	Stamps audio data with a new revision, once done writing to it through 
+	getWritableBlock() or getFrame(). See WaveData::touch(). */
+
+	void touchData();
+
+	/* getData
+	Returns audio data for reading. */
+
+	const WaveData& getData() const;
 	
 	std::string getBasename(bool ext=false) const;
 	std::string getExtension() const;
@@ -62,6 +97,28 @@ public:
 	bool isLogical() const;
 	bool isEdited() const;
 
+	/* isDirty
+	True if audio data differs from the one in the source file, i.e. the file it
+	has been read from or last written to. Any write to audio data makes the Wave
+	dirty. Waves with no source file, such as takes, are always dirty. */
+
+	bool isDirty() const;
+
+	/* getSourcePath
+	Returns the path of the source file, or an empty string if dirty. */
+
+	std::string getSourcePath() const;
+
+	/* isSharingData
+	True if this Wave and 'other' point to the same audio data. */
+
+	bool isSharingData(const Wave& other) const;
+
+	/* getSharedData
+	Returns the audio data held by this Wave, for sharing it with other Waves. */
+
+	SharedData getSharedData() const;
+
 	/* setPath
 	Sets new path 'p'. If 'id' != -1 inserts a numeric id next to the file 
 	extension, e.g. : /path/to/sample-[id].wav */
@@ -69,13 +126,29 @@ public:
 	void setPath(const std::string& p, int id=-1);
 
 	void setRate(int v);
+	void setBits(int v);
 	void setLogical(bool l);
 	void setEdited(bool e);
 
-	/* moveData
-	Moves data held by 'b' into this buffer. Then 'b' becomes an empty buffer. */
+	/* setSourcePath
+	Marks audio data as equal to the one stored in file 'p'. */
+
+	void setSourcePath(const std::string& p);
+
+	/* setSharedData
+	Makes this Wave point to audio data 'd', without copying it. */
+
+	void setSharedData(SharedData d);
+
+	/* setData
+	Replaces audio data with 'd'. Cheap: see WaveData. */
 
-	void moveData(AudioBuffer& b); 
+	void setData(WaveData d);
+
+	/* setStorage
+	Converts audio data to storage format 's'. See WaveData::compact(). */
+
+	void setStorage(SampleStorage s);
 	
 	/* copyData
 	Copies 'frames' frames from the new 'data' into m_data, starting from frame 
@@ -85,9 +158,10 @@ public:
 	void copyData(const AudioBuffer& b);
 
 	/* addData
-	Merges audio data from buffer 'b' onto this one. */
+	Merges audio data from buffer 'b' or from 'd' onto this one. */
 
 	void addData(const AudioBuffer& b);
+	void addData(const WaveData& d);
 
 	void alloc(int size, int channels, int rate, int bits, const std::string& path);
 
@@ -95,12 +169,24 @@ public:
 
 private:
 
-	AudioBuffer buffer;
+	/* detach
+	Makes a private copy of the audio data, if shared with other Waves. Call it
+	before any write. */
+
+	void detach();
+
+	/* touch
+	Marks audio data as modified, i.e. not equal to the source file anymore. */
+
+	void touch();
+
+	SharedData m_data;
 	int m_rate;
 	int m_bits;
 	bool m_logical;     // memory only (a take)
 	bool m_edited;      // edited via editor
 	std::string m_path; // E.g. /path/to/my/sample.wav
+	std::string m_sourcePath; // File that holds the same audio data, if any
 };
 }} // giada::m::
 
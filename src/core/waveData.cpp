@@ -0,0 +1,584 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "core/sampleCodec.h"
+#include "core/waveData.h"
+
+
+namespace giada {
+namespace m
+{
+namespace
+{
+std::atomic<std::uint64_t> lastRevision_(0);
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+WaveData::WaveData()
+: m_size    (0)
+, m_channels(0)
+, m_revision(++lastRevision_)
+{
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveData::WaveData(Frame size, int channels)
+: m_size    (0)
+, m_channels(channels)
+, m_revision(0)
+{
+	for (Frame f = 0; f < size; f += CHUNK_SIZE) {
+		Frame frames = std::min(CHUNK_SIZE, size - f);
+		m_pieces.push_back({ std::make_shared<AudioBuffer>(frames, channels), nullptr, 0, frames });
+	}
+	rebuild();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+const float* WaveData::operator [](Frame f) const
+{
+	return getBlock(f).data;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame       WaveData::countFrames() const   { return m_size; }
+int         WaveData::countChannels() const { return m_channels; }
+std::size_t WaveData::countPieces() const   { return m_pieces.size(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveData::Block WaveData::getBlock(Frame f) const
+{
+	std::size_t  i = findPiece(f);
+	const Piece& p = m_pieces[i];
+	Frame        d = f - m_starts[i];
+
+	assert(p.chunk != nullptr);
+
+	return { (*p.chunk)[p.offset + d], p.frames - d };
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveData::WritableBlock WaveData::getWritableBlock(Frame f)
+{
+	std::size_t i = findPiece(f);
+	Piece&      p = m_pieces[i];
+	Frame       d = f - m_starts[i];
+
+	/* Compact chunk: decode the portion in use to a new float chunk. */
+
+	if (p.packed != nullptr) {
+		std::shared_ptr<AudioBuffer> chunk = std::make_shared<AudioBuffer>(p.frames, m_channels);
+		sampleCodec::decode(p.packed->data.data() + p.offset * m_channels, (*chunk)[0], 
+			p.frames * m_channels, p.packed->storage);
+		p.chunk  = chunk;
+		p.packed = nullptr;
+		p.offset = 0;
+	}
+
+	/* Chunk shared with other pieces, here or in other WaveData objects: make 
+	a private copy of the portion in use. */
+
+	else
+	if (p.chunk.use_count() > 1) {
+		std::shared_ptr<AudioBuffer> chunk = std::make_shared<AudioBuffer>(p.frames, m_channels);
+		chunk->copyData((*p.chunk)[p.offset], p.frames, m_channels);
+		p.chunk  = chunk;
+		p.offset = 0;
+	}
+
+	return { (*p.chunk)[p.offset + d], p.frames - d };
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::read(Frame first, Frame count, float* dest) const
+{
+	if (count == 0)
+		return;
+
+	assert(first >= 0 && first + count <= m_size);
+
+	for (std::size_t i = findPiece(first); count > 0; i++) {
+		const Piece& p = m_pieces[i];
+		Frame        d = std::max(first - m_starts[i], Frame(0));
+		Frame        n = std::min(p.frames - d, count);
+		std::size_t  samples = n * m_channels;
+
+		if (p.chunk != nullptr)
+			std::memcpy(dest, (*p.chunk)[p.offset + d], samples * sizeof(float));
+		else
+			sampleCodec::decode(p.packed->data.data() + (p.offset + d) * m_channels, 
+				dest, samples, p.packed->storage);
+
+		dest  += samples;
+		count -= n;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool WaveData::isCompact() const
+{
+	return std::any_of(m_pieces.begin(), m_pieces.end(), [](const Piece& p)
+	{
+		return p.packed != nullptr;
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::compact(SampleStorage s)
+{
+	/* Whole chunks are converted, so that piece offsets stay valid. Keep track
+	of converted chunks, as many pieces might point to the same one. */
+
+	std::unordered_map<const void*, Piece> converted;
+
+	for (Piece& p : m_pieces) {
+		SampleStorage current = p.packed != nullptr ? p.packed->storage : SampleStorage::FLOAT;
+		if (current == s)
+			continue;
+
+		const void* key = p.packed != nullptr ? static_cast<const void*>(p.packed.get()) : p.chunk.get();
+		auto        it  = converted.find(key);
+
+		if (it == converted.end()) {
+			/* Bring the chunk to float first, if compact. */
+
+			std::shared_ptr<AudioBuffer> chunk = p.chunk;
+			if (p.packed != nullptr) {
+				Frame frames = p.packed->data.size() / m_channels;
+				chunk = std::make_shared<AudioBuffer>(frames, m_channels);
+				sampleCodec::decode(p.packed->data.data(), (*chunk)[0], chunk->countSamples(), 
+					p.packed->storage);
+			}
+
+			Piece out{};
+			if (s == SampleStorage::FLOAT)
+				out.chunk = chunk;
+			else {
+				auto packed = std::make_shared<PackedChunk>();
+				packed->storage = s;
+				packed->data.resize(chunk->countSamples());
+				sampleCodec::encode((*chunk)[0], packed->data.data(), chunk->countSamples(), s);
+				out.packed = packed;
+			}
+			it = converted.emplace(key, out).first;
+		}
+
+		p.chunk  = it->second.chunk;
+		p.packed = it->second.packed;
+	}
+
+	if (!converted.empty())
+		touch();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t WaveData::countExclusiveBytes(const WaveData& o) const
+{
+	/* Each piece points to either a float or a compact chunk: use whichever is
+	set as identity. */
+
+	auto getKey = [](const Piece& p)
+	{
+		return p.packed != nullptr ? static_cast<const void*>(p.packed.get()) : p.chunk.get();
+	};
+
+	std::unordered_set<const void*> others;
+	for (const Piece& p : o.m_pieces)
+		others.insert(getKey(p));
+
+	std::unordered_set<const void*> mine;
+	std::size_t bytes = 0;
+	for (const Piece& p : m_pieces) {
+		if (others.count(getKey(p)) != 0 || !mine.insert(getKey(p)).second)
+			continue;
+		if (p.packed != nullptr)
+			bytes += p.packed->data.size() * sampleCodec::getBytes(p.packed->storage);
+		else
+			bytes += p.chunk->countSamples() * sizeof(float);
+	}
+	return bytes;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool WaveData::isSameContent(const WaveData& o) const
+{
+	if (m_size != o.m_size || m_channels != o.m_channels)
+		return false;
+
+	/* Compact data can't be compared in place: decode both sides one chunk at 
+	a time. */
+
+	if (isCompact() || o.isCompact()) {
+		std::vector<float> a(std::min(m_size, CHUNK_SIZE) * m_channels);
+		std::vector<float> b(a.size());
+		for (Frame f = 0; f < m_size;) {
+			Frame n = std::min(CHUNK_SIZE, m_size - f);
+			read(f, n, a.data());
+			o.read(f, n, b.data());
+			if (std::memcmp(a.data(), b.data(), n * m_channels * sizeof(float)) != 0)
+				return false;
+			f += n;
+		}
+		return true;
+	}
+
+	for (Frame f = 0; f < m_size;) {
+		Block a = getBlock(f);
+		Block b = o.getBlock(f);
+		Frame n = std::min(a.frames, b.frames);
+		if (a.data != b.data && std::memcmp(a.data, b.data, n * m_channels * sizeof(float)) != 0)
+			return false;
+		f += n;
+	}
+	return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::uint64_t WaveData::getRevision() const
+{
+	return m_revision;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveData::Changes WaveData::findChanges(const WaveData& o) const
+{
+	if (m_channels != o.m_channels)
+		return {0, m_size};
+
+	auto same = [](const Piece& a, Frame fa, const Piece& b, Frame fb)
+	{
+		return a.chunk == b.chunk && a.packed == b.packed && fa == fb;
+	};
+
+	/* Walk both piece tables from the beginning, then from the end, as long as
+	pieces point to the same chunk positions. Piece boundaries might differ, as
+	contiguous pieces are merged. */
+
+	Frame       prefix = 0;
+	std::size_t i = 0, j = 0;
+	Frame       fi = 0, fj = 0;
+	while (i < m_pieces.size() && j < o.m_pieces.size()) {
+		const Piece& a = m_pieces[i];
+		const Piece& b = o.m_pieces[j];
+		if (!same(a, a.offset + fi, b, b.offset + fj))
+			break;
+		Frame n = std::min(a.frames - fi, b.frames - fj);
+		prefix += n;
+		fi     += n;
+		fj     += n;
+		if (fi == a.frames) { i++; fi = 0; }
+		if (fj == b.frames) { j++; fj = 0; }
+	}
+
+	Frame suffix = 0;
+	i  = m_pieces.size();
+	j  = o.m_pieces.size();
+	fi = 0;
+	fj = 0;
+	while (i > 0 && j > 0) {
+		const Piece& a = m_pieces[i - 1];
+		const Piece& b = o.m_pieces[j - 1];
+		if (!same(a, a.offset + a.frames - fi, b, b.offset + b.frames - fj))
+			break;
+		Frame n = std::min(a.frames - fi, b.frames - fj);
+		suffix += n;
+		fi     += n;
+		fj     += n;
+		if (fi == a.frames) { i--; fi = 0; }
+		if (fj == b.frames) { j--; fj = 0; }
+	}
+
+	suffix = std::min(suffix, std::min(m_size, o.m_size) - prefix);
+	return {prefix, m_size - suffix};
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveData WaveData::slice(Frame a, Frame b) const
+{
+	assert(a >= 0 && a <= b && b <= m_size);
+
+	WaveData out;
+	out.m_channels = m_channels;
+	out.appendRange(*this, a, b);
+	out.rebuild();
+	return out;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::remove(Frame a, Frame b)
+{
+	assert(a >= 0 && a <= b && b <= m_size);
+
+	WaveData out;
+	out.m_channels = m_channels;
+	out.appendRange(*this, 0, a);
+	out.appendRange(*this, b, m_size);
+	out.rebuild();
+
+	*this = std::move(out);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::insert(Frame a, const WaveData& src)
+{
+	assert(a >= 0 && a <= m_size);
+	assert(src.m_channels == m_channels || src.m_size == 0 || m_size == 0);
+
+	WaveData out;
+	out.m_channels = std::max(m_channels, src.m_channels);
+	out.appendRange(*this, 0, a);
+	out.appendRange(src, 0, src.m_size);
+	out.appendRange(*this, a, m_size);
+	out.rebuild();
+
+	*this = std::move(out);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::rotate(Frame f)
+{
+	assert(f >= 0 && f <= m_size);
+
+	WaveData out;
+	out.m_channels = m_channels;
+	out.appendRange(*this, f, m_size);
+	out.appendRange(*this, 0, f);
+	out.rebuild();
+
+	*this = std::move(out);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::copyData(const float* data, Frame frames, int channels, Frame offset)
+{
+	assert(offset + frames <= m_size);
+
+	touch();
+
+	for (Frame f = 0; f < frames;) {
+		WritableBlock block = getWritableBlock(offset + f);
+		Frame         n     = std::min(block.frames, frames - f);
+
+		/* View the block as an AudioBuffer, to reuse its channel spreading 
+		logic. */
+
+		AudioBuffer view;
+		view.setData(block.data, n, m_channels);
+		view.copyData(data + (f * channels), n, channels);
+		view.setData(nullptr, 0, 0);
+
+		f += n;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::addData(const AudioBuffer& b)
+{
+	assert(b.countChannels() <= m_channels);
+
+	Frame frames = std::min(m_size, b.countFrames());
+
+	touch();
+
+	for (Frame f = 0; f < frames;) {
+		WritableBlock block = getWritableBlock(f);
+		Frame         n     = std::min(block.frames, frames - f);
+		for (Frame i = 0; i < n; i++)
+			for (int j = 0; j < b.countChannels(); j++)
+				block.data[i * m_channels + j] += b[f + i][j];
+		f += n;
+	}
+}
+
+
+void WaveData::addData(const WaveData& o)
+{
+	assert(o.countChannels() == m_channels);
+
+	Frame frames = std::min(m_size, o.countFrames());
+
+	for (Frame f = 0; f < frames;) {
+		Block block = o.getBlock(f);
+		Frame n     = std::min(block.frames, frames - f);
+		addData(block.data, n, 1.0f, f);
+		f += n;
+	}
+}
+
+
+void WaveData::addData(const float* data, Frame frames, float gain, Frame offset)
+{
+	assert(offset + frames <= m_size);
+
+	touch();
+
+	for (Frame f = 0; f < frames;) {
+		WritableBlock block = getWritableBlock(offset + f);
+		Frame         n     = std::min(block.frames, frames - f);
+		AudioBuffer::addSamples(block.data, data + f * m_channels, n * m_channels, gain);
+		f += n;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t WaveData::findPiece(Frame f) const
+{
+	assert(f >= 0 && f < m_size);
+
+	auto it = std::upper_bound(m_starts.begin(), m_starts.end(), f);
+	return std::distance(m_starts.begin(), it) - 1;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::append(const Piece& p)
+{
+	if (p.frames == 0)
+		return;
+
+	if (!m_pieces.empty()) {
+		Piece& last = m_pieces.back();
+		if (last.chunk == p.chunk && last.packed == p.packed && last.offset + last.frames == p.offset) {
+			last.frames += p.frames;
+			return;
+		}
+	}
+	m_pieces.push_back(p);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::appendRange(const WaveData& src, Frame a, Frame b)
+{
+	if (a >= b)
+		return;
+
+	for (std::size_t i = src.findPiece(a); i < src.m_pieces.size() && src.m_starts[i] < b; i++) {
+		const Piece& p     = src.m_pieces[i];
+		Frame        start = std::max(a, src.m_starts[i]);
+		Frame        end   = std::min(b, src.m_starts[i] + p.frames);
+		append({ p.chunk, p.packed, p.offset + (start - src.m_starts[i]), end - start });
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::rebuild()
+{
+	m_starts.resize(m_pieces.size());
+	m_size = 0;
+	for (std::size_t i = 0; i < m_pieces.size(); i++) {
+		m_starts[i] = m_size;
+		m_size     += m_pieces[i].frames;
+	}
+	touch();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveData::touch()
+{
+	m_revision = ++lastRevision_;
+}
+}} // giada::m::
@@ -0,0 +1,274 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_WAVE_DATA_H
+#define G_WAVE_DATA_H
+
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "core/audioBuffer.h"
+#include "core/types.h"
+
+
+namespace giada {
+namespace m
+{
+/* WaveData
+Audio data of a Wave, stored as a piece table over fixed-size chunks. Chunks 
+are shared among WaveData objects (copies, slices, pastes) and duplicated only
+when written to, one at a time. Structural edits (remove, insert, rotate) only
+touch the piece table, never the audio data. Data is contiguous only within a 
+block: use getBlock() to walk through it. 
+Chunks can also be stored in a compact 16-bit format (see compact()), to halve
+memory usage. Compact chunks can only be accessed through read(), which decodes
+them on the fly. They are promoted back to float when written to. */
+
+class WaveData
+{
+public:
+
+	/* CHUNK_SIZE
+	Size of each chunk, in frames. */
+
+	static constexpr Frame CHUNK_SIZE = 32768;
+
+	/* Block, WritableBlock
+	A contiguous portion of audio data: 'frames' frames starting from 'data'. */
+
+	struct Block
+	{
+		const float* data;
+		Frame        frames;
+	};
+
+	struct WritableBlock
+	{
+		float* data;
+		Frame  frames;
+	};
+
+	/* Changes
+	Range of frames [first, last) that might differ from another WaveData. */
+
+	struct Changes
+	{
+		Frame first;
+		Frame last;
+	};
+
+	/* WaveData (1)
+	Creates an empty WaveData. */
+
+	WaveData();
+
+	/* WaveData (2)
+	Creates a silent WaveData of 'size' frames. */
+
+	WaveData(Frame size, int channels);
+
+	/* operator []
+	Returns a pointer to frame 'f'. Only the frame itself is guaranteed to be
+	contiguous: see getBlock(). Float data only. */
+
+	const float* operator [](Frame f) const;
+
+	Frame countFrames() const;
+	int countChannels() const;
+	std::size_t countPieces() const;
+
+	/* getBlock
+	Returns the contiguous block that starts at frame 'f'. Float data only: use
+	read() if the data might be compact. */
+
+	Block getBlock(Frame f) const;
+
+	/* getWritableBlock
+	Same as getBlock(), with write access. The underlying chunk is copied first,
+	if shared, and promoted to float if compact. The revision is left alone: 
+	call touch() once done writing. */
+
+	WritableBlock getWritableBlock(Frame f);
+
+	/* read
+	Copies 'count' frames starting from frame 'first' into 'dest', as floats, 
+	whatever the storage format. */
+
+	void read(Frame first, Frame count, float* dest) const;
+
+	/* isCompact
+	True if any chunk is stored in a 16-bit format. */
+
+	bool isCompact() const;
+
+	/* compact
+	Converts all chunks to storage format 's'. Chunks shared with other 
+	WaveData objects are left untouched: converted copies are made instead. 
+	Pass SampleStorage::FLOAT to promote everything back to float. */
+
+	void compact(SampleStorage s);
+
+	/* countExclusiveBytes
+	Returns the amount of memory, in bytes, held by chunks in use by this 
+	WaveData and not by 'o'. */
+
+	std::size_t countExclusiveBytes(const WaveData& o) const;
+
+	/* isSameContent
+	True if 'o' holds the same audio data, regardless of how it is stored. */
+
+	bool isSameContent(const WaveData& o) const;
+
+	/* findChanges
+	Returns the smallest range of frames out of which this data is the same as
+	'o': frames before 'first' match the beginning of 'o', frames from 'last' on
+	match the end of 'o'. Cheap: only piece tables are compared, frames match if
+	they come from the same position in the same chunk. */
+
+	Changes findChanges(const WaveData& o) const;
+
+	/* getRevision
+	Returns a stamp that changes whenever the audio data is modified. Unique 
+	across all WaveData objects: two of them with the same stamp (e.g. copies) 
+	hold the same audio data. */
+
+	std::uint64_t getRevision() const;
+
+	/* touch
+	Stamps the data with a new revision. Edits made through the methods of this
+	class do it on their own, writes through getWritableBlock() don't. Not 
+	thread-safe: call it from the thread that owns the data. */
+
+	void touch();
+
+	/* slice
+	Returns a new WaveData made of frames in range [a, b). No data is copied. */
+
+	WaveData slice(Frame a, Frame b) const;
+
+	/* remove
+	Removes frames in range [a, b). */
+
+	void remove(Frame a, Frame b);
+
+	/* insert
+	Inserts 'src' data at frame 'a'. Both must have the same amount of 
+	channels. */
+
+	void insert(Frame a, const WaveData& src);
+
+	/* rotate
+	Rotates data to the left, so that frame 'f' becomes the first one. */
+
+	void rotate(Frame f);
+
+	/* copyData
+	Copies 'frames' frames from 'data' into this, starting from frame 'offset'.
+	Mono data is spread over all channels. See AudioBuffer::copyData(). */
+
+	void copyData(const float* data, Frame frames, int channels, Frame offset=0);
+
+	/* addData (1)
+	Merges audio data from buffer 'b' onto this one. */
+
+	void addData(const AudioBuffer& b);
+
+	/* addData (2)
+	Merges audio data from 'o' onto this one. Both must have the same amount of
+	channels. Float data only, as getBlock(). */
+
+	void addData(const WaveData& o);
+
+	/* addData (3)
+	Merges 'frames' frames of interleaved 'data', multiplied by 'gain', onto 
+	this one starting from frame 'offset'. 'data' must have the same amount of
+	channels. Realtime-safe as long as the chunks involved are float and not 
+	shared, e.g. on a brand new WaveData. */
+
+	void addData(const float* data, Frame frames, float gain, Frame offset);
+
+private:
+
+	/* PackedChunk
+	A chunk stored in a 16-bit format: interleaved samples, as AudioBuffer. */
+
+	struct PackedChunk
+	{
+		SampleStorage              storage;
+		std::vector<std::uint16_t> data;
+	};
+
+	/* Piece
+	A range of 'frames' frames in 'chunk', starting from 'offset'. Either 'chunk'
+	or 'packed' is set, depending on the storage format. */
+
+	struct Piece
+	{
+		std::shared_ptr<AudioBuffer>       chunk;
+		std::shared_ptr<const PackedChunk> packed;
+		Frame                              offset;
+		Frame                              frames;
+	};
+
+	/* findPiece
+	Returns the index of the piece that contains frame 'f'. */
+
+	std::size_t findPiece(Frame f) const;
+
+	/* append
+	Adds piece 'p' to the end of the table, merging it with the last one if
+	they are contiguous in the same chunk. */
+
+	void append(const Piece& p);
+
+	/* appendRange
+	Appends pieces that cover frames [a, b) of 'src'. */
+
+	void appendRange(const WaveData& src, Frame a, Frame b);
+
+	/* rebuild
+	Recomputes piece starting frames and total size. */
+
+	void rebuild();
+
+	std::vector<Piece> m_pieces;
+
+	/* m_starts
+	First frame of each piece, for binary search. */
+
+	std::vector<Frame> m_starts;
+
+	Frame         m_size;
+	int           m_channels;
+	std::uint64_t m_revision;
+};
+}} // giada::m::
+
+
+#endif
@@ -28,9 +28,19 @@
 #include <cmath>
 #include <cassert>
 #include <algorithm>
+#include <utility>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define G_WAVE_FX_SSE
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define G_WAVE_FX_NEON
+#endif
 #include "core/model/model.h"
 #include "utils/log.h"
 #include "const.h"
+#include "threadPool.h"
 #include "wave.h"
 #include "waveFx.h"
 
@@ -41,28 +51,195 @@ namespace wfx
 {
 namespace
 {
-void fadeFrame_(Wave& w, int i, float val)
+/* PARALLEL_SPANS
+Minimum number of spans (see below) worth spreading across multiple threads.
+Shorter ranges are processed in the calling thread, as spawning threads would
+take longer than the job itself. */
+
+constexpr std::size_t PARALLEL_SPANS = 8;
+
+
+/* Span
+A contiguous portion of writable audio data: 'frames' frames starting from 
+frame 'first', stored at 'data'. */
+
+struct Span
 {
-	for (int j=0; j<w.getChannels(); j++)
-		w[i][j] *= val;
+	float* data;
+	int    first;
+	int    frames;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* touch_
+Stamps the data of 'w' with a new revision, see WaveData::touch(). */
+
+void touch_(Wave& w)     { w.touchData(); }
+void touch_(WaveData& d) { d.touch(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getSpans_
+Returns the spans that cover range [a, b) of 'w' (a Wave or a WaveData). Chunks
+are copied or promoted to float here, if needed (see WaveData), so that the
+returned spans can be safely written to from multiple threads. The data is 
+stamped with a new revision here too, once for the whole edit. */
+
+template <typename T>
+std::vector<Span> getSpans_(T& w, int a, int b)
+{
+	touch_(w);
+
+	std::vector<Span> spans;
+	for (int i=a; i<b;) {
+		WaveData::WritableBlock block = w.getWritableBlock(i);
+		int n = std::min(block.frames, b - i);
+		spans.push_back({ block.data, i, n });
+		i += n;
+	}
+	return spans;
 }
 
 
 /* -------------------------------------------------------------------------- */
 
+/* processSpans_
+Calls 'f' on each span, in parallel if there are enough of them. */
 
-float getPeak_(const Wave& w, int a, int b)
+template <typename F>
+void processSpans_(const std::vector<Span>& spans, F f)
 {
-	float peak = 0.0f;
-	float abs  = 0.0f;
-	for (int i=a; i<b; i++) {
-		for (int j=0; j<w.getChannels(); j++) // Find highest value in any channel
-			abs = fabs(w[i][j]);
-		if (abs > peak)
-			peak = abs;
+	ThreadPool pool(spans.size() >= PARALLEL_SPANS ? G_MAX_IO_THREADS : 1);
+	pool.run(spans.size(), [&](std::size_t i) { f(spans[i]); });
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* scale_
+Multiplies 'count' samples by 'gain'. */
+
+void scale_(float* data, int count, float gain)
+{
+	int i = 0;
+#if defined(G_WAVE_FX_SSE)
+	const __m128 g = _mm_set1_ps(gain);
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), g));
+#elif defined(G_WAVE_FX_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), gain));
+#endif
+	for (; i < count; i++)
+		data[i] *= gain;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* ramp_
+Multiplies 'frames' frames of 'channels' channels by a linear ramp. Frame k
+gets gain (origin + sign * (k + k0)) * step, with 'sign' either 1 or -1: such
+a formula keeps the ramp ends exact, i.e. a zero gain is a real zero. */
+
+void ramp_(float* data, int frames, int channels, int k0, int origin, int sign, float step)
+{
+	int k = 0;
+#if defined(G_WAVE_FX_SSE)
+	if (channels == 2) {
+		/* Two stereo frames per vector: gains are {k, k, k+1, k+1}. */
+		const __m128  o = _mm_set1_ps(static_cast<float>(origin));
+		const __m128  s = _mm_set1_ps(static_cast<float>(sign));
+		const __m128  d = _mm_set1_ps(step);
+		const __m128i two = _mm_set1_epi32(2);
+		__m128i idx = _mm_set_epi32(k0 + 1, k0 + 1, k0, k0);
+		for (; k + 2 <= frames; k += 2) {
+			__m128 g = _mm_mul_ps(_mm_add_ps(o, _mm_mul_ps(s, _mm_cvtepi32_ps(idx))), d);
+			_mm_storeu_ps(data + k * 2, _mm_mul_ps(_mm_loadu_ps(data + k * 2), g));
+			idx = _mm_add_epi32(idx, two);
+		}
 	}
+#elif defined(G_WAVE_FX_NEON)
+	if (channels == 2) {
+		const std::int32_t first[4] = { k0, k0, k0 + 1, k0 + 1 };
+		const float32x4_t  o   = vdupq_n_f32(static_cast<float>(origin));
+		const float32x4_t  s   = vdupq_n_f32(static_cast<float>(sign));
+		const int32x4_t    two = vdupq_n_s32(2);
+		int32x4_t idx = vld1q_s32(first);
+		for (; k + 2 <= frames; k += 2) {
+			float32x4_t g = vmulq_n_f32(vmlaq_f32(o, s, vcvtq_f32_s32(idx)), step);
+			vst1q_f32(data + k * 2, vmulq_f32(vld1q_f32(data + k * 2), g));
+			idx = vaddq_s32(idx, two);
+		}
+	}
+#endif
+	for (; k < frames; k++) {
+		float g = static_cast<float>(origin + sign * (k + k0)) * step;
+		for (int j=0; j<channels; j++)
+			data[k * channels + j] *= g;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* peak_
+Returns the highest absolute value among 'count' samples. */
+
+float peak_(const float* data, int count)
+{
+	float peak = 0.0f;
+	int   i    = 0;
+#if defined(G_WAVE_FX_SSE)
+	const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	__m128 m = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+		m = _mm_max_ps(m, _mm_and_ps(_mm_loadu_ps(data + i), mask));
+	alignas(16) float lanes[4];
+	_mm_store_ps(lanes, m);
+	peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(G_WAVE_FX_NEON)
+	float32x4_t m = vdupq_n_f32(0.0f);
+	for (; i + 4 <= count; i += 4)
+		m = vmaxq_f32(m, vabsq_f32(vld1q_f32(data + i)));
+	float lanes[4];
+	vst1q_f32(lanes, m);
+	peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+	for (; i < count; i++)
+		peak = std::max(peak, std::fabs(data[i]));
 	return peak;
 }
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getPeak_
+Returns the highest absolute value in range [a, b), across all channels. Data 
+is read one chunk at a time, whatever its storage format. */
+
+float getPeak_(const Wave& w, int a, int b)
+{
+	const int         channels = w.getChannels();
+	const std::size_t jobs     = b > a ? (b - a + WaveData::CHUNK_SIZE - 1) / WaveData::CHUNK_SIZE : 0;
+
+	std::vector<float> peaks(jobs, 0.0f);
+
+	ThreadPool pool(jobs >= PARALLEL_SPANS ? G_MAX_IO_THREADS : 1);
+	pool.run(jobs, [&](std::size_t i)
+	{
+		int first = a + static_cast<int>(i) * WaveData::CHUNK_SIZE;
+		int count = std::min(WaveData::CHUNK_SIZE, b - first);
+		std::vector<float> frames(count * channels);
+		w.getData().read(first, count, frames.data());
+		peaks[i] = peak_(frames.data(), count * channels);
+	});
+
+	return peaks.empty() ? 0.0f : *std::max_element(peaks.begin(), peaks.end());
+}
 } // {anonymous}
 
 
@@ -82,10 +259,11 @@ void normalize(ID waveId, int a, int b)
 		if (peak == 0.0f || peak > 1.0f)
 			return;
 
-		for (int i=a; i<b; i++) {
-			for (int j=0; j<w.getChannels(); j++)
-				w[i][j] = w[i][j] * (1.0f / peak);
-		}
+		const int channels = w.getChannels();
+		processSpans_(getSpans_(w, a, b), [&](const Span& s)
+		{
+			scale_(s.data, s.frames * channels, 1.0f / peak);
+		});
 		w.setEdited(true);
 	});
 }
@@ -99,14 +277,21 @@ int monoToStereo(Wave& w)
 	if (w.getChannels() >= G_MAX_IO_CHANS)
 		return G_RES_OK;
 
-	AudioBuffer newData;
-	newData.alloc(w.getSize(), G_MAX_IO_CHANS);
+	WaveData newData(w.getSize(), G_MAX_IO_CHANS);
+
+	/* Read mono frames to the beginning of each destination span, then spread
+	them over both channels, back to front so that no frame is overwritten 
+	before being read. */
 
-	for (int i=0; i<newData.countFrames(); i++)
-		for (int j=0; j<newData.countChannels(); j++)
-			newData[i][j] = w[i][0];
+	const WaveData& data = w.getData();
+	processSpans_(getSpans_(newData, 0, w.getSize()), [&](const Span& s)
+	{
+		data.read(s.first, s.frames, s.data);
+		for (int k=s.frames-1; k>=0; k--)
+			s.data[k * 2] = s.data[k * 2 + 1] = s.data[k];
+	});
 
-	w.moveData(newData);
+	w.setData(std::move(newData));
 
 	return G_RES_OK;
 }
@@ -121,9 +306,11 @@ void silence(ID waveId, int a, int b)
 	
 	model::onSwap(m::model::waves, waveId, [&](Wave& w)
 	{
-		for (int i=a; i<b; i++)
-			for (int j=0; j<w.getChannels(); j++)	
-				w[i][j] = 0.0f;
+		const int channels = w.getChannels();
+		processSpans_(getSpans_(w, a, b), [&](const Span& s)
+		{
+			std::fill_n(s.data, s.frames * channels, 0.0f);
+		});
 		w.setEdited(true);
 	});
 }
@@ -139,25 +326,15 @@ void cut(ID waveId, int a, int b)
 		if (a < 0) a = 0;
 		if (b > w.getSize()) b = w.getSize();
 
-		/* Create a new temp wave and copy there the original one, skipping the a-b 
-		range. */
-
-		int newSize = w.getSize() - (b - a);
-
-		AudioBuffer newData;
-		newData.alloc(newSize, w.getChannels());
-
 		u::log::print("[wfx::cut] cutting from %d to %d\n", a, b);
 
-		for (int i=0, k=0; i<w.getSize(); i++) {
-			if (i < a || i >= b) {
-				for (int j=0; j<w.getChannels(); j++)	
-					newData[k][j] = w[i][j];
-				k++;
-			}
-		}
+		/* Just drop the a-b range from the piece table: no audio data is 
+		copied. */
 
-		w.moveData(newData);
+		WaveData newData = w.getData();
+		newData.remove(a, b);
+
+		w.setData(std::move(newData));
 		w.setEdited(true);
 	});
 }
@@ -173,18 +350,9 @@ void trim(ID waveId, int a, int b)
 		if (a < 0) a = 0;
 		if (b > w.getSize()) b = w.getSize();
 
-		int newSize = b - a;
-
-		AudioBuffer newData;
-		newData.alloc(newSize, w.getChannels());
-
 		u::log::print("[wfx::trim] trimming from %d to %d (area = %d)\n", a, b, b-a);
 
-		for (int i=0; i<newData.countFrames(); i++)
-			for (int j=0; j<newData.countChannels(); j++)
-				newData[i][j] = w[i+a][j];
-
-		w.moveData(newData);
+		w.setData(w.getData().slice(a, b));
 		w.setEdited(true);
 	});
 }
@@ -199,17 +367,13 @@ void paste(const Wave& src, ID waveId, int a)
 	{
 		assert(src.getChannels() == des.getChannels());
 
-		AudioBuffer newData;
-		newData.alloc(src.getSize() + des.getSize(), des.getChannels());
-
 		/* |---original data---|///paste data///|---original data---|
 				 des[0, a)      src[0, src.size)   des[a, des.size)	*/
 
-		newData.copyData(des[0], a, 0);
-		newData.copyData(src[0], src.getSize(), a);
-		newData.copyData(des[a], des.getSize() - a, src.getSize() + a);
+		WaveData newData = des.getData();
+		newData.insert(a, src.getData());
 
-		des.moveData(newData);
+		des.setData(std::move(newData));
 		des.setEdited(true);
 	});
 }
@@ -222,18 +386,21 @@ void fade(ID waveId, int a, int b, Fade type)
 {
 	u::log::print("[wfx::fade] fade from %d to %d (range = %d)\n", a, b, b-a);
 
-	float m = 0.0f;
 	float d = 1.0f / (float) (b - a);
 
 	model::onSwap(m::model::waves, waveId, [&](Wave& w)
 	{
-		if (type == Fade::IN)
-			for (int i=a; i<=b; i++, m+=d)
-				fadeFrame_(w, i, m);
-		else
-			for (int i=b; i>=a; i--, m+=d)
-				fadeFrame_(w, i, m);		
-		
+		/* Fade in: gain (i - a) * d. Fade out: gain (b - i) * d. Frame b is 
+		included. */
+
+		const int channels = w.getChannels();
+		processSpans_(getSpans_(w, a, std::min(b + 1, w.getSize())), [&](const Span& s)
+		{
+			if (type == Fade::IN)
+				ramp_(s.data, s.frames, channels, s.first - a, 0, 1, d);
+			else
+				ramp_(s.data, s.frames, channels, s.first - a, b - a, -1, d);
+		});
 		w.setEdited(true);
 	});
 }
@@ -265,12 +432,15 @@ void shift(ID waveId, int offset)
 	model::onSwap(m::model::waves, waveId, [&](Wave& w)
 	{
 		if (offset < 0)
-			offset = (w.getSize() + w.getChannels()) + offset;
+			offset = w.getSize() + offset;
 
-		float* begin = w.getFrame(0);
-		float* end   = w.getFrame(0) + (w.getSize() * w.getChannels());
+		/* Rotating right by 'offset' frames is just a matter of rearranging the
+		piece table. */
 
-		std::rotate(begin, end - (offset * w.getChannels()), end);
+		WaveData newData = w.getData();
+		newData.rotate(w.getSize() - offset);
+
+		w.setData(std::move(newData));
 		w.setEdited(true);
 	});
 }
@@ -281,16 +451,21 @@ void shift(ID waveId, int offset)
 
 void reverse(ID waveId, int a, int b)
 {
-	/* https://stackoverflow.com/questions/33201528/reversing-an-array-of-structures-in-c */
 	model::onSwap(m::model::waves, waveId, [&](Wave& w)
 	{
-		float* begin = w.getFrame(0) + (a * w.getChannels());
-		float* end   = w.getFrame(0) + (b * w.getChannels());
-
-		std::reverse(begin, end);
-
+		/* Frames may span across several blocks: take a copy of the range 
+		first, then write it back in reverse order. */
+
+		AudioBuffer range(b - a, w.getChannels());
+		w.getData().read(a, b - a, range[0]);
+
+		const int channels = w.getChannels();
+		processSpans_(getSpans_(w, a, b), [&](const Span& s)
+		{
+			for (int k=0; k<s.frames; k++)
+				std::copy_n(range[b - 1 - (s.first + k)], channels, s.data + k * channels);
+		});
 		w.setEdited(true);
 	});
 }
-
 }}} // giada::m::wfx::
@@ -0,0 +1,139 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <cassert>
+#include "waveHistory.h"
+
+
+namespace giada {
+namespace m
+{
+WaveHistory::WaveHistory(std::size_t maxBytes)
+: m_cursor  (0)
+, m_bytes   (0)
+, m_maxBytes(maxBytes)
+{
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool WaveHistory::canUndo() const { return m_cursor > 0; }
+bool WaveHistory::canRedo() const { return m_cursor < m_entries.size(); }
+
+std::size_t WaveHistory::getBytes() const   { return m_bytes; }
+std::size_t WaveHistory::countSteps() const { return m_entries.size(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveHistory::push(WaveData before, WaveData after, Frame shiftBefore, 
+	Frame shiftAfter)
+{
+	/* A new edit invalidates the redoable steps. */
+
+	while (m_entries.size() > m_cursor) {
+		m_bytes -= m_entries.back().bytes;
+		m_entries.pop_back();
+	}
+
+	std::size_t bytes = before.countExclusiveBytes(after) + 
+	                    after.countExclusiveBytes(before);
+
+	m_entries.push_back({ std::move(before), std::move(after), shiftBefore, 
+		shiftAfter, bytes });
+	m_bytes += bytes;
+	m_cursor++;
+
+	trim();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+const WaveHistory::Entry* WaveHistory::undo()
+{
+	if (!canUndo())
+		return nullptr;
+	return &m_entries[--m_cursor];
+}
+
+
+const WaveHistory::Entry* WaveHistory::redo()
+{
+	if (!canRedo())
+		return nullptr;
+	return &m_entries[m_cursor++];
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveHistory::setMaxBytes(std::size_t maxBytes)
+{
+	m_maxBytes = maxBytes;
+	trim();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveHistory::clear()
+{
+	m_entries.clear();
+	m_cursor = 0;
+	m_bytes  = 0;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveHistory::trim()
+{
+	while (m_bytes > m_maxBytes && !m_entries.empty()) {
+		/* Oldest undoable steps go first. With nothing left to undo, drop the
+		farthest redoable ones instead, so that the chain stays consistent. */
+		if (m_cursor > 0) {
+			m_bytes -= m_entries.front().bytes;
+			m_entries.pop_front();
+			m_cursor--;
+		}
+		else {
+			m_bytes -= m_entries.back().bytes;
+			m_entries.pop_back();
+		}
+	}
+	assert(m_cursor <= m_entries.size());
+}
+}} // giada::m::
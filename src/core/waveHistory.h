@@ -0,0 +1,120 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_WAVE_HISTORY_H
+#define G_WAVE_HISTORY_H
+
+
+#include <cstddef>
+#include <deque>
+#include "core/waveData.h"
+#include "core/types.h"
+
+
+namespace giada {
+namespace m
+{
+/* WaveHistory
+Undo/redo history for destructive edits on a Wave. Each step stores the 
+WaveData before and after the edit: since WaveData shares untouched chunks, a
+step only costs the memory of the chunks the edit has replaced. Old steps are 
+discarded when the memory budget is exceeded. */
+
+class WaveHistory
+{
+public:
+
+	struct Entry
+	{
+		WaveData    before;
+		WaveData    after;
+		Frame       shiftBefore;
+		Frame       shiftAfter;
+		std::size_t bytes;
+	};
+
+	/* WaveHistory
+	Creates an empty history that can hold at most 'maxBytes' bytes of audio
+	data. */
+
+	WaveHistory(std::size_t maxBytes=0);
+
+	bool canUndo() const;
+	bool canRedo() const;
+
+	/* getBytes
+	Returns the memory held by the history, in bytes. */
+
+	std::size_t getBytes() const;
+
+	/* countSteps
+	Returns the number of steps stored, undoable or redoable. */
+
+	std::size_t countSteps() const;
+
+	/* push
+	Records a new edit. Clears any redoable step. */
+
+	void push(WaveData before, WaveData after, Frame shiftBefore=0, 
+		Frame shiftAfter=0);
+
+	/* undo, redo
+	Move the history one step backward/forward. Return the step to apply, or
+	nullptr if there is nothing to undo/redo. Use Entry::before when undoing, 
+	Entry::after when redoing. */
+
+	const Entry* undo();
+	const Entry* redo();
+
+	/* setMaxBytes
+	Changes the memory budget, discarding old steps if needed. */
+
+	void setMaxBytes(std::size_t maxBytes);
+
+	void clear();
+
+private:
+
+	/* trim
+	Discards the oldest steps until the history fits the memory budget. */
+
+	void trim();
+
+	std::deque<Entry> m_entries;
+
+	/* m_cursor
+	Number of undoable steps, i.e. the index of the first redoable one. */
+
+	std::size_t m_cursor;
+	std::size_t m_bytes;
+	std::size_t m_maxBytes;
+};
+}} // giada::m::
+
+
+#endif
@@ -0,0 +1,139 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "utils/log.h"
+#include "core/const.h"
+#include "core/patch.h"
+#include "core/threadPool.h"
+#include "core/wave.h"
+#include "core/waveManager.h"
+#include "core/waveLoader.h"
+
+
+namespace giada::m::waveLoader
+{
+namespace
+{
+std::thread       worker_;
+std::atomic<bool> cancel_(false);
+
+/* pending_
+Number of Waves not collected yet, including those still being decoded. */
+
+std::atomic<std::size_t> pending_(0);
+
+/* loaded_
+Decoded Waves waiting to be collected. Guarded by 'mutex_'. */
+
+std::vector<Loaded> loaded_;
+std::mutex          mutex_;
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+void start(std::vector<patch::Wave> waves, int samplerate, int quality, 
+	SampleStorage storage)
+{
+	stop();
+
+	if (waves.empty())
+		return;
+
+	u::log::print("[waveLoader::start] loading %d waves in background\n", 
+		static_cast<int>(waves.size()));
+
+	cancel_.store(false);
+	pending_.store(waves.size());
+
+	worker_ = std::thread([waves = std::move(waves), samplerate, quality, storage]()
+	{
+		ThreadPool pool(G_MAX_IO_THREADS);
+		pool.run(waves.size(), [&](std::size_t i)
+		{
+			if (cancel_.load())
+				return;
+			std::unique_ptr<Wave> w = waveManager::deserializeWave(waves[i], samplerate, quality, storage);
+			std::lock_guard<std::mutex> lock(mutex_);
+			loaded_.push_back({ waves[i].id, std::move(w) });
+		});
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void stop()
+{
+	cancel_.store(true);
+	wait();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	loaded_.clear();
+	pending_.store(0);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void wait()
+{
+	if (worker_.joinable())
+		worker_.join();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::vector<Loaded> collect()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::vector<Loaded> out = std::move(loaded_);
+	loaded_.clear();
+	pending_ -= out.size();
+	return out;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool isLoading()
+{
+	return pending_.load() > 0;
+}
+} // giada::m::waveLoader::
@@ -0,0 +1,91 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_WAVE_LOADER_H
+#define G_WAVE_LOADER_H
+
+
+#include <memory>
+#include <vector>
+#include "core/types.h"
+
+
+namespace giada::m 
+{
+class Wave;
+namespace patch
+{
+struct Wave;
+}
+namespace waveLoader
+{
+struct Loaded
+{
+	/* id
+	ID of the Wave as found in the patch. */
+
+	ID id;
+
+	/* wave
+	The decoded Wave, or nullptr if decoding has failed. */
+
+	std::unique_ptr<Wave> wave;
+};
+
+/* start
+Starts decoding Waves 'waves' in background. Any previous loading session is
+stopped first. Decoded Waves are not pushed into the model: grab them with 
+collect() from the main thread. */
+
+void start(std::vector<patch::Wave> waves, int samplerate, int quality, 
+	SampleStorage storage);
+
+/* stop
+Cancels the current loading session, if any, and discards pending Waves. Blocks
+until the background thread has finished. */
+
+void stop();
+
+/* wait
+Blocks until all Waves of the current session have been decoded. */
+
+void wait();
+
+/* collect
+Returns Waves decoded so far, removing them from the internal queue. */
+
+std::vector<Loaded> collect();
+
+/* isLoading
+True if some Waves are still being decoded or not yet collected. */
+
+bool isLoading();
+}} // giada::m::waveLoader::
+
+
+#endif
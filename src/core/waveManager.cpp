@@ -25,13 +25,23 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <utility>
+#include <mutex>
+#include <filesystem>
 #include <sndfile.h>
 #include <samplerate.h>
 #include "utils/log.h"
 #include "utils/fs.h"
 #include "const.h"
 #include "idManager.h"
+#include "threadPool.h"
 #include "wave.h"
 #include "patch.h"
 #include "waveFx.h"
@@ -46,27 +56,364 @@ namespace
 {
 IdManager waveId_;
 
+/* CacheEntry
+Audio data already loaded in memory, shared by one or more Waves. Weak 
+references only: data goes away together with the last Wave using it. The
+revision tells whether the data has been modified since it was cached (see 
+WaveData::getRevision()). */
+
+struct CacheEntry
+{
+	std::weak_ptr<WaveData>    data;
+	std::uint64_t              hash;
+	std::uint64_t              revision;
+	int                        rate;
+	int                        bits;
+};
+
+/* filesCache_, contentCache_
+Data shared among Waves, indexed by file (path + size + modification time + 
+output format) and by content hash respectively. Guarded by 'cacheMutex_', as
+Waves can be created from multiple threads at once. */
+
+std::map<std::string, CacheEntry>   filesCache_;
+std::map<std::uint64_t, CacheEntry> contentCache_;
+std::mutex                          cacheMutex_;
+
+
+/* -------------------------------------------------------------------------- */
+
+
+/* hash_
+FNV-1a hash of the audio data, decoded to float if compact. Samples are read as
+32-bit words. */
+
+std::uint64_t hash_(const WaveData& d)
+{
+	std::uint64_t h = 14695981039346656037ull;
+
+	std::vector<float> buffer(std::min(d.countFrames(), WaveData::CHUNK_SIZE) * d.countChannels());
+
+	for (Frame f = 0; f < d.countFrames();) {
+		Frame frames = std::min(d.countFrames() - f, WaveData::CHUNK_SIZE);
+		d.read(f, frames, buffer.data());
+
+		const std::uint32_t* data = reinterpret_cast<const std::uint32_t*>(buffer.data());
+		const std::size_t    size = frames * d.countChannels();
+		for (std::size_t i = 0; i < size; i++) {
+			h ^= data[i];
+			h *= 1099511628211ull;
+		}
+		f += frames;
+	}
+	return h;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+/* makeFileKey_
+Returns a key that identifies the file in 'path' once decoded with the given 
+parameters, or an empty string if the file can't be inspected. */
+
+std::string makeFileKey_(const std::string& path, int samplerate, int quality, 
+	SampleStorage storage)
+{
+	namespace fs = std::filesystem;
+
+	std::error_code ec;
+	fs::path     p    = fs::canonical(path, ec);
+	std::uintmax_t size = fs::file_size(p, ec);
+	auto         time = fs::last_write_time(p, ec);
+	if (ec)
+		return "";
+
+	return p.string() + "|" + std::to_string(size) + "|" + 
+	       std::to_string(time.time_since_epoch().count()) + "|" + 
+	       std::to_string(samplerate) + "|" + std::to_string(quality) + "|" + 
+	       std::to_string(static_cast<int>(storage));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+/* purgeCache_
+Removes entries whose data is no longer used by any Wave. */
+
+template <typename M>
+void purgeCache_(M& cache)
+{
+	for (auto it = cache.begin(); it != cache.end();)
+		it = it->second.data.expired() ? cache.erase(it) : std::next(it);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+/* shareFromFile_
+Makes 'w' share the data already loaded from the same file, if any and if still
+untouched. Returns whether the data has been shared. */
+
+bool shareFromFile_(Wave& w, const std::string& key)
+{
+	if (key.empty())
+		return false;
+
+	std::lock_guard<std::mutex> lock(cacheMutex_);
+
+	auto it = filesCache_.find(key);
+	if (it == filesCache_.end())
+		return false;
+
+	Wave::SharedData data = it->second.data.lock();
+	if (data == nullptr)
+		return false;
+
+	/* Data might have been modified in place in the meantime (e.g. overdub):
+	share it only if still identical to the original file content. */
+
+	if (data->getRevision() != it->second.revision)
+		return false;
+
+	w.setSharedData(data);
+	w.setRate(it->second.rate);
+	w.setBits(it->second.bits);
+	return true;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+/* shareOrRegister_
+Makes 'w' share the data of an identical Wave already in memory, if any. 
+Otherwise registers its data for future sharing. */
+
+void shareOrRegister_(Wave& w, const std::string& key)
+{
+	if (w.getSize() == 0)
+		return;
+
+	std::uint64_t hash = hash_(w.getData());
+
+	std::lock_guard<std::mutex> lock(cacheMutex_);
+
+	purgeCache_(filesCache_);
+	purgeCache_(contentCache_);
+
+	auto it = contentCache_.find(hash);
+	if (it != contentCache_.end()) {
+		const Wave::SharedData data = it->second.data.lock();
+		if (data != nullptr && data->isSameContent(w.getData())) {
+			u::log::print("[waveManager::create] same content already in memory, sharing it\n");
+			w.setSharedData(data);
+		}
+	}
+
+	CacheEntry entry = { w.getSharedData(), hash, w.getData().getRevision(), 
+		w.getRate(), w.getBits() };
+
+	contentCache_[hash] = entry;
+	if (!key.empty())
+		filesCache_[key] = entry;
+}
+
 
 /* -------------------------------------------------------------------------- */
 
 
 int getBits_(const SF_INFO& header)
 {
-	if      (header.format & SF_FORMAT_PCM_S8)
-		return 8;
-	else if (header.format & SF_FORMAT_PCM_16)
-		return 16;
-	else if (header.format & SF_FORMAT_PCM_24)
-		return 24;
-	else if (header.format & SF_FORMAT_PCM_32)
-		return 32;
-	else if (header.format & SF_FORMAT_PCM_U8)
-		return 8;
-	else if (header.format & SF_FORMAT_FLOAT)
-		return 32;
-	else if (header.format & SF_FORMAT_DOUBLE)
-		return 64;
-	return 0;
+	/* Subtypes are plain values, not flags: mask them out before comparing. */
+
+	switch (header.format & SF_FORMAT_SUBMASK) {
+		case SF_FORMAT_PCM_S8:
+		case SF_FORMAT_PCM_U8:
+			return 8;
+		case SF_FORMAT_PCM_16:
+			return 16;
+		case SF_FORMAT_PCM_24:
+			return 24;
+		case SF_FORMAT_PCM_32:
+		case SF_FORMAT_FLOAT:
+			return 32;
+		case SF_FORMAT_DOUBLE:
+			return 64;
+		default:
+			return 0;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getFileFormat_
+Returns the libsndfile format for writing Wave 'w' as 'f'. Original bit depths 
+of 32 bits are written as float, as there is no way to tell float from integer
+data at this point. FLAC supports integer data up to 24 bits. */
+
+int getFileFormat_(const Wave& w, SampleFileFormat f)
+{
+	const int bits = w.getBits();
+
+	switch (f) {
+		case SampleFileFormat::WAV_ORIGINAL:
+			if (bits == 8)  return SF_FORMAT_WAV | SF_FORMAT_PCM_U8;
+			if (bits == 16) return SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+			if (bits == 24) return SF_FORMAT_WAV | SF_FORMAT_PCM_24;
+			if (bits == 64) return SF_FORMAT_WAV | SF_FORMAT_DOUBLE;
+			return SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+		case SampleFileFormat::FLAC:
+			if (bits == 8)  return SF_FORMAT_FLAC | SF_FORMAT_PCM_S8;
+			if (bits == 16) return SF_FORMAT_FLAC | SF_FORMAT_PCM_16;
+			return SF_FORMAT_FLAC | SF_FORMAT_PCM_24;
+		default:
+			return SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* RESAMPLE_SEGMENT, RESAMPLE_WARMUP
+Input frames per parallel resampling job, and extra input frames read on each 
+side of it. See resample(). */
+
+constexpr Frame RESAMPLE_SEGMENT = WaveData::CHUNK_SIZE * 4;
+constexpr Frame RESAMPLE_WARMUP  = 8192;
+
+
+/* Segment
+A portion of the resampling job: input frames [inBegin, inEnd) that map exactly
+to output frames [outBegin, outEnd). */
+
+struct Segment
+{
+	Frame inBegin;
+	Frame inEnd;
+	Frame outBegin;
+	Frame outEnd;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* Span
+A contiguous portion of writable audio data: 'frames' frames starting from 
+frame 'first', stored at 'data'. */
+
+struct Span
+{
+	float* data;
+	Frame  first;
+	Frame  frames;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getSpans_
+Returns the spans that cover the whole 'd', sorted by frame. Chunks are made 
+writable here, on the calling thread: workers then write through the spans and
+never call into WaveData. */
+
+std::vector<Span> getSpans_(WaveData& d)
+{
+	std::vector<Span> spans;
+	for (Frame f = 0; f < d.countFrames();) {
+		WaveData::WritableBlock block = d.getWritableBlock(f);
+		spans.push_back({ block.data, f, block.frames });
+		f += block.frames;
+	}
+	d.touch();
+	return spans;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* findSpan_
+Returns the span in 'spans' that contains frame 'f'. */
+
+const Span& findSpan_(const std::vector<Span>& spans, Frame f)
+{
+	auto it = std::upper_bound(spans.begin(), spans.end(), f, 
+		[](Frame f, const Span& s) { return f < s.first; });
+	assert(it != spans.begin());
+	return *std::prev(it);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* resampleSegment_
+Resamples segment 's' of Wave 'w' into output spans 'out'. The converter starts 'warmup' 
+input frames before the segment and reads as many past it, so that its filter 
+state at the seams is the same as in a single run over the whole Wave. Output
+produced during the warmup is thrown away. Returns a libsamplerate error code. */
+
+int resampleSegment_(const Wave& w, const std::vector<Span>& out, int quality, 
+	double ratio, const Segment& s, Frame warmup)
+{
+	int ret;
+	SRC_STATE* state = src_new(quality, w.getChannels(), &ret);
+	if (state == nullptr)
+		return ret;
+
+	const Frame inStart = std::max(Frame(0), s.inBegin - warmup);
+	const Frame inStop  = std::min(Frame(w.getSize()), s.inEnd + warmup);
+
+	/* Segments start on frames where input and output are aligned, so the
+	amount of output to skip is an integer. */
+
+	Frame in  = inStart;
+	Frame pos = s.outBegin - static_cast<Frame>(std::llround((s.inBegin - inStart) * ratio));
+
+	std::vector<float> scratch(WaveData::CHUNK_SIZE * w.getChannels());
+
+	while (pos < s.outEnd) {
+		WaveData::Block blockIn = in < inStop ? w.getBlock(in) : WaveData::Block{ nullptr, 0 };
+		blockIn.frames = std::min(blockIn.frames, inStop - in);
+
+		/* Before the segment: write to the scratch buffer. Within the segment:
+		write straight into the destination. */
+
+		float* dataOut;
+		Frame  framesOut;
+		if (pos < s.outBegin) {
+			dataOut   = scratch.data();
+			framesOut = std::min(s.outBegin - pos, WaveData::CHUNK_SIZE);
+		}
+		else {
+			const Span& span = findSpan_(out, pos);
+			dataOut   = span.data + (pos - span.first) * w.getChannels();
+			framesOut = std::min(span.first + span.frames, s.outEnd) - pos;
+		}
+
+		SRC_DATA src_data;
+		src_data.data_in       = blockIn.data;
+		src_data.input_frames  = blockIn.frames;
+		src_data.data_out      = dataOut;
+		src_data.output_frames = framesOut;
+		src_data.end_of_input  = in + blockIn.frames >= inStop;
+		src_data.src_ratio     = ratio;
+
+		ret = src_process(state, &src_data);
+		if (ret != 0)
+			break;
+
+		in  += src_data.input_frames_used;
+		pos += src_data.output_frames_gen;
+
+		if (src_data.input_frames_used == 0 && src_data.output_frames_gen == 0) // Flushed
+			break;
+	}
+
+	src_delete(state);
+	return ret;
 }
 } // {anonymous}
 
@@ -79,13 +426,28 @@ int getBits_(const SF_INFO& header)
 void init()
 {
 	waveId_ = IdManager();
+
+	std::lock_guard<std::mutex> lock(cacheMutex_);
+	filesCache_.clear();
+	contentCache_.clear();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void reserveIds(const std::vector<patch::Wave>& waves)
+{
+	for (const patch::Wave& w : waves)
+		waveId_.set(w.id);
 }
 
 
 /* -------------------------------------------------------------------------- */
 
 
-Result createFromFile(const std::string& path, ID id, int samplerate, int quality)
+Result createFromFile(const std::string& path, ID id, int samplerate, int quality,
+	SampleStorage storage)
 {
 	if (path == "" || u::fs::isDir(path)) {
 		u::log::print("[waveManager::create] malformed path (was '%s')\n", path);
@@ -111,10 +473,30 @@ Result createFromFile(const std::string& path, ID id, int samplerate, int qualit
 	waveId_.set(id);
 
 	std::unique_ptr<Wave> wave = std::make_unique<Wave>(waveId_.get(id));
+
+	/* Same file already loaded? Just share its data, no need to decode it
+	again. */
+
+	std::string key = makeFileKey_(path, samplerate, quality, storage);
+	if (shareFromFile_(*wave, key)) {
+		sf_close(fileIn);
+		wave->setPath(path);
+		if (header.samplerate == samplerate)
+			wave->setSourcePath(path);
+		u::log::print("[waveManager::create] %s already in memory, sharing it\n", path);
+		return { G_RES_OK, std::move(wave) };
+	}
+
 	wave->alloc(header.frames, header.channels, header.samplerate, getBits_(header), path);
 
-	if (sf_readf_float(fileIn, wave->getFrame(0), header.frames) != header.frames)
-		u::log::print("[waveManager::create] warning: incomplete read!\n");
+	for (Frame f = 0; f < header.frames;) {
+		WaveData::WritableBlock block = wave->getWritableBlock(f);
+		if (sf_readf_float(fileIn, block.data, block.frames) != block.frames) {
+			u::log::print("[waveManager::create] warning: incomplete read!\n");
+			break;
+		}
+		f += block.frames;
+	}
 
 	sf_close(fileIn);
 
@@ -128,6 +510,17 @@ Result createFromFile(const std::string& path, ID id, int samplerate, int qualit
 			return  { G_RES_ERR_PROCESSING };
 	}
 
+	if (storage != SampleStorage::FLOAT)
+		wave->setStorage(storage);
+
+	shareOrRegister_(*wave, key);
+
+	/* The file holds the very same data, unless it has been resampled. Mono
+	to stereo conversion doesn't count: it just happens again on each load. */
+
+	if (header.samplerate == samplerate)
+		wave->setSourcePath(path);
+
 	u::log::print("[waveManager::create] new Wave created, %d frames\n", wave->getSize());
 
 	return { G_RES_OK, std::move(wave) };
@@ -155,12 +548,20 @@ std::unique_ptr<Wave> createEmpty(int frames, int channels, int samplerate,
 
 std::unique_ptr<Wave> createFromWave(const Wave& src, int a, int b)
 {
-	int channels = src.getChannels();
-	int frames   = b - a;
+	int frames = b - a;
 
 	std::unique_ptr<Wave> wave = std::make_unique<Wave>(waveId_.get());
-	wave->alloc(frames, channels, src.getRate(), src.getBits(), src.getPath());
-	wave->copyData(src.getFrame(a), frames, channels);
+
+	/* No data is copied: the whole Wave data is shared, while a portion of it 
+	shares the underlying chunks. */
+
+	if (a == 0 && b == src.getSize())
+		wave->setSharedData(src.getSharedData());
+	else
+		wave->setData(src.getData().slice(a, b));
+	wave->setRate(src.getRate());
+	wave->setBits(src.getBits());
+	wave->setPath(src.getPath());
 	wave->setLogical(true);
 
 	u::log::print("[waveManager::createFromWave] new Wave created, %d frames\n", frames);
@@ -172,9 +573,10 @@ std::unique_ptr<Wave> createFromWave(const Wave& src, int a, int b)
 /* -------------------------------------------------------------------------- */
 
 
-std::unique_ptr<Wave> deserializeWave(const patch::Wave& w, int samplerate, int quality)
+std::unique_ptr<Wave> deserializeWave(const patch::Wave& w, int samplerate, int quality,
+	SampleStorage storage)
 {
-	return createFromFile(w.path, w.id, samplerate, quality).wave;
+	return createFromFile(w.path, w.id, samplerate, quality, storage).wave;
 }
 
 
@@ -189,28 +591,55 @@ const patch::Wave serializeWave(const Wave& w)
 
 int resample(Wave& w, int quality, int samplerate)
 {
-	float ratio = samplerate / (float) w.getRate();
-	int newSizeFrames = static_cast<int>(ceil(w.getSize() * ratio));
+	/* Input and output frames line up every 'q' input frames, i.e. every 'p'
+	output frames. */
+
+	const std::int64_t g = std::gcd(samplerate, w.getRate());
+	const std::int64_t p = samplerate / g;
+	const std::int64_t q = w.getRate() / g;
+	const double       ratio = samplerate / static_cast<double>(w.getRate());
 
-	AudioBuffer newData;
-	newData.alloc(newSizeFrames, w.getChannels());
+	Frame newSizeFrames = static_cast<Frame>((w.getSize() * p + q - 1) / q);
 
-	SRC_DATA src_data;
-	src_data.data_in       = w.getFrame(0);
-	src_data.input_frames  = w.getSize();
-	src_data.data_out      = newData[0];
-	src_data.output_frames = newSizeFrames;
-	src_data.src_ratio     = ratio;
+	WaveData newData(newSizeFrames, w.getChannels());
 
 	u::log::print("[waveManager::resample] resampling: new size=%d frames\n", newSizeFrames);
 
-	int ret = src_simple(&src_data, quality, w.getChannels());
-	if (ret != 0) {
-		u::log::print("[waveManager::resample] resampling error: %s\n", src_strerror(ret));
-		return G_RES_ERR_PROCESSING;
+	/* Split the job into segments bounded by aligned frames, to be processed in
+	parallel. Each segment needs some extra input around it to settle the 
+	filter state: more when downsampling, as the filter gets longer. Both are
+	rounded up to a multiple of 'q', so rates with little in common end up in 
+	longer segments. */
+
+	const std::int64_t warmupMin = static_cast<std::int64_t>(std::ceil(RESAMPLE_WARMUP / std::min(ratio, 1.0)));
+	const Frame        warmup    = static_cast<Frame>((warmupMin + q - 1) / q * q);
+	const Frame        length    = static_cast<Frame>(std::max<std::int64_t>(RESAMPLE_SEGMENT / q, 1) * q);
+
+	std::vector<Segment> segments;
+	for (Frame in = 0; in < w.getSize(); in += length) {
+		Frame inEnd = std::min<Frame>(in + length, w.getSize());
+		segments.push_back({ in, inEnd, static_cast<Frame>(in * p / q), 
+			inEnd == w.getSize() ? newSizeFrames : static_cast<Frame>(inEnd * p / q) });
 	}
 
-	w.moveData(newData);
+	std::vector<int>  results(segments.size(), 0);
+	std::vector<Span> spans = getSpans_(newData);
+
+	ThreadPool pool(G_MAX_IO_THREADS);
+	pool.run(segments.size(), [&](std::size_t i)
+	{
+		results[i] = resampleSegment_(std::as_const(w), spans, quality, ratio, 
+			segments[i], warmup);
+	});
+
+	for (int ret : results) {
+		if (ret != 0) {
+			u::log::print("[waveManager::resample] resampling error: %s\n", src_strerror(ret));
+			return G_RES_ERR_PROCESSING;
+		}
+	}
+
+	w.setData(std::move(newData));
 	w.setRate(samplerate);
 
 	return G_RES_OK;
@@ -220,12 +649,17 @@ int resample(Wave& w, int quality, int samplerate)
 /* -------------------------------------------------------------------------- */
 
 
-int save(const Wave& w, const std::string& path)
+int save(const Wave& w, const std::string& path, SampleFileFormat format)
 {
 	SF_INFO header;
 	header.samplerate = w.getRate();
 	header.channels   = w.getChannels();
-	header.format     = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+	header.format     = getFileFormat_(w, format);
+
+	/* Replace any existing file instead of overwriting it: it might be a hard
+	link to a file in another project (see persist()). */
+
+	u::fs::remove(path);
 
 	SNDFILE* file = sf_open(path.c_str(), SFM_WRITE, &header);
 	if (file == nullptr) {
@@ -234,11 +668,72 @@ int save(const Wave& w, const std::string& path)
 		return G_RES_ERR_IO;
 	}
 
-	if (sf_writef_float(file, w.getFrame(0), w.getSize()) != w.getSize())
-		u::log::print("[waveManager::save] warning: incomplete write!\n");
+	/* Integer formats: clip out-of-range values, instead of wrapping them 
+	around. */
+
+	if ((header.format & SF_FORMAT_SUBMASK) != SF_FORMAT_FLOAT && 
+	    (header.format & SF_FORMAT_SUBMASK) != SF_FORMAT_DOUBLE)
+		sf_command(file, SFC_SET_CLIPPING, nullptr, SF_TRUE);
+
+	/* Data might be stored in a compact format: decode it one chunk at a time.
+	libsndfile takes care of converting it to the output format. */
+
+	std::vector<float> buffer(std::min(w.getSize(), WaveData::CHUNK_SIZE) * w.getChannels());
+
+	for (Frame f = 0; f < w.getSize();) {
+		Frame frames = std::min(w.getSize() - f, WaveData::CHUNK_SIZE);
+		w.getData().read(f, frames, buffer.data());
+		if (sf_writef_float(file, buffer.data(), frames) != frames) {
+			u::log::print("[waveManager::save] warning: incomplete write!\n");
+			break;
+		}
+		f += frames;
+	}
 
 	sf_close(file);
 
 	return G_RES_OK;
 }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+int persist(const Wave& w, const std::string& path, SampleFileFormat format)
+{
+	std::string source = w.getSourcePath();
+
+	/* The source file is good as long as it is in the same format, as far as 
+	the extension can tell. */
+
+	if (!w.isDirty() && u::fs::fileExists(source) && u::fs::getExt(source) == u::fs::getExt(path)) {
+		if (source == path)
+			return G_RES_OK;
+		if (u::fs::linkOrCopy(source, path))
+			return G_RES_OK;
+		u::log::print("[waveManager::persist] unable to link %s, writing it instead\n", source);
+	}
+	return save(w, path, format);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::vector<int> persist(const std::vector<const Wave*>& waves, 
+	const std::vector<std::string>& paths, SampleFileFormat format, 
+	std::function<void(float)> progress)
+{
+	assert(waves.size() == paths.size());
+
+	std::vector<int> results(waves.size(), G_RES_ERR_IO);
+
+	ThreadPool pool(G_MAX_IO_THREADS);
+	pool.run(waves.size(), [&](std::size_t i)
+	{
+		results[i] = persist(*waves[i], paths[i], format);
+	}, progress);
+
+	return results;
+}
 }}} // giada::m::waveManager
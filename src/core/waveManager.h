@@ -31,6 +31,8 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <functional>
 #include "core/types.h"
 
 
@@ -54,12 +56,20 @@ Initializes internal data. */
 	
 void init();
 
+/* reserveIds
+Marks the IDs of patch Waves 'waves' as taken, so that Waves created while they
+are still being decoded in background don't get one of them. */
+
+void reserveIds(const std::vector<patch::Wave>& waves);
+
 /* create
 Creates a new Wave object with data read from file 'path'. Pass id = 0 to 
 auto-generate it. The function converts the Wave sample rate if it doesn't match
-the desired one as specified in 'samplerate'. */
+the desired one as specified in 'samplerate'. Audio data is then stored in the
+format 'storage' (see WaveData::compact()). */
 
-Result createFromFile(const std::string& path, ID id, int samplerate, int quality);
+Result createFromFile(const std::string& path, ID id, int samplerate, int quality,
+    SampleStorage storage=SampleStorage::FLOAT);
 
 /* createEmpty
 Creates a new silent Wave object. */
@@ -73,9 +83,12 @@ Creates a new Wave from an existing one, copying the data in range a - b. */
 std::unique_ptr<Wave> createFromWave(const Wave& src, int a, int b);
 
 /* (de)serializeWave
-Creates a new Wave given the patch raw data and vice versa. */
+Creates a new Wave given the patch raw data and vice versa. Waves can be 
+deserialized from multiple threads at once (see waveLoader): the shared state 
+involved, i.e. IDs and data caches, is thread-safe. */
 
-std::unique_ptr<Wave> deserializeWave(const patch::Wave& w, int samplerate, int quality);
+std::unique_ptr<Wave> deserializeWave(const patch::Wave& w, int samplerate, int quality,
+    SampleStorage storage=SampleStorage::FLOAT);
 const patch::Wave     serializeWave(const Wave& w);
 
 /* resample
@@ -85,9 +98,31 @@ algorithm to use for the conversion. */
 int resample(Wave& w, int quality, int samplerate); 
 
 /* save
-Writes Wave data to file 'path'. Only 'wav' format is supported for now. */
-
-int save(const Wave& w, const std::string& path);
+Writes Wave data to file 'path', in format 'format'. Integer formats clip values
+out of the [-1.0, 1.0] range. */
+
+int save(const Wave& w, const std::string& path, 
+    SampleFileFormat format=SampleFileFormat::WAV_FLOAT);
+
+/* persist (1)
+Makes file 'path' hold Wave data, writing it only if needed. A Wave that hasn't
+changed since it was loaded or saved (see Wave::isDirty()) is hard-linked from
+its source file instead, or copied if linking is not possible, provided that 
+they share the same file extension. */
+
+int persist(const Wave& w, const std::string& path, 
+    SampleFileFormat format=SampleFileFormat::WAV_FLOAT);
+
+/* persist (2)
+Same as persist() above, for a list of Waves, each one to the path with the 
+same index in 'paths'. Files are written (and encoded) in parallel. Returns the result of 
+each operation. The optional 'progress' callback is invoked on the calling 
+thread. */
+
+std::vector<int> persist(const std::vector<const Wave*>& waves, 
+    const std::vector<std::string>& paths, 
+    SampleFileFormat format=SampleFileFormat::WAV_FLOAT, 
+    std::function<void(float)> progress=nullptr);
 
 }}} // giada::m::waveManager
 
@@ -0,0 +1,264 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include "core/const.h"
+#include "waveSummary.h"
+
+
+namespace giada {
+namespace m 
+{
+namespace
+{
+/* READ_BINS
+How many level 0 bins are computed from each read of the audio data. */
+
+constexpr std::size_t READ_BINS = 64;
+
+
+/* -------------------------------------------------------------------------- */
+
+/* Accumulator
+Merges frames or bins into a single bin. RMS values are weighted by the 
+amount of frames they cover. */
+
+struct Accumulator
+{
+	void add(float v)
+	{
+		min    = std::min(min, v);
+		max    = std::max(max, v);
+		power += v * v;
+		count += 1;
+	}
+
+	void add(const WaveSummary::Bin& b, Frame frames)
+	{
+		min    = std::min(min, b.min);
+		max    = std::max(max, b.max);
+		power += b.rms * b.rms * frames;
+		count += frames;
+	}
+
+	WaveSummary::Bin get() const
+	{
+		if (count == 0)
+			return {0.0f, 0.0f, 0.0f};
+		return {min, max, static_cast<float>(std::sqrt(power / count))};
+	}
+
+	float  min   = std::numeric_limits<float>::max();
+	float  max   = std::numeric_limits<float>::lowest();
+	double power = 0.0;
+	Frame  count = 0;
+};
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::size_t countBins_(std::size_t size, std::size_t binSize)
+{
+	return (size + binSize - 1) / binSize;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* countBinFrames_
+Returns the frames covered by bin 'i' of a level with 'binFrames' frames per
+bin: the last one might be shorter. */
+
+Frame countBinFrames_(std::size_t i, Frame binFrames, Frame size)
+{
+	return std::min<Frame>(binFrames, size - i * binFrames);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* mix_
+Returns the mono mix of a frame, i.e. the average of its channels. */
+
+float mix_(const float* frame, int channels)
+{
+	float sum = 0.0f;
+	for (int i = 0; i < channels; i++)
+		sum += frame[i];
+	return sum / channels;
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+void WaveSummary::update(const WaveData& data)
+{
+	const Frame delta = data.countFrames() - m_data.countFrames();
+
+	/* Level 0: bins before the changed range are kept. So are bins after it,
+	as long as they are still aligned, i.e. the size has changed by a multiple
+	of BASE. Everything else is computed from the audio data. */
+
+	WaveData::Changes changes = m_levels.empty() ? WaveData::Changes{0, data.countFrames()} 
+	                                             : data.findChanges(m_data);
+
+	std::vector<Bin> bins(countBins_(data.countFrames(), BASE));
+	std::size_t first = changes.first / BASE;
+	std::size_t last  = bins.size();
+
+	if (!m_levels.empty()) {
+		const std::vector<Bin>& old = m_levels[0];
+		std::copy_n(old.begin(), first, bins.begin());
+		if (delta % BASE == 0) {
+			last = countBins_(changes.last, BASE);
+			std::copy(old.begin() + (static_cast<Frame>(last) - delta / BASE), old.end(), bins.begin() + last);
+		}
+	}
+
+	m_data = data;
+	compute(bins, first, last);
+
+	/* Levels above: cheap enough to be recomputed from the first changed bin
+	on, whatever the size change. */
+
+	std::vector<std::vector<Bin>> levels;
+	Frame binFrames = BASE;
+
+	levels.push_back(std::move(bins));
+	while (levels.back().size() > 1) {
+		const std::vector<Bin>& below = levels.back();
+		std::vector<Bin>        above(countBins_(below.size(), FACTOR));
+
+		first = std::min(first / FACTOR, above.size());
+		if (levels.size() < m_levels.size())
+			std::copy_n(m_levels[levels.size()].begin(), std::min(first, m_levels[levels.size()].size()), above.begin());
+		else
+			first = 0;
+
+		for (std::size_t i = first; i < above.size(); i++) {
+			Accumulator acc;
+			for (std::size_t k = i * FACTOR; k < std::min((i + 1) * FACTOR, below.size()); k++)
+				acc.add(below[k], countBinFrames_(k, binFrames, m_data.countFrames()));
+			above[i] = acc.get();
+		}
+
+		binFrames *= FACTOR;
+		levels.push_back(std::move(above));
+	}
+
+	m_levels = std::move(levels);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool WaveSummary::isUpToDate(const WaveData& data) const
+{
+	WaveData::Changes changes = data.findChanges(m_data);
+	return data.countFrames() == m_data.countFrames() && changes.first == changes.last;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+WaveSummary::Bin WaveSummary::get(Frame a, Frame b) const
+{
+	const Frame size     = m_data.countFrames();
+	const int   channels = m_data.countChannels();
+
+	a = std::clamp(a, 0, size);
+	b = std::clamp(b, a, size);
+
+	Accumulator acc;
+
+	if (b - a < BASE) {
+		assert(channels <= G_MAX_IO_CHANS);
+		std::array<float, BASE * G_MAX_IO_CHANS> frames;
+		m_data.read(a, b - a, frames.data());
+		for (Frame f = 0; f < b - a; f++)
+			acc.add(mix_(frames.data() + f * channels, channels));
+		return acc.get();
+	}
+
+	std::size_t level     = 0;
+	Frame       binFrames = BASE;
+	while (level + 1 < m_levels.size() && binFrames * FACTOR <= b - a) {
+		binFrames *= FACTOR;
+		level++;
+	}
+
+	for (Frame i = a / binFrames; i <= (b - 1) / binFrames; i++)
+		acc.add(m_levels[level][i], countBinFrames_(i, binFrames, size));
+	return acc.get();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame WaveSummary::countFrames() const { return m_data.countFrames(); }
+int   WaveSummary::countLevels() const { return m_levels.size(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void WaveSummary::compute(std::vector<Bin>& bins, std::size_t first, std::size_t last) const
+{
+	const Frame size     = m_data.countFrames();
+	const int   channels = m_data.countChannels();
+
+	std::vector<float> frames(READ_BINS * BASE * channels);
+
+	for (std::size_t i = first; i < last; i += READ_BINS) {
+		std::size_t n     = std::min(READ_BINS, last - i);
+		Frame       start = i * BASE;
+		Frame       count = std::min<Frame>(n * BASE, size - start);
+
+		m_data.read(start, count, frames.data());
+
+		for (std::size_t k = 0; k < n; k++) {
+			Accumulator acc;
+			for (Frame f = k * BASE; f < std::min<Frame>((k + 1) * BASE, count); f++)
+				acc.add(mix_(frames.data() + f * channels, channels));
+			bins[i + k] = acc.get();
+		}
+	}
+}
+}} // giada::m::
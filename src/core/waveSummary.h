@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef G_WAVE_SUMMARY_H
+#define G_WAVE_SUMMARY_H
+
+
+#include <vector>
+#include "core/types.h"
+#include "core/waveData.h"
+
+
+namespace giada {
+namespace m
+{
+/* WaveSummary
+Multi-resolution summary of audio data, used to draw waveforms at any zoom 
+level without scanning every frame. Level 0 holds the minimum, maximum and RMS
+value of each BASE frames of the mono mix. Each level above merges FACTOR bins
+of the level below, up to a single bin. After an edit, only bins over changed
+frames are recomputed (see WaveData::findChanges()): the summary keeps a 
+snapshot of the data it was computed from, which only costs a piece table. */
+
+class WaveSummary
+{
+public:
+
+	static constexpr Frame BASE   = 64;
+	static constexpr int   FACTOR = 4;
+
+	struct Bin
+	{
+		float min;
+		float max;
+		float rms;
+	};
+
+	/* update
+	Brings the summary up to date with 'data'. Might take a while on long 
+	data: safe to call from a worker thread on a summary not in use. */
+
+	void update(const WaveData& data);
+
+	/* isUpToDate
+	True if the summary reflects 'data'. Cheap, see WaveData::findChanges(). */
+
+	bool isUpToDate(const WaveData& data) const;
+
+	/* get
+	Returns a Bin summarizing frames [a, b), merged from the closest level whose
+	bins are not longer than the range. Bins are merged whole, so the range is 
+	rounded out to bin boundaries: good enough for drawing, where a range is a 
+	pixel. Ranges shorter than BASE frames are read from the audio data. */
+
+	Bin get(Frame a, Frame b) const;
+
+	Frame countFrames() const;
+	int countLevels() const;
+
+private:
+
+	/* compute
+	Computes bins [first, last) of level 0 from the audio data. */
+
+	void compute(std::vector<Bin>& bins, std::size_t first, std::size_t last) const;
+
+	/* m_data
+	Snapshot of the audio data the summary is computed from. */
+
+	WaveData m_data;
+
+	std::vector<std::vector<Bin>> m_levels;
+};
+}} // giada::m::
+
+
+#endif
@@ -32,6 +32,7 @@
 #include "core/recorderHandler.h"
 #include "core/recorder.h"
 #include "core/action.h"
+#include "core/plugins/plugin.h"
 #include "glue/events.h"
 #include "glue/recorder.h"
 #include "actionEditor.h"
@@ -56,18 +57,23 @@ Frame fixVerticalEnvActions_(Frame f, const m::Action& a1, const m::Action& a2)
 /* -------------------------------------------------------------------------- */
 
 /* recordFirstEnvelopeAction_
-First action ever? Add actions at boundaries. */
+First action ever? Add actions at boundaries. Volume starts at full scale, a 
+plug-in parameter at the value of the first point. */
 
-void recordFirstEnvelopeAction_(ID channelId, Frame frame, int value)
+void recordFirstEnvelopeAction_(ID channelId, Frame frame, int value, 
+	ID pluginId, int pluginParam)
 {
 	namespace mr = m::recorder;
 
+	int boundary = pluginId == -1 ? G_MAX_VELOCITY : value;
+
 	// TODO - use MidiEvent(float)
-	m::MidiEvent e1 = m::MidiEvent(m::MidiEvent::ENVELOPE, 0, G_MAX_VELOCITY);
+	m::MidiEvent e1 = m::MidiEvent(m::MidiEvent::ENVELOPE, 0, boundary);
 	m::MidiEvent e2 = m::MidiEvent(m::MidiEvent::ENVELOPE, 0, value);
-	const m::Action a1 = mr::rec(channelId, 0, e1);	
-	const m::Action a2 = mr::rec(channelId, frame, e2); 
-	const m::Action a3 = mr::rec(channelId, m::clock::getFramesInLoop() - 1, e1);
+	const m::Action a1 = mr::rec(channelId, 0, e1, pluginId, pluginParam);	
+	const m::Action a2 = mr::rec(channelId, frame, e2, pluginId, pluginParam); 
+	const m::Action a3 = mr::rec(channelId, m::clock::getFramesInLoop() - 1, e1, 
+		pluginId, pluginParam);
 
 	mr::updateSiblings(a1.id, /*prev=*/a3.id, /*next=*/a2.id); // Circular loop (begin)
 	mr::updateSiblings(a2.id, /*prev=*/a1.id, /*next=*/a3.id);
@@ -82,12 +88,13 @@ void recordFirstEnvelopeAction_(ID channelId, Frame frame, int value)
 Find action right before frame 'frame' and inject a new action in there. 
 Vertical envelope points are forbidden. */
 
-void recordNonFirstEnvelopeAction_(ID channelId, Frame frame, int value)
+void recordNonFirstEnvelopeAction_(ID channelId, Frame frame, int value, 
+	ID pluginId, int pluginParam)
 {
 	namespace mr = m::recorder;
 
-	const m::Action a1 = mr::getClosestAction(channelId, frame, m::MidiEvent::ENVELOPE);
-	const m::Action a3 = a1.next != nullptr ? *a1.next : m::Action{};
+	const m::Action a1 = mr::getClosestEnvelopeAction(channelId, frame, pluginId, pluginParam);
+	const m::Action a3 = mr::getAction(a1.nextId);
 
 	assert(a1.isValid());
 	assert(a3.isValid());
@@ -98,7 +105,7 @@ void recordNonFirstEnvelopeAction_(ID channelId, Frame frame, int value)
 
 	// TODO - use MidiEvent(float)
 	m::MidiEvent e2 = m::MidiEvent(m::MidiEvent::ENVELOPE, 0, value);
-	const m::Action a2 = mr::rec(channelId, frame, e2);
+	const m::Action a2 = mr::rec(channelId, frame, e2, pluginId, pluginParam);
 
 	mr::updateSiblings(a2.id, a1.id, a3.id);
 }
@@ -134,10 +141,11 @@ SampleData::SampleData(const m::SamplePlayer& s)
 /* -------------------------------------------------------------------------- */
 
 
-Data::Data(const m::Channel& c)
+Data::Data(const m::Channel& c, Range<Frame> frames)
 : channelId  (c.id)
 , channelName(c.state->name)
-, actions    (m::recorder::getActionsOnChannel(c.id))
+, frames     (frames)
+, actions    (m::recorder::getActionsOnChannel(c.id, frames.getBegin(), frames.getEnd()))
 {
 	if (c.getType() == ChannelType::SAMPLE)
 		sample = std::make_optional<SampleData>(*c.samplePlayer);
@@ -149,12 +157,40 @@ Data::Data(const m::Channel& c)
 /* -------------------------------------------------------------------------- */
 
 
-Data getData(ID channelId)
+Data getData(ID channelId, Range<Frame> frames)
 {
 	namespace mm = m::model;
 
 	mm::ChannelsLock cl(mm::channels);
-	return Data(mm::get(mm::channels, channelId));
+	return Data(mm::get(mm::channels, channelId), frames);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::vector<EnvelopeLane> getEnvelopeLanes(ID channelId)
+{
+	namespace mm = m::model;
+
+	std::vector<EnvelopeLane> out;
+
+	mm::ChannelsLock cl(mm::channels);
+	const m::Channel& c = mm::get(mm::channels, channelId);
+
+	if (c.getType() == ChannelType::SAMPLE)
+		out.push_back({-1, -1, "volume"});
+
+#ifdef WITH_VST
+	mm::PluginsLock pl(mm::plugins);
+	for (ID pluginId : c.pluginIds) {
+		const m::Plugin& p = mm::get(mm::plugins, pluginId);
+		for (int i = 0; i < p.getNumParameters(); i++)
+			out.push_back({pluginId, i, p.getName() + ": " + p.getParameterName(i)});
+	}
+#endif
+
+	return out;
 }
 
 
@@ -199,9 +235,11 @@ void deleteMidiAction(ID channelId, const m::Action& a)
 	/* Send a note-off first in case we are deleting it in a middle of a 
 	key_on/key_off sequence. Check if 'next' exist first: could be orphaned. */
 	
-	if (a.next != nullptr) {
-		events::sendMidiToChannel(channelId, a.next->event, Thread::MAIN);
-		mr::deleteAction(a.id, a.next->id);
+	const m::Action next = mr::getAction(a.nextId);
+
+	if (next.isValid()) {
+		events::sendMidiToChannel(channelId, next.event, Thread::MAIN);
+		mr::deleteAction(a.id, next.id);
 	}
 	else
 		mr::deleteAction(a.id);
@@ -217,7 +255,7 @@ void updateMidiAction(ID channelId, const m::Action& a, int note, int velocity,
 {
 	namespace mr = m::recorder;
 
-	mr::deleteAction(a.id, a.next->id);
+	mr::deleteAction(a.id, a.nextId);
 	recordMidiAction(channelId, note, velocity, f1, f2);
 }
 
@@ -254,7 +292,7 @@ void updateSampleAction(ID channelId, const m::Action& a, int type,
 	namespace mr = m::recorder;	
 
 	if (isSinglePressMode_(channelId))
-		mr::deleteAction(a.id, a.next->id);
+		mr::deleteAction(a.id, a.nextId);
 	else
 		mr::deleteAction(a.id);
 
@@ -270,8 +308,8 @@ void deleteSampleAction(ID channelId, const m::Action& a)
 	namespace mr = m::recorder;
 	namespace cr = c::recorder;
 
-	if (a.next != nullptr) // For ChannelMode::SINGLE_PRESS combo
-		mr::deleteAction(a.id, a.next->id);
+	if (a.nextId != 0) // For ChannelMode::SINGLE_PRESS combo
+		mr::deleteAction(a.id, a.nextId);
 	else
 		mr::deleteAction(a.id);
 
@@ -282,7 +320,8 @@ void deleteSampleAction(ID channelId, const m::Action& a)
 /* -------------------------------------------------------------------------- */
 
 
-void recordEnvelopeAction(ID channelId, Frame f, int value)
+void recordEnvelopeAction(ID channelId, Frame f, int value, ID pluginId, 
+	int pluginParam)
 {
 	namespace mr = m::recorder;	
 	namespace cr = c::recorder;	
@@ -294,10 +333,10 @@ void recordEnvelopeAction(ID channelId, Frame f, int value)
 	are forbidden for now. */
 	
 
-	if (!mr::hasActions(channelId, m::MidiEvent::ENVELOPE))
-		recordFirstEnvelopeAction_(channelId, f, value);
+	if (!mr::hasEnvelope(channelId, pluginId, pluginParam))
+		recordFirstEnvelopeAction_(channelId, f, value, pluginId, pluginParam);
 	else 
-		recordNonFirstEnvelopeAction_(channelId, f, value);
+		recordNonFirstEnvelopeAction_(channelId, f, value, pluginId, pluginParam);
 
 	recorder::updateChannel(channelId, /*updateActionEditor=*/false);
 }
@@ -325,16 +364,16 @@ void deleteEnvelopeAction(ID channelId, const m::Action& a)
 				c.volume_d = 0.0;
 			});*/
 		}
-		mr::clearActions(channelId, a.event.getStatus());
+		mr::clearEnvelope(channelId, a.pluginId, a.pluginParam);
 	}
 	else {
-		assert(a.prev != nullptr);
-		assert(a.next != nullptr);
-		
-		const m::Action a1     = *a.prev;
-		const m::Action a1prev = *a1.prev;
-		const m::Action a3     = *a.next; 
-		const m::Action a3next = *a3.next; 
+		const m::Action a1     = mr::getAction(a.prevId);
+		const m::Action a1prev = mr::getAction(a1.prevId);
+		const m::Action a3     = mr::getAction(a.nextId); 
+		const m::Action a3next = mr::getAction(a3.nextId); 
+
+		assert(a1.isValid());
+		assert(a3.isValid());
 
 		/* Original status:   a1--->a--->a3
 		   Modified status:   a1-------->a3 
@@ -367,7 +406,7 @@ void updateEnvelopeAction(ID channelId, const m::Action& a, Frame f, int value)
 		mr::updateEvent(a.id, m::MidiEvent(m::MidiEvent::ENVELOPE, 0, value));
 	else {
 		deleteEnvelopeAction(channelId, a);
-		recordEnvelopeAction(channelId, f, value);
+		recordEnvelopeAction(channelId, f, value, a.pluginId, a.pluginParam);
 	}
 }
 
@@ -375,15 +414,6 @@ void updateEnvelopeAction(ID channelId, const m::Action& a, Frame f, int value)
 /* -------------------------------------------------------------------------- */
 
 
-std::vector<m::Action> getActions(ID channelId)
-{
-	return m::recorder::getActionsOnChannel(channelId);
-}
-
-
-/* -------------------------------------------------------------------------- */
-
-
 void updateVelocity(const m::Action& a, int value)
 {
 	namespace mr = m::recorder;
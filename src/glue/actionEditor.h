@@ -33,6 +33,7 @@
 #include <vector>
 #include <string>
 #include "core/types.h"
+#include "core/range.h"
 
 
 namespace giada {
@@ -53,19 +54,42 @@ struct SampleData
 	bool             isLoopMode;
 };
 
+/* Data
+Actions are limited to the frames shown by the editor (see 
+m::recorder::getActionsOnChannel()): dense takes would be slow to copy and draw
+all at once. */
+
 struct Data
 {
     Data() = default;
-    Data(const m::Channel&);
+    Data(const m::Channel&, Range<Frame> frames);
 
     ID                     channelId; 
     std::string            channelName;
+	Range<Frame>           frames;
 	std::vector<m::Action> actions;
 
     std::optional<SampleData> sample;
 };
 
-Data getData(ID channelId);
+/* EnvelopeLane
+An envelope that can be edited: channel volume (pluginId == -1) or a plug-in
+parameter. */
+
+struct EnvelopeLane
+{
+	ID          pluginId;
+	int         pluginParam;
+	std::string name;
+};
+
+Data getData(ID channelId, Range<Frame> frames);
+
+/* getEnvelopeLanes
+Returns the envelopes available on a channel: volume for Sample Channels, then
+one for each parameter of each plug-in. */
+
+std::vector<EnvelopeLane> getEnvelopeLanes(ID channelId);
 
 /* MIDI actions.  */
 
@@ -83,9 +107,11 @@ void deleteSampleAction(ID channelId, const m::Action& a);
 void updateSampleAction(ID channelId, const m::Action& a, int type, 
     Frame f1, Frame f2=0);
 
-/* Envelope actions (only volume for now). */
+/* Envelope actions. The lane comes from the action itself, or from 'pluginId'
+and 'pluginParam' when recording. */
 
-void recordEnvelopeAction(ID channelId, Frame f, int value);
+void recordEnvelopeAction(ID channelId, Frame f, int value, ID pluginId=-1, 
+	int pluginParam=-1);
 void deleteEnvelopeAction(ID channelId, const m::Action& a);
 void updateEnvelopeAction(ID channelId, const m::Action& a, Frame f, int value);
 }}} // giada::c::actionEditor::
@@ -108,6 +108,7 @@ Frame SampleData::a_getBegin() const             { return a_get(m_samplePlayer->
 Frame SampleData::a_getEnd() const               { return a_get(m_samplePlayer->state->end); }
 bool  SampleData::a_getInputMonitor() const      { return a_get(m_audioReceiver->state->inputMonitor); }
 bool  SampleData::a_getOverdubProtection() const { return a_get(m_audioReceiver->state->overdubProtection); }
+int   SampleData::a_getInputPair() const         { return a_get(m_audioReceiver->state->inputPair); }
 
 
 /* -------------------------------------------------------------------------- */
@@ -294,6 +295,18 @@ void setOverdubProtection(ID channelId, bool value)
 /* -------------------------------------------------------------------------- */
 
 
+void setInputPair(ID channelId, int pair)
+{
+	m::model::onGet(m::model::channels, channelId, [&](m::Channel& c) 
+	{ 
+		c.audioReceiver->state->inputPair.store(pair);
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void cloneChannel(ID channelId)
 {
 	m::mh::cloneChannel(channelId);
@@ -320,6 +333,48 @@ void setSamplePlayerMode(ID channelId, SamplePlayerMode m)
 /* -------------------------------------------------------------------------- */
 
 
+void setResamplerQuality(ID channelId, ResamplerQuality q)
+{
+	m::model::onSwap(m::model::channels, channelId, [&](m::Channel& c)
+	{
+		c.samplePlayer->setResamplerQuality(q);
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void setPolyphony(ID channelId, int p)
+{
+	m::model::onSwap(m::model::channels, channelId, [&](m::Channel& c)
+	{
+		c.samplePlayer->setPolyphony(p);
+	});
+}
+
+
+void setVoiceStealing(ID channelId, VoiceStealing s)
+{
+	m::model::onSwap(m::model::channels, channelId, [&](m::Channel& c)
+	{
+		c.samplePlayer->setVoiceStealing(s);
+	});
+}
+
+
+void setRootNote(ID channelId, int note)
+{
+	m::model::onSwap(m::model::channels, channelId, [&](m::Channel& c)
+	{
+		c.samplePlayer->setRootNote(note);
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void setHeight(ID channelId, Pixel p)
 {
 	m::model::onGet(m::model::channels, channelId, [&](m::Channel& c)
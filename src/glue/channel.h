@@ -56,6 +56,7 @@ struct SampleData
 	Frame a_getEnd() const;
 	bool  a_getInputMonitor() const;
 	bool  a_getOverdubProtection() const;
+	int   a_getInputPair() const;
 
 	ID               waveId;
 	SamplePlayerMode mode;
@@ -175,10 +176,20 @@ Sets several channel properties. */
 
 void setInputMonitor(ID channelId, bool value);
 void setOverdubProtection(ID channelId, bool value);
+void setInputPair(ID channelId, int pair);
 void setName(ID channelId, const std::string& name);
 void setHeight(ID channelId, Pixel p);
 
 void setSamplePlayerMode(ID channelId, SamplePlayerMode m);
+void setResamplerQuality(ID channelId, ResamplerQuality q);
+
+/* setPolyphony, setVoiceStealing, setRootNote
+Voice settings of a sample channel. A root note below zero disables the keyed
+mode, i.e. playing the sample chromatically from MIDI notes. */
+
+void setPolyphony(ID channelId, int p);
+void setVoiceStealing(ID channelId, VoiceStealing s);
+void setRootNote(ID channelId, int note);
 }}} // giada::c::channel::
 
 #endif
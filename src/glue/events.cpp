@@ -26,6 +26,9 @@
 
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <vector>
 #include <FL/Fl.H>
 #include "core/model/model.h"
 #include "core/const.h"
@@ -37,6 +40,7 @@
 #include "core/mixerHandler.h"
 #include "core/conf.h"
 #include "core/recManager.h"
+#include "core/recorderHandler.h"
 #include "utils/log.h"
 #include "gui/dialogs/sampleEditor.h"
 #include "gui/dialogs/mainWindow.h"
@@ -78,6 +82,38 @@ void pushEvent_(m::mixer::Event e, Thread t)
 	if (!res)
 		G_DEBUG("[events] Queue full!\n");
 }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+#ifdef WITH_VST
+/* recPluginParameter_
+Records a plug-in parameter change as an envelope point on the channel that
+owns the plug-in, the same way channels record live actions. */
+
+void recPluginParameter_(ID pluginId, int paramIndex, float value, Thread t)
+{
+	namespace mm = m::model;
+
+	if (!m::recManager::isRecordingAction() || !m::clock::isRunning() || 
+	    m::recManager::isRecordingInput())
+		return;
+
+	mm::ChannelsLock cl(mm::channels);
+
+	for (const m::Channel* ch : mm::channels) {
+		const std::vector<ID>& ids = ch->pluginIds;
+		if (std::find(ids.begin(), ids.end(), pluginId) == ids.end())
+			continue;
+		m::MidiEvent e = m::MidiEvent(m::MidiEvent::ENVELOPE, 0, 
+			static_cast<int>(std::lround(value * G_MAX_VELOCITY)));
+		m::recorderHandler::liveRec(ch->id, e, m::clock::getCurrentFrame(), t, 
+			pluginId, paramIndex);
+		return;
+	}
+}
+#endif
 } // {anonymous}
 
 
@@ -297,6 +333,7 @@ void toggleInputRecording()
 void setPluginParameter(ID pluginId, int paramIndex, float value, bool gui)
 {
 	m::pluginHost::setPluginParameter(pluginId, paramIndex, value);
+	recPluginParameter_(pluginId, paramIndex, value, gui ? Thread::MAIN : Thread::MIDI);
 	c::plugin::updateWindow(pluginId, gui);
 }
 #endif
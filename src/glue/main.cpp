@@ -42,6 +42,7 @@
 #include "core/mixer.h"
 #include "core/clock.h"
 #include "core/init.h"
+#include "core/autosave.h"
 #include "core/kernelMidi.h"
 #include "core/kernelAudio.h"
 #include "core/recorder.h"
@@ -78,7 +79,6 @@ void setBpm_(float current, std::string s)
 	float previous = m::clock::getBpm();
 	m::clock::setBpm(current);
 	m::recorderHandler::updateBpm(previous, current, m::clock::getQuantizerStep());
-	m::mixer::allocRecBuffer(m::clock::getFramesInLoop());
 
 	/* This function might get called by Jack callback BEFORE the UI is up
 	and running, that is when G_MainWin == nullptr. */
@@ -227,7 +227,6 @@ void setBeats(int beats, int bars)
 		return;
 
 	m::clock::setBeats(beats, bars);
-	m::mixer::allocRecBuffer(m::clock::getFramesInLoop());
 
 	G_MainWin->mainTimer->setMeter(m::clock::getBeats(), m::clock::getBars());
 	u::gui::refreshActionEditor();  // in case the action editor is open
@@ -301,5 +300,6 @@ void closeProject()
 		return;
 	m::init::reset();
 	m::mixer::enable();
+	m::autosave::reset(m::patch::Patch());
 }
 }}} // giada::c::main::
@@ -37,6 +37,7 @@
 #include "core/plugins/plugin.h"
 #include "core/const.h"
 #include "core/conf.h"
+#include "core/recorder.h"
 #include "utils/gui.h"
 #include "gui/dialogs/mainWindow.h"
 #include "gui/dialogs/pluginWindow.h"
@@ -44,6 +45,7 @@
 #include "gui/dialogs/warnings.h"
 #include "gui/dialogs/config.h"
 #include "gui/dialogs/browser/browserDir.h"
+#include "recorder.h"
 #include "plugin.h"
 
 
@@ -202,6 +204,8 @@ void swapPlugins(ID pluginId1, ID pluginId2, ID channelId)
 void freePlugin(ID pluginId, ID channelId)
 {
 	m::pluginHost::freePlugin(pluginId, channelId);
+	m::recorder::clearPluginActions(pluginId);
+	recorder::updateChannel(channelId, /*updateActionEditor=*/true);
 }
 
 
@@ -63,7 +63,7 @@ void clearVolumeActions(ID channelId)
 {
 	if (!v::gdConfirmWin("Warning", "Clear all volume actions: are you sure?"))
 		return;
-	m::recorder::clearActions(channelId, m::MidiEvent::ENVELOPE);
+	m::recorder::clearEnvelope(channelId);
 	updateChannel(channelId, /*updateActionEditor=*/true);
 }
 
@@ -26,6 +26,10 @@
 
 
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <map>
 #include <FL/Fl.H>
 #include "glue/events.h"
 #include "gui/dialogs/mainWindow.h"
@@ -43,7 +47,12 @@
 #include "gui/elems/mainWindow/keyboard/keyboard.h"
 #include "gui/elems/mainWindow/keyboard/channel.h"
 #include "core/model/model.h"
+#include "core/channels/state.h"
+#include "core/clock.h"
+#include "core/conf.h"
 #include "core/wave.h"
+#include "core/waveHistory.h"
+#include "core/waveSummary.h"
 #include "core/waveManager.h"
 #include "core/mixerHandler.h"
 #include "core/const.h"
@@ -69,6 +78,25 @@ std::unique_ptr<m::Wave> waveBuffer_;
 
 Frame previewTracker_ = 0;
 
+/* history_
+Undo/redo history of the Wave currently in the sample editor, identified by
+historyWaveId_. */
+
+m::WaveHistory history_;
+ID             historyWaveId_ = 0;
+
+/* Summary, summaries_
+Waveform summaries by Wave ID: the last one computed and the one being computed
+in background, if any. */
+
+struct Summary
+{
+	std::shared_ptr<const m::WaveSummary>              ready;
+	std::future<std::shared_ptr<const m::WaveSummary>> pending;
+};
+
+std::map<ID, Summary> summaries_;
+
 
 /* -------------------------------------------------------------------------- */
 
@@ -104,6 +132,112 @@ void updateWavePtr_(ID channelId, ID waveId)
 		c.samplePlayer->loadWave(&wave);
 	});
 }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Frame getShift_(ID channelId)
+{
+	Frame shift = 0;
+	m::model::onGet(m::model::channels, channelId, [&](const m::Channel& c)
+	{
+		shift = c.samplePlayer->state->shift.load();
+	});
+	return shift;
+}
+
+
+void setShift_(ID channelId, Frame shift)
+{
+	m::model::onGet(m::model::channels, channelId, [&](m::Channel& c)
+	{
+		c.samplePlayer->state->shift.store(shift);
+	});
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getWaveData_
+Returns a copy of the Wave audio data. Cheap: chunks are shared, not copied. */
+
+m::WaveData getWaveData_(ID waveId)
+{
+	m::model::WavesLock lock(m::model::waves);
+	return m::model::get(m::model::waves, waveId).getData();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* getHistory_
+Returns the undo/redo history for Wave 'waveId', starting a new one if the 
+Wave has changed (e.g. a different channel has been opened or the sample has
+been reloaded). */
+
+m::WaveHistory& getHistory_(ID waveId)
+{
+	if (waveId != historyWaveId_) {
+		history_.clear();
+		historyWaveId_ = waveId;
+	}
+	history_.setMaxBytes(static_cast<std::size_t>(m::conf::conf.sampleEditorUndoMemory) * 1024 * 1024);
+	return history_;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* edit_
+Performs the destructive edit 'f' on Wave 'waveId' and records it in the 
+undo/redo history. Leaves the channel with shift value 'shift'. Compact data 
+(see conf::sampleStorage) is promoted to float by the edit itself, only where
+written to: the history keeps sharing the untouched chunks. */
+
+void edit_(ID channelId, ID waveId, std::function<void()> f, Frame shift=0)
+{
+	m::WaveData before      = getWaveData_(waveId);
+	Frame       shiftBefore = getShift_(channelId);
+
+	f();
+	updateWavePtr_(channelId, waveId);
+	setShift_(channelId, shift);
+
+	getHistory_(waveId).push(std::move(before), getWaveData_(waveId), shiftBefore, shift);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* restore_
+Replaces the Wave audio data with a snapshot from the undo/redo history. Begin
+and end points survive as long as the length doesn't change (e.g. undoing a 
+fade). */
+
+void restore_(ID channelId, ID waveId, const m::WaveData& data, Frame shift)
+{
+	Frame begin, end, size;
+	m::model::onGet(m::model::channels, channelId, [&](const m::Channel& c)
+	{
+		begin = c.samplePlayer->state->begin.load();
+		end   = c.samplePlayer->state->end.load();
+		size  = c.samplePlayer->getWaveSize();
+	});
+
+	m::model::onSwap(m::model::waves, waveId, [&](m::Wave& w)
+	{
+		w.setData(data);
+		w.setEdited(true);
+	});
+	updateWavePtr_(channelId, waveId);
+	setShift_(channelId, shift);
+
+	if (data.countFrames() == size)
+		setBeginEnd(channelId, begin, end);
+	else
+		resetBeginEnd_(channelId);
+}
 } // {anonymous}
 
 
@@ -119,9 +253,15 @@ Data::Data(const m::Channel& c, const m::Wave& w)
 , volume      (c.state->volume.load())
 , pan         (c.state->pan.load())
 , pitch       (c.samplePlayer->state->pitch.load())
+, resamplerQuality(c.samplePlayer->getResamplerQuality())
+, polyphony   (c.samplePlayer->getPolyphony())
+, voiceStealing(c.samplePlayer->getVoiceStealing())
+, rootNote    (c.samplePlayer->getRootNote())
 , begin       (c.samplePlayer->state->begin.load())
 , end         (c.samplePlayer->state->end.load())
 , shift       (c.samplePlayer->state->shift.load())
+, stretchToTempo(c.samplePlayer->state->stretchToTempo.load())
+, stretchBeats(c.samplePlayer->state->stretchBeats.load())
 , waveSize    (w.getSize())
 , waveBits    (w.getBits())
 , waveDuration(w.getDuration())
@@ -225,8 +365,7 @@ void setBeginEnd(ID channelId, int b, int e)
 void cut(ID channelId, ID waveId, int a, int b)
 {
 	copy(waveId, a, b);
-	m::wfx::cut(waveId, a, b);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::cut(waveId, a, b); });
 	resetBeginEnd_(channelId);
 }
 
@@ -251,8 +390,7 @@ void paste(ID channelId, ID waveId, int a)
 		return;
 	}
 
-	m::wfx::paste(*waveBuffer_, waveId, a);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::paste(*waveBuffer_, waveId, a); });
 
 	/* Shift begin/end points to keep the previous position. */
 
@@ -281,8 +419,7 @@ void paste(ID channelId, ID waveId, int a)
 
 void silence(ID channelId, ID waveId, int a, int b)
 {
-	m::wfx::silence(waveId, a, b);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::silence(waveId, a, b); });
 }
 
 
@@ -291,8 +428,7 @@ void silence(ID channelId, ID waveId, int a, int b)
 
 void fade(ID channelId, ID waveId, int a, int b, m::wfx::Fade type)
 {
-	m::wfx::fade(waveId, a, b, type);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::fade(waveId, a, b, type); });
 }
 
 
@@ -301,8 +437,7 @@ void fade(ID channelId, ID waveId, int a, int b, m::wfx::Fade type)
 
 void smoothEdges(ID channelId, ID waveId, int a, int b)
 {
-	m::wfx::smooth(waveId, a, b);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::smooth(waveId, a, b); });
 }
 
 
@@ -311,8 +446,7 @@ void smoothEdges(ID channelId, ID waveId, int a, int b)
 
 void reverse(ID channelId, ID waveId, int a, int b)
 {
-	m::wfx::reverse(waveId, a, b);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::reverse(waveId, a, b); });
 }
 
 
@@ -321,8 +455,7 @@ void reverse(ID channelId, ID waveId, int a, int b)
 
 void normalize(ID channelId, ID waveId, int a, int b)
 {
-	m::wfx::normalize(waveId, a, b);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::normalize(waveId, a, b); });
 }
 
 
@@ -331,8 +464,7 @@ void normalize(ID channelId, ID waveId, int a, int b)
 
 void trim(ID channelId, ID waveId, int a, int b)
 {
-	m::wfx::trim(waveId, a, b);
-	updateWavePtr_(channelId, waveId);
+	edit_(channelId, waveId, [&] { m::wfx::trim(waveId, a, b); });
 	resetBeginEnd_(channelId);
 }
 
@@ -412,6 +544,48 @@ bool isWaveBufferFull()
 /* -------------------------------------------------------------------------- */
 
 
+std::shared_ptr<const m::WaveSummary> getSummary(ID waveId)
+{
+	/* Forget about Waves gone in the meantime. */
+
+	for (auto it = summaries_.begin(); it != summaries_.end();) {
+		if (m::model::exists(m::model::waves, it->first))
+			++it;
+		else
+			it = summaries_.erase(it);
+	}
+
+	if (!m::model::exists(m::model::waves, waveId))
+		return nullptr;
+
+	Summary& s = summaries_[waveId];
+
+	if (s.pending.valid() && s.pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		s.ready = s.pending.get();
+
+	/* Start a new job if the Wave has changed since the last summary, which is
+	copied and updated: only changed parts are computed again. */
+
+	if (!s.pending.valid()) {
+		m::WaveData data = getWaveData_(waveId);
+		if (s.ready == nullptr || !s.ready->isUpToDate(data)) {
+			s.pending = std::async(std::launch::async, [data = std::move(data), old = s.ready]()
+			{
+				auto summary = old != nullptr ? std::make_shared<m::WaveSummary>(*old) 
+				                              : std::make_shared<m::WaveSummary>();
+				summary->update(data);
+				return std::shared_ptr<const m::WaveSummary>(summary);
+			});
+		}
+	}
+
+	return s.ready;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void reload(ID channelId, ID waveId)
 {
 	if (!v::gdConfirmWin("Warning", "Reload sample: are you sure?"))
@@ -437,20 +611,71 @@ void reload(ID channelId, ID waveId)
 
 void shift(ID channelId, ID waveId, int offset)
 {
-	Frame shift;
-	m::model::onGet(m::model::channels, channelId, [&](const m::Channel& c)
+	Frame shift = getShift_(channelId);
+	
+	edit_(channelId, waveId, [&] { m::wfx::shift(waveId, offset - shift); }, offset);
+
+	getSampleEditorWindow()->shiftTool->update(offset);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void undo(ID channelId, ID waveId)
+{
+	const m::WaveHistory::Entry* e = getHistory_(waveId).undo();
+	if (e == nullptr) {
+		u::log::print("[sampleEditor::undo] Nothing to undo\n");
+		return;
+	}
+	restore_(channelId, waveId, e->before, e->shiftBefore);
+	getSampleEditorWindow()->shiftTool->update(e->shiftBefore);
+}
+
+
+void redo(ID channelId, ID waveId)
+{
+	const m::WaveHistory::Entry* e = getHistory_(waveId).redo();
+	if (e == nullptr) {
+		u::log::print("[sampleEditor::redo] Nothing to redo\n");
+		return;
+	}
+	restore_(channelId, waveId, e->after, e->shiftAfter);
+	getSampleEditorWindow()->shiftTool->update(e->shiftAfter);
+}
+
+
+bool canUndo(ID waveId) { return waveId == historyWaveId_ && history_.canUndo(); }
+bool canRedo(ID waveId) { return waveId == historyWaveId_ && history_.canRedo(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void setStretchToTempo(ID channelId, bool v)
+{
+	m::model::onGet(m::model::channels, channelId, [&](m::Channel& c)
 	{
-		shift = c.samplePlayer->state->shift.load();
+		m::SamplePlayerState& s = *c.samplePlayer->state;
+		if (v && s.stretchBeats.load() <= 0.0f) {
+			float beats = (s.end.load() - s.begin.load()) / static_cast<float>(m::clock::getFramesInBeat());
+			s.stretchBeats.store(std::max(1.0f, std::round(beats)));
+		}
+		s.stretchToTempo.store(v);
 	});
-	
-	m::wfx::shift(waveId, offset - shift);
-	updateWavePtr_(channelId, waveId);
 
+	getSampleEditorWindow()->rebuild();
+}
+
+
+void setStretchBeats(ID channelId, float beats)
+{
 	m::model::onGet(m::model::channels, channelId, [&](m::Channel& c)
 	{
-		c.samplePlayer->state->shift.store(offset);
+		c.samplePlayer->state->stretchBeats.store(std::max(0.0f, beats));
 	});
 
-	getSampleEditorWindow()->shiftTool->update(offset);
+	getSampleEditorWindow()->rebuild();
 }
 }}} // giada::c::sampleEditor::
@@ -30,6 +30,7 @@
 
 
 #include <functional>
+#include <memory>
 #include <string>
 #include "core/types.h"
 #include "core/waveFx.h"
@@ -40,6 +41,7 @@ namespace m
 {
 class Channel;
 class Wave;
+class WaveSummary;
 }
 namespace v 
 {
@@ -62,9 +64,15 @@ struct Data
     float       volume;
     float       pan;
     float       pitch;
+    ResamplerQuality resamplerQuality;
+    int         polyphony;
+    VoiceStealing voiceStealing;
+    int         rootNote;
     Frame       begin;
     Frame       end;
     Frame       shift;
+    bool        stretchToTempo;
+    float       stretchBeats;
     Frame       waveSize;
     int         waveBits;
     int         waveDuration;
@@ -98,10 +106,35 @@ void silence(ID channelId, ID waveId, int a, int b);
 void fade(ID channelId, ID waveId, int a, int b, m::wfx::Fade type);
 void smoothEdges(ID channelId, ID waveId, int a, int b);
 void shift(ID channelId, ID waveId, int offset);
+
+/* setStretchToTempo, setStretchBeats
+Make the sample follow the tempo without changing pitch, lasting 'beats' beats.
+When enabled for the first time, the length in beats is guessed from the 
+current tempo. */
+
+void setStretchToTempo(ID channelId, bool v);
+void setStretchBeats(ID channelId, float beats);
 void reload(ID channelId, ID waveId);
 
+/* undo, redo
+Revert/reapply the last destructive edit made on Wave 'waveId'. Memory used by
+the history is bounded by conf::sampleEditorUndoMemory. */
+
+void undo(ID channelId, ID waveId);
+void redo(ID channelId, ID waveId);
+bool canUndo(ID waveId);
+bool canRedo(ID waveId);
+
 bool isWaveBufferFull();
 
+/* getSummary
+Returns the min/max/RMS summary of Wave 'waveId' used to draw the waveform, or
+nullptr if not available yet. The summary is computed in background the first
+time, then updated in background whenever the Wave changes: the one returned
+might be out of date for a while. Call it again later to get the new one. */
+
+std::shared_ptr<const m::WaveSummary> getSummary(ID waveId);
+
 void playPreview(bool loop);
 void stopPreview();
 void setPreviewTracker(Frame f);
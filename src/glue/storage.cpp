@@ -25,7 +25,14 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <atomic>
 #include <cassert>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <FL/Fl.H>
 #include "core/model/model.h"
 #include "core/model/storage.h"
 #include "core/mixer.h"
@@ -37,8 +44,10 @@
 #include "core/plugins/plugin.h"
 #include "core/conf.h"
 #include "core/patch.h"
+#include "core/autosave.h"
 #include "core/init.h"
 #include "core/waveManager.h"
+#include "core/waveLoader.h"
 #include "core/clock.h"
 #include "core/wave.h"
 #include "utils/gui.h"
@@ -67,9 +76,31 @@ namespace storage
 {
 namespace
 {
-std::string makeWavePath_(const std::string& base, const m::Wave& w, int k)
+/* SaveJob
+Samples of a project being written to disk in background, and what to do once
+they are done. See saveProject(). */
+
+struct SaveJob
+{
+	std::unique_ptr<Fl_Widget_Tracker> browser;
+	std::string                        name;
+	std::string                        gptcPath;
+	std::vector<m::Wave>               waves;
+	std::vector<std::string>           paths;
+	std::atomic<float>                 progress{0.0f};
+	std::future<std::vector<int>>      results;
+};
+
+std::unique_ptr<SaveJob> saveJob_;
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::string makeWavePath_(const std::string& base, const m::Wave& w, 
+	const std::string& ext, int k)
 {
-	return base + G_SLASH + w.getBasename(/*ext=*/false) + "-" + std::to_string(k) + "." +  w.getExtension();
+	return base + G_SLASH + w.getBasename(/*ext=*/false) + "-" + std::to_string(k) + "." +  ext;
 } 
 
 
@@ -83,17 +114,24 @@ bool isWavePathUnique_(const m::Wave& skip, const std::string& path)
 	return true;
 }
 
-std::string makeUniqueWavePath_(const std::string& base, const m::Wave& w)
+/* makeUniqueWavePath_
+Returns a path in 'base' for Wave 'w', not used by any other Wave. Files are 
+written with the same extension as the original one, unless the format requires
+a specific one. */
+
+std::string makeUniqueWavePath_(const std::string& base, const m::Wave& w, 
+	SampleFileFormat format)
 {
-	std::string path = base + G_SLASH + w.getBasename(/*ext=*/true);
+	std::string ext  = format == SampleFileFormat::FLAC ? "flac" : w.getExtension();
+	std::string path = base + G_SLASH + w.getBasename(/*ext=*/false) + "." + ext;
 	if (isWavePathUnique_(w, path))
 		return path;
 
 	// TODO - just use a timestamp. e.g. makeWavePath_(..., ..., getTimeStamp())
 	int k = 0;
-	path = makeWavePath_(base, w, k);
+	path = makeWavePath_(base, w, ext, k);
 	while (!isWavePathUnique_(w, path))
-		path = makeWavePath_(base, w, k++);
+		path = makeWavePath_(base, w, ext, k++);
 	
 	return path;
 }
@@ -109,11 +147,12 @@ bool savePatch_(const std::string& path, const std::string& name)
 	m::model::store(m::patch::patch);
 	v::model::store(m::patch::patch);
 
-	if (!m::patch::write(path))
+	if (!m::patch::write(path, static_cast<PatchFormat>(m::conf::conf.projectPatchFormat)))
 		return false;
 
 	u::gui::updateMainWinLabel(name);
 	m::conf::conf.patchPath = u::fs::getUpDir(u::fs::getUpDir(path));
+	m::autosave::reset(m::patch::patch);
 	u::log::print("[savePatch] patch saved as %s\n", path);
 
 	return true;
@@ -123,16 +162,138 @@ bool savePatch_(const std::string& path, const std::string& name)
 /* -------------------------------------------------------------------------- */
 
 
-void saveWavesToProject_(const std::string& basePath)
+/* prepareWavesToProject_
+Assigns a path in 'basePath' to each Wave and fills 'job' with the Waves to be
+written. Works on copies of the Waves (they are cheap, data is shared), so that
+the model is not locked while writing. */
+
+void prepareWavesToProject_(const std::string& basePath, SampleFileFormat format,
+	SaveJob& job)
 {
 	/* No need for a hard Wave swap here: nobody is reading the path data. */
 
 	m::model::WavesLock l(m::model::waves);
-
 	for (m::Wave* w : m::model::waves) {
-		w->setPath(makeUniqueWavePath_(basePath, *w));
-		m::waveManager::save(*w, w->getPath()); // TODO - error checking			
+
+		/* Waves sharing the same audio data are written to disk only once. */
+
+		auto it = std::find_if(job.waves.begin(), job.waves.end(), [w](const m::Wave& s) 
+		{ 
+			return s.isSharingData(*w); 
+		});
+		if (it != job.waves.end()) {
+			w->setPath(it->getPath());
+			continue;
+		}
+
+		w->setPath(makeUniqueWavePath_(basePath, *w, format));
+		job.waves.push_back(*w);
+		job.paths.push_back(w->getPath());
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* finalizeWavesToProject_
+Written files become the new source files, for Waves that haven't been modified
+in the meantime. Returns false if any Wave failed to save. */
+
+bool finalizeWavesToProject_(const SaveJob& job, const std::vector<int>& results)
+{
+	m::model::WavesLock l(m::model::waves);
+
+	bool ok = true;
+	for (std::size_t i = 0; i < job.waves.size(); i++) {
+		if (results[i] != G_RES_OK) {
+			u::log::print("[finalizeWavesToProject] unable to save %s\n", job.paths[i]);
+			ok = false;
+			continue;
+		}
+		for (m::Wave* w : m::model::waves)
+			if (w->isSharingData(job.waves[i]))
+				w->setSourcePath(job.paths[i]);
 	}
+	return ok;
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* pollSaveJob_
+Called periodically from the main loop while samples are being written. Updates
+the progress bar, then finishes the job (patch included) once the background
+work is over. */
+
+void pollSaveJob_(void* /*p*/)
+{
+	assert(saveJob_ != nullptr);
+
+	v::gdBrowserSave* browser = static_cast<v::gdBrowserSave*>(saveJob_->browser->widget());
+
+	if (saveJob_->results.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		if (browser != nullptr)
+			browser->setStatusBar(saveJob_->progress.load());
+		Fl::repeat_timeout(G_GUI_REFRESH_RATE, pollSaveJob_, nullptr);
+		return;
+	}
+
+	std::unique_ptr<SaveJob> job = std::move(saveJob_);
+
+	bool wavesSaved = finalizeWavesToProject_(*job, job->results.get());
+
+	G_MainWin->activate();
+	if (browser != nullptr) {
+		browser->hideStatusBar();
+		browser->activate();
+	}
+
+	if (!wavesSaved)
+		v::gdAlert("Some samples could not be saved.");
+
+	if (!savePatch_(job->gptcPath, job->name))
+		v::gdAlert("Unable to save the project!");
+	else
+	if (browser != nullptr)
+		browser->do_callback();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* loadPatch_
+Fills the model with the current patch. */
+
+void loadPatch_()
+{
+	/* Reset the system first (it disables mixer), then fill the model. Samples
+	are decoded in background: channels become playable one by one, as soon as
+	their Wave is ready. */
+
+	m::init::reset();
+	m::model::load(m::patch::patch);
+	v::model::load(m::patch::patch);
+
+	/* Prepare the engine. Recorder has to recompute the actions positions if 
+	the current samplerate != patch samplerate. Clock needs to update frames
+	in sequencer. */
+
+	m::mh::updateSoloCount();
+	m::recorderHandler::updateSamplerate(m::conf::conf.samplerate, m::patch::patch.samplerate);
+	m::clock::recomputeFrames();
+
+	/* Mixer is ready to go back online. */
+
+	m::mixer::enable();
+
+	u::gui::updateMainWinLabel(m::patch::patch.name);
+
+#ifdef WITH_VST
+
+	if (m::pluginManager::hasMissingPlugins())
+		v::gdAlert("Some plugins were not loaded successfully.\nCheck the plugin browser to know more.");
+
+#endif
 }
 } // {anonymous}
 
@@ -179,37 +340,13 @@ void loadProject(void* data)
 	if (!isProject)
 		v::gdAlert("Support for raw patches is deprecated\nand will be removed soon!");
 
-	/* Then reset the system (it disables mixer) and fill the model. */
-
-	m::init::reset();
-	m::model::load(m::patch::patch);
-	v::model::load(m::patch::patch);
-
-	/* Prepare the engine. Recorder has to recompute the actions positions if 
-	the current samplerate != patch samplerate. Clock needs to update frames
-	in sequencer. */
-
-	m::mh::updateSoloCount();
-	m::recorderHandler::updateSamplerate(m::conf::conf.samplerate, m::patch::patch.samplerate);
-	m::clock::recomputeFrames();
-	m::mixer::allocRecBuffer(m::clock::getFramesInLoop());
-
-	/* Mixer is ready to go back online. */
-
-	m::mixer::enable();
+	loadPatch_();
+	m::autosave::reset(m::patch::patch);
 
 	/* Utilities and cosmetics. Save patchPath by taking the last dir of the 
-	broswer, in order to reuse it the next time. Also update UI. */
+	broswer, in order to reuse it the next time. */
 
 	m::conf::conf.patchPath = u::fs::dirname(fullPath);
-	u::gui::updateMainWinLabel(m::patch::patch.name);
-
-#ifdef WITH_VST
-
-	if (m::pluginManager::hasMissingPlugins())
-		v::gdAlert("Some plugins were not loaded successfully.\nCheck the plugin browser to know more.");
-
-#endif
 
 	browser->do_callback();
 }
@@ -226,6 +363,9 @@ void saveProject(void* data)
 	std::string fullPath      = folderPath + G_SLASH + name + ".gprj";
 	std::string gptcPath      = fullPath + G_SLASH + name + ".gptc";
 
+	if (saveJob_ != nullptr)  // Still saving the previous one
+		return;
+
 	if (name == "") {
 		v::gdAlert("Please choose a project name.");
 		return;
@@ -241,13 +381,56 @@ void saveProject(void* data)
 
 	u::log::print("[saveProject] Project dir created: %s\n", fullPath);
 
-	saveWavesToProject_(fullPath);
+	/* Samples still loading in background must be part of the project too. */
 
-	if (savePatch_(gptcPath, name))
-		browser->do_callback();
-	else
-		v::gdAlert("Unable to save the project!");
+	m::waveLoader::wait();
+	m::mh::bindLoadedWaves();
+
+	SampleFileFormat format = static_cast<SampleFileFormat>(m::conf::conf.projectSampleFormat);
+
+	saveJob_ = std::make_unique<SaveJob>();
+	saveJob_->browser  = std::make_unique<Fl_Widget_Tracker>(browser);
+	saveJob_->name     = name;
+	saveJob_->gptcPath = gptcPath;
+	prepareWavesToProject_(fullPath, format, *saveJob_);
+
+	/* Only new or modified Waves are actually written (and encoded), in 
+	parallel, on a background thread. The UI is locked in the meantime and 
+	polls for completion: see pollSaveJob_(). */
+
+	saveJob_->results = std::async(std::launch::async, [job = saveJob_.get(), format]()
+	{
+		std::vector<const m::Wave*> waves;
+		for (const m::Wave& w : job->waves)
+			waves.push_back(&w);
+		return m::waveManager::persist(waves, job->paths, format, [job](float progress)
+		{
+			job->progress.store(progress);
+		});
+	});
+
+	G_MainWin->deactivate();
+	browser->deactivate();
+	browser->showStatusBar();
+	Fl::add_timeout(G_GUI_REFRESH_RATE, pollSaveJob_, nullptr);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void recoverSession(const std::string& dir)
+{
+	u::log::print("[recoverSession] recover from %s\n", dir);
+
+	m::patch::init();
+	if (m::autosave::recover(dir, m::patch::patch) != G_PATCH_OK) {
+		m::patch::init();
+		v::gdAlert("Unable to recover the last session.");
+		return;
+	}
 
+	loadPatch_();
 }
 
 
@@ -29,6 +29,9 @@
 #define G_GLUE_STORAGE_H
 
 
+#include <string>
+
+
 namespace giada {
 namespace c {
 namespace storage
@@ -37,6 +40,12 @@ void loadProject(void* data);
 void saveProject(void* data);
 void saveSample (void* data);
 void loadSample (void* data);
+
+/* recoverSession
+Loads the session left in autosave directory 'dir' by a crash. See 
+m::autosave. */
+
+void recoverSession(const std::string& dir);
 }}} // giada::c::storage::
 
 #endif
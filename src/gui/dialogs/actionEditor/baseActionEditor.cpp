@@ -25,10 +25,12 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <FL/Fl.H>
 #include <FL/fl_draw.H>
+#include <FL/Fl_Scrollbar.H>
 #include "utils/gui.h"
 #include "utils/string.h"
 #include "core/conf.h"
@@ -49,6 +51,7 @@ namespace v
 gdBaseActionEditor::gdBaseActionEditor(ID channelId)
 : gdWindow (640, 284)
 , channelId(channelId)
+, viewport (nullptr)
 , ratio    (G_DEFAULT_ZOOM_RATIO)
 {
 	using namespace giada::m;
@@ -81,6 +84,7 @@ gdBaseActionEditor::~gdBaseActionEditor()
 
 void gdBaseActionEditor::cb_zoomIn(Fl_Widget* /*w*/, void* p)  { ((gdBaseActionEditor*)p)->zoomIn(); }
 void gdBaseActionEditor::cb_zoomOut(Fl_Widget* /*w*/, void* p) { ((gdBaseActionEditor*)p)->zoomOut(); }
+void gdBaseActionEditor::cb_scroll(Fl_Widget* w, void* p)      { ((gdBaseActionEditor*)p)->scroll(static_cast<Fl_Scrollbar*>(w)->value()); }
 
 
 /* -------------------------------------------------------------------------- */
@@ -152,7 +156,7 @@ void gdBaseActionEditor::zoomOut()
 void gdBaseActionEditor::centerViewportIn()
 {
 	Pixel sx = Fl::event_x() + (viewport->xposition() * 2);
-	viewport->scroll_to(sx, viewport->yposition());	
+	scroll(sx);
 }
 
 
@@ -160,7 +164,30 @@ void gdBaseActionEditor::centerViewportOut()
 {
 	Pixel sx = -((Fl::event_x() + viewport->xposition()) / 2) + viewport->xposition();
 	if (sx < 0) sx = 0;
-	viewport->scroll_to(sx, viewport->yposition());
+	scroll(sx);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void gdBaseActionEditor::scroll(Pixel p)
+{
+	viewport->scroll_to(p, viewport->yposition());
+	rebuild();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+Range<Frame> gdBaseActionEditor::getVisibleFrames() const
+{
+	Pixel margin = viewport->w() / 2;
+	Pixel p1     = std::max(0, viewport->xposition() - margin);
+	Pixel p2     = viewport->xposition() + viewport->w() + margin;
+
+	return Range<Frame>(pixelToFrame(p1, /*snap=*/false), pixelToFrame(p2, /*snap=*/false) + 1);
 }
 
 
@@ -198,6 +225,11 @@ void gdBaseActionEditor::prepareWindow()
 	size_range(640, 284);
 	resizable(viewport);
 
+	/* Editors only show actions in the visible frames: rebuild them when 
+	scrolling. */
+
+	viewport->hscrollbar.callback(cb_scroll, this);
+
 	show();
 }
 
@@ -205,6 +237,23 @@ void gdBaseActionEditor::prepareWindow()
 /* -------------------------------------------------------------------------- */
 
 
+void gdBaseActionEditor::resize(int X, int Y, int W, int H)
+{
+	bool resized = W != w();
+
+	gdWindow::resize(X, Y, W, H);
+
+	/* A wider viewport shows more frames. Skip it while the editor is still 
+	being built. */
+
+	if (resized && viewport != nullptr)
+		rebuild();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 int gdBaseActionEditor::handle(int e)
 {
 	switch (e) {
@@ -30,6 +30,7 @@
 
 
 #include "core/types.h"
+#include "core/range.h"
 #include "glue/actionEditor.h"
 #include "gui/dialogs/window.h"
 
@@ -55,6 +56,7 @@ public:
 	virtual ~gdBaseActionEditor();
 
 	int handle(int e) override;
+	void resize(int x, int y, int w, int h) override;
 
 	Pixel frameToPixel(Frame f) const;
 	Frame pixelToFrame(Pixel p, bool snap=true) const;
@@ -85,6 +87,19 @@ protected:
 	void zoomOut();
 	static void cb_zoomIn(Fl_Widget* /*w*/, void* p);
 	static void cb_zoomOut(Fl_Widget* /*w*/, void* p);
+	static void cb_scroll(Fl_Widget* w, void* p);
+
+	/* scroll
+	Scrolls the viewport horizontally to pixel 'p' and rebuilds the editors 
+	for the frames now visible. */
+
+	void scroll(Pixel p);
+
+	/* getVisibleFrames
+	Returns the frames shown in the viewport, plus half a viewport on each side
+	so that widgets on the edges are not left out. */
+
+	Range<Frame> getVisibleFrames() const;
 	
 	/* computeWidth
 	Computes total width, in pixel. */
@@ -29,13 +29,16 @@
 #include "core/graphics.h"
 #include "glue/actionEditor.h"
 #include "glue/channel.h"
+#include "utils/gui.h"
 #include "gui/elems/basics/scrollPack.h"
 #include "gui/elems/basics/button.h"
 #include "gui/elems/basics/resizerBar.h"
 #include "gui/elems/basics/box.h"
+#include "gui/elems/basics/choice.h"
 #include "gui/elems/actionEditor/noteEditor.h"
 #include "gui/elems/actionEditor/velocityEditor.h"
 #include "gui/elems/actionEditor/pianoRoll.h"
+#include "gui/elems/actionEditor/envelopeEditor.h"
 #include "gui/elems/actionEditor/gridTool.h"
 #include "midiActionEditor.h"
 
@@ -45,6 +48,9 @@ namespace v
 {
 gdMidiActionEditor::gdMidiActionEditor(ID channelId)
 : gdBaseActionEditor(channelId)
+, m_ee              (nullptr)
+, m_eer             (nullptr)
+, m_lanes           (c::actionEditor::getEnvelopeLanes(channelId))
 {
 	end();
 
@@ -52,10 +58,12 @@ gdMidiActionEditor::gdMidiActionEditor(ID channelId)
 
 	gePack* upperArea = new gePack(G_GUI_OUTER_MARGIN, G_GUI_OUTER_MARGIN, Direction::HORIZONTAL);
 		gridTool   = new geGridTool(0, 0);
-		geBox* b1  = new geBox     (0, 0, w() - 150, G_GUI_UNIT);    // padding actionType - zoomButtons
+		m_laneType = new geChoice  (0, 0, 160, G_GUI_UNIT);
+		geBox* b1  = new geBox     (0, 0, w() - 314, G_GUI_UNIT);    // padding laneType - zoomButtons
 		zoomInBtn  = new geButton  (0, 0, G_GUI_UNIT, G_GUI_UNIT, "", zoomInOff_xpm, zoomInOn_xpm);
 		zoomOutBtn = new geButton  (0, 0, G_GUI_UNIT, G_GUI_UNIT, "", zoomOutOff_xpm, zoomOutOn_xpm);
 	upperArea->add(gridTool); 
+	upperArea->add(m_laneType); 
 	upperArea->add(b1); 
 	upperArea->add(zoomInBtn); 
 	upperArea->add(zoomOutBtn); 
@@ -74,6 +82,23 @@ gdMidiActionEditor::gdMidiActionEditor(ID channelId)
 	viewport->add(m_ve);
 	viewport->add(m_ver);
 
+	/* Envelope lanes, one for each plug-in parameter. */
+
+	if (m_lanes.empty())
+		m_laneType->deactivate();
+	else {
+		m_ee  = new geEnvelopeEditor(0, 0, "", this);
+		m_eer = new geResizerBar    (0, 0, viewport->w(), RESIZER_BAR_H, MIN_WIDGET_H, geResizerBar::VERTICAL);
+		viewport->add(m_ee);
+		viewport->add(m_eer);
+
+		for (std::size_t i = 0; i < m_lanes.size(); i++)
+			m_laneType->addItem(u::gui::removeFltkChars(m_lanes[i].name), i);
+		m_laneType->showItem(0);
+		m_laneType->onChange = [this](ID i) { setLane(i); };
+		m_ee->setLane(m_lanes[0].pluginId, m_lanes[0].pluginParam, m_lanes[0].name);
+	}
+
 	zoomInBtn->callback(cb_zoomIn, (void*)this);
 	zoomOutBtn->callback(cb_zoomOut, (void*)this);
 
@@ -89,14 +114,31 @@ gdMidiActionEditor::gdMidiActionEditor(ID channelId)
 /* -------------------------------------------------------------------------- */
 
 
+void gdMidiActionEditor::setLane(ID i)
+{
+	const c::actionEditor::EnvelopeLane& lane = m_lanes.at(i);
+
+	m_ee->setLane(lane.pluginId, lane.pluginParam, lane.name);
+	rebuild();
+	redraw();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void gdMidiActionEditor::rebuild()
 {
-	m_data = c::actionEditor::getData(channelId);
+	m_data = c::actionEditor::getData(channelId, getVisibleFrames());
 
 	computeWidth();
 	m_ne->rebuild(m_data);
 	m_ner->size(m_ne->w(), m_ner->h());
 	m_ve->rebuild(m_data);
 	m_ver->size(m_ve->w(), m_ver->h());
+	if (m_ee != nullptr) {
+		m_ee->rebuild(m_data);	
+		m_eer->size(m_ee->w(), m_eer->h());
+	}
 }
 }} // giada::v::
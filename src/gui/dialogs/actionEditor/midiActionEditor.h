@@ -29,6 +29,7 @@
 #define GD_MIDI_ACTION_EDITOR_H
 
 
+#include <vector>
 #include "baseActionEditor.h"
 
 
@@ -40,6 +41,7 @@ namespace v
 {
 class geNoteEditor;
 class geVelocityEditor;
+class geEnvelopeEditor;
 
 class gdMidiActionEditor : public gdBaseActionEditor
 {
@@ -51,11 +53,26 @@ public:
 
 private:
 
+	/* setLane
+	Shows the i-th envelope lane in the envelope editor. */
+
+	void setLane(ID i);
+
     geNoteEditor*     m_ne;
 	geResizerBar*     m_ner;
 
 	geVelocityEditor* m_ve;
     geResizerBar*     m_ver;
+
+	/* m_ee, m_eer
+	Envelope editor for plug-in parameters. Null if the channel has no 
+	plug-ins. */
+
+	geEnvelopeEditor* m_ee;
+    geResizerBar*     m_eer;
+
+	geChoice*                                  m_laneType;
+	std::vector<c::actionEditor::EnvelopeLane> m_lanes;
 };
 }} // giada::v::
 
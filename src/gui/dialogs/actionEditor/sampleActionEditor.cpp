@@ -32,6 +32,7 @@
 #include "core/graphics.h"
 #include "glue/actionEditor.h"
 #include "glue/channel.h"
+#include "utils/gui.h"
 #include "gui/elems/basics/pack.h"
 #include "gui/elems/basics/scrollPack.h"
 #include "gui/elems/basics/button.h"
@@ -54,17 +55,20 @@ gdSampleActionEditor::gdSampleActionEditor(ID channelId)
 
 	computeWidth();
 
-	/* Container with zoom buttons and the action type selector. Scheme of the 
-	resizable boxes: |[--b1--][actionType][--b2--][+][-]| */
+	/* Container with zoom buttons, the action type and the envelope lane
+	selectors. Scheme of the resizable boxes: 
+	|[actionType][gridTool][laneType][--b1--][+][-]| */
 
 	gePack* upperArea = new gePack(G_GUI_OUTER_MARGIN, G_GUI_OUTER_MARGIN, Direction::HORIZONTAL);
 		actionType = new geChoice  (0, 0, 80, 20);
 		gridTool   = new geGridTool(0, 0);
-		geBox* b1  = new geBox     (0, 0, w() - 232, 20);    // padding actionType - zoomButtons
+		m_laneType = new geChoice  (0, 0, 160, 20);
+		geBox* b1  = new geBox     (0, 0, w() - 396, 20);    // padding laneType - zoomButtons
 		zoomInBtn  = new geButton  (0, 0, 20, 20, "", zoomInOff_xpm, zoomInOn_xpm);
 		zoomOutBtn = new geButton  (0, 0, 20, 20, "", zoomOutOff_xpm, zoomOutOn_xpm);
 	upperArea->add(actionType);
 	upperArea->add(gridTool);
+	upperArea->add(m_laneType);
 	upperArea->add(b1);
 	upperArea->add(zoomInBtn);
 	upperArea->add(zoomOutBtn);
@@ -77,6 +81,14 @@ gdSampleActionEditor::gdSampleActionEditor(ID channelId)
 	if (!canChangeActionType())
 		actionType->deactivate();
 
+	/* Envelope lanes: volume first, then plug-in parameters. */
+
+	m_lanes = c::actionEditor::getEnvelopeLanes(channelId);
+	for (std::size_t i = 0; i < m_lanes.size(); i++)
+		m_laneType->addItem(u::gui::removeFltkChars(m_lanes[i].name), i);
+	m_laneType->showItem(0);
+	m_laneType->onChange = [this](ID i) { setLane(i); };
+
 	zoomInBtn->callback(cb_zoomIn, (void*)this);
 	zoomOutBtn->callback(cb_zoomOut, (void*)this);
 
@@ -115,9 +127,22 @@ bool gdSampleActionEditor::canChangeActionType()
 /* -------------------------------------------------------------------------- */
 
 
+void gdSampleActionEditor::setLane(ID i)
+{
+	const c::actionEditor::EnvelopeLane& lane = m_lanes.at(i);
+
+	m_ee->setLane(lane.pluginId, lane.pluginParam, lane.name);
+	rebuild();
+	redraw();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void gdSampleActionEditor::rebuild()
 {
-	m_data = c::actionEditor::getData(channelId);
+	m_data = c::actionEditor::getData(channelId, getVisibleFrames());
 
 	canChangeActionType() ? actionType->activate() : actionType->deactivate(); 
 	computeWidth();
@@ -29,6 +29,7 @@
 #define GD_SAMPLE_ACTION_EDITOR_H
 
 
+#include <vector>
 #include "baseActionEditor.h"
 
 
@@ -52,11 +53,19 @@ private:
 
 	bool canChangeActionType();
 
+	/* setLane
+	Shows the i-th envelope lane in the envelope editor. */
+
+	void setLane(ID i);
+
 	geSampleActionEditor* m_ae;
     geResizerBar*         m_aer;
 
 	geEnvelopeEditor*     m_ee;
     geResizerBar*         m_eer;
+
+	geChoice*                                  m_laneType;
+	std::vector<c::actionEditor::EnvelopeLane> m_lanes;
 };
 }} // giada::v::
 
@@ -148,8 +148,7 @@ void gdBrowserBase::cb_toggleHiddenFiles()
 
 void gdBrowserBase::setStatusBar(float v)
 {
-	status->value(status->value() + v);
-	Fl::wait(0);
+	status->value(v);
 }
 
 
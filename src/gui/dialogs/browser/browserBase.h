@@ -65,7 +65,7 @@ public:
 	void fireCallback() const;
 	
 	/* setStatusBar
-	Increments status bar for progress tracking. */
+	Sets status bar value in [0.0, 1.0] for progress tracking. */
 
 	void setStatusBar(float v);
 
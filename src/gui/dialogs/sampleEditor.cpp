@@ -56,6 +56,8 @@
 #include "gui/elems/sampleEditor/pitchTool.h"
 #include "gui/elems/sampleEditor/rangeTool.h"
 #include "gui/elems/sampleEditor/shiftTool.h"
+#include "gui/elems/sampleEditor/stretchTool.h"
+#include "gui/elems/sampleEditor/voiceTool.h"
 #include "gui/elems/mainWindow/keyboard/channel.h"
 #include "gui/dialogs/warnings.h"
 #include "sampleEditor.h"
@@ -74,7 +76,7 @@ gdSampleEditor::gdSampleEditor(ID channelId)
 	gePack* upperBar = createUpperBar();
 	
 	waveTools = new geWaveTools(G_GUI_OUTER_MARGIN, upperBar->y()+upperBar->h()+G_GUI_OUTER_MARGIN, 
-		w()-16, h()-168);
+		w()-16, h()-216);
 	
 	gePack* bottomBar = createBottomBar(G_GUI_OUTER_MARGIN, waveTools->y()+waveTools->h()+G_GUI_OUTER_MARGIN, 
 		h()-waveTools->h()-upperBar->h()-32);
@@ -126,6 +128,8 @@ void gdSampleEditor::rebuild()
 	pitchTool->rebuild(m_data);
 	rangeTool->rebuild(m_data);
 	shiftTool->rebuild(m_data);
+	stretchTool->rebuild(m_data);
+	voiceTool->rebuild(m_data);
 
 	updateInfo();
 
@@ -204,6 +208,8 @@ gePack* gdSampleEditor::createOpTools(int x, int y)
 	pitchTool  = new gePitchTool (m_data, 0, 0);
 	rangeTool  = new geRangeTool (m_data, 0, 0);
 	shiftTool  = new geShiftTool (m_data, 0, 0);
+	stretchTool = new geStretchTool(m_data, 0, 0);
+	voiceTool   = new geVoiceTool(m_data, 0, 0);
 	
 	gePack* g = new gePack(x, y, Direction::VERTICAL);
 	g->add(volumeTool);
@@ -211,6 +217,8 @@ gePack* gdSampleEditor::createOpTools(int x, int y)
 	g->add(pitchTool);
 	g->add(rangeTool);
 	g->add(shiftTool);
+	g->add(stretchTool);
+	g->add(voiceTool);
 
 	return g;
 }
@@ -58,6 +58,8 @@ class gePanTool;
 class gePitchTool;
 class geRangeTool;
 class geShiftTool;
+class geStretchTool;
+class geVoiceTool;
 class gdSampleEditor : public gdWindow
 {
 friend class geWaveform;
@@ -85,6 +87,8 @@ public:
 
 	geRangeTool* rangeTool;
 	geShiftTool* shiftTool;
+	geStretchTool* stretchTool;
+	geVoiceTool*   voiceTool;
 	geButton*    reload;
 
 	geStatusButton* play;
@@ -25,6 +25,7 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include <FL/Fl.H>
 #include <FL/fl_draw.H>
 #include "baseAction.h"
@@ -95,6 +96,26 @@ int geBaseAction::handle(int e)
 /* -------------------------------------------------------------------------- */
 
 
+void geBaseAction::reset(Pixel X, Pixel Y, Pixel W, Pixel H, m::Action A1, 
+	m::Action A2)
+{
+	resize(X, Y, std::max(W, MIN_WIDTH), H);
+
+	onRightEdge = false;
+	onLeftEdge  = false;
+	hovered     = false;
+	altered     = false;
+	pick        = 0;
+	a1          = A1;
+	a2          = A2;
+
+	show();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void geBaseAction::setLeftEdge(Pixel p)
 {
 	resize(p, y(), x() - p + w(), h());
@@ -53,6 +53,13 @@ public:
 
 	int handle(int e) override;
 
+	/* reset
+	Recycles the widget for another pair of actions, see 
+	geBaseActionEditor::recycle(). */
+
+	virtual void reset(Pixel x, Pixel y, Pixel w, Pixel h, m::Action a1, 
+		m::Action a2);
+
 	bool isOnEdges() const;
 
 	/* setLeftEdge/setRightEdge
@@ -55,7 +55,7 @@ geBaseAction* geBaseActionEditor::getActionAtCursor() const
 {
 	for (int i = 0; i < children(); i++) {
 		geBaseAction* a = static_cast<geBaseAction*>(child(i));
-		if (a->hovered)
+		if (a->visible() && a->hovered)
 			return a;
 	}
 	return nullptr;
@@ -65,6 +65,25 @@ geBaseAction* geBaseActionEditor::getActionAtCursor() const
 /* -------------------------------------------------------------------------- */
 
 
+geBaseAction* geBaseActionEditor::recycle(int i) const
+{
+	return i < children() ? static_cast<geBaseAction*>(child(i)) : nullptr;
+}
+
+
+void geBaseActionEditor::hideFrom(int i)
+{
+	for (; i < children(); i++) {
+		geBaseAction* a = static_cast<geBaseAction*>(child(i));
+		a->hovered = false;
+		a->hide();
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void geBaseActionEditor::baseDraw(bool clear) const
 {
 	/* Clear the screen. */
@@ -54,8 +54,8 @@ public:
 	int handle(int e) override;
 
 	/* getActionAtCursor
-	Returns the action under the mouse. nullptr if nothing found. Why not using
-	Fl::belowmouse? It would require a boring dynamic_cast. */
+	Returns the visible action under the mouse. nullptr if nothing found. Why 
+	not using Fl::belowmouse? It would require a boring dynamic_cast. */
 
 	geBaseAction* getActionAtCursor() const;
 
@@ -80,6 +80,19 @@ protected:
 
   void baseDraw(bool clear=true) const;
 
+	/* recycle
+	Editors show only the actions in the visible frames, and keep their widgets
+	across rebuilds instead of deleting them: returns the i-th action widget, 
+	to be reset() with new actions, or nullptr if a new one must be created. */
+
+	geBaseAction* recycle(int i) const;
+
+	/* hideFrom
+	Hides all action widgets starting from the i-th one, i.e. those not recycled
+	during the last rebuild. */
+
+	void hideFrom(int i);
+
 	virtual void onAddAction()     = 0;
 	virtual void onDeleteAction()  = 0;
 	virtual void onMoveAction()    = 0;
@@ -46,6 +46,8 @@ namespace v
 {
 geEnvelopeEditor::geEnvelopeEditor(Pixel x, Pixel y, const char* l, gdBaseActionEditor* b)
 : geBaseActionEditor(x, y, 200, m::conf::conf.envelopeEditorH, b)
+, m_pluginId        (-1)
+, m_pluginParam     (-1)
 {
 	copy_label(l);
 }
@@ -78,27 +80,30 @@ void geEnvelopeEditor::draw()
 
 	Pixel side = geEnvelopePoint::SIDE / 2;
 
-	Pixel x1 = child(0)->x() + side;
-	Pixel y1 = child(0)->y() + side;
+	Pixel x1 = 0;
+	Pixel y1 = 0;
 	Pixel x2 = 0;
 	Pixel y2 = 0;
 
-	/* For each point: 
-		- paint the connecting line with the next one;
+	/* For each visible point: 
+		- paint the connecting line with the previous one;
 		- reposition it on the y axis, only if there's no point selected (dragged
 	    around). */
 
+	bool first = true;
 	for (int i=0; i<children(); i++) {
 		geEnvelopePoint* p = static_cast<geEnvelopePoint*>(child(i));
+		if (!p->visible())
+			continue;
 		if (m_action == nullptr)
 			p->position(p->x(), valueToY(p->a1.event.getVelocity()));
-		if (i > 0) {
-			x2 = p->x() + side;
-			y2 = p->y() + side;
+		x2 = p->x() + side;
+		y2 = p->y() + side;
+		if (!first)
 			fl_line(x1, y1, x2, y2);
-			x1 = x2;
-			y1 = y2;
-		}
+		x1    = x2;
+		y1    = y2;
+		first = false;
 	}
 
 	draw_children();
@@ -108,21 +113,41 @@ void geEnvelopeEditor::draw()
 /* -------------------------------------------------------------------------- */
 
 
+void geEnvelopeEditor::setLane(ID pluginId, int pluginParam, const std::string& label)
+{
+	m_pluginId    = pluginId;
+	m_pluginParam = pluginParam;
+	copy_label(label.c_str());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 void geEnvelopeEditor::rebuild(c::actionEditor::Data& d)
 {
 	m_data = &d;
 
-	/* Remove all existing actions and set a new width, according to the current
-	zoom level. */
+	/* Set a new width, according to the current zoom level, then recycle the
+	existing points for the visible actions. */
 
-	clear();
 	size(m_base->fullWidth, h());
 
+	int i = 0;
 	for (const m::Action& a : m_data->actions) {
-		if (a.event.getStatus() != m::MidiEvent::ENVELOPE)
+		if (a.event.getStatus() != m::MidiEvent::ENVELOPE || 
+		    a.pluginId != m_pluginId || a.pluginParam != m_pluginParam)
 			continue;
-		add(new geEnvelopePoint(frameToX(a.frame), valueToY(a.event.getVelocity()), a)); 		
+
+		Pixel px = frameToX(a.frame);
+		Pixel py = valueToY(a.event.getVelocity());
+
+		if (geBaseAction* point = recycle(i++); point != nullptr)
+			point->reset(px, py, geEnvelopePoint::SIDE, geEnvelopePoint::SIDE, a, {});
+		else
+			add(new geEnvelopePoint(px, py, a)); 		
 	}
+	hideFrom(i);
 
 	resizable(nullptr);
 
@@ -133,15 +158,19 @@ void geEnvelopeEditor::rebuild(c::actionEditor::Data& d)
 /* -------------------------------------------------------------------------- */
 
 
+/* Envelopes are circular: the first point is linked back to the last one and
+vice versa. Only some points might be shown, so the siblings are read from the
+recorder. */
+
 bool geEnvelopeEditor::isFirstPoint() const
 {
-	return find(m_action) == 0;
+	return m::recorder::getAction(m_action->a1.prevId).frame > m_action->a1.frame;
 }
 
 
 bool geEnvelopeEditor::isLastPoint() const
 {
-	return find(m_action) == children() - 1;
+	return m::recorder::getAction(m_action->a1.nextId).frame < m_action->a1.frame;
 }
 
 
@@ -174,7 +203,7 @@ void geEnvelopeEditor::onAddAction()
 	Frame f = m_base->pixelToFrame(Fl::event_x() - x());
 	int   v = yToValue(Fl::event_y() - y());
 	
-	c::actionEditor::recordEnvelopeAction(m_data->channelId, f, v);
+	c::actionEditor::recordEnvelopeAction(m_data->channelId, f, v, m_pluginId, m_pluginParam);
 	
 	m_base->rebuild(); // TODO - USELESS
 }
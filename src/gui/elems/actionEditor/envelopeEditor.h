@@ -29,6 +29,7 @@
 #define GE_ENVELOPE_EDITOR_H
 
 
+#include <string>
 #include "baseActionEditor.h"
 
 
@@ -51,6 +52,12 @@ public:
 
 	void rebuild(c::actionEditor::Data& d) override;
 
+	/* setLane
+	Shows the envelope of a plug-in parameter, or the volume one if 
+	pluginId == -1. Call rebuild() afterwards. */
+
+	void setLane(ID pluginId, int pluginParam, const std::string& label);
+
 private:
 
 	void onAddAction()     override;
@@ -65,6 +72,9 @@ private:
 
 	bool isFirstPoint() const;
 	bool isLastPoint()  const;
+
+	ID  m_pluginId;
+	int m_pluginParam;
 };
 }} // giada::v::
 
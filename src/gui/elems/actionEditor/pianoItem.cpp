@@ -49,6 +49,19 @@ gePianoItem::gePianoItem(Pixel X, Pixel Y, Pixel W, Pixel H, m::Action a1,
 /* -------------------------------------------------------------------------- */
 
 
+void gePianoItem::reset(Pixel X, Pixel Y, Pixel W, Pixel H, m::Action A1, 
+	m::Action A2)
+{
+	geBaseAction::reset(X, Y, W, H, A1, A2);
+	m_ringLoop  = a2.isValid() && a1.frame > a2.frame;
+	m_orphaned  = !a2.isValid();
+	m_resizable = isResizable();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 bool gePianoItem::isResizable() const
 {
 	return !(m_ringLoop || m_orphaned);
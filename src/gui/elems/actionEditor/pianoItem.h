@@ -48,6 +48,8 @@ public:
 	gePianoItem(int x, int y, int w, int h, m::Action a1, m::Action a2);
  
 	void draw() override;
+	void reset(Pixel x, Pixel y, Pixel w, Pixel h, m::Action a1, 
+		m::Action a2) override;
 
 	bool isResizable() const;
 
@@ -31,6 +31,7 @@
 #include "core/const.h"
 #include "core/clock.h"
 #include "core/action.h"
+#include "core/recorder.h"
 #include "core/midiEvent.h"
 #include "utils/log.h"
 #include "utils/string.h"
@@ -49,6 +50,8 @@ namespace v
 gePianoRoll::gePianoRoll(Pixel X, Pixel Y, Pixel W, gdBaseActionEditor* b)
 : geBaseActionEditor(X, Y, W, 40, b)
 , pick              (0)
+, surface1          (0)
+, surface2          (0)
 {
 	position(x(), m::conf::conf.pianoRollY == -1 ? y()-(h()/2) : m::conf::conf.pianoRollY);
 }
@@ -360,12 +363,12 @@ void gePianoRoll::rebuild(c::actionEditor::Data& d)
 {
 	m_data = &d;
 
-	/* Remove all existing actions and set a new width, according to the current
-	zoom level. */
+	/* Set a new width, according to the current zoom level, then recycle the
+	existing items for the visible actions. */
 
-	clear();
 	size(m_base->fullWidth, (MAX_KEYS + 1) * CELL_H);
 
+	int i = 0;
 	for (const m::Action& a1 : m_data->actions)
 	{
 		if (a1.event.getStatus() == m::MidiEvent::NOTE_OFF)
@@ -373,18 +376,25 @@ void gePianoRoll::rebuild(c::actionEditor::Data& d)
 
 		assert(a1.isValid());  // a2 might be null if orphaned
 
-		const m::Action& a2 = a1.next != nullptr ? *a1.next : m::Action{};
+		const m::Action a2 = m::recorder::getAction(a1.nextId);
 
 		Pixel px = x() + m_base->frameToPixel(a1.frame);
 		Pixel py = y() + noteToY(a1.event.getNote());
 		Pixel ph = CELL_H;
 		Pixel pw = getPianoItemW(px, a1, a2);
 
-		add(new gePianoItem(px, py, pw, ph, a1, a2));
+		if (geBaseAction* item = recycle(i++); item != nullptr)
+			item->reset(px, py, pw, ph, a1, a2);
+		else
+			add(new gePianoItem(px, py, pw, ph, a1, a2));
 	}
+	hideFrom(i);
 
-	drawSurface1();
-	drawSurface2();
+	/* Surfaces don't depend on actions nor zoom: draw them once, as rebuilds
+	happen while scrolling too. */
+
+	if (!surface1) drawSurface1();
+	if (!surface2) drawSurface2();
 
 	redraw();
 }
@@ -78,6 +78,8 @@ void geVelocityEditor::draw()
 
 	for (int i=0; i<children(); i++) {
 		geEnvelopePoint* p = static_cast<geEnvelopePoint*>(child(i));
+		if (!p->visible())
+			continue;
 		if (m_action == nullptr)
 			p->position(p->x(), valueToY(p->a1.event.getVelocity()));
 		Pixel x1 = p->x() + side;
@@ -113,12 +115,12 @@ void geVelocityEditor::rebuild(c::actionEditor::Data& d)
 {
 	m_data = &d;
 
-	/* Remove all existing actions and set a new width, according to the current
-	zoom level. */
+	/* Set a new width, according to the current zoom level, then recycle the
+	existing points for the visible actions. */
 
-	clear();
 	size(m_base->fullWidth, h());
 
+	int i = 0;
 	for (const m::Action& action : m_data->actions) {
 		
 		if (action.event.getStatus() == m::MidiEvent::NOTE_OFF)
@@ -127,8 +129,12 @@ void geVelocityEditor::rebuild(c::actionEditor::Data& d)
 		Pixel px = x() + m_base->frameToPixel(action.frame);
 		Pixel py = y() + valueToY(action.event.getVelocity());
 
-		add(new geEnvelopePoint(px, py, action));
+		if (geBaseAction* point = recycle(i++); point != nullptr)
+			point->reset(px, py, geEnvelopePoint::SIDE, geEnvelopePoint::SIDE, action, {});
+		else
+			add(new geEnvelopePoint(px, py, action));
 	}
+	hideFrom(i);
 	
 	resizable(nullptr);
 	redraw();
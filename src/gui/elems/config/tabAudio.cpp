@@ -59,7 +59,8 @@ geTabAudio::geTabAudio(int X, int Y, int W, int H)
 	channelsIn      = new geChoice(x()+114, y()+149, 55,  20, "Input channels");
 	recTriggerLevel = new geInput (x()+309, y()+149, 55,  20, "Rec threshold (dB)");
 	rsmpQuality     = new geChoice(x()+114, y()+177, 250, 20, "Resampling");
-                      new geBox(x(), rsmpQuality->y()+rsmpQuality->h()+8, w(), 92, "Restart Giada for the changes to take effect.");
+	sampleStorage   = new geChoice(x()+114, y()+205, 250, 20, "Sample storage");
+                      new geBox(x(), sampleStorage->y()+sampleStorage->h()+8, w(), 64, "Restart Giada for the changes to take effect.");
 	end();
 
 	labelsize(G_GUI_FONT_SIZE_BASE);
@@ -209,6 +210,11 @@ geTabAudio::geTabAudio(int X, int Y, int W, int H)
 	rsmpQuality->add("Linear (very fast)");
 	rsmpQuality->value(m::conf::conf.rsmpQuality);
 
+	sampleStorage->add("32 bit float (best quality)");
+	sampleStorage->add("16 bit integer (half memory)");
+	sampleStorage->add("16 bit float (half memory)");
+	sampleStorage->value(m::conf::conf.sampleStorage);
+
 	recTriggerLevel->value(u::string::fToString(m::conf::conf.recTriggerLevel, 1).c_str());
 
 	limitOutput->value(m::conf::conf.limitOutput);
@@ -519,6 +525,7 @@ void geTabAudio::save()
 	m::conf::conf.channelsInStart = channelsIn->getSelectedId() - (m::conf::conf.channelsInCount == 1 ? 1 : 1001);
 	m::conf::conf.limitOutput     = limitOutput->value();
 	m::conf::conf.rsmpQuality     = rsmpQuality->value();
+	m::conf::conf.sampleStorage   = sampleStorage->value();
 
 	/* If sounddevOut is disabled because of system change e.g. alsa -> jack, 
 	soundDeviceOut and channelsOut are == -1. Change them! */
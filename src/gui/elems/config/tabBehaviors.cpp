@@ -43,6 +43,7 @@ geTabBehaviors::geTabBehaviors(int X, int Y, int W, int H)
 , m_treatRecsAsLoops          (0, 0, 280, 20, "Treat one shot channels with actions as loops")
 , m_inputMonitorDefaultOn     (0, 0, 280, 20, "New sample channels have input monitor on by default")
 , m_overdubProtectionDefaultOn(0, 0, 280, 30, "New sample channels have overdub protection on\nby default")
+, m_freeInputRec              (0, 0, 280, 30, "Input recordings longer than the loop are kept\nwhole on empty channels")
 {
 	end();
 
@@ -54,6 +55,7 @@ geTabBehaviors::geTabBehaviors(int X, int Y, int W, int H)
 	m_container.add(&m_treatRecsAsLoops);
 	m_container.add(&m_inputMonitorDefaultOn);
 	m_container.add(&m_overdubProtectionDefaultOn);
+	m_container.add(&m_freeInputRec);
 
 	add(m_container);
 
@@ -61,6 +63,7 @@ geTabBehaviors::geTabBehaviors(int X, int Y, int W, int H)
 	m_treatRecsAsLoops.value(m::conf::conf.treatRecsAsLoops);
 	m_inputMonitorDefaultOn.value(m::conf::conf.inputMonitorDefaultOn);
 	m_overdubProtectionDefaultOn.value(m::conf::conf.overdubProtectionDefaultOn);
+	m_freeInputRec.value(m::conf::conf.freeInputRec);
 }
 
 
@@ -73,5 +76,6 @@ void geTabBehaviors::save()
 	m::conf::conf.treatRecsAsLoops = m_treatRecsAsLoops.value();
 	m::conf::conf.inputMonitorDefaultOn = m_inputMonitorDefaultOn.value();
 	m::conf::conf.overdubProtectionDefaultOn = m_overdubProtectionDefaultOn.value();
+	m::conf::conf.freeInputRec = m_freeInputRec.value();
 }
 }} // giada::v::
\ No newline at end of file
@@ -52,6 +52,7 @@ private:
 	geCheck m_treatRecsAsLoops;
 	geCheck m_inputMonitorDefaultOn;
 	geCheck m_overdubProtectionDefaultOn;
+	geCheck m_freeInputRec;
 };
 }} // giada::v::
 
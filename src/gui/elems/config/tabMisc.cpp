@@ -38,13 +38,24 @@ geTabMisc::geTabMisc(int X, int Y, int W, int H)
 : Fl_Group(X, Y, W, H, "Misc")
 {
 	begin();
-	debugMsg = new geChoice(x()+w()-230, y()+9, 230, 20, "Debug messages");
+	debugMsg     = new geChoice(x()+w()-230, y()+9, 230, 20, "Debug messages");
+	sampleFormat = new geChoice(x()+w()-230, y()+37, 230, 20, "Project samples");
+	patchFormat  = new geChoice(x()+w()-230, y()+65, 230, 20, "Project file");
 	end();
 
 	debugMsg->add("(disabled)");
 	debugMsg->add("To standard output");
 	debugMsg->add("To file");
 
+	sampleFormat->add("WAV, 32 bit float");
+	sampleFormat->add("WAV, original bit depth");
+	sampleFormat->add("FLAC (compressed)");
+	sampleFormat->value(m::conf::conf.projectSampleFormat);
+
+	patchFormat->add("JSON");
+	patchFormat->add("Binary (faster loading)");
+	patchFormat->value(m::conf::conf.projectPatchFormat);
+
 	labelsize(G_GUI_FONT_SIZE_BASE);
 	selection_color(G_COLOR_GREY_4);
 
@@ -78,5 +89,7 @@ void geTabMisc::save()
 			m::conf::conf.logMode = LOG_MODE_FILE;
 			break;
 	}
+	m::conf::conf.projectSampleFormat = sampleFormat->value();
+	m::conf::conf.projectPatchFormat  = patchFormat->value();
 }
 }} // giada::v::
\ No newline at end of file
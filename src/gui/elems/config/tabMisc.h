@@ -45,6 +45,8 @@ public:
 	void save();
 
 	geChoice* debugMsg;
+	geChoice* sampleFormat;
+	geChoice* patchFormat;
 };
 }} // giada::v::
 
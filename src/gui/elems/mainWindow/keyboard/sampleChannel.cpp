@@ -26,6 +26,8 @@
 
 
 #include <cassert>
+#include <array>
+#include <string>
 #include "core/channels/channel.h"
 #include "core/channels/samplePlayer.h"
 #include "core/model/model.h"
@@ -36,12 +38,15 @@
 #include "core/wave.h"
 #include "core/recorder.h"
 #include "core/recManager.h"
+#include "core/kernelAudio.h"
+#include "core/const.h"
 #include "glue/io.h"
 #include "glue/channel.h"
 #include "glue/events.h"
 #include "glue/recorder.h"
 #include "glue/storage.h"
 #include "utils/gui.h"
+#include "utils/string.h"
 #include "gui/dispatcher.h"
 #include "gui/dialogs/mainWindow.h"
 #include "gui/dialogs/keyGrabber.h"
@@ -77,6 +82,13 @@ enum class Menu
 {
 	INPUT_MONITOR = 0,
 	OVERDUB_PROTECTION,
+	INPUT,
+	INPUT_MASTER,
+	INPUT_PAIR_1,
+	INPUT_PAIR_2,
+	INPUT_PAIR_3,
+	INPUT_PAIR_4,
+	__END_INPUT_SUBMENU__,
 	LOAD_SAMPLE,
 	EXPORT_SAMPLE,
 	SETUP_KEYBOARD_INPUT,
@@ -113,6 +125,17 @@ void menuCallback(Fl_Widget* w, void* v)
 			c::channel::setOverdubProtection(data.id, !data.sample->a_getOverdubProtection());
 			break;
 		}
+		case Menu::INPUT_MASTER: {
+			c::channel::setInputPair(data.id, -1);
+			break;
+		}
+		case Menu::INPUT_PAIR_1:
+		case Menu::INPUT_PAIR_2:
+		case Menu::INPUT_PAIR_3:
+		case Menu::INPUT_PAIR_4: {
+			c::channel::setInputPair(data.id, (int) (intptr_t) v - (int) Menu::INPUT_PAIR_1);
+			break;
+		}
 		case Menu::LOAD_SAMPLE: {
 			gdWindow* w = new gdBrowserLoad("Browse sample", 
 				m::conf::conf.samplePath.c_str(), c::storage::loadSample, data.id);
@@ -280,11 +303,26 @@ void geSampleChannel::cb_openMenu()
 	if (m::recManager::isRecording())
 		return;
 
+	/* Input pairs start from the first input channel of the device stream. */
+
+	std::array<std::string, G_MAX_INPUT_PAIRS> pairs;
+	for (int i = 0; i < G_MAX_INPUT_PAIRS; i++) {
+		int first = m::kernelAudio::getFirstInputChannel() + i * 2 + 1;
+		pairs[i] = u::string::iToString(first) + "-" + u::string::iToString(first + 1);
+	}
+
 	Fl_Menu_Item rclick_menu[] = {
 		{"Input monitor",            0, menuCallback, (void*) Menu::INPUT_MONITOR,
 			FL_MENU_TOGGLE | (m_channel.sample->a_getInputMonitor() ? FL_MENU_VALUE : 0)},
 		{"Overdub protection",       0, menuCallback, (void*) Menu::OVERDUB_PROTECTION,
-			FL_MENU_TOGGLE | FL_MENU_DIVIDER | (m_channel.sample->a_getOverdubProtection() ? FL_MENU_VALUE : 0)},
+			FL_MENU_TOGGLE | (m_channel.sample->a_getOverdubProtection() ? FL_MENU_VALUE : 0)},
+		{"Input",                    0, menuCallback, (void*) Menu::INPUT, FL_SUBMENU | FL_MENU_DIVIDER},
+			{"Master input", 0, menuCallback, (void*) Menu::INPUT_MASTER, FL_MENU_RADIO},
+			{pairs[0].c_str(), 0, menuCallback, (void*) Menu::INPUT_PAIR_1, FL_MENU_RADIO},
+			{pairs[1].c_str(), 0, menuCallback, (void*) Menu::INPUT_PAIR_2, FL_MENU_RADIO},
+			{pairs[2].c_str(), 0, menuCallback, (void*) Menu::INPUT_PAIR_3, FL_MENU_RADIO},
+			{pairs[3].c_str(), 0, menuCallback, (void*) Menu::INPUT_PAIR_4, FL_MENU_RADIO},
+			{0},
 		{"Load new sample...",       0, menuCallback, (void*) Menu::LOAD_SAMPLE},
 		{"Export sample to file...", 0, menuCallback, (void*) Menu::EXPORT_SAMPLE},
 		{"Setup keyboard input...",  0, menuCallback, (void*) Menu::SETUP_KEYBOARD_INPUT},
@@ -304,6 +342,13 @@ void geSampleChannel::cb_openMenu()
 		{0}
 	};
 
+	/* Only pairs of inputs the audio device actually has. */
+
+	for (int i = 0; i < G_MAX_INPUT_PAIRS; i++)
+		if (i * 2 >= m::kernelAudio::countInputChannels())
+			rclick_menu[(int) Menu::INPUT_PAIR_1 + i].deactivate();
+	rclick_menu[(int) Menu::INPUT_MASTER + m_channel.sample->a_getInputPair() + 1].setonly();
+
 	if (m_channel.sample->waveId == 0) {
 		rclick_menu[(int) Menu::EXPORT_SAMPLE].deactivate();
 		rclick_menu[(int) Menu::EDIT_SAMPLE].deactivate();
@@ -311,6 +356,13 @@ void geSampleChannel::cb_openMenu()
 		rclick_menu[(int) Menu::RENAME_CHANNEL].deactivate();
 	}
 
+	/* Sample data is not there yet while loading in background. */
+
+	if (m_channel.a_getPlayStatus() == ChannelStatus::LOADING) {
+		rclick_menu[(int) Menu::EXPORT_SAMPLE].deactivate();
+		rclick_menu[(int) Menu::EDIT_SAMPLE].deactivate();
+	}
+
 	if (!m_channel.hasActions)
 		rclick_menu[(int) Menu::CLEAR_ACTIONS].deactivate();
 
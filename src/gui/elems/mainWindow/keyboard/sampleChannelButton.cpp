@@ -49,6 +49,9 @@ geSampleChannelButton::geSampleChannelButton(int x, int y, int w, int h, const c
 		case ChannelStatus::WRONG:
 			label("* file not found! *");
 			break;
+		case ChannelStatus::LOADING:
+			label("-- loading --");
+			break;
 		default:
 			label(m_channel.sample->waveId == 0 ? "-- no sample --" : m_channel.name.c_str());
 			break;
@@ -32,6 +32,7 @@
 #include "core/graphics.h"  
 #include "core/clock.h"
 #include "glue/events.h"
+#include "glue/channel.h"
 #include "utils/gui.h"
 #include "utils/string.h"
 #include "gui/dialogs/sampleEditor.h"
@@ -56,6 +57,7 @@ gePitchTool::gePitchTool(const c::sampleEditor::Data& d, int x, int y)
 , m_pitchHalf  (0, 0, G_GUI_UNIT, G_GUI_UNIT, "", divideOff_xpm, divideOn_xpm)
 , m_pitchDouble(0, 0, G_GUI_UNIT, G_GUI_UNIT, "", multiplyOff_xpm, multiplyOn_xpm)
 , m_pitchReset (0, 0, 70, G_GUI_UNIT, "Reset")
+, m_quality    (0, 0, 80, G_GUI_UNIT)
 {
 	add(&m_label);
 	add(&m_dial);
@@ -65,6 +67,7 @@ gePitchTool::gePitchTool(const c::sampleEditor::Data& d, int x, int y)
 	add(&m_pitchHalf);
 	add(&m_pitchDouble);
 	add(&m_pitchReset);
+	add(&m_quality);
 
 	m_dial.range(0.01f, 4.0f);
 	m_dial.callback(cb_setPitch, (void*)this);
@@ -80,6 +83,15 @@ gePitchTool::gePitchTool(const c::sampleEditor::Data& d, int x, int y)
 	m_pitchDouble.callback(cb_setPitchDouble, (void*)this);
 	m_pitchReset.callback(cb_resetPitch, (void*)this);
 
+	m_quality.addItem("Linear",  static_cast<ID>(ResamplerQuality::LINEAR));
+	m_quality.addItem("Cubic",   static_cast<ID>(ResamplerQuality::CUBIC));
+	m_quality.addItem("Sinc 16", static_cast<ID>(ResamplerQuality::SINC_16));
+	m_quality.addItem("Sinc 64", static_cast<ID>(ResamplerQuality::SINC_64));
+	m_quality.onChange = [this](ID id)
+	{
+		c::channel::setResamplerQuality(m_data->channelId, static_cast<ResamplerQuality>(id));
+	};
+
 	rebuild(d);
 }
 
@@ -91,6 +103,7 @@ void gePitchTool::rebuild(const c::sampleEditor::Data& d)
 {
 	m_data = &d;
 	update(m_data->pitch, /*isDial=*/false);
+	m_quality.showItem(static_cast<ID>(m_data->resamplerQuality));
 }
 
 
@@ -34,6 +34,7 @@
 #include "gui/elems/basics/dial.h"
 #include "gui/elems/basics/input.h"
 #include "gui/elems/basics/button.h"
+#include "gui/elems/basics/choice.h"
 
 
 namespace giada {
@@ -75,6 +76,7 @@ private:
 	geButton m_pitchHalf;
 	geButton m_pitchDouble;
 	geButton m_pitchReset;
+	geChoice m_quality;
 };
 }} // giada::v::
 
@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <cstdlib>
+#include "core/const.h"
+#include "utils/string.h"
+#include "glue/sampleEditor.h"
+#include "stretchTool.h"
+
+
+namespace giada {
+namespace v 
+{
+geStretchTool::geStretchTool(const c::sampleEditor::Data& d, int x, int y)
+: gePack      (x, y, Direction::HORIZONTAL)
+, m_data      (nullptr)
+, m_label     (0, 0, 60, G_GUI_UNIT, "Stretch", FL_ALIGN_LEFT)
+, m_toTempo   (0, 0, 70, G_GUI_UNIT, "To tempo")
+, m_beats     (0, 0, 70, G_GUI_UNIT)
+, m_beatsLabel(0, 0, 40, G_GUI_UNIT, "beats", FL_ALIGN_LEFT)
+{
+	add(&m_label);
+	add(&m_toTempo);
+	add(&m_beats);
+	add(&m_beatsLabel);
+
+	m_toTempo.callback(cb_setStretchToTempo, (void*)this);
+
+	m_beats.type(FL_FLOAT_INPUT);
+	m_beats.when(FL_WHEN_RELEASE | FL_WHEN_ENTER_KEY); // on focus lost or enter key
+	m_beats.callback(cb_setBeats, (void*)this);
+
+	rebuild(d);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void geStretchTool::cb_setStretchToTempo(Fl_Widget* /*w*/, void* p) { ((geStretchTool*)p)->cb_setStretchToTempo(); }
+void geStretchTool::cb_setBeats(Fl_Widget* /*w*/, void* p) { ((geStretchTool*)p)->cb_setBeats(); }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void geStretchTool::cb_setStretchToTempo()
+{
+	c::sampleEditor::setStretchToTempo(m_data->channelId, m_toTempo.value());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void geStretchTool::cb_setBeats()
+{
+	c::sampleEditor::setStretchBeats(m_data->channelId, atof(m_beats.value()));
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void geStretchTool::rebuild(const c::sampleEditor::Data& d)
+{
+	m_data = &d;
+
+	m_toTempo.value(m_data->stretchToTempo);
+	m_beats.value(u::string::fToString(m_data->stretchBeats, 2).c_str());
+	if (m_data->stretchToTempo)
+		m_beats.activate();
+	else
+		m_beats.deactivate();
+}
+}} // giada::v::
@@ -0,0 +1,67 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#ifndef GE_STRETCH_TOOL_H
+#define GE_STRETCH_TOOL_H
+
+
+#include "gui/elems/basics/pack.h"
+#include "gui/elems/basics/box.h"
+#include "gui/elems/basics/input.h"
+#include "gui/elems/basics/check.h"
+
+
+namespace giada {
+namespace v 
+{
+class geStretchTool : public gePack
+{
+public:
+
+	geStretchTool(const c::sampleEditor::Data& d, int x, int y);
+
+	void rebuild(const c::sampleEditor::Data& d);
+
+private:
+
+	static void cb_setStretchToTempo(Fl_Widget* /*w*/, void* p);
+	static void cb_setBeats(Fl_Widget* /*w*/, void* p);
+	void cb_setStretchToTempo();
+	void cb_setBeats();
+
+	const c::sampleEditor::Data* m_data;
+	
+	geBox   m_label;
+	geCheck m_toTempo;
+	geInput m_beats;
+	geBox   m_beatsLabel;
+};
+}} // giada::v::
+
+
+#endif
@@ -0,0 +1,105 @@
+/* -----------------------------------------------------------------------------
+ *
+ * Giada - Your Hardcore Loopmachine
+ *
+ * -----------------------------------------------------------------------------
+ *
+ * Copyright (C) 2010-2021 Giovanni A. Zuliani | Monocasual
+ *
+ * This file is part of Giada - Your Hardcore Loopmachine.
+ *
+ * Giada - Your Hardcore Loopmachine is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * Giada - Your Hardcore Loopmachine is distributed in the hope that it
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Giada - Your Hardcore Loopmachine. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * -------------------------------------------------------------------------- */
+
+
+
+#include <string>
+#include "core/const.h"
+#include "glue/channel.h"
+#include "glue/sampleEditor.h"
+#include "voiceTool.h"
+
+
+namespace giada {
+namespace v 
+{
+namespace
+{
+std::string noteToString_(int note)
+{
+	static const char* names[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+	return names[note % 12] + std::to_string(note / 12 - 1);
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+
+geVoiceTool::geVoiceTool(const c::sampleEditor::Data& d, int x, int y)
+: gePack     (x, y, Direction::HORIZONTAL)
+, m_data     (nullptr)
+, m_label    (0, 0, 60, G_GUI_UNIT, "Voices", FL_ALIGN_LEFT)
+, m_polyphony(0, 0, 70, G_GUI_UNIT)
+, m_stealing (0, 0, 80, G_GUI_UNIT)
+, m_rootNote (0, 0, 90, G_GUI_UNIT)
+{
+	add(&m_label);
+	add(&m_polyphony);
+	add(&m_stealing);
+	add(&m_rootNote);
+
+	for (int p = 1; p <= G_MAX_POLYPHONY; p *= 2)
+		m_polyphony.addItem(p == 1 ? "Mono" : std::to_string(p) + " voices", p);
+	m_polyphony.onChange = [this](ID id)
+	{
+		c::channel::setPolyphony(m_data->channelId, id);
+	};
+
+	m_stealing.addItem("Oldest",   static_cast<ID>(VoiceStealing::OLDEST));
+	m_stealing.addItem("Quietest", static_cast<ID>(VoiceStealing::QUIETEST));
+	m_stealing.addItem("No steal", static_cast<ID>(VoiceStealing::NONE));
+	m_stealing.onChange = [this](ID id)
+	{
+		c::channel::setVoiceStealing(m_data->channelId, static_cast<VoiceStealing>(id));
+	};
+
+	m_rootNote.addItem("Not keyed", -1);
+	for (int note = 0; note <= G_MAX_VELOCITY; note++)
+		m_rootNote.addItem("Root " + noteToString_(note), note);
+	m_rootNote.onChange = [this](ID id)
+	{
+		c::channel::setRootNote(m_data->channelId, id);
+	};
+
+	rebuild(d);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void geVoiceTool::rebuild(const c::sampleEditor::Data& d)
+{
+	m_data = &d;
+
+	m_polyphony.showItem(m_data->polyphony);
+	m_stealing.showItem(static_cast<ID>(m_data->voiceStealing));
+	m_rootNote.showItem(m_data->rootNote);
+}
+}} // giada::v::
@@ -45,7 +45,9 @@ namespace
 {
 enum class Menu
 {
-	CUT = 0,
+	UNDO = 0,
+	REDO,
+	CUT,
 	COPY,
 	PASTE,
 	TRIM,
@@ -75,6 +77,12 @@ void menuCallback_(Fl_Widget* w, void* v)
 	int b = wt->waveform->getSelectionB();
 
 	switch (selectedItem) {
+		case Menu::UNDO:
+			c::sampleEditor::undo(channelId, waveId);
+			break;
+		case Menu::REDO:
+			c::sampleEditor::redo(channelId, waveId);
+			break;
 		case Menu::CUT:
 			c::sampleEditor::cut(channelId, waveId, a, b);
 			break;		
@@ -151,6 +159,7 @@ void geWaveTools::rebuild(const c::sampleEditor::Data& d)
 
 void geWaveTools::refresh()
 {
+	waveform->refresh();
 	if (m_data->a_getPreviewStatus() == ChannelStatus::PLAY)
 		waveform->redraw();
 }
@@ -207,6 +216,8 @@ int geWaveTools::handle(int e)
 void geWaveTools::openMenu()
 {
 	Fl_Menu_Item menu[] = {
+		{"Undo",                0, menuCallback_, (void*) Menu::UNDO},
+		{"Redo",                0, menuCallback_, (void*) Menu::REDO, FL_MENU_DIVIDER},
 		{"Cut",                 0, menuCallback_, (void*) Menu::CUT},
 		{"Copy",                0, menuCallback_, (void*) Menu::COPY},
 		{"Paste",               0, menuCallback_, (void*) Menu::PASTE},
@@ -222,6 +233,11 @@ void geWaveTools::openMenu()
 		{0}
 	};
 
+	if (!c::sampleEditor::canUndo(m_data->waveId))
+		menu[(int)Menu::UNDO].deactivate();
+	if (!c::sampleEditor::canRedo(m_data->waveId))
+		menu[(int)Menu::REDO].deactivate();
+
 	if (!waveform->isSelected()) {
 		menu[(int)Menu::CUT].deactivate();
 		menu[(int)Menu::COPY].deactivate();		
@@ -25,8 +25,10 @@
  * -------------------------------------------------------------------------- */
 
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <vector>
 #include <FL/fl_draw.H>
 #include <FL/Fl_Menu_Button.H>
 #include "core/model/model.h"
@@ -35,6 +37,7 @@
 #include "core/const.h"
 #include "core/mixer.h"
 #include "core/waveFx.h"
+#include "core/waveSummary.h"
 #include "glue/channel.h"
 #include "glue/sampleEditor.h"
 #include "utils/log.h"
@@ -75,6 +78,8 @@ void geWaveform::clearData()
 {
 	m_waveform.sup.clear();
 	m_waveform.inf.clear();
+	m_waveform.rmsSup.clear();
+	m_waveform.rmsInf.clear();
 	m_waveform.size = 0;
 	m_grid.points.clear();
 }
@@ -85,17 +90,15 @@ void geWaveform::clearData()
 
 int geWaveform::alloc(int datasize, bool force)
 {
-	/* TODO - geWaveform needs better isolation from m::. Refactoring needed. */
-	
-	m::model::WavesLock l(m::model::waves);
-	const m::Wave& wave = m::model::get(m::model::waves, m_data->waveId);
+	const Frame waveSize = m_data->waveSize;
 
-	m_ratio = wave.getSize() / (float) datasize;
+	m_summary = c::sampleEditor::getSummary(m_data->waveId);
+	m_ratio   = waveSize / (float) datasize;
 
 	/* Limit 1:1 drawing (to avoid sub-frame drawing) by keeping m_ratio >= 1. */
 
 	if (m_ratio < 1) {  
-		datasize = wave.getSize();
+		datasize = waveSize;
 		m_ratio = 1;
 	}
 
@@ -107,56 +110,39 @@ int geWaveform::alloc(int datasize, bool force)
 	m_waveform.size = datasize;
 	m_waveform.sup.resize(m_waveform.size);
 	m_waveform.inf.resize(m_waveform.size);
+	m_waveform.rmsSup.resize(m_waveform.size);
+	m_waveform.rmsInf.resize(m_waveform.size);
 
 	u::log::print("[geWaveform::alloc] %d pixels, %f m_ratio\n", m_waveform.size, m_ratio);
 
 	int offset = h() / 2;
 	int zero   = y() + offset; // center, zero amplitude (-inf dB)
 
-	/* Frid frequency: store a grid point every 'gridFreq' frame (if grid is
+	/* Grid frequency: store a grid point every 'gridFreq' frame (if grid is
 	enabled). TODO - this will cause round off errors, since gridFreq is integer. */
 
-	int gridFreq = m_grid.level != 0 ? wave.getSize() / m_grid.level : 0;
+	int gridFreq = m_grid.level != 0 ? waveSize / m_grid.level : 0;
+	for (int k = gridFreq; gridFreq != 0 && k < waveSize; k += gridFreq)
+		m_grid.points.push_back(k);
 
-	/* Resampling the waveform, hardcore way. Many thanks to 
-	http://fourier.eng.hmc.edu/e161/lectures/resize/node3.html */
+	/* Each pixel shows frames [pc, pn), read from the waveform summary at the
+	closest zoom level, without scanning the audio data. The waveform stays 
+	flat until the summary is ready: see refresh(). */
 
 	for (int i = 0; i < m_waveform.size; i++) {
-		
-		/* Scan the original waveform in chunks [pc, pn]. */
 
 		int pc = i     * m_ratio;  // current point TODO - int until we switch to uint32_t for Wave size...
 		int pn = (i+1) * m_ratio;  // next point    TODO - int until we switch to uint32_t for Wave size...
 
-		float peaksup = 0.0f;
-		float peakinf = 0.0f;
-
-		for (int k = pc; k < pn; k++) { // TODO - int until we switch to uint32_t for Wave size...
-
-			if (k >= wave.getSize())
-				continue;
-
-			/* Compute average of stereo signal. */
-
-			float avg = 0.0f;
-			float* frame = wave.getFrame(k);
-			for (int j = 0; j < wave.getChannels(); j++)
-				avg += frame[j];
-			avg /= wave.getChannels();
-			
-			/* Find peaks (greater and lower). */
+		m::WaveSummary::Bin bin = m_summary != nullptr ? m_summary->get(pc, pn) : m::WaveSummary::Bin{};
 
-			if      (avg > peaksup)  peaksup = avg;
-			else if (avg <= peakinf) peakinf = avg;
+		float peaksup = std::max(bin.max, 0.0f);
+		float peakinf = std::min(bin.min, 0.0f);
 
-			/* Fill up grid vector. */
-
-			if (gridFreq != 0 && (int) k % gridFreq == 0 && k != 0)
-				m_grid.points.push_back(k);
-		}
-
-		m_waveform.sup[i] = zero - (peaksup * offset);
-		m_waveform.inf[i] = zero - (peakinf * offset);
+		m_waveform.sup[i]    = zero - (peaksup * offset);
+		m_waveform.inf[i]    = zero - (peakinf * offset);
+		m_waveform.rmsSup[i] = zero - (std::min(bin.rms, peaksup) * offset);
+		m_waveform.rmsInf[i] = zero + (std::min(bin.rms, -peakinf) * offset);
 
 		// avoid window overflow
 
@@ -216,6 +202,15 @@ void geWaveform::drawWaveform(int from, int to)
 		fl_line(i+x(), zero, i+x(), m_waveform.sup[i]);
 		fl_line(i+x(), zero, i+x(), m_waveform.inf[i]);
 	}
+
+	/* RMS, inside peaks. */
+
+	fl_color(G_COLOR_GREY_3);
+	for (int i=from; i<to; i++) {
+		if (i >= m_waveform.size)
+			break;
+		fl_line(i+x(), m_waveform.rmsSup[i], i+x(), m_waveform.rmsInf[i]);
+	}
 }
 
 
@@ -668,6 +663,21 @@ void geWaveform::rebuild(const c::sampleEditor::Data& d)
 /* -------------------------------------------------------------------------- */
 
 
+void geWaveform::refresh()
+{
+	/* Redraw as soon as a new summary is ready, i.e. computed for the first 
+	time or updated after an edit. */
+
+	if (c::sampleEditor::getSummary(m_data->waveId) == m_summary)
+		return;
+	alloc(m_waveform.size, /*force=*/true);
+	redraw();
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 bool geWaveform::smaller() const
 {
 	return w() < parent()->w();
@@ -29,12 +29,17 @@
 #define GE_WAVEFORM_H
 
 
+#include <memory>
 #include <vector>
 #include <FL/Fl_Widget.H>
 #include "core/const.h"
 
 
 namespace giada {
+namespace m
+{
+class WaveSummary;
+}
 namespace v 
 {
 class geWaveform : public Fl_Widget
@@ -84,6 +89,12 @@ public:
 
 	void rebuild(const c::sampleEditor::Data& d);
 
+	/* refresh
+	Redraws the waveform if its summary has changed in the meantime (see
+	c::sampleEditor::getSummary()). */
+
+	void refresh();
+
 	/* setGridLevel
 	Sets a new frequency level for the grid. 0 means disabled. */
 
@@ -122,8 +133,10 @@ private:
 
 	struct
 	{
-		std::vector<int> sup;   // upper part of the waveform
-		std::vector<int> inf;   // lower part of the waveform
+		std::vector<int> sup;     // upper part of the waveform
+		std::vector<int> inf;     // lower part of the waveform
+		std::vector<int> rmsSup;  // upper part of the RMS band
+		std::vector<int> rmsInf;  // lower part of the RMS band
 		int  size;  // width of the waveform to draw (in pixel)
 	} m_waveform;
 
@@ -190,6 +203,11 @@ private:
 
 	const c::sampleEditor::Data* m_data;
 
+	/* m_summary
+	Waveform summary the picture has been built from. */
+
+	std::shared_ptr<const m::WaveSummary> m_summary;
+
 	int   m_chanStart;
 	bool  m_chanStartLit;
 	int   m_chanEnd;
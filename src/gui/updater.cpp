@@ -28,6 +28,8 @@
 #include <FL/Fl.H>
 #include "core/const.h"
 #include "core/model/model.h"
+#include "core/mixerHandler.h"
+#include "core/autosave.h"
 #include "utils/gui.h"
 #include "updater.h"
 
@@ -38,6 +40,15 @@ namespace updater
 {
 void update(void* /*p*/)
 {
+	/* Give channels the Waves loaded in background so far, if any. This will
+	trigger a rebuild below. */
+
+	m::mh::bindLoadedWaves();
+
+	/* Hand a snapshot of the session to the autosave thread, if it's time. */
+
+	m::autosave::update();
+
 	if (m::model::waves.changed.load()    == true ||
 		m::model::actions.changed.load()  == true ||
 		m::model::channels.changed.load()  == true)
@@ -39,6 +39,7 @@
 	#include "tests/utils.cpp"
 	#include "tests/wave.cpp"
 	#include "tests/waveFx.cpp"
+	#include "tests/waveLoader.cpp"
 	#include "tests/waveManager.cpp"
 #endif
 
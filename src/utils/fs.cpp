@@ -92,6 +92,32 @@ bool mkdir(const std::string& s)
 /* -------------------------------------------------------------------------- */
 
 
+bool remove(const std::string& s)
+{
+	std::error_code ec;
+	return std::filesystem::remove(s, ec);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+bool linkOrCopy(const std::string& from, const std::string& to)
+{
+	std::error_code ec;
+	if (std::filesystem::equivalent(from, to, ec))
+		return true;
+	std::filesystem::remove(to, ec);
+	std::filesystem::create_hard_link(from, to, ec);
+	if (!ec)
+		return true;
+	return std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
 std::string getRealPath(const std::string& s)
 {
 	return s.empty() ? "" : std::filesystem::canonical(s).string();
@@ -49,6 +49,18 @@ bool isRootDir(const std::string& s);
 
 bool isProject(const std::string& s);
 bool mkdir(const std::string& s);
+
+/* remove
+Deletes file 's', if any. */
+
+bool remove(const std::string& s);
+
+/* linkOrCopy
+Makes file 'to' a hard link to file 'from', or a plain copy of it if links are
+not supported (e.g. across different file systems). Any existing 'to' file is 
+replaced. */
+
+bool linkOrCopy(const std::string& from, const std::string& to);
 std::string getCurrentPath();
 std::string getHomePath();
 
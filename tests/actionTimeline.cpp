@@ -0,0 +1,299 @@
+#include <map>
+#include <vector>
+#include "../src/core/actionTimeline.h"
+#include "../src/core/action.h"
+#include "../src/core/midiEvent.h"
+#include "../src/core/types.h"
+#include <catch2/catch.hpp>
+
+
+namespace
+{
+giada::m::Action makeAction(giada::ID id, giada::ID channelId, giada::Frame f, 
+	giada::ID prevId=0, giada::ID nextId=0)
+{
+	using namespace giada::m;
+	return Action{id, channelId, f, MidiEvent(MidiEvent::NOTE_ON, 0, id), -1, -1, 
+		prevId, nextId};
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+std::vector<giada::ID> getIds(const giada::m::ActionTimeline& t)
+{
+	std::vector<giada::ID> out;
+	t.forEach([&](std::size_t i) { out.push_back(t.getId(i)); });
+	return out;
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("ActionTimeline")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	ActionTimeline t;
+	t.insert({
+		makeAction(1, 1, 300, 0, 2),
+		makeAction(2, 1, 500, 1, 0),
+		makeAction(3, 2, 100),
+		makeAction(4, 2, 300),
+	});
+
+	SECTION("test order")
+	{
+		/* Sorted by frame, insertion order within the same frame. */
+
+		REQUIRE(getIds(t) == std::vector<ID>{3, 1, 4, 2});
+
+		t.insert(makeAction(5, 1, 300));
+		REQUIRE(getIds(t) == std::vector<ID>{3, 1, 4, 5, 2});
+	}
+
+	SECTION("test lookups")
+	{
+		REQUIRE(t.find(4) == 2);
+		REQUIRE(t.find(42) == ActionTimeline::npos);
+		REQUIRE(t.lowerBound(0) == 0);
+		REQUIRE(t.lowerBound(300) == 1);
+		REQUIRE(t.lowerBound(301) == 3);
+		REQUIRE(t.lowerBound(1000) == t.size());
+		REQUIRE(t.contains(2, 300, MidiEvent(MidiEvent::NOTE_ON, 0, 4)));
+		REQUIRE(!t.contains(1, 300, MidiEvent(MidiEvent::NOTE_ON, 0, 4)));
+		REQUIRE(t.countOnChannel(1) == 2);
+		REQUIRE(t.countOnChannel(3) == 0);
+
+		std::vector<ID> ids;
+		t.forEachInRange(100, 500, [&](std::size_t i) { ids.push_back(t.getId(i)); });
+		REQUIRE(ids == std::vector<ID>{3, 1, 4});
+
+		ids.clear();
+		t.forEachOnChannel(2, [&](std::size_t i) { ids.push_back(t.getId(i)); });
+		REQUIRE(ids == std::vector<ID>{3, 4});
+
+		ids.clear();
+		t.forEachOnChannel(1, 300, 500, [&](std::size_t i) { ids.push_back(t.getId(i)); });
+		REQUIRE(ids == std::vector<ID>{1});
+	}
+
+	SECTION("test duplicates")
+	{
+		/* Same channel, frame and event of action 4, then twice the same new 
+		action in one batch. */
+
+		Action dup = makeAction(5, 2, 300);
+		dup.event  = t.getEvent(t.find(4));
+
+		t.insert({dup, makeAction(6, 1, 700), makeAction(6, 1, 700)}, /*skipDuplicates=*/true);
+		
+		REQUIRE(t.size() == 5);
+		REQUIRE(t.find(5) == ActionTimeline::npos);
+		REQUIRE(t.find(6) == 4);
+
+		/* The event index follows edits. */
+
+		t.setEvent(t.find(4), MidiEvent(MidiEvent::NOTE_OFF, 0, 0));
+		REQUIRE(t.contains(2, 300, MidiEvent(MidiEvent::NOTE_OFF, 0, 0)));
+		REQUIRE(!t.contains(2, 300, MidiEvent(MidiEvent::NOTE_ON, 0, 4)));
+	}
+
+	SECTION("test large timeline")
+	{
+		std::vector<Action> as;
+		for (int i = 0; i < 1000; i++)
+			as.push_back(makeAction(i + 10, i % 7, i * 3));
+		t.insert(as);
+
+		for (int i = 0; i < 1000; i++) {
+			std::size_t index = t.find(i + 10);
+			REQUIRE(index != ActionTimeline::npos);
+			REQUIRE(t.getFrame(index) == i * 3);
+			REQUIRE(t.contains(i % 7, i * 3, MidiEvent(MidiEvent::NOTE_ON, 0, i + 10)));
+		}
+		REQUIRE(t.find(2000) == ActionTimeline::npos);
+	}
+
+	SECTION("test siblings")
+	{
+		REQUIRE(t.getNext(t.find(1)) == t.find(2));
+		REQUIRE(t.getPrev(t.find(2)) == t.find(1));
+		REQUIRE(t.getPrev(t.find(1)) == ActionTimeline::npos);
+
+		/* Links survive a copy and a reorder. */
+
+		ActionTimeline copy = t;
+		copy.setFrames([](Frame f) { return 1000 - f; });
+		REQUIRE(getIds(copy) == std::vector<ID>{2, 1, 4, 3});
+		REQUIRE(copy.getNext(copy.find(1)) == copy.find(2));
+		REQUIRE(copy.get(copy.find(2)).prevId == 1);
+
+		t.setSiblings(t.find(4), 3, 0);
+		REQUIRE(t.get(t.find(3)).nextId == 4);
+		REQUIRE(t.getNext(t.find(3)) == t.find(4));
+	}
+
+	SECTION("test spans")
+	{
+		REQUIRE(t.getMaxSpan(1) == 200);
+		REQUIRE(t.getMaxSpan(2) == 0);
+		REQUIRE(t.getMaxSpan(3) == 0);
+
+		t.setSiblings(t.find(4), 3, 0);
+		REQUIRE(t.getMaxSpan(2) == 200);
+
+		/* Links going back in time, as in looping envelopes, are left out. */
+
+		t.insert({
+			makeAction(10, 3, 100, 0, 11), 
+			makeAction(11, 3, 400, 10, 12), 
+			makeAction(12, 3, 500, 11, 10)
+		});
+		REQUIRE(t.getMaxSpan(3) == 300);
+
+		t.removeIf([](const Action& a) { return a.channelId == 1; });
+		REQUIRE(t.getMaxSpan(1) == 0);
+	}
+
+	SECTION("test lanes")
+	{
+		/* Two plug-in parameter envelopes and a volume one on channel 3. */
+
+		auto point = [](ID id, Frame f, int value, ID pluginId, int pluginParam)
+		{
+			return Action{id, 3, f, MidiEvent(MidiEvent::ENVELOPE, 0, value), 
+				pluginId, pluginParam, 0, 0};
+		};
+
+		t.insert({
+			point(10, 1000, 0,   7, 0),
+			point(11, 0,    127, 7, 0),
+			point(12, 2000, 127, 7, 0),
+			point(13, 0,    64,  7, 1),
+			point(14, 0,    127, -1, -1),
+		});
+
+		std::vector<ActionTimeline::Lane> lanes;
+		t.forEachLane(3, [&](const ActionTimeline::Lane& l) { lanes.push_back(l); });
+		
+		REQUIRE(lanes.size() == 3);
+		REQUIRE(lanes[0].pluginId == -1);
+		REQUIRE(lanes[1].pluginParam == 0);
+		REQUIRE(lanes[1].last - lanes[1].first == 3);
+
+		/* Points at the same frame and value on different lanes are not 
+		duplicates. */
+
+		REQUIRE(t.contains(3, 0, MidiEvent(MidiEvent::ENVELOPE, 0, 127), 7, 0));
+		REQUIRE(!t.contains(3, 0, MidiEvent(MidiEvent::ENVELOPE, 0, 127), 7, 1));
+
+		/* Linear interpolation between points, flat outside. */
+
+		REQUIRE(t.getLaneValue(lanes[1], 0) == Approx(1.0f));
+		REQUIRE(t.getLaneValue(lanes[1], 500) == Approx(0.5f));
+		REQUIRE(t.getLaneValue(lanes[1], 1000) == Approx(0.0f));
+		REQUIRE(t.getLaneValue(lanes[1], 1500) == Approx(0.5f));
+		REQUIRE(t.getLaneValue(lanes[1], 5000) == Approx(1.0f));
+		REQUIRE(t.getLaneValue(lanes[2], 5000) == Approx(64 / 127.0f));
+
+		/* Lanes follow edits. */
+
+		t.removeIf([](const Action& a) { return a.pluginParam == 1; });
+		lanes.clear();
+		t.forEachLane(3, [&](const ActionTimeline::Lane& l) { lanes.push_back(l); });
+		REQUIRE(lanes.size() == 2);
+		t.forEachLane(1, [&](const ActionTimeline::Lane&) { FAIL(); });
+	}
+
+	SECTION("test remove")
+	{
+		t.removeIf([](const Action& a) { return a.channelId == 2; });
+
+		REQUIRE(getIds(t) == std::vector<ID>{1, 2});
+		REQUIRE(t.countOnChannel(2) == 0);
+		REQUIRE(t.getNext(t.find(1)) == t.find(2));
+
+		t.clear();
+		REQUIRE(t.empty());
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("ActionTimeline benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Cost of cloning a large timeline for a model swap and of reading the 
+	actions of an audio block, against the former map of vectors. */
+
+	static const int   ACTIONS = 50000;
+	static const Frame BLOCK   = 512;
+
+	std::vector<Action> actions;
+	for (int i = 0; i < ACTIONS; i++)
+		actions.push_back(makeAction(i + 1, i % 16, i * 37));
+
+	ActionTimeline timeline;
+	timeline.insert(actions);
+
+	std::map<Frame, std::vector<Action>> map;
+	for (const Action& a : actions)
+		map[a.frame].push_back(a);
+
+	BENCHMARK("copy, map")      { return std::map<Frame, std::vector<Action>>(map).size(); };
+	BENCHMARK("copy, timeline") { return ActionTimeline(timeline).size(); };
+
+	BENCHMARK("read block, map")
+	{
+		int count = 0;
+		for (Frame f = ACTIONS * 18; f < ACTIONS * 18 + BLOCK; f++)
+			if (map.count(f) > 0)
+				count += map.at(f).size();
+		return count;
+	};
+
+	/* Cost of consolidating a live take of one action every 256 frames: the
+	duplicate check used to scan the whole map for each new action. */
+
+	std::vector<Action> take;
+	for (int i = 0; i < ACTIONS / 50; i++)
+		take.push_back(makeAction(ACTIONS + i + 1, 0, i * 256));
+
+	BENCHMARK("consolidate, scan")
+	{
+		std::map<Frame, std::vector<Action>> out = map;
+		for (const Action& a : take) {
+			bool exists = false;
+			for (const auto& [_, as] : out)
+				for (const Action& b : as)
+					exists = exists || (b.channelId == a.channelId && b.frame == a.frame && 
+					                    b.event.getRaw() == a.event.getRaw());
+			if (!exists)
+				out[a.frame].push_back(a);
+		}
+		return out.size();
+	};
+
+	BENCHMARK("consolidate, timeline")
+	{
+		ActionTimeline out = timeline;
+		out.insert(take, /*skipDuplicates=*/true);
+		return out.size();
+	};
+
+	BENCHMARK("read block, timeline")
+	{
+		int count = 0;
+		timeline.forEachInRange(ACTIONS * 18, ACTIONS * 18 + BLOCK, [&](std::size_t) { count++; });
+		return count;
+	};
+}
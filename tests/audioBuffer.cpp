@@ -81,4 +81,61 @@ TEST_CASE("AudioBuffer")
 
 		delete[] data;
 	}
+
+	SECTION("test add range")
+	{
+		AudioBuffer other(BUFFER_SIZE, 2);
+		for (int i=0; i<BUFFER_SIZE; i++) {
+			buffer[i][0] = buffer[i][1] = 1.0f;
+			other[i][0]  = (float) i;
+			other[i][1]  = (float) -i;
+		}
+
+		/* An odd number of frames exercises both the vectorized and the scalar 
+		code paths. */
+
+		buffer.addData(other, 0.5f, 7, 10, 100);
+
+		REQUIRE(buffer[99][0]  == 1.0f);
+		REQUIRE(buffer[100][0] == 6.0f);
+		REQUIRE(buffer[100][1] == -4.0f);
+		REQUIRE(buffer[106][0] == 9.0f);
+		REQUIRE(buffer[106][1] == -7.0f);
+		REQUIRE(buffer[107][0] == 1.0f);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("AudioBuffer benchmarks", "[.][benchmark]")
+{
+	using namespace giada::m;
+
+	/* Cost of overdubbing a block of input onto a loop-sized buffer, frame by
+	frame vs. in one go. */
+
+	static const int BUFFER_SIZE = 512;
+	static const int LOOP_SIZE   = 44100 * 4;
+
+	AudioBuffer loop(LOOP_SIZE, 2);
+	AudioBuffer in(BUFFER_SIZE, 2);
+	loop.clear();
+	in.clear();
+
+	BENCHMARK("overdub, per frame")
+	{
+		for (int i=0; i<BUFFER_SIZE; i++)
+			for (int j=0; j<in.countChannels(); j++)
+				loop[(LOOP_SIZE - 100 + i) % LOOP_SIZE][j] += in[i][j] * 0.5f;
+		return loop[0][0];
+	};
+
+	BENCHMARK("overdub, block")
+	{
+		loop.addData(in, 0.5f, 100, 0, LOOP_SIZE - 100);
+		loop.addData(in, 0.5f, BUFFER_SIZE - 100, 100, 0);
+		return loop[0][0];
+	};
 }
@@ -0,0 +1,153 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "../src/core/autosave.h"
+#include "../src/core/patch.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+
+namespace
+{
+giada::m::patch::Channel makeChannel(giada::ID id, giada::ID columnId)
+{
+	giada::m::patch::Channel c = {};
+	c.id       = id;
+	c.type     = giada::ChannelType::SAMPLE;
+	c.name     = "channel " + std::to_string(id);
+	c.columnId = columnId;
+	c.volume   = G_DEFAULT_VOL;
+	c.pan      = G_DEFAULT_PAN;
+	return c;
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("autosave")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const std::string DIR = "test-autosave";
+
+	autosave::clear(DIR);
+
+	patch::Patch a;
+	a.name     = "session";
+	a.columns  = { { 1, 380 } };
+	a.channels = { makeChannel(4, 1), makeChannel(5, 1), makeChannel(6, 1) };
+	a.waves    = { { 10, "kick.wav" }, { 11, "snare.wav" } };
+	for (ID id = 1; id <= 100; id++)
+		a.actions.push_back({ id, 4, id * 10, 0x90003C00, 0, 0 });
+
+	/* Second state: a channel edited, one removed, one added in a new column,
+	some actions removed, a wave replaced, bpm changed. */
+
+	patch::Patch b = a;
+	b.bpm                 = 90.0f;
+	b.channels[0].volume  = 0.5f;
+	b.channels.erase(b.channels.begin() + 1);
+	b.channels.push_back(makeChannel(7, 2));
+	b.actions.erase(b.actions.begin(), b.actions.begin() + 50);
+	b.actions.push_back({ 101, 7, 5, 0x90003C00, 0, 0 });
+	b.waves[1].path       = "autosave/snare.wav";
+
+	SECTION("test diff")
+	{
+		REQUIRE(!autosave::diff(a, a).has_value());
+
+		std::optional<autosave::Entry> e = autosave::diff(a, b);
+		REQUIRE(e.has_value());
+		REQUIRE(e->changes.channels.size() == 2);
+		REQUIRE(e->removedChannels == std::vector<ID>{ 5 });
+		REQUIRE(e->changes.actions.size() == 1);
+		REQUIRE(e->removedActions.size() == 50);
+		REQUIRE(e->changes.waves.size() == 1);
+		REQUIRE(e->removedWaves.empty());
+		REQUIRE(e->changes.bpm == 90.0f);
+	}
+
+	SECTION("test apply")
+	{
+		patch::Patch p = a;
+		autosave::apply(*autosave::diff(a, b), p);
+
+		REQUIRE(p.bpm == b.bpm);
+		REQUIRE(p.channels == b.channels);
+		REQUIRE(p.actions.size() == b.actions.size());
+		REQUIRE(p.waves == b.waves);
+	}
+
+	SECTION("test recover")
+	{
+		REQUIRE(autosave::canRecover(DIR) == false);
+		REQUIRE(autosave::compact(DIR, a) == true);
+		REQUIRE(autosave::canRecover(DIR) == true);
+
+		patch::Patch c = b;
+		c.channels[0].name = "renamed";
+
+		REQUIRE(autosave::append(DIR, *autosave::diff(a, b)) > 0);
+		REQUIRE(autosave::append(DIR, *autosave::diff(b, c)) > 0);
+
+		SECTION("full journal")
+		{
+			patch::Patch p;
+			REQUIRE(autosave::recover(DIR, p) == G_PATCH_OK);
+			REQUIRE(p.name == c.name);
+			REQUIRE(p.bpm == c.bpm);
+			REQUIRE(p.channels == c.channels);
+			REQUIRE(p.waves == c.waves);
+			REQUIRE(p.actions.size() == c.actions.size());
+
+			/* The new column comes from the channel added in the meantime. */
+
+			REQUIRE(p.columns.size() == 2);
+			REQUIRE(p.columns[1].id == 2);
+		}
+
+		SECTION("torn journal")
+		{
+			/* A crash while appending the last entry: only the first one is 
+			replayed. */
+
+			std::string journal = DIR + G_SLASH + "journal";
+			std::filesystem::resize_file(journal, std::filesystem::file_size(journal) - 10);
+
+			patch::Patch p;
+			REQUIRE(autosave::recover(DIR, p) == G_PATCH_OK);
+			REQUIRE(p.channels == b.channels);
+		}
+
+		SECTION("stale journal")
+		{
+			/* A crash during compaction, right after the new snapshot has been
+			written: the old journal doesn't match and is ignored. */
+
+			std::string journal = DIR + G_SLASH + "journal";
+			std::filesystem::copy_file(journal, journal + ".old");
+			REQUIRE(autosave::compact(DIR, c) == true);
+			std::filesystem::rename(journal + ".old", journal);
+
+			patch::Patch p;
+			REQUIRE(autosave::recover(DIR, p) == G_PATCH_OK);
+			REQUIRE(p.channels == c.channels);
+		}
+
+		SECTION("compaction")
+		{
+			REQUIRE(autosave::compact(DIR, c) == true);
+
+			patch::Patch p;
+			REQUIRE(autosave::recover(DIR, p) == G_PATCH_OK);
+			REQUIRE(p.channels == c.channels);
+			REQUIRE(std::filesystem::file_size(DIR + G_SLASH + "journal") < 100);
+		}
+	}
+
+	autosave::clear(DIR);
+	REQUIRE(autosave::canRecover(DIR) == false);
+}
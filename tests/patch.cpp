@@ -0,0 +1,299 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <string>
+#include "../src/core/patch.h"
+#include "../src/core/patchBinary.h"
+#include "../src/core/const.h"
+#include "../src/core/types.h"
+#include <catch2/catch.hpp>
+
+
+namespace
+{
+/* makePatch
+Fills the global patch with a bit of everything. */
+
+void makePatch(int actions)
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	patch::init();
+	patch::patch.name       = "test patch";
+	patch::patch.bars       = 8;
+	patch::patch.bpm        = 134.5f;
+	patch::patch.lastTakeId = 3;
+	patch::patch.metronome  = true;
+	patch::patch.columns    = { { 1, 380 }, { 2, 200 } };
+	patch::patch.waves      = { { 10, "sample.wav" }, { 11, "loops/drum loop.flac" } };
+
+	for (ID id = 4; id < 8; id++) {
+		patch::Channel c = {};
+		c.id           = id;
+		c.type         = id == 7 ? ChannelType::MIDI : ChannelType::SAMPLE;
+		c.height       = G_GUI_UNIT;
+		c.name         = "channel " + std::to_string(id);
+		c.columnId     = 1;
+		c.volume       = 0.5f;
+		c.pan          = id == 7 ? G_DEFAULT_PAN : 0.25f;
+		c.hasActions   = true;
+		c.midiInKill   = 0xB0000300;
+		c.waveId       = id == 7 ? 0 : 10;
+		c.mode         = SamplePlayerMode::LOOP_BASIC;
+		c.end          = 44100;
+		c.pitch        = 1.5f;
+		c.polyphony    = 4;
+		c.rootNote     = 60;
+		c.inputPair    = id % 3 - 1;
+		c.midiOutChan  = 2;
+		patch::patch.channels.push_back(c);
+	}
+
+	for (int i = 0; i < actions; i++)
+		patch::patch.actions.push_back({ i + 1, 4 + i % 3, i * 100, 0x90003C00u + i % 128, i, i + 2 });
+
+	/* A few plug-in parameter envelope points. */
+
+	for (int i = 0; i < actions; i += 10) {
+		patch::patch.actions[i].event       = 0xB0000000u + i % 128;
+		patch::patch.actions[i].pluginId    = 20;
+		patch::patch.actions[i].pluginParam = i % 4;
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void requireEqual(const giada::m::patch::Patch& a, const giada::m::patch::Patch& b)
+{
+	REQUIRE(a.version == b.version);
+	REQUIRE(a.name == b.name);
+	REQUIRE(a.bars == b.bars);
+	REQUIRE(a.beats == b.beats);
+	REQUIRE(a.bpm == b.bpm);
+	REQUIRE(a.quantize == b.quantize);
+	REQUIRE(a.lastTakeId == b.lastTakeId);
+	REQUIRE(a.samplerate == b.samplerate);
+	REQUIRE(a.metronome == b.metronome);
+
+	REQUIRE(a.columns.size() == b.columns.size());
+	for (std::size_t i = 0; i < a.columns.size(); i++) {
+		REQUIRE(a.columns[i].id == b.columns[i].id);
+		REQUIRE(a.columns[i].width == b.columns[i].width);
+	}
+
+	REQUIRE(a.waves.size() == b.waves.size());
+	for (std::size_t i = 0; i < a.waves.size(); i++) {
+		REQUIRE(a.waves[i].id == b.waves[i].id);
+		REQUIRE(a.waves[i].path == b.waves[i].path);
+	}
+
+	REQUIRE(a.actions.size() == b.actions.size());
+	for (std::size_t i = 0; i < a.actions.size(); i++) {
+		REQUIRE(a.actions[i].id == b.actions[i].id);
+		REQUIRE(a.actions[i].channelId == b.actions[i].channelId);
+		REQUIRE(a.actions[i].frame == b.actions[i].frame);
+		REQUIRE(a.actions[i].event == b.actions[i].event);
+		REQUIRE(a.actions[i].prevId == b.actions[i].prevId);
+		REQUIRE(a.actions[i].nextId == b.actions[i].nextId);
+		REQUIRE(a.actions[i].pluginId == b.actions[i].pluginId);
+		REQUIRE(a.actions[i].pluginParam == b.actions[i].pluginParam);
+	}
+
+	REQUIRE(a.channels.size() == b.channels.size());
+	for (std::size_t i = 0; i < a.channels.size(); i++) {
+		REQUIRE(a.channels[i].id == b.channels[i].id);
+		REQUIRE(a.channels[i].type == b.channels[i].type);
+		REQUIRE(a.channels[i].name == b.channels[i].name);
+		REQUIRE(a.channels[i].volume == b.channels[i].volume);
+		REQUIRE(a.channels[i].pan == b.channels[i].pan);
+		REQUIRE(a.channels[i].midiInKill == b.channels[i].midiInKill);
+		REQUIRE(a.channels[i].waveId == b.channels[i].waveId);
+		REQUIRE(a.channels[i].mode == b.channels[i].mode);
+		REQUIRE(a.channels[i].end == b.channels[i].end);
+		REQUIRE(a.channels[i].pitch == b.channels[i].pitch);
+		REQUIRE(a.channels[i].polyphony == b.channels[i].polyphony);
+		REQUIRE(a.channels[i].rootNote == b.channels[i].rootNote);
+		REQUIRE(a.channels[i].inputPair == b.channels[i].inputPair);
+		REQUIRE(a.channels[i].midiOutChan == b.channels[i].midiOutChan);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+/* setSection
+Overwrites record size and count of the section of type 'type' in binary patch
+'data', the count being limited to what fits in the file. Layout as in 
+patchBinary.cpp: a 32-byte header ending with the number of sections, then a 
+table of 24-byte sections (type, record size, offset, count). */
+
+void setSection(std::string& data, std::uint32_t type, std::uint32_t recordSize, 
+	std::uint64_t count)
+{
+	std::uint32_t sections;
+	std::memcpy(&sections, data.data() + 28, sizeof(sections));
+
+	for (std::uint32_t i = 0; i < sections; i++) {
+		char*         s = data.data() + 32 + i * 24;
+		std::uint32_t t;
+		std::uint64_t offset;
+		std::memcpy(&t, s, sizeof(t));
+		std::memcpy(&offset, s + 8, sizeof(offset));
+		if (t != type)
+			continue;
+		if (recordSize > 0)
+			count = std::min<std::uint64_t>(count, (data.size() - offset) / recordSize);
+		std::memcpy(s + 4, &recordSize, sizeof(recordSize));
+		std::memcpy(s + 16, &count, sizeof(count));
+		return;
+	}
+	FAIL("section not found");
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("patch")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const std::string JSON   = "test-patch.gptc";
+	static const std::string BINARY = "test-patch-binary.gptc";
+	static const std::string COPY   = "test-patch-copy.gptc";
+
+	makePatch(/*actions=*/100);
+	const patch::Patch original = patch::patch;
+
+	REQUIRE(patch::write(JSON, PatchFormat::JSON) == true);
+	REQUIRE(patch::write(BINARY, PatchFormat::BINARY) == true);
+
+	SECTION("test format detection")
+	{
+		REQUIRE(patch::binary::isBinary(JSON) == false);
+		REQUIRE(patch::binary::isBinary(BINARY) == true);
+	}
+
+	SECTION("test binary round trip")
+	{
+		patch::init();
+		REQUIRE(patch::read(BINARY, "") == G_PATCH_OK);
+		requireEqual(patch::patch, original);
+	}
+
+	SECTION("test conversion")
+	{
+		/* JSON -> binary -> JSON gives back the same patch. The global patch
+		is left untouched. */
+
+		REQUIRE(patch::convert(JSON, COPY, PatchFormat::BINARY) == G_PATCH_OK);
+		REQUIRE(patch::binary::isBinary(COPY) == true);
+		REQUIRE(patch::convert(COPY, COPY, PatchFormat::JSON) == G_PATCH_OK);
+		REQUIRE(patch::binary::isBinary(COPY) == false);
+		requireEqual(patch::patch, original);
+
+		patch::init();
+		REQUIRE(patch::read(COPY, "") == G_PATCH_OK);
+		requireEqual(patch::patch, original);
+	}
+
+	SECTION("test base path")
+	{
+		patch::init();
+		REQUIRE(patch::read(BINARY, "project/") == G_PATCH_OK);
+		REQUIRE(patch::patch.waves[1].path == "project/loops/drum loop.flac");
+	}
+
+	SECTION("test corrupted files")
+	{
+		std::ifstream      ifs(BINARY, std::ios::binary);
+		const std::string  data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+		SECTION("truncated")
+		{
+			std::ofstream(COPY, std::ios::binary).write(data.data(), data.size() / 2);
+		}
+
+		SECTION("header only")
+		{
+			std::ofstream(COPY, std::ios::binary).write(data.data(), 16);
+		}
+
+		SECTION("garbage table")
+		{
+			std::string garbage = data;
+			for (std::size_t i = 36; i < 200; i++)
+				garbage[i] = static_cast<char>(0xFF);
+			std::ofstream(COPY, std::ios::binary).write(garbage.data(), garbage.size());
+		}
+
+		/* Record counts must not make the reader allocate more than a few times 
+		the file size. Section type 5 is CHANNELS. */
+
+		SECTION("zero record size")
+		{
+			std::string bad = data;
+			setSection(bad, 5, 0, std::numeric_limits<std::uint64_t>::max() / 2);
+			std::ofstream(COPY, std::ios::binary).write(bad.data(), bad.size());
+		}
+
+		SECTION("tiny records")
+		{
+			std::string bad = data;
+			setSection(bad, 5, 1, std::numeric_limits<std::uint64_t>::max());
+			std::ofstream(COPY, std::ios::binary).write(bad.data(), bad.size());
+		}
+
+		patch::init();
+		REQUIRE(patch::read(COPY, "") == G_PATCH_INVALID);
+	}
+
+	REQUIRE(patch::read("does-not-exist.gptc", "") == G_PATCH_UNREADABLE);
+
+	std::remove(JSON.c_str());
+	std::remove(BINARY.c_str());
+	std::remove(COPY.c_str());
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("patch benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Cost of loading a patch with lots of actions, JSON vs. binary. */
+
+	static const std::string JSON   = "test-patch-bench.gptc";
+	static const std::string BINARY = "test-patch-bench-binary.gptc";
+
+	makePatch(/*actions=*/50000);
+	patch::write(JSON, PatchFormat::JSON);
+	patch::write(BINARY, PatchFormat::BINARY);
+
+	BENCHMARK("read, JSON")
+	{
+		patch::init();
+		patch::read(JSON, "");
+		return patch::patch.actions.size();
+	};
+
+	BENCHMARK("read, binary")
+	{
+		patch::init();
+		patch::read(BINARY, "");
+		return patch::patch.actions.size();
+	};
+
+	std::remove(JSON.c_str());
+	std::remove(BINARY.c_str());
+}
@@ -1,3 +1,4 @@
+#include <vector>
 #include "../src/core/recorder.h"
 #include "../src/core/const.h"
 #include "../src/core/types.h"
@@ -59,6 +60,102 @@ TEST_CASE("recorder")
 		}
 
 
+		SECTION("Test range")
+		{
+			/* A long note crossing the whole range, plus one right after it. */
+
+			recorder::rec(ch, 1000, 5000, e1, e2);
+			recorder::rec(ch, 3000, MidiEvent(MidiEvent::NOTE_ON, 0x01, 0x00));
+
+			std::vector<Action> as = recorder::getActionsOnChannel(ch, 2000, 4000);
+
+			REQUIRE(as.size() == 3);
+			REQUIRE(as[0].frame == 1000);
+			REQUIRE(as[1].frame == 3000);
+			REQUIRE(as[2].frame == 5000);
+			REQUIRE(recorder::getActionsOnChannel(ch, 0, 20).size() == 1);
+			REQUIRE(recorder::getActionsOnChannel(ch, 6000, 7000).size() == 0);
+		}
+
+		SECTION("Test envelopes")
+		{
+			/* A volume and a plug-in parameter envelope on the same frames. */
+
+			const MidiEvent e = MidiEvent(MidiEvent::ENVELOPE, 0x00, 0x7F);
+
+			REQUIRE(recorder::rec(ch, 0, e).isValid());
+			REQUIRE(recorder::rec(ch, 0, e, /*pluginId=*/5, /*param=*/2).isValid());
+			REQUIRE(!recorder::rec(ch, 0, e, 5, 2).isValid()); // Duplicate
+			REQUIRE(recorder::rec(ch, 500, e, 5, 2).isValid());
+
+			REQUIRE(recorder::hasEnvelope(ch));
+			REQUIRE(recorder::hasEnvelope(ch, 5, 2));
+			REQUIRE(!recorder::hasEnvelope(ch, 5, 3));
+			REQUIRE(recorder::getClosestEnvelopeAction(ch, 600, 5, 2).frame == 500);
+			REQUIRE(recorder::getClosestEnvelopeAction(ch, 600).frame == 0);
+
+			recorder::clearEnvelope(ch);
+			REQUIRE(!recorder::hasEnvelope(ch));
+			REQUIRE(recorder::hasEnvelope(ch, 5, 2));
+
+			recorder::clearPluginActions(5);
+			REQUIRE(!recorder::hasEnvelope(ch, 5, 2));
+			REQUIRE(recorder::hasActions(ch));
+		}
+
+		SECTION("Test envelope merge")
+		{
+			/* Points recorded live on a plug-in parameter: a new envelope gets
+			its boundaries from the first point, the latest point on a frame 
+			wins. */
+
+			recorder::recEnvelope(ch, /*pluginId=*/5, /*param=*/2, 
+				{{500, 10}, {300, 20}, {500, 30}}, /*framesInLoop=*/1000);
+
+			std::vector<Action> as;
+			recorder::forEachAction([&](const Action& a) 
+			{
+				if (a.pluginId == 5) as.push_back(a);
+			});
+
+			REQUIRE(as.size() == 4);
+			REQUIRE(as[0].frame == 0);
+			REQUIRE(as[0].event.getVelocity() == 10);
+			REQUIRE(as[1].frame == 300);
+			REQUIRE(as[2].frame == 500);
+			REQUIRE(as[2].event.getVelocity() == 30);
+			REQUIRE(as[3].frame == 999);
+			REQUIRE(as[3].event.getVelocity() == 10);
+			for (std::size_t i = 0; i < as.size(); i++) {
+				REQUIRE(as[i].nextId == as[(i + 1) % as.size()].id);
+				REQUIRE(as[(i + 1) % as.size()].prevId == as[i].id);
+			}
+
+			/* Second pass over the same envelope: points go in between the 
+			existing ones, or replace them. Nothing past the loop. */
+
+			recorder::recEnvelope(ch, 5, 2, {{400, 40}, {300, 50}, {2000, 60}}, 1000);
+
+			as.clear();
+			recorder::forEachAction([&](const Action& a) 
+			{
+				if (a.pluginId == 5) as.push_back(a);
+			});
+
+			REQUIRE(as.size() == 5);
+			REQUIRE(as[1].frame == 300);
+			REQUIRE(as[1].event.getVelocity() == 50);
+			REQUIRE(as[2].frame == 400);
+			REQUIRE(as[2].event.getVelocity() == 40);
+			for (std::size_t i = 0; i < as.size(); i++)
+				REQUIRE(recorder::getAction(as[i].id).nextId == as[(i + 1) % as.size()].id);
+
+			/* Volume envelopes start at full scale. */
+
+			recorder::recEnvelope(ch, -1, -1, {{500, 10}}, 1000);
+			REQUIRE(recorder::getClosestEnvelopeAction(ch, 100).event.getVelocity() == G_MAX_VELOCITY);
+		}
+
 		SECTION("Test clear all")
 		{
 			recorder::clearAll();
@@ -0,0 +1,134 @@
+#include <cmath>
+#include <vector>
+#include <samplerate.h>
+#include "../src/core/resampler.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("Resampler")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const int FRAMES = 1024;
+
+	auto quality = GENERATE(ResamplerQuality::LINEAR, ResamplerQuality::CUBIC,
+		ResamplerQuality::SINC_16, ResamplerQuality::SINC_64);
+
+	Resampler resampler(quality);
+
+	/* Input: history frames, then a ramp where each frame holds its own index
+	(left) and its negative (right), then enough frames for the kernel tail. */
+
+	const int history = resampler.getHistory();
+	std::vector<float> in((FRAMES + resampler.getTaps()) * G_MAX_IO_CHANS);
+	for (int i = 0; i < FRAMES + resampler.getTaps(); i++) {
+		in[i * 2]     =  static_cast<float>(i - history);
+		in[i * 2 + 1] = -static_cast<float>(i - history);
+	}
+
+	std::vector<float> out(FRAMES * G_MAX_IO_CHANS);
+
+	SECTION("test frame count")
+	{
+		REQUIRE(resampler.countOutputFrames(100, 0.5f) == 200);
+		REQUIRE(resampler.countOutputFrames(100, 2.0f) == 50);
+		REQUIRE(resampler.countInputFrames(200, 0.5f) == 100);
+		REQUIRE(resampler.countInputFrames(50, 2.0f) == 99);
+
+		REQUIRE(resampler.process(in.data(), out.data(), 100, 0.5f) == 50);
+		REQUIRE(resampler.process(in.data(), out.data(), 3, 0.5f) == 1);
+
+		/* Half a frame is left over from the previous call. */
+
+		REQUIRE(resampler.countOutputFrames(100, 0.5f) == 199);
+		REQUIRE(resampler.process(in.data(), out.data(), 1, 0.5f) == 1);
+
+		resampler.reset();
+		REQUIRE(resampler.countOutputFrames(100, 0.5f) == 200);
+	}
+
+	SECTION("test interpolation")
+	{
+		/* A ramp is a straight line: every tier must follow it closely, far 
+		from the kernel edges. */
+
+		const float step = 0.37f;
+		const int   n    = std::min(FRAMES, resampler.countOutputFrames(FRAMES / 2, step));
+		resampler.process(in.data(), out.data(), n, step);
+
+		float margin = quality == ResamplerQuality::SINC_64 ? 0.05f : 0.01f;
+		for (int i = 64; i < n; i++) {
+			REQUIRE(out[i * 2]     == Approx( i * step).margin(margin));
+			REQUIRE(out[i * 2 + 1] == Approx(-i * step).margin(margin));
+		}
+	}
+
+	SECTION("test unity gain")
+	{
+		std::fill(in.begin(), in.end(), 0.5f);
+
+		resampler.process(in.data(), out.data(), FRAMES / 2, 1.7f);
+
+		for (int i = 0; i < FRAMES / 2 * G_MAX_IO_CHANS; i++)
+			REQUIRE(out[i] == Approx(0.5f).margin(0.0001f));
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("Resampler benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Renders one second of stereo noise in audio-sized blocks, as a sample 
+	channel does at pitch != 1.0. */
+
+	static const int   BUFFER = 512;
+	static const float PITCH  = 1.3f;
+	static const int   FRAMES = G_DEFAULT_SAMPLERATE;
+
+	std::vector<float> in((FRAMES * 2 + Resampler::MAX_TAPS) * G_MAX_IO_CHANS);
+	std::vector<float> out(BUFFER * G_MAX_IO_CHANS);
+	for (float& s : in)
+		s = (std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f;
+
+	auto run = [&](ResamplerQuality q)
+	{
+		Resampler r(q);
+		Frame     used = 0;
+		for (int f = 0; f < FRAMES; f += BUFFER)
+			used += r.process(in.data() + used * G_MAX_IO_CHANS, out.data(), BUFFER, PITCH);
+		return used;
+	};
+
+	auto runSrc = [&](int type)
+	{
+		SRC_STATE* src = src_new(type, G_MAX_IO_CHANS, nullptr);
+		Frame      used = 0;
+		for (int f = 0; f < FRAMES; f += BUFFER) {
+			SRC_DATA data;
+			data.data_in       = in.data() + used * G_MAX_IO_CHANS;
+			data.input_frames  = FRAMES * 2 - used;
+			data.data_out      = out.data();
+			data.output_frames = BUFFER;
+			data.end_of_input  = false;
+			data.src_ratio     = 1 / PITCH;
+			src_process(src, &data);
+			used += data.input_frames_used;
+		}
+		src_delete(src);
+		return used;
+	};
+
+	BENCHMARK("SRC_LINEAR")       { return runSrc(SRC_LINEAR); };
+	BENCHMARK("SRC_SINC_FASTEST") { return runSrc(SRC_SINC_FASTEST); };
+	BENCHMARK("Resampler linear") { return run(ResamplerQuality::LINEAR); };
+	BENCHMARK("Resampler cubic")  { return run(ResamplerQuality::CUBIC); };
+	BENCHMARK("Resampler sinc16") { return run(ResamplerQuality::SINC_16); };
+	BENCHMARK("Resampler sinc64") { return run(ResamplerQuality::SINC_64); };
+}
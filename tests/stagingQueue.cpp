@@ -0,0 +1,69 @@
+#include <thread>
+#include "../src/core/stagingQueue.h"
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("StagingQueue")
+{
+	using namespace giada::m;
+
+	StagingQueue<int> queue;
+
+	SECTION("test empty")
+	{
+		int item;
+		REQUIRE(queue.capacity() == 0);
+		REQUIRE(queue.push(1) == false);
+		REQUIRE(queue.pop(item) == false);
+		REQUIRE(queue.takeDropped() == 1);
+	}
+
+	SECTION("test overflow")
+	{
+		queue.alloc(4);
+
+		for (int i = 0; i < 6; i++)
+			queue.push(i);
+
+		REQUIRE(queue.takeDropped() == 2);
+		REQUIRE(queue.takeDropped() == 0);
+
+		int item;
+		for (int i = 0; i < 4; i++) {
+			REQUIRE(queue.pop(item) == true);
+			REQUIRE(item == i);
+		}
+		REQUIRE(queue.pop(item) == false);
+
+		/* Room again after draining. */
+
+		REQUIRE(queue.push(42) == true);
+		REQUIRE(queue.pop(item) == true);
+		REQUIRE(item == 42);
+	}
+
+	SECTION("test concurrent")
+	{
+		/* The consumer drains while the producer pushes: nothing is lost as 
+		long as the queue never fills up, and the order is kept. */
+
+		static const int ITEMS = 100000;
+
+		queue.alloc(ITEMS);
+
+		std::thread producer([&]()
+		{
+			for (int i = 0; i < ITEMS; i++)
+				queue.push(i);
+		});
+
+		int expected = 0;
+		int item;
+		while (expected < ITEMS)
+			if (queue.pop(item))
+				REQUIRE(item == expected++);
+
+		producer.join();
+		REQUIRE(queue.takeDropped() == 0);
+	}
+}
@@ -0,0 +1,56 @@
+#include <filesystem>
+#include <samplerate.h>
+#include "../src/core/takeWriter.h"
+#include "../src/core/waveManager.h"
+#include "../src/core/wave.h"
+#include "../src/core/audioBuffer.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("takeWriter")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	namespace fs = std::filesystem;
+
+	static const Frame BUFFER = 512;
+	static const int   BLOCKS = 100;
+
+	std::string path = (fs::temp_directory_path() / "giada-test-take.wav").string();
+
+	AudioBuffer in(BUFFER, G_MAX_IO_CHANS);
+	for (Frame i = 0; i < BUFFER; i++) {
+		in[i][0] = 0.5f;
+		in[i][1] = -0.5f;
+	}
+
+	SECTION("test writing")
+	{
+		REQUIRE(takeWriter::open(path, G_MAX_IO_CHANS, G_DEFAULT_SAMPLERATE) == true);
+		REQUIRE(takeWriter::isOpen());
+
+		for (int i = 0; i < BLOCKS; i++)
+			takeWriter::push(in, 0.5f);
+
+		REQUIRE(takeWriter::close() == BUFFER * BLOCKS);
+		REQUIRE(!takeWriter::isOpen());
+
+		waveManager::Result res = waveManager::createFromFile(path, /*ID=*/0, 
+			G_DEFAULT_SAMPLERATE, SRC_LINEAR);
+
+		REQUIRE(res.status == G_RES_OK);
+		REQUIRE(res.wave->getSize() == BUFFER * BLOCKS);
+		REQUIRE((*res.wave)[BUFFER * BLOCKS - 1][0] == 0.25f);
+		REQUIRE((*res.wave)[BUFFER * BLOCKS - 1][1] == -0.25f);
+	}
+
+	SECTION("test closed")
+	{
+		takeWriter::push(in, 1.0f);
+		REQUIRE(takeWriter::close() == 0);
+	}
+
+	fs::remove(path);
+}
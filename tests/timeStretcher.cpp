@@ -0,0 +1,152 @@
+#include <cmath>
+#include <functional>
+#include <vector>
+#include "../src/core/timeStretcher.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+
+namespace
+{
+/* Source
+Stereo input for the TimeStretcher, silent outside its bounds. */
+
+struct Source
+{
+	Source(giada::Frame frames, std::function<float(giada::Frame)> f)
+	: data(frames * 2)
+	, position(0)
+	{
+		for (giada::Frame i = 0; i < frames; i++)
+			data[i * 2] = data[i * 2 + 1] = f(i);
+	}
+
+	void operator()(giada::Frame offset, giada::Frame count, float* dest) const
+	{
+		giada::Frame first = position + offset;
+		if (first >= 0 && first + count <= static_cast<giada::Frame>(data.size() / 2)) {
+			std::copy_n(data.data() + first * 2, count * 2, dest);
+			return;
+		}
+		for (giada::Frame i = 0; i < count; i++) {
+			giada::Frame f = first + i;
+			bool inside = f >= 0 && f < static_cast<giada::Frame>(data.size() / 2);
+			dest[i * 2]     = inside ? data[f * 2]     : 0.0f;
+			dest[i * 2 + 1] = inside ? data[f * 2 + 1] : 0.0f;
+		}
+	}
+
+	std::vector<float> data;
+	giada::Frame       position;
+};
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("TimeStretcher")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const Frame BUFFER = 256;
+	static const Frame FRAMES = 44100;
+
+	TimeStretcher stretcher;
+	std::vector<float> out(BUFFER * 2);
+
+	SECTION("test input consumption")
+	{
+		float stretch = GENERATE(0.5f, 1.0f, 1.5f, 3.0f);
+
+		Source source(FRAMES, [](Frame) { return 0.0f; });
+		Frame  generated = 0;
+		while (generated < FRAMES / 2) {
+			source.position += stretcher.process(out.data(), BUFFER, stretch, source);
+			generated       += BUFFER;
+		}
+
+		/* Input runs ahead of output by at most one hop. */
+
+		REQUIRE(source.position == Approx(generated / stretch).margin(TimeStretcher::HOP / stretch + 1));
+	}
+
+	SECTION("test unity gain")
+	{
+		Source source(FRAMES, [](Frame) { return 0.5f; });
+		for (Frame f = 0; f < FRAMES / 2; f += BUFFER) {
+			source.position += stretcher.process(out.data(), BUFFER, 1.3f, source);
+			for (float s : out)
+				REQUIRE(s == Approx(0.5f).margin(0.001f));
+		}
+	}
+
+	SECTION("test pitch is preserved")
+	{
+		/* 441 Hz at 44100 Hz: one period every 100 frames. */
+
+		Source source(FRAMES * 2, [](Frame f) { return std::sin(2.0f * 3.14159265f * f / 100.0f); });
+
+		std::vector<float> rendered;
+		for (Frame f = 0; f < FRAMES; f += BUFFER) {
+			source.position += stretcher.process(out.data(), BUFFER, 1.7f, source);
+			rendered.insert(rendered.end(), out.begin(), out.end());
+		}
+
+		int crossings = 0;
+		for (std::size_t i = TimeStretcher::GRAIN * 2; i + 2 < rendered.size(); i += 2)
+			if ((rendered[i] < 0.0f) != (rendered[i + 2] < 0.0f))
+				crossings++;
+
+		float frames   = rendered.size() / 2 - TimeStretcher::GRAIN;
+		float expected = frames / 50.0f; // Two crossings per period
+		REQUIRE(crossings == Approx(expected).epsilon(0.02));
+	}
+
+	SECTION("test reset")
+	{
+		Source source(FRAMES, [](Frame) { return 0.5f; });
+		for (Frame f = 0; f < FRAMES / 4; f += BUFFER)
+			source.position += stretcher.process(out.data(), BUFFER, 1.0f, source);
+
+		stretcher.reset();
+
+		/* Starts over right away, with no fade in. */
+
+		stretcher.process(out.data(), BUFFER, 1.0f, source);
+		REQUIRE(out[0] == 0.5f);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("TimeStretcher benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Cost of one channel rendering one second of audio in audio-sized blocks,
+	at the stretch factors of common tempo changes. */
+
+	static const Frame BUFFER = 512;
+	static const Frame FRAMES = G_DEFAULT_SAMPLERATE;
+
+	Source source(FRAMES * 4, [](Frame) { return (std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f; });
+	std::vector<float> out(BUFFER * 2);
+
+	auto run = [&](float stretch)
+	{
+		TimeStretcher stretcher;
+		source.position = 0;
+		for (Frame f = 0; f < FRAMES; f += BUFFER)
+			source.position += stretcher.process(out.data(), BUFFER, stretch, source);
+		return source.position;
+	};
+
+	BENCHMARK("stretch 0.8")  { return run(0.8f); };
+	BENCHMARK("stretch 1.25") { return run(1.25f); };
+	BENCHMARK("stretch 2.0")  { return run(2.0f); };
+}
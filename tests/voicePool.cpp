@@ -0,0 +1,195 @@
+#include <cstdlib>
+#include "../src/core/channels/voicePool.h"
+#include "../src/core/audioBuffer.h"
+#include "../src/core/wave.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("VoicePool")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const Frame BUFFER = 256;
+	static const Frame SIZE   = BUFFER * 16;
+
+	Wave wave(1);
+	wave.alloc(SIZE, G_MAX_IO_CHANS, G_DEFAULT_SAMPLERATE, 32, "path/to/sample.wav");
+	for (Frame i = 0; i < SIZE; i++)
+		wave[i][0] = wave[i][1] = 1.0f;
+
+	VoicePool   pool(BUFFER);
+	AudioBuffer out(BUFFER, G_MAX_IO_CHANS);
+
+	pool.setWave(&wave);
+
+	SECTION("test pool size")
+	{
+		/* A mono channel has no extra voices: the player is the only one. */
+
+		REQUIRE(pool.start(0, 0, 1.0f, 1.0f, -1) == false);
+
+		pool.setPolyphony(4);
+		for (int i = 0; i < 3; i++)
+			REQUIRE(pool.start(0, 0, 1.0f, 1.0f, -1) == true);
+		REQUIRE(pool.countActive() == 3);
+
+		/* In keyed mode all voices come from the pool. */
+
+		pool.setRootNote(60);
+		REQUIRE(pool.isKeyed());
+		REQUIRE(pool.countActive() == 0);
+		for (int i = 0; i < 4; i++)
+			pool.start(0, 0, 1.0f, 1.0f, 60 + i);
+		REQUIRE(pool.countActive() == 4);
+
+		pool.setPolyphony(G_MAX_POLYPHONY * 2);
+		REQUIRE(pool.getPolyphony() == G_MAX_POLYPHONY);
+	}
+
+	SECTION("test rendering")
+	{
+		pool.setPolyphony(3);
+		pool.start(0, 0,   1.0f, 0.5f,  -1);
+		pool.start(0, 100, 1.0f, 0.25f, -1);
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+
+		REQUIRE(out[99][0]  == Approx(0.5f));
+		REQUIRE(out[100][0] == Approx(0.75f));
+		REQUIRE(out[BUFFER - 1][1] == Approx(0.75f));
+	}
+
+	SECTION("test end of range")
+	{
+		pool.setPolyphony(2);
+		pool.start(SIZE - 10, 0, 1.0f, 1.0f, -1);
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+
+		REQUIRE(out[9][0]  == Approx(1.0f));
+		REQUIRE(out[10][0] == 0.0f);
+		REQUIRE(pool.countActive() == 0);
+	}
+
+	SECTION("test release")
+	{
+		pool.setRootNote(60);
+		pool.setPolyphony(2);
+		pool.start(0, 0, 1.0f, 1.0f, 60);
+		pool.start(0, 0, 1.0f, 1.0f, 61);
+		pool.release(60, 100);
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+
+		REQUIRE(out[99][0]  == Approx(2.0f));
+		REQUIRE(out[100][0] == Approx(1.0f));
+		REQUIRE(pool.countActive() == 1);
+
+		pool.kill(0);
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+		REQUIRE(pool.countActive() == 0);
+	}
+
+	SECTION("test stealing")
+	{
+		pool.setPolyphony(3);
+		pool.start(0, 0, 1.0f, 0.5f,  -1);
+		pool.start(0, 0, 1.0f, 0.25f, -1);
+
+		auto steal = [&](VoiceStealing s)
+		{
+			pool.setStealing(s);
+			bool started = pool.start(0, 0, 1.0f, 1.0f, -1);
+			pool.render(out, 1.0f, 1.0f, 0, SIZE);
+			return started;
+		};
+
+		SECTION("oldest")
+		{
+			REQUIRE(steal(VoiceStealing::OLDEST) == true);
+			REQUIRE(out[0][0] == Approx(1.25f));
+		}
+
+		SECTION("quietest")
+		{
+			REQUIRE(steal(VoiceStealing::QUIETEST) == true);
+			REQUIRE(out[0][0] == Approx(1.5f));
+		}
+
+		SECTION("none")
+		{
+			REQUIRE(steal(VoiceStealing::NONE) == false);
+			REQUIRE(out[0][0] == Approx(0.75f));
+		}
+	}
+
+	SECTION("test fork")
+	{
+		WaveReader reader;
+		reader.wave = &wave;
+
+		pool.setPolyphony(2);
+		REQUIRE(pool.fork(reader, SIZE - BUFFER - 1) == true);
+
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+		REQUIRE(pool.countActive() == 1);
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+		REQUIRE(pool.countActive() == 0);
+	}
+
+	SECTION("test pitch")
+	{
+		/* An octave up reads twice as fast. */
+
+		pool.setRootNote(60);
+		pool.setPolyphony(1);
+		pool.start(SIZE - BUFFER * 2, 0, 2.0f, 1.0f, 72);
+		pool.render(out, 1.0f, 1.0f, 0, SIZE);
+
+		REQUIRE(pool.countActive() == 0);
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("VoicePool benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Cost of one second of audio rendered in audio-sized blocks by a growing
+	number of voices, both at the original pitch (plain copy) and resampled. */
+
+	static const Frame BUFFER = 512;
+	static const Frame FRAMES = G_DEFAULT_SAMPLERATE;
+
+	Wave wave(1);
+	wave.alloc(FRAMES * 4, G_MAX_IO_CHANS, G_DEFAULT_SAMPLERATE, 32, "path/to/sample.wav");
+	for (Frame i = 0; i < FRAMES * 4; i++)
+		wave[i][0] = wave[i][1] = (std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f;
+
+	AudioBuffer out(BUFFER, G_MAX_IO_CHANS);
+
+	auto run = [&](VoicePool& pool, int voices, float pitch)
+	{
+		for (int i = 0; i < voices; i++)
+			pool.start(i, 0, pitch, 1.0f, 60 + i);
+		for (Frame f = 0; f < FRAMES; f += BUFFER) {
+			out.clear();
+			pool.render(out, 1.0f, 1.0f, 0, FRAMES * 4);
+		}
+		pool.kill(0);
+		return out[0][0];
+	};
+
+	for (int voices : { 1, 8, 32 }) {
+		VoicePool pool(BUFFER);
+		pool.setWave(&wave);
+		pool.setRootNote(60);
+		pool.setPolyphony(voices);
+
+		BENCHMARK("voices " + std::to_string(voices) + ", pitch 1.0") { return run(pool, voices, 1.0f); };
+		BENCHMARK("voices " + std::to_string(voices) + ", pitch 1.5") { return run(pool, voices, 1.5f); };
+	}
+}
@@ -1,4 +1,5 @@
 #include <memory>
+#include <utility>
 #include "../src/core/wave.h"
 #include <catch2/catch.hpp>
 
@@ -45,5 +46,49 @@ TEST_CASE("Wave")
 			REQUIRE(wave.getBasename() == "sample");
 			REQUIRE(wave.getBasename(true) == "sample.wav");
 		}
+
+		SECTION("test copy-on-write")
+		{
+			wave[0][0] = 0.5f;
+
+			m::Wave copy(wave);
+
+			REQUIRE(copy.isSharingData(wave));
+			REQUIRE(std::as_const(copy).getFrame(0) == std::as_const(wave).getFrame(0));
+
+			copy[0][0] = 1.0f;
+
+			REQUIRE(!copy.isSharingData(wave));
+			REQUIRE(copy.getSize() == wave.getSize());
+			REQUIRE(std::as_const(copy)[0][0] == 1.0f);
+			REQUIRE(std::as_const(wave)[0][0] == 0.5f);
+		}
+
+		SECTION("test dirty tracking")
+		{
+			REQUIRE(wave.isDirty());
+
+			wave.setSourcePath("path/to/sample.wav");
+
+			REQUIRE(!wave.isDirty());
+			REQUIRE(wave.getSourcePath() == "path/to/sample.wav");
+
+			/* Copies are clean as well, until written to. Reads don't count. */
+
+			m::Wave copy(wave);
+			std::as_const(copy).getFrame(0);
+
+			REQUIRE(!copy.isDirty());
+
+			copy[0][0] = 1.0f;
+
+			REQUIRE(copy.isDirty());
+			REQUIRE(copy.getSourcePath() == "");
+			REQUIRE(!wave.isDirty());
+
+			wave.setData(m::WaveData(BUFFER_SIZE, CHANNELS));
+
+			REQUIRE(wave.isDirty());
+		}
 	}
 }
@@ -0,0 +1,326 @@
+#include <memory>
+#include <vector>
+#include "../src/core/waveData.h"
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("WaveData")
+{
+	using namespace giada::m;
+
+	static const int SIZE     = WaveData::CHUNK_SIZE * 2 + 100; // 3 chunks
+	static const int CHANNELS = 2;
+
+	/* Each SECTION the TEST_CASE is executed from the start. Any code between 
+	this comment and the first SECTION macro is exectuted before each SECTION. */
+
+	WaveData data(SIZE, CHANNELS);
+
+	/* Fill frame 'i' with value 'i' on each channel, so that frames can be 
+	tracked after structural edits. */
+
+	for (int i = 0; i < SIZE;) {
+		WaveData::WritableBlock block = data.getWritableBlock(i);
+		for (int k = 0; k < block.frames; k++, i++)
+			for (int j = 0; j < CHANNELS; j++)
+				block.data[k * CHANNELS + j] = static_cast<float>(i);
+	}
+
+	SECTION("test allocation")
+	{
+		REQUIRE(data.countFrames() == SIZE);
+		REQUIRE(data.countChannels() == CHANNELS);
+		REQUIRE(data.countPieces() == 3);
+		REQUIRE(data.getBlock(0).frames == WaveData::CHUNK_SIZE);
+		REQUIRE(data.getBlock(10).frames == WaveData::CHUNK_SIZE - 10);
+		REQUIRE(data.getBlock(SIZE - 1).frames == 1);
+		REQUIRE(data[WaveData::CHUNK_SIZE][0] == WaveData::CHUNK_SIZE);
+	}
+
+	SECTION("test slice")
+	{
+		WaveData slice = data.slice(50, WaveData::CHUNK_SIZE + 50);
+
+		REQUIRE(slice.countFrames() == WaveData::CHUNK_SIZE);
+		REQUIRE(slice.countPieces() == 2);
+		REQUIRE(slice[0][0] == 50);
+		REQUIRE(slice[WaveData::CHUNK_SIZE - 1][1] == WaveData::CHUNK_SIZE + 49);
+		REQUIRE(slice[0] == data[50]); // Same memory, nothing copied
+	}
+
+	SECTION("test remove")
+	{
+		data.remove(10, 20);
+
+		REQUIRE(data.countFrames() == SIZE - 10);
+		REQUIRE(data[9][0] == 9);
+		REQUIRE(data[10][0] == 20);
+		REQUIRE(data[SIZE - 11][0] == SIZE - 1);
+	}
+
+	SECTION("test insert")
+	{
+		WaveData other = data.slice(0, 10);
+		data.insert(5, other);
+
+		REQUIRE(data.countFrames() == SIZE + 10);
+		REQUIRE(data[4][0] == 4);
+		REQUIRE(data[5][0] == 0);
+		REQUIRE(data[14][0] == 9);
+		REQUIRE(data[15][0] == 5);
+
+		SECTION("test remove inserted data")
+		{
+			/* Contiguous pieces are merged back together. */
+
+			data.remove(5, 15);
+
+			REQUIRE(data.countFrames() == SIZE);
+			REQUIRE(data.countPieces() == 3);
+		}
+	}
+
+	SECTION("test rotate")
+	{
+		data.rotate(SIZE - 1);
+
+		REQUIRE(data[0][0] == SIZE - 1);
+		REQUIRE(data[1][0] == 0);
+		REQUIRE(data[SIZE - 1][0] == SIZE - 2);
+	}
+
+	SECTION("test copy-on-write")
+	{
+		WaveData copy = data;
+
+		copy.getWritableBlock(WaveData::CHUNK_SIZE + 1).data[0] = -1.0f;
+
+		REQUIRE(copy[WaveData::CHUNK_SIZE + 1][0] == -1.0f);
+		REQUIRE(data[WaveData::CHUNK_SIZE + 1][0] == WaveData::CHUNK_SIZE + 1);
+		REQUIRE(copy[0] == data[0]);                   // Untouched chunk, still shared
+		REQUIRE(copy[SIZE - 1] == data[SIZE - 1]);     // Untouched chunk, still shared
+		REQUIRE(!copy.isSameContent(data));
+	}
+
+	SECTION("test revision")
+	{
+		WaveData copy = data;
+
+		REQUIRE(copy.getRevision() == data.getRevision());
+
+		/* Raw writes are stamped once, by hand. */
+
+		copy.getWritableBlock(0);
+		REQUIRE(copy.getRevision() == data.getRevision());
+		copy.touch();
+		REQUIRE(copy.getRevision() != data.getRevision());
+
+		copy = data;
+		copy.addData(data);
+		REQUIRE(copy.getRevision() != data.getRevision());
+
+		copy = data;
+		copy.rotate(1);
+		REQUIRE(copy.getRevision() != data.getRevision());
+		REQUIRE(WaveData(SIZE, CHANNELS).getRevision() != WaveData(SIZE, CHANNELS).getRevision());
+	}
+
+	SECTION("test merge")
+	{
+		/* Across chunk boundaries, and onto shared chunks without touching the
+		other reference. */
+
+		WaveData copy = data;
+		std::vector<float> ones(100 * CHANNELS, 1.0f);
+		data.addData(ones.data(), 100, 0.5f, WaveData::CHUNK_SIZE - 50);
+
+		REQUIRE(data[WaveData::CHUNK_SIZE - 51][0] == WaveData::CHUNK_SIZE - 51);
+		REQUIRE(data[WaveData::CHUNK_SIZE - 50][0] == WaveData::CHUNK_SIZE - 49.5f);
+		REQUIRE(data[WaveData::CHUNK_SIZE + 49][1] == WaveData::CHUNK_SIZE + 49.5f);
+		REQUIRE(data[WaveData::CHUNK_SIZE + 50][0] == WaveData::CHUNK_SIZE + 50);
+		REQUIRE(copy[WaveData::CHUNK_SIZE][0] == WaveData::CHUNK_SIZE);
+
+		copy.addData(data);
+
+		REQUIRE(copy[10][0] == 20);
+		REQUIRE(copy[WaveData::CHUNK_SIZE][1] == WaveData::CHUNK_SIZE * 2 + 0.5f);
+	}
+
+	SECTION("test shared chunk in the same table")
+	{
+		/* Writing to a chunk referenced twice must not affect the other 
+		reference. */
+
+		data.insert(0, data.slice(0, 10));
+		data.getWritableBlock(0).data[0] = -1.0f;
+
+		REQUIRE(data[0][0] == -1.0f);
+		REQUIRE(data[10][0] == 0);
+	}
+
+	SECTION("test content comparison")
+	{
+		WaveData other(SIZE, CHANNELS);
+		
+		REQUIRE(!other.isSameContent(data));
+
+		/* Same content, different memory. */
+
+		for (int i = 0; i < SIZE;) {
+			WaveData::Block block = data.getBlock(i);
+			other.copyData(block.data, block.frames, CHANNELS, i);
+			i += block.frames;
+		}
+
+		REQUIRE(other[0] != data[0]);
+		REQUIRE(other.isSameContent(data));
+	}
+
+	SECTION("test changes")
+	{
+		WaveData copy = data;
+
+		WaveData::Changes changes = copy.findChanges(data);
+		REQUIRE(changes.first == SIZE);
+		REQUIRE(changes.last == SIZE);
+
+		SECTION("write")
+		{
+			copy.getWritableBlock(WaveData::CHUNK_SIZE + 1).data[0] = -1.0f;
+			changes = copy.findChanges(data);
+
+			/* The whole chunk has been copied. */
+
+			REQUIRE(changes.first == WaveData::CHUNK_SIZE);
+			REQUIRE(changes.last == WaveData::CHUNK_SIZE * 2);
+		}
+
+		SECTION("remove")
+		{
+			copy.remove(10, 20);
+			changes = copy.findChanges(data);
+
+			REQUIRE(changes.first == 10);
+			REQUIRE(changes.last == 10);
+		}
+
+		SECTION("insert")
+		{
+			copy.insert(100, WaveData(50, CHANNELS));
+			changes = copy.findChanges(data);
+
+			REQUIRE(changes.first == 100);
+			REQUIRE(changes.last == 150);
+		}
+
+		SECTION("unrelated data")
+		{
+			changes = WaveData(SIZE, CHANNELS).findChanges(data);
+
+			REQUIRE(changes.first == 0);
+			REQUIRE(changes.last == SIZE);
+		}
+	}
+}
+
+
+TEST_CASE("WaveData compact storage")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const int SIZE     = WaveData::CHUNK_SIZE + 100; // 2 chunks
+	static const int CHANNELS = 2;
+
+	/* A ramp in [-1.0, 1.0], plus a few tiny values that half-floats store as
+	denormals. */
+
+	std::vector<float> src(SIZE * CHANNELS);
+	for (std::size_t i = 0; i < src.size(); i++)
+		src[i] = -1.0f + 2.0f * i / (src.size() - 1);
+	src[1] = 1e-6f;
+	src[2] = -3e-7f;
+
+	WaveData data(SIZE, CHANNELS);
+	data.copyData(src.data(), SIZE, CHANNELS);
+
+	SampleStorage storage = GENERATE(SampleStorage::INT16, SampleStorage::HALF);
+	
+	/* Max error: half an int16 step, or half a half-float ulp in [0.5, 1.0). */
+
+	const float tolerance = storage == SampleStorage::INT16 ? 1.0f / 32767 : 1.0f / 2048;
+
+	WaveData compact = data;
+	compact.compact(storage);
+
+	SECTION("test read")
+	{
+		REQUIRE(compact.isCompact());
+		REQUIRE(!data.isCompact());
+		REQUIRE(compact.countFrames() == SIZE);
+
+		std::vector<float> out(src.size());
+		compact.read(0, SIZE, out.data());
+
+		for (std::size_t i = 0; i < src.size(); i++)
+			REQUIRE(out[i] == Approx(src[i]).margin(tolerance));
+		REQUIRE(out[SIZE * CHANNELS - 1] == 1.0f);
+		if (storage == SampleStorage::HALF)
+			REQUIRE(out[1] == Approx(1e-6f).margin(1e-7f));
+
+		/* Partial read across chunks. */
+
+		std::vector<float> part(200 * CHANNELS);
+		compact.read(WaveData::CHUNK_SIZE - 100, 200, part.data());
+		REQUIRE(part[0] == out[(WaveData::CHUNK_SIZE - 100) * CHANNELS]);
+		REQUIRE(part[part.size() - 1] == out[(WaveData::CHUNK_SIZE + 100) * CHANNELS - 1]);
+	}
+
+	SECTION("test memory")
+	{
+		REQUIRE(compact.countExclusiveBytes(data) * 2 == data.countExclusiveBytes(compact));
+	}
+
+	SECTION("test structural edits")
+	{
+		std::vector<float> before(src.size());
+		compact.read(0, SIZE, before.data());
+
+		compact.rotate(10);
+		compact.remove(0, 5);
+
+		std::vector<float> after(2 * CHANNELS);
+		compact.read(0, 2, after.data());
+		REQUIRE(compact.isCompact());
+		REQUIRE(after[0] == before[15 * CHANNELS]);
+		REQUIRE(after[2] == before[16 * CHANNELS]);
+	}
+
+	SECTION("test promotion on write")
+	{
+		std::vector<float> before(src.size());
+		compact.read(0, SIZE, before.data());
+
+		/* Only the written chunk is promoted to float. */
+
+		compact.getWritableBlock(WaveData::CHUNK_SIZE).data[0] = 0.5f;
+
+		REQUIRE(compact.isCompact());
+		REQUIRE(compact[WaveData::CHUNK_SIZE][0] == 0.5f);
+		REQUIRE(compact[WaveData::CHUNK_SIZE][1] == before[WaveData::CHUNK_SIZE * CHANNELS + 1]);
+
+		compact.compact(SampleStorage::FLOAT);
+
+		REQUIRE(!compact.isCompact());
+		REQUIRE(compact[0][0] == before[0]);
+	}
+
+	SECTION("test content comparison")
+	{
+		WaveData other = data;
+		other.compact(storage);
+
+		REQUIRE(other.isSameContent(compact));
+		REQUIRE(!other.isSameContent(data));
+	}
+}
@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <memory>
 #include "../src/core/model/model.h"
 #include "../src/core/const.h"
@@ -103,6 +104,70 @@ TEST_CASE("waveFx")
 		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(b)[1] == 0.0f);
 	}
 
+	SECTION("test fade values")
+	{
+		int a = 100;
+		int b = 1100;
+		float d = 1.0f / (b - a);
+
+		for (int i=0; i<getWave(WAVE_STEREO_ID).getSize(); i++)
+			getWave(WAVE_STEREO_ID)[i][0] = getWave(WAVE_STEREO_ID)[i][1] = 1.0f;
+
+		wfx::fade(getWave(WAVE_STEREO_ID).id, a, b, wfx::Fade::OUT);
+
+		for (int i=a; i<=b; i++) {
+			REQUIRE(getWave(WAVE_STEREO_ID).getFrame(i)[0] == Approx((b - i) * d));
+			REQUIRE(getWave(WAVE_STEREO_ID).getFrame(i)[1] == Approx((b - i) * d));
+		}
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(b + 1)[0] == 1.0f);
+	}
+
+	SECTION("test normalize")
+	{
+		/* The peak is searched across all channels. */
+
+		getWave(WAVE_STEREO_ID)[10][0] = 0.5f;
+		getWave(WAVE_STEREO_ID)[10][1] = 0.25f;
+		getWave(WAVE_STEREO_ID)[20][1] = -0.1f;
+
+		wfx::normalize(getWave(WAVE_STEREO_ID).id, 0, getWave(WAVE_STEREO_ID).getSize());
+
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(10)[0] == Approx(1.0f));
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(10)[1] == Approx(0.5f));
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(20)[1] == Approx(-0.2f));
+	}
+
+	SECTION("test reverse")
+	{
+		int a = 10;
+		int b = 20;
+
+		getWave(WAVE_STEREO_ID)[a][0] = 1.0f;
+		getWave(WAVE_STEREO_ID)[a][1] = 2.0f;
+
+		wfx::reverse(getWave(WAVE_STEREO_ID).id, a, b);
+
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(b - 1)[0] == 1.0f);
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(b - 1)[1] == 2.0f);
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(a)[0] == 0.0f);
+	}
+
+	SECTION("test shift")
+	{
+		int prevSize = getWave(WAVE_STEREO_ID).getSize();
+
+		getWave(WAVE_STEREO_ID)[0][0] = 1.0f;
+
+		wfx::shift(getWave(WAVE_STEREO_ID).id, 10);
+
+		REQUIRE(getWave(WAVE_STEREO_ID).getSize() == prevSize);
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(10)[0] == 1.0f);
+
+		wfx::shift(getWave(WAVE_STEREO_ID).id, -10);
+
+		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(0)[0] == 1.0f);
+	}
+
 	SECTION("test smooth")
 	{
 		int a = 11;
@@ -116,3 +181,136 @@ TEST_CASE("waveFx")
 		REQUIRE(getWave(WAVE_STEREO_ID).getFrame(b)[1] == 0.0f);
 	}
 }
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("waveFx long ranges")
+{
+	/* Long ranges are processed in parallel, one span at a time. Make sure 
+	span boundaries don't show up in the results. */
+
+	static const ID  WAVE_ID = 1;
+	static const int SIZE    = WaveData::CHUNK_SIZE * 10 + 1001;
+
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(WAVE_ID);
+	wave->alloc(SIZE, 2, 44100, 32, "path/to/sample.wav");
+	for (int i=0; i<SIZE; i++) {
+		(*wave)[i][0] = i / static_cast<float>(SIZE) * 0.5f;
+		(*wave)[i][1] = -0.25f;
+	}
+
+	model::waves.clear();
+	model::waves.push(std::move(wave));
+
+	int a = 500;
+	int b = SIZE - 500;
+
+	SECTION("test normalize")
+	{
+		wfx::normalize(WAVE_ID, a, b);
+
+		for (int i=a; i<b; i++) {
+			REQUIRE(getWave(WAVE_ID).getFrame(i)[0] == Approx(i / static_cast<float>(b - 1)).margin(0.001));
+			REQUIRE(getWave(WAVE_ID).getFrame(i)[1] == Approx(-0.25f / ((b - 1) / static_cast<float>(SIZE) * 0.5f)));
+		}
+		REQUIRE(getWave(WAVE_ID).getFrame(b)[1] == -0.25f);
+	}
+
+	SECTION("test fade")
+	{
+		float d = 1.0f / (b - a);
+
+		wfx::fade(WAVE_ID, a, b, wfx::Fade::IN);
+
+		for (int i=a; i<=b; i++)
+			REQUIRE(getWave(WAVE_ID).getFrame(i)[1] == Approx(-0.25f * (i - a) * d));
+		REQUIRE(getWave(WAVE_ID).getFrame(a - 1)[1] == -0.25f);
+	}
+
+	SECTION("test silence")
+	{
+		wfx::silence(WAVE_ID, a, b);
+
+		REQUIRE(getWave(WAVE_ID).getFrame(a - 1)[1] == -0.25f);
+		for (int i=a; i<b; i++)
+			REQUIRE(getWave(WAVE_ID).getFrame(i)[1] == 0.0f);
+		REQUIRE(getWave(WAVE_ID).getFrame(b)[1] == -0.25f);
+	}
+
+	SECTION("test reverse")
+	{
+		wfx::reverse(WAVE_ID, a, b);
+
+		for (int i=a; i<b; i++)
+			REQUIRE(getWave(WAVE_ID).getFrame(i)[0] == (a + b - 1 - i) / static_cast<float>(SIZE) * 0.5f);
+	}
+
+	SECTION("test mono->stereo conversion")
+	{
+		Wave mono(2);
+		mono.alloc(SIZE, 1, 44100, 32, "path/to/sample.wav");
+		for (int i=0; i<SIZE; i++)
+			mono[i][0] = static_cast<float>(i);
+
+		REQUIRE(wfx::monoToStereo(mono) == G_RES_OK);
+
+		for (int i=0; i<SIZE; i++) {
+			REQUIRE(mono.getFrame(i)[0] == static_cast<float>(i));
+			REQUIRE(mono.getFrame(i)[1] == static_cast<float>(i));
+		}
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("waveFx benchmarks", "[.][benchmark]")
+{
+	/* Cost of editing a ten minutes stereo sample as a whole. Each edit works 
+	on a copy of the Wave, as the sample editor does: the cost of copying the 
+	touched chunks is included. */
+
+	static const ID  WAVE_ID = 1;
+	static const int SIZE    = G_DEFAULT_SAMPLERATE * 600;
+
+	std::unique_ptr<Wave> wave = std::make_unique<Wave>(WAVE_ID);
+	wave->alloc(SIZE, 2, G_DEFAULT_SAMPLERATE, 32, "path/to/sample.wav");
+	for (int i=0; i<SIZE; i++)
+		(*wave)[i][0] = (*wave)[i][1] = (std::rand() / static_cast<float>(RAND_MAX)) - 0.5f;
+
+	model::waves.clear();
+	model::waves.push(std::move(wave));
+
+	BENCHMARK("normalize") { wfx::normalize(WAVE_ID, 0, SIZE); };
+	BENCHMARK("fade")      { wfx::fade(WAVE_ID, 0, SIZE - 1, wfx::Fade::OUT); };
+	BENCHMARK("reverse")   { wfx::reverse(WAVE_ID, 0, SIZE); };
+	BENCHMARK("silence")   { wfx::silence(WAVE_ID, 0, SIZE); };
+
+	/* Cut and trim change the size of the Wave: each run gets its own copy. */
+
+	ID next = WAVE_ID + 1;
+
+	auto resize = [&](Catch::Benchmark::Chronometer meter, auto f)
+	{
+		ID first = next;
+		for (int i=0; i<meter.runs(); i++) {
+			std::unique_ptr<Wave> copy = std::make_unique<Wave>(getWave(WAVE_ID));
+			copy->id = next++;
+			model::waves.push(std::move(copy));
+		}
+		meter.measure([&](int i) { f(first + i); });
+	};
+
+	BENCHMARK_ADVANCED("cut")(Catch::Benchmark::Chronometer meter)
+	{
+		resize(meter, [](ID id) { wfx::cut(id, SIZE / 4, SIZE / 2); });
+	};
+
+	BENCHMARK_ADVANCED("trim")(Catch::Benchmark::Chronometer meter)
+	{
+		resize(meter, [](ID id) { wfx::trim(id, SIZE / 4, SIZE / 2); });
+	};
+}
@@ -0,0 +1,111 @@
+#include "../src/core/waveHistory.h"
+#include "../src/core/waveData.h"
+#include <catch2/catch.hpp>
+
+
+TEST_CASE("WaveHistory")
+{
+	using namespace giada::m;
+
+	static const int SIZE     = WaveData::CHUNK_SIZE * 4;
+	static const int CHANNELS = 2;
+	static const std::size_t CHUNK_BYTES = WaveData::CHUNK_SIZE * CHANNELS * sizeof(float);
+
+	WaveData    data(SIZE, CHANNELS);
+	WaveHistory history(CHUNK_BYTES * 100);
+
+	/* edit
+	Writes 'value' to frame 'f', recording the change. */
+
+	auto edit = [&](giada::Frame f, float value)
+	{
+		WaveData before = data;
+		data.getWritableBlock(f).data[0] = value;
+		history.push(before, data);
+	};
+
+	SECTION("test empty history")
+	{
+		REQUIRE(history.canUndo() == false);
+		REQUIRE(history.canRedo() == false);
+		REQUIRE(history.undo() == nullptr);
+		REQUIRE(history.redo() == nullptr);
+		REQUIRE(history.getBytes() == 0);
+	}
+
+	SECTION("test undo/redo")
+	{
+		edit(0, 1.0f);
+		edit(0, 2.0f);
+
+		REQUIRE(history.countSteps() == 2);
+		REQUIRE(history.canUndo() == true);
+		REQUIRE(history.canRedo() == false);
+
+		data = history.undo()->before;
+		REQUIRE(data[0][0] == 1.0f);
+		data = history.undo()->before;
+		REQUIRE(data[0][0] == 0.0f);
+		REQUIRE(history.canUndo() == false);
+		REQUIRE(history.canRedo() == true);
+
+		data = history.redo()->after;
+		REQUIRE(data[0][0] == 1.0f);
+		data = history.redo()->after;
+		REQUIRE(data[0][0] == 2.0f);
+		REQUIRE(history.canRedo() == false);
+	}
+
+	SECTION("test new edit clears redo")
+	{
+		edit(0, 1.0f);
+		edit(0, 2.0f);
+		data = history.undo()->before;
+		edit(0, 3.0f);
+
+		REQUIRE(history.countSteps() == 2);
+		REQUIRE(history.canRedo() == false);
+
+		data = history.undo()->before;
+		REQUIRE(data[0][0] == 1.0f);
+	}
+
+	SECTION("test memory is proportional to the change")
+	{
+		edit(0, 1.0f);
+
+		/* One chunk replaced: the old and the new one are both held. */
+
+		REQUIRE(history.getBytes() == CHUNK_BYTES * 2);
+
+		/* Structural edits don't touch audio data. */
+
+		WaveData before = data;
+		data.remove(0, WaveData::CHUNK_SIZE);
+		history.push(before, data);
+
+		REQUIRE(history.getBytes() == CHUNK_BYTES * 3);
+	}
+
+	SECTION("test memory budget")
+	{
+		history.setMaxBytes(CHUNK_BYTES * 4);
+
+		edit(0, 1.0f);
+		edit(0, 2.0f);
+		edit(0, 3.0f);
+
+		REQUIRE(history.countSteps() == 2);
+		REQUIRE(history.getBytes() <= CHUNK_BYTES * 4);
+
+		data = history.undo()->before;
+		data = history.undo()->before;
+		REQUIRE(data[0][0] == 1.0f);
+		REQUIRE(history.canUndo() == false);
+
+		history.setMaxBytes(0);
+
+		REQUIRE(history.countSteps() == 0);
+		REQUIRE(history.getBytes() == 0);
+	}
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <samplerate.h>
+#include "../src/core/waveLoader.h"
+#include "../src/core/waveManager.h"
+#include "../src/core/wave.h"
+#include "../src/core/patch.h"
+#include "../src/core/const.h"
+#include "../src/core/types.h"
+#include <catch2/catch.hpp>
+
+
+namespace
+{
+/* load
+Decodes 'waves' with the waveLoader and returns them sorted by patch ID. */
+
+std::vector<giada::m::waveLoader::Loaded> load(const std::vector<giada::m::patch::Wave>& waves)
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	waveLoader::start(waves, 88200, SRC_LINEAR, SampleStorage::FLOAT);
+	waveLoader::wait();
+
+	std::vector<waveLoader::Loaded> out = waveLoader::collect();
+	std::sort(out.begin(), out.end(),
+		[](const waveLoader::Loaded& a, const waveLoader::Loaded& b) { return a.id < b.id; });
+	return out;
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("waveLoader")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	waveManager::init();
+
+	std::vector<patch::Wave> pwaves;
+	for (ID id = 1; id <= 16; id++)
+		pwaves.push_back({ id, TEST_RESOURCES_DIR "test.wav" });
+	pwaves.push_back({ 17, "/path/to/nowhere.wav" });
+
+	SECTION("test parallel loading")
+	{
+		std::vector<waveLoader::Loaded> waves = load(pwaves);
+
+		REQUIRE(waveLoader::isLoading() == false);
+		REQUIRE(waves.size() == pwaves.size());
+		REQUIRE(waves.back().wave == nullptr);
+
+		std::unique_ptr<Wave> ref = waveManager::deserializeWave(pwaves[0], 88200, SRC_LINEAR);
+
+		for (std::size_t i = 0; i < waves.size() - 1; i++) {
+			const Wave& w = *waves[i].wave;
+			REQUIRE(waves[i].id == pwaves[i].id);
+			REQUIRE(w.id == pwaves[i].id);
+			REQUIRE(w.getSize() == ref->getSize());
+			REQUIRE(w.getRate() == 88200);
+			REQUIRE(w.getFrame(ref->getSize() / 2)[0] == std::as_const(*ref).getFrame(ref->getSize() / 2)[0]);
+		}
+	}
+
+	SECTION("test stop")
+	{
+		waveLoader::start(pwaves, 88200, SRC_LINEAR, SampleStorage::FLOAT);
+		waveLoader::stop();
+
+		REQUIRE(waveLoader::isLoading() == false);
+		REQUIRE(waveLoader::collect().empty());
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("waveLoader benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Loads copies of the test asset many times, as in a project with lots of
+	samples. Compare against 'deserializeWave in a loop' to see the speedup.
+	Copies live in different files, so that each one is actually decoded. */
+
+	namespace fs = std::filesystem;
+
+	std::vector<patch::Wave> pwaves;
+	for (ID id = 1; id <= 200; id++) {
+		fs::path path = fs::temp_directory_path() / ("giada-test-" + std::to_string(id) + ".wav");
+		fs::copy_file(TEST_RESOURCES_DIR "test.wav", path, fs::copy_options::overwrite_existing);
+		pwaves.push_back({ id, path.string() });
+	}
+
+	BENCHMARK("deserializeWave in a loop")
+	{
+		std::vector<std::unique_ptr<Wave>> waves;
+		for (const patch::Wave& w : pwaves)
+			waves.push_back(waveManager::deserializeWave(w, 88200, SRC_LINEAR));
+		return waves.size();
+	};
+
+	BENCHMARK("waveLoader")
+	{
+		return load(pwaves).size();
+	};
+
+	/* Same file over and over: data is decoded once and then shared. */
+
+	std::vector<patch::Wave> sameWaves(pwaves.size(), pwaves[0]);
+
+	BENCHMARK("waveLoader, same file")
+	{
+		return load(sameWaves).size();
+	};
+
+	for (const patch::Wave& w : pwaves)
+		fs::remove(w.path);
+}
@@ -1,12 +1,21 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <memory>
+#include <vector>
+#include <utility>
+#include <filesystem>
 #include <samplerate.h>
 #include "../src/core/waveManager.h"
 #include "../src/core/wave.h"
+#include "../src/core/audioBuffer.h"
+#include "../src/core/patch.h"
 #include "../src/core/const.h"
 #include <catch2/catch.hpp>
 
 
 using std::string;
+using namespace giada;
 using namespace giada::m;
 
 
@@ -44,6 +53,15 @@ TEST_CASE("waveManager")
 		REQUIRE(wave->isEdited() == false);
 	}
 
+	SECTION("test reserved IDs")
+	{
+		waveManager::init();
+		waveManager::reserveIds({ { 1, "a.wav" }, { 40, "b.wav" } });
+
+		REQUIRE(waveManager::createEmpty(G_BUFFER_SIZE, G_MAX_IO_CHANS, 
+			G_SAMPLE_RATE, "test.wav")->id == 41);
+	}
+
 	SECTION("test resampling")
 	{
 		waveManager::Result res = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
@@ -58,4 +76,186 @@ TEST_CASE("waveManager")
 		REQUIRE(res.wave->isLogical() == false);
 		REQUIRE(res.wave->isEdited() == false);
 	}
+
+	SECTION("test chunked resampling")
+	{
+		/* Segments processed in parallel must match a single run over the 
+		whole data. */
+
+		const int SIZE = WaveData::CHUNK_SIZE * 10 + 123;
+		const int rate = GENERATE(48000, 22050, 96000, 8000);
+
+		std::vector<float> data(SIZE * G_CHANNELS);
+		std::uint32_t seed = 1;
+		for (int i = 0; i < SIZE; i++) {
+			seed = seed * 1664525u + 1013904223u;
+			float noise = (seed >> 8) / float(1 << 24) - 0.5f;
+			data[i * 2]     = 0.5f * std::sin(i * 0.01f) + 0.1f * noise;
+			data[i * 2 + 1] = 0.5f * std::sin(i * 0.37f);
+		}
+
+		std::unique_ptr<Wave> wave = waveManager::createEmpty(SIZE, G_CHANNELS, 
+			G_SAMPLE_RATE, "test.wav");
+		wave->copyData(data.data(), SIZE, G_CHANNELS);
+
+		REQUIRE(waveManager::resample(*wave, SRC_SINC_FASTEST, rate) == G_RES_OK);
+
+		std::vector<float> ref(wave->getSize() * G_CHANNELS);
+
+		SRC_DATA src_data;
+		src_data.data_in       = data.data();
+		src_data.input_frames  = SIZE;
+		src_data.data_out      = ref.data();
+		src_data.output_frames = wave->getSize();
+		src_data.src_ratio     = rate / static_cast<double>(G_SAMPLE_RATE);
+		REQUIRE(src_simple(&src_data, SRC_SINC_FASTEST, G_CHANNELS) == 0);
+
+		std::vector<float> out(ref.size());
+		wave->getData().read(0, wave->getSize(), out.data());
+
+		float maxError = 0.0f;
+		for (long i = 0; i < src_data.output_frames_gen * G_CHANNELS; i++)
+			maxError = std::max(maxError, std::fabs(out[i] - ref[i]));
+
+		REQUIRE(wave->getRate() == rate);
+		REQUIRE(maxError < 1e-4f);
+	}
+
+	SECTION("test data sharing")
+	{
+		waveManager::Result a = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+			/*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+		waveManager::Result b = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+			/*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		REQUIRE(a.wave->id != b.wave->id);
+		REQUIRE(a.wave->isSharingData(*b.wave));
+
+		SECTION("test copy-on-write")
+		{
+			(*b.wave)[0][0] = 1.0f;
+
+			REQUIRE(!a.wave->isSharingData(*b.wave));
+			REQUIRE(std::as_const(*a.wave)[0][0] != 1.0f);
+		}
+
+		SECTION("test whole Wave copy")
+		{
+			std::unique_ptr<Wave> c = waveManager::createFromWave(*a.wave, 0, a.wave->getSize());
+
+			REQUIRE(c->isSharingData(*a.wave));
+			REQUIRE(c->isLogical() == true);
+		}
+
+		SECTION("test modified data")
+		{
+			/* Data modified in place is not shared anymore with new Waves. */
+
+			AudioBuffer buffer(a.wave->getSize(), a.wave->getChannels());
+			buffer[0][0] = 1.0f;
+
+			b.wave.reset();
+			a.wave->addData(buffer);
+			
+			waveManager::Result c = waveManager::createFromFile(TEST_RESOURCES_DIR "test.wav",
+				/*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+			REQUIRE(!c.wave->isSharingData(*a.wave));
+		}
+	}
+
+	SECTION("test persist")
+	{
+		namespace fs = std::filesystem;
+
+		fs::path dir = fs::temp_directory_path() / "giada-test-persist";
+		fs::remove_all(dir);
+		fs::create_directory(dir);
+		fs::copy_file(TEST_RESOURCES_DIR "test.wav", dir / "source.wav");
+
+		waveManager::Result res = waveManager::createFromFile((dir / "source.wav").string(),
+			/*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+		REQUIRE(!res.wave->isDirty());
+		REQUIRE(res.wave->getSourcePath() == (dir / "source.wav").string());
+
+		SECTION("test clean Wave")
+		{
+			/* Linked, not written: both paths point to the same file. */
+
+			REQUIRE(waveManager::persist(*res.wave, (dir / "linked.wav").string()) == G_RES_OK);
+			REQUIRE(fs::equivalent(dir / "source.wav", dir / "linked.wav"));
+		}
+
+		SECTION("test dirty Wave")
+		{
+			(*res.wave)[0][0] = 0.5f;
+			fs::create_hard_link(dir / "source.wav", dir / "written.wav");
+
+			REQUIRE(res.wave->isDirty());
+			REQUIRE(waveManager::persist(*res.wave, (dir / "written.wav").string()) == G_RES_OK);
+
+			/* Existing links are broken, not written through. */
+
+			REQUIRE(!fs::equivalent(dir / "source.wav", dir / "written.wav"));
+
+			waveManager::Result written = waveManager::createFromFile((dir / "written.wav").string(),
+				/*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+			REQUIRE(std::as_const(*written.wave)[0][0] == 0.5f);
+		}
+
+		SECTION("test parallel persist")
+		{
+			Wave dirty(*res.wave);
+			dirty[0][0] = 0.5f;
+
+			std::vector<int> results = waveManager::persist({ res.wave.get(), &dirty }, 
+				{ (dir / "a.wav").string(), (dir / "b.wav").string() });
+
+			REQUIRE(results == std::vector<int>{ G_RES_OK, G_RES_OK });
+			REQUIRE(fs::equivalent(dir / "source.wav", dir / "a.wav"));
+			REQUIRE(fs::exists(dir / "b.wav"));
+		}
+
+		SECTION("test formats")
+		{
+			/* A different format means a new file, even for a clean Wave. */
+
+			REQUIRE(waveManager::persist(*res.wave, (dir / "compressed.flac").string(), 
+				SampleFileFormat::FLAC) == G_RES_OK);
+			REQUIRE(!fs::equivalent(dir / "source.wav", dir / "compressed.flac"));
+
+			/* Original bit depth is preserved. */
+
+			(*res.wave)[0][0] = 0.5f;
+
+			REQUIRE(res.wave->getBits() == 16);
+			REQUIRE(waveManager::save(*res.wave, (dir / "original.wav").string(), 
+				SampleFileFormat::WAV_ORIGINAL) == G_RES_OK);
+
+			waveManager::Result original = waveManager::createFromFile((dir / "original.wav").string(),
+				/*ID=*/0, /*sampleRate=*/G_SAMPLE_RATE, /*quality=*/SRC_LINEAR);
+
+			REQUIRE(original.wave->getBits() == 16);
+			REQUIRE(std::as_const(*original.wave)[0][0] == Approx(0.5f).margin(0.0001));
+		}
+
+		fs::remove_all(dir);
+	}
+}
+
+
+TEST_CASE("waveManager benchmarks", "[.][benchmark]")
+{
+	/* A 10-minute stereo sample, from 44.1 kHz to 48 kHz. */
+
+	std::unique_ptr<Wave> wave = waveManager::createEmpty(G_SAMPLE_RATE * 600, 
+		G_CHANNELS, G_SAMPLE_RATE, "test.wav");
+
+	BENCHMARK("resample")
+	{
+		Wave copy(*wave);
+		return waveManager::resample(copy, SRC_SINC_FASTEST, 48000);
+	};
 }
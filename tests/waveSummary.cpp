@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "../src/core/waveSummary.h"
+#include "../src/core/waveData.h"
+#include "../src/core/const.h"
+#include <catch2/catch.hpp>
+
+
+namespace
+{
+/* summarize
+Brute-force reference: min, max and RMS of the mono mix of frames [a, b). */
+
+giada::m::WaveSummary::Bin summarize(const giada::m::WaveData& data, giada::Frame a, giada::Frame b)
+{
+	std::vector<float> frames((b - a) * data.countChannels());
+	data.read(a, b - a, frames.data());
+
+	float  min   = frames.empty() ? 0.0f : 1.0f;
+	float  max   = frames.empty() ? 0.0f : -1.0f;
+	double power = 0.0;
+	for (giada::Frame f = 0; f < b - a; f++) {
+		float v = (frames[f * 2] + frames[f * 2 + 1]) / 2.0f;
+		min    = std::min(min, v);
+		max    = std::max(max, v);
+		power += v * v;
+	}
+	return {min, max, b > a ? static_cast<float>(std::sqrt(power / (b - a))) : 0.0f};
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void fill(giada::m::WaveData& data, giada::Frame a, giada::Frame b)
+{
+	std::vector<float> frames((b - a) * data.countChannels());
+	for (float& s : frames)
+		s = (std::rand() / static_cast<float>(RAND_MAX)) * 2.0f - 1.0f;
+	data.copyData(frames.data(), b - a, data.countChannels(), a);
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+void requireSame(const giada::m::WaveSummary& a, const giada::m::WaveSummary& b,
+	giada::Frame from, giada::Frame to)
+{
+	giada::m::WaveSummary::Bin ba = a.get(from, to);
+	giada::m::WaveSummary::Bin bb = b.get(from, to);
+	REQUIRE(ba.min == bb.min);
+	REQUIRE(ba.max == bb.max);
+	REQUIRE(ba.rms == Approx(bb.rms));
+}
+} // {anonymous}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("WaveSummary")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	static const Frame SIZE = WaveData::CHUNK_SIZE * 3 + 1000;
+
+	WaveData data(SIZE, 2);
+	fill(data, 0, SIZE);
+
+	WaveSummary summary;
+	summary.update(data);
+
+	SECTION("test levels")
+	{
+		REQUIRE(summary.countFrames() == SIZE);
+		REQUIRE(summary.isUpToDate(data));
+		REQUIRE(summary.countLevels() > 1);
+	}
+
+	SECTION("test ranges")
+	{
+		/* Min and max are exact on bin boundaries. */
+
+		for (Frame a : { 0, 16384, 65536 }) {
+			for (Frame length : { 64, 256, 1024, 16384 }) {
+				WaveSummary::Bin expected = summarize(data, a, a + length);
+				WaveSummary::Bin bin      = summary.get(a, a + length);
+				REQUIRE(bin.min == expected.min);
+				REQUIRE(bin.max == expected.max);
+				REQUIRE(bin.rms == Approx(expected.rms).epsilon(0.001));
+			}
+		}
+
+		/* Short ranges are read from the audio data. */
+
+		WaveSummary::Bin expected = summarize(data, 100, 110);
+		WaveSummary::Bin bin      = summary.get(100, 110);
+		REQUIRE(bin.min == expected.min);
+		REQUIRE(bin.max == expected.max);
+
+		/* Ranges are clamped. */
+
+		REQUIRE(summary.get(SIZE, SIZE + 100).rms == 0.0f);
+	}
+
+	SECTION("test incremental update")
+	{
+		WaveData edited = data;
+
+		SECTION("write")  { fill(edited, 1000, 2000); }
+		SECTION("remove") { edited.remove(1000, 1033); }
+		SECTION("insert") { edited.insert(1000, data.slice(0, WaveSummary::BASE * 3)); }
+		SECTION("rotate") { edited.rotate(SIZE / 2); }
+
+		REQUIRE(!summary.isUpToDate(edited));
+
+		summary.update(edited);
+
+		WaveSummary reference;
+		reference.update(edited);
+
+		REQUIRE(summary.isUpToDate(edited));
+		REQUIRE(summary.countFrames() == edited.countFrames());
+		REQUIRE(summary.countLevels() == reference.countLevels());
+
+		for (Frame a = 0; a < edited.countFrames(); a += 5000)
+			requireSame(summary, reference, a, a + 5000);
+		requireSame(summary, reference, 0, edited.countFrames());
+	}
+}
+
+
+/* -------------------------------------------------------------------------- */
+
+
+TEST_CASE("WaveSummary benchmarks", "[.][benchmark]")
+{
+	using namespace giada;
+	using namespace giada::m;
+
+	/* Cost of drawing a ten minutes sample on a 1000 pixels wide waveform,
+	scanning frames vs. reading the summary, and cost of building the summary
+	from scratch vs. after a short edit. */
+
+	static const Frame SIZE   = G_DEFAULT_SAMPLERATE * 600;
+	static const int   PIXELS = 1000;
+
+	WaveData data(SIZE, 2);
+	fill(data, 0, SIZE);
+
+	WaveSummary summary;
+	summary.update(data);
+
+	BENCHMARK("draw, scan")
+	{
+		float peak = 0.0f;
+		for (int i = 0; i < PIXELS; i++)
+			peak += summarize(data, SIZE / PIXELS * i, SIZE / PIXELS * (i + 1)).max;
+		return peak;
+	};
+
+	BENCHMARK("draw, summary")
+	{
+		float peak = 0.0f;
+		for (int i = 0; i < PIXELS; i++)
+			peak += summary.get(SIZE / PIXELS * i, SIZE / PIXELS * (i + 1)).max;
+		return peak;
+	};
+
+	BENCHMARK("build")
+	{
+		WaveSummary s;
+		s.update(data);
+		return s.countLevels();
+	};
+
+	BENCHMARK_ADVANCED("update after edit")(Catch::Benchmark::Chronometer meter)
+	{
+		WaveData edited = data;
+		fill(edited, SIZE / 2, SIZE / 2 + 1000);
+		std::vector<WaveSummary> summaries(meter.runs(), summary);
+		meter.measure([&](int i) { summaries[i].update(edited); return summaries[i].countLevels(); });
+	};
+}